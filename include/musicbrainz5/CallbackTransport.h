@@ -0,0 +1,77 @@
+/* --------------------------------------------------------------------------
+
+   libmusicbrainz5 - Client library to access MusicBrainz
+
+   Copyright (C) 2012 Andrew Hawkins
+
+   This file is part of libmusicbrainz5.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   libmusicbrainz5 is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+     $Id$
+
+----------------------------------------------------------------------------*/
+
+#ifndef _MUSICBRAINZ5_CALLBACK_TRANSPORT_H
+#define _MUSICBRAINZ5_CALLBACK_TRANSPORT_H
+
+#include "musicbrainz5/Transport.h"
+
+namespace MusicBrainz5
+{
+	class CCallbackTransportPrivate;
+
+	/**
+	 * @brief Transport passing requests to a callback
+	 *
+	 * Passes each request to an application supplied function, which fills in the
+	 * response. This allows responses to be generated in process, or requests to be
+	 * passed to an HTTP implementation supplied by the application.
+	 */
+	class CCallbackTransport: public CTransport
+	{
+	public:
+		/**
+		 * @brief Callback function type
+		 *
+		 * The callback should set the status of the response, and pass it the body with
+		 * MusicBrainz5::CTransportResponse::Read. It may throw any of the exceptions listed
+		 * for MusicBrainz5::CTransport::Fetch. It may be called from several threads at once.
+		 */
+
+		typedef void (*tCallback)(void *UserData, const CTransportRequest& Request, CTransportResponse& Response);
+
+		/**
+		 * @brief Constructor
+		 *
+		 * Constructor
+		 *
+		 * @param Callback Function to call for each request
+		 * @param UserData Data passed to the callback
+		 */
+
+		CCallbackTransport(tCallback Callback, void *UserData=0);
+		virtual ~CCallbackTransport();
+
+		virtual void Fetch(const CTransportRequest& Request, CTransportResponse& Response);
+
+	private:
+		CCallbackTransport(const CCallbackTransport& Other);
+		CCallbackTransport& operator =(const CCallbackTransport& Other);
+
+		CCallbackTransportPrivate * const m_d;
+	};
+}
+
+#endif
@@ -0,0 +1,84 @@
+/* --------------------------------------------------------------------------
+
+   libmusicbrainz5 - Client library to access MusicBrainz
+
+   Copyright (C) 2012 Andrew Hawkins
+
+   This file is part of libmusicbrainz5.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   libmusicbrainz5 is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+     $Id$
+
+----------------------------------------------------------------------------*/
+
+#ifndef _MUSICBRAINZ5_CHROME_TRACE_WRITER_H
+#define _MUSICBRAINZ5_CHROME_TRACE_WRITER_H
+
+#include <string>
+
+#include "musicbrainz5/TraceHook.h"
+
+namespace MusicBrainz5
+{
+	class CChromeTraceWriterPrivate;
+
+	/**
+	 * @brief Trace hook writing a Chrome trace file
+	 *
+	 * Writes the spans of each query to a file in the Trace Event JSON format, which
+	 * can be loaded into chrome://tracing or Perfetto. Each thread performing queries
+	 * appears as a separate track, and every event carries the request ID of its query.
+	 *
+	 * Events are written as they happen, so the file can be inspected even if the
+	 * program does not exit cleanly.
+	 */
+	class CChromeTraceWriter: public CTraceHook
+	{
+	public:
+		/**
+		 * @brief Constructor
+		 *
+		 * Constructor. Any existing file is replaced.
+		 *
+		 * @param FileName File to write the trace to
+		 *
+		 * @throw CFetchError The file could not be created
+		 */
+
+		CChromeTraceWriter(const std::string& FileName);
+		virtual ~CChromeTraceWriter();
+
+		virtual void Begin(unsigned long RequestID, tSpan Span, const std::string& Detail);
+		virtual void End(unsigned long RequestID, tSpan Span);
+
+		/**
+		 * @brief Return the number of events written
+		 *
+		 * Return the number of events written to the file
+		 *
+		 * @return Number of events written
+		 */
+
+		int NumEvents() const;
+
+	private:
+		CChromeTraceWriter(const CChromeTraceWriter& Other);
+		CChromeTraceWriter& operator =(const CChromeTraceWriter& Other);
+
+		CChromeTraceWriterPrivate * const m_d;
+	};
+}
+
+#endif
@@ -0,0 +1,197 @@
+/* --------------------------------------------------------------------------
+
+   libmusicbrainz5 - Client library to access MusicBrainz
+
+   Copyright (C) 2012 Andrew Hawkins
+
+   This file is part of libmusicbrainz5.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   libmusicbrainz5 is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+     $Id$
+
+----------------------------------------------------------------------------*/
+
+#ifndef _MUSICBRAINZ5_CURL_TRANSPORT_H
+#define _MUSICBRAINZ5_CURL_TRANSPORT_H
+
+#include <string>
+
+#include "musicbrainz5/Transport.h"
+
+namespace MusicBrainz5
+{
+	class CCurlTransportPrivate;
+
+	/**
+	 * @brief Transport making HTTP requests using the libcurl multi interface
+	 *
+	 * An alternative to MusicBrainz5::CNeonTransport, only available if the library was
+	 * configured with WITH_CURL. All requests are performed by a single background thread,
+	 * which drives every transfer in progress from one event loop. Requests made from
+	 * several threads at once share a small number of connections. Where the server
+	 * supports HTTP/2, they are multiplexed as separate streams on a single connection.
+	 * Each response body is passed on as it arrives by the thread that made the request,
+	 * so the background thread is never held up by parsing.
+	 *
+	 * HTTP/2 is negotiated automatically for https connections. For plain http
+	 * connections it is only used if enabled with SetHTTP2PriorKnowledge.
+	 */
+	class CCurlTransport: public CTransport
+	{
+	public:
+		/**
+		 * @brief Constructor
+		 *
+		 * Constructor
+		 *
+		 * @param UserAgent User agent string to send
+		 * @param Host Host name to connect to
+		 * @param Port Port to connect to (80 by default)
+		 * @param UseSSL true to connect using https, false to use http
+		 */
+
+		CCurlTransport(const std::string& UserAgent, const std::string& Host, int Port=80, bool UseSSL=false);
+		virtual ~CCurlTransport();
+
+		/**
+		 * @brief Set the user name to use
+		 *
+		 * Set the user name to use when authenticating with the web server
+		 *
+		 * @param UserName User name to use
+		 */
+
+		void SetUserName(const std::string& UserName);
+
+		/**
+		 * @brief Set the password to use
+		 *
+		 * Set the password to use when authenticating with the web server
+		 *
+		 * @param Password Password to use
+		 */
+
+		void SetPassword(const std::string& Password);
+
+		/**
+		 * @brief Set the proxy server to use
+		 *
+		 * Set the proxy server to use when connecting with the web server. By default the
+		 * proxy is taken from the http_proxy environment variable.
+		 *
+		 * @param ProxyHost Proxy server to use
+		 */
+
+		void SetProxyHost(const std::string& ProxyHost);
+
+		/**
+		 * @brief Set the proxy port to use
+		 *
+		 * Set the proxy server port to use when connecting to the web server
+		 *
+		 * @param ProxyPort Proxy server port to use
+		 */
+
+		void SetProxyPort(int ProxyPort);
+
+		/**
+		 * @brief Set the proxy user name to use
+		 *
+		 * Set the user name to use when authenticating with the proxy server
+		 *
+		 * @param ProxyUserName Proxy user name to use
+		 */
+
+		void SetProxyUserName(const std::string& ProxyUserName);
+
+		/**
+		 * @brief Set the proxy password to use
+		 *
+		 * Set the password to use when authenticating with the proxy server
+		 *
+		 * @param ProxyPassword Proxy server password to use
+		 */
+
+		void SetProxyPassword(const std::string& ProxyPassword);
+
+		/**
+		 * @brief Enable or disable compression
+		 *
+		 * Request gzip or deflate compressed responses from the server (enabled by default)
+		 *
+		 * @param Compression true to request compressed responses, false otherwise
+		 */
+
+		void SetCompression(bool Compression);
+
+		/**
+		 * @brief Set the maximum number of connections
+		 *
+		 * Set the maximum number of connections held open to the server (defaults to 2).
+		 * Requests beyond this wait for a connection, or share one using HTTP/2.
+		 *
+		 * @param MaxConnections Maximum number of connections
+		 */
+
+		void SetMaxConnections(int MaxConnections);
+
+		/**
+		 * @brief Set the connection timeout
+		 *
+		 * Set the number of seconds to wait for a connection to the server to be made
+		 * (defaults to 30)
+		 *
+		 * @param Seconds Connection timeout in seconds, or 0 for no timeout
+		 */
+
+		void SetConnectTimeout(int Seconds);
+
+		/**
+		 * @brief Set the read timeout
+		 *
+		 * Set the number of seconds a request may go without receiving any data before
+		 * it is abandoned (defaults to 60)
+		 *
+		 * @param Seconds Read timeout in seconds, or 0 for no timeout
+		 */
+
+		void SetReadTimeout(int Seconds);
+
+		/**
+		 * @brief Use HTTP/2 without negotiation
+		 *
+		 * Speak HTTP/2 to the server straight away on plain http connections, for servers
+		 * known to support it (disabled by default)
+		 *
+		 * @param PriorKnowledge true to use HTTP/2 without negotiation, false otherwise
+		 */
+
+		void SetHTTP2PriorKnowledge(bool PriorKnowledge);
+
+		virtual void Fetch(const CTransportRequest& Request, CTransportResponse& Response);
+
+	private:
+		CCurlTransport(const CCurlTransport& Other);
+		CCurlTransport& operator =(const CCurlTransport& Other);
+
+		CCurlTransportPrivate * const m_d;
+
+		static void *EventLoop(void *userdata);
+		static size_t curlWriter(char *ptr, size_t size, size_t nmemb, void *userdata);
+		static size_t curlHeader(char *ptr, size_t size, size_t nitems, void *userdata);
+	};
+}
+
+#endif
@@ -0,0 +1,281 @@
+/* --------------------------------------------------------------------------
+
+   libmusicbrainz5 - Client library to access MusicBrainz
+
+   Copyright (C) 2012 Andrew Hawkins
+
+   This file is part of libmusicbrainz5.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   libmusicbrainz5 is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+     $Id$
+
+----------------------------------------------------------------------------*/
+
+#ifndef _MUSICBRAINZ5_DISK_CACHE_H
+#define _MUSICBRAINZ5_DISK_CACHE_H
+
+#include <string>
+
+#include "musicbrainz5/HTTPFetch.h"
+
+namespace MusicBrainz5
+{
+	class CDiskCachePrivate;
+
+	/**
+	 * @brief Persistent cache of query responses
+	 *
+	 * Stores the responses to queries in a directory, so that they can be reused by
+	 * later processes. Each response is held in its own file, named after a hash of
+	 * the query path. Files are written to a temporary name and renamed into place,
+	 * so several processes may share the same directory safely. Nothing is read
+	 * until a query is looked up, and files are read using mmap.
+	 *
+	 * Entries expire after a time to live which may be set separately for each entity
+	 * type. Expired entries, and the oldest entries once the directory grows beyond
+	 * its size limit, are removed by Collect(), which is run automatically from time
+	 * to time when entries are added. The automatic collections run on a thread of
+	 * their own, so they never hold up a query.
+	 *
+	 * Install a cache using MusicBrainz5::CQuery::SetDiskCache. The cache is safe to
+	 * use from multiple threads.
+	 */
+	class CDiskCache
+	{
+	public:
+		/**
+		 * @brief Constructor
+		 *
+		 * Constructor. The directory is created when the first entry is written.
+		 *
+		 * @param Directory Directory to hold the cache
+		 * @param MaxBytes Maximum total size of the cached files, in bytes
+		 */
+
+		CDiskCache(const std::string& Directory, size_t MaxBytes=256*1024*1024);
+		~CDiskCache();
+
+		/**
+		 * @brief Return the directory
+		 *
+		 * Return the directory holding the cache
+		 *
+		 * @return Cache directory
+		 */
+
+		std::string Directory() const;
+
+		/**
+		 * @brief Set the size limit
+		 *
+		 * Set the maximum total size of the cached files. The limit is enforced by
+		 * Collect().
+		 *
+		 * @param MaxBytes Maximum size in bytes
+		 */
+
+		void SetMaxBytes(size_t MaxBytes);
+
+		/**
+		 * @brief Set the default time to live
+		 *
+		 * Set the number of seconds an entry is kept for entity types that have no time
+		 * to live of their own (defaults to one day)
+		 *
+		 * @param Seconds Time to live in seconds, or 0 to not cache these entities
+		 */
+
+		void SetDefaultTTL(int Seconds);
+
+		/**
+		 * @brief Set the time to live for an entity type
+		 *
+		 * Set the number of seconds responses for an entity type are kept. The entity
+		 * type is the first part of the query path, for example 'release' or 'discid'.
+		 *
+		 * @param Entity Entity type
+		 * @param Seconds Time to live in seconds, or 0 to not cache this entity type
+		 */
+
+		void SetTTL(const std::string& Entity, int Seconds);
+
+		/**
+		 * @brief Set the collection interval
+		 *
+		 * Set how often Collect() is run automatically when entries are added. The time
+		 * of the last collection is recorded in the cache directory, so the interval
+		 * applies to all processes sharing the cache.
+		 *
+		 * @param Seconds Seconds between collections, or 0 to only collect when Collect()
+		 *                is called
+		 */
+
+		void SetCollectInterval(int Seconds);
+
+		/**
+		 * @brief Set how long expired entries are kept
+		 *
+		 * Set the number of seconds after expiry that an entry with an ETag or
+		 * Last-Modified date is kept, so that it can be revalidated with the server
+		 * rather than fetched again (defaults to 30 days). Expired entries without
+		 * either header are removed as soon as they are found.
+		 *
+		 * @param Seconds Seconds to keep expired entries
+		 */
+
+		void SetMaxStale(int Seconds);
+
+		/**
+		 * @brief Look up a query
+		 *
+		 * Look up the response to a query, and pass it to a reader if found. Expired
+		 * entries are treated as missing, and removed.
+		 *
+		 * @param Query Query path
+		 * @param Reader Reader to receive the response
+		 *
+		 * @return true if the response was found and accepted by the reader, false
+		 *         otherwise
+		 */
+
+		bool Get(const std::string& Query, CHTTPBodyReader& Reader);
+
+		/**
+		 * @brief Look up a query
+		 *
+		 * Look up the response to a query, and pass it to a reader if found. Also return
+		 * the ETag and Last-Modified headers stored with the response.
+		 *
+		 * @param Query Query path
+		 * @param Reader Reader to receive the response
+		 * @param ETag Filled in with the ETag of the response
+		 * @param LastModified Filled in with the Last-Modified date of the response
+		 *
+		 * @return true if the response was found and accepted by the reader, false
+		 *         otherwise
+		 */
+
+		bool Get(const std::string& Query, CHTTPBodyReader& Reader, std::string& ETag, std::string& LastModified);
+
+		/**
+		 * @brief Return the validators of a response
+		 *
+		 * Return the ETag and Last-Modified headers stored with the response to a query,
+		 * whether or not it has expired, so that it can be revalidated with the server
+		 *
+		 * @param Query Query path
+		 * @param ETag Filled in with the ETag of the response
+		 * @param LastModified Filled in with the Last-Modified date of the response
+		 *
+		 * @return true if the response was found and has at least one of the headers,
+		 *         false otherwise
+		 */
+
+		bool Validators(const std::string& Query, std::string& ETag, std::string& LastModified);
+
+		/**
+		 * @brief Add a response
+		 *
+		 * Write the response to a query to the cache, replacing any existing entry.
+		 * Failure to write the entry is not reported.
+		 *
+		 * @param Query Query path
+		 * @param Data Response body
+		 * @param Length Length of the response body
+		 * @param ETag ETag header of the response, if any
+		 * @param LastModified Last-Modified header of the response, if any
+		 */
+
+		void Put(const std::string& Query, const char *Data, size_t Length, const std::string& ETag="", const std::string& LastModified="");
+
+		/**
+		 * @brief Renew a response
+		 *
+		 * Restart the time to live of an entry, for example because the server has
+		 * confirmed that it has not changed
+		 *
+		 * @param Query Query path
+		 */
+
+		void Touch(const std::string& Query);
+
+		/**
+		 * @brief Remove a response
+		 *
+		 * Remove the response to a query from the cache, if present
+		 *
+		 * @param Query Query path
+		 */
+
+		void Remove(const std::string& Query);
+
+		/**
+		 * @brief Remove old entries
+		 *
+		 * Remove entries that expired longer ago than allowed by SetMaxStale, then remove
+		 * the oldest remaining entries until the cache is within its size limit.
+		 */
+
+		void Collect();
+
+		/**
+		 * @brief Return the number of hits
+		 *
+		 * Return the number of lookups that were answered from the cache
+		 *
+		 * @return Number of hits
+		 */
+
+		int Hits() const;
+
+		/**
+		 * @brief Return the number of misses
+		 *
+		 * Return the number of lookups that were not found in the cache, or had expired
+		 *
+		 * @return Number of misses
+		 */
+
+		int Misses() const;
+
+		/**
+		 * @brief Return the number of writes
+		 *
+		 * Return the number of entries written to the cache
+		 *
+		 * @return Number of writes
+		 */
+
+		int Writes() const;
+
+		/**
+		 * @brief Return the number of entries collected
+		 *
+		 * Return the number of files removed by Collect()
+		 *
+		 * @return Number of entries removed
+		 */
+
+		int Collected() const;
+
+	private:
+		CDiskCache(const CDiskCache& Other);
+		CDiskCache& operator =(const CDiskCache& Other);
+
+		CDiskCachePrivate * const m_d;
+	};
+}
+
+#endif
@@ -0,0 +1,190 @@
+/* --------------------------------------------------------------------------
+
+   libmusicbrainz5 - Client library to access MusicBrainz
+
+   Copyright (C) 2012 Andrew Hawkins
+
+   This file is part of libmusicbrainz5.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   libmusicbrainz5 is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+     $Id$
+
+----------------------------------------------------------------------------*/
+
+#ifndef _MUSICBRAINZ5_ELEMENT_NAME_H
+#define _MUSICBRAINZ5_ELEMENT_NAME_H
+
+#include <string>
+
+#include "musicbrainz5/xmlParser.h"
+
+namespace MusicBrainz5
+{
+	/**
+	 * @brief Names of the elements and attributes in web service responses
+	 *
+	 * Maps the name of an element or attribute to a value that an entity can switch
+	 * on while parsing, rather than comparing the name with each one it knows in turn.
+	 * Elements and attributes share one set of values.
+	 */
+
+	class CElementName
+	{
+	public:
+		/**
+		 * @brief Enumerated type for recognised names
+		 *
+		 * Enumerated type for the names of the elements and attributes that are parsed
+		 */
+		enum tName
+		{
+			eName_Unknown=0,
+			eName_AliasList,
+			eName_AnnotationList,
+			eName_Artist,
+			eName_ArtistCredit,
+			eName_ArtistList,
+			eName_ASIN,
+			eName_AttributeList,
+			eName_Barcode,
+			eName_Begin,
+			eName_BeginDate,
+			eName_CatalogNumber,
+			eName_Category,
+			eName_CDStub,
+			eName_CDStubList,
+			eName_Collection,
+			eName_CollectionList,
+			eName_Comment,
+			eName_Count,
+			eName_Country,
+			eName_Created,
+			eName_Date,
+			eName_Direction,
+			eName_Disambiguation,
+			eName_Disc,
+			eName_DiscList,
+			eName_Editor,
+			eName_End,
+			eName_EndDate,
+			eName_Ended,
+			eName_Entity,
+			eName_FirstReleaseDate,
+			eName_Format,
+			eName_FreeDBDiscList,
+			eName_Gender,
+			eName_Generator,
+			eName_ID,
+			eName_IPI,
+			eName_IPIList,
+			eName_ISRC,
+			eName_ISRCList,
+			eName_ISWCList,
+			eName_Joinphrase,
+			eName_Label,
+			eName_LabelCode,
+			eName_LabelInfoList,
+			eName_LabelList,
+			eName_Language,
+			eName_Length,
+			eName_LifeSpan,
+			eName_Locale,
+			eName_MediumList,
+			eName_Message,
+			eName_Name,
+			eName_NameCredit,
+			eName_NonmbTrackList,
+			eName_Number,
+			eName_Offset,
+			eName_OffsetList,
+			eName_Packaging,
+			eName_Position,
+			eName_Primary,
+			eName_PrimaryType,
+			eName_PUID,
+			eName_PUIDList,
+			eName_Quality,
+			eName_Rating,
+			eName_Recording,
+			eName_RecordingList,
+			eName_RelationList,
+			eName_Release,
+			eName_ReleaseGroup,
+			eName_ReleaseGroupList,
+			eName_ReleaseList,
+			eName_Script,
+			eName_SecondaryTypeList,
+			eName_Sectors,
+			eName_SortName,
+			eName_Status,
+			eName_TagList,
+			eName_Target,
+			eName_TargetType,
+			eName_Text,
+			eName_TextRepresentation,
+			eName_Title,
+			eName_TrackCount,
+			eName_TrackList,
+			eName_Type,
+			eName_UserRating,
+			eName_UserTagList,
+			eName_VotesCount,
+			eName_Work,
+			eName_WorkList,
+			eName_XMLNS,
+			eName_XMLNSExt,
+			eName_Year,
+			eName_NumNames
+		};
+
+		/**
+		 * @brief Look up a name
+		 *
+		 * Look up the name of an element or attribute
+		 *
+		 * @param Name Name to look up
+		 *
+		 * @return Value for the name, or eName_Unknown if it is not recognised
+		 */
+
+		static tName Lookup(const char *Name);
+
+		/**
+		 * @brief Look up a name
+		 *
+		 * Look up the name of an element or attribute
+		 *
+		 * @param Name Name to look up
+		 *
+		 * @return Value for the name, or eName_Unknown if it is not recognised
+		 */
+
+		static tName Lookup(const std::string& Name);
+
+		/**
+		 * @brief Look up the name of an element
+		 *
+		 * Look up the name of an element
+		 *
+		 * @param Node Element to look up
+		 *
+		 * @return Value for the name, or eName_Unknown if it is not recognised
+		 */
+
+		static tName Lookup(const XMLNode& Node);
+	};
+}
+
+#endif
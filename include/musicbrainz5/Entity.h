@@ -32,6 +32,7 @@
 #include <map>
 
 #include "musicbrainz5/xmlParser.h"
+#include "musicbrainz5/ElementName.h"
 
 namespace MusicBrainz5
 {
@@ -51,6 +52,13 @@ namespace MusicBrainz5
 
 		void Parse(const XMLNode& Node);
 
+		//Parse a complete document, taking ownership of it. Elements that hold other
+		//entities are kept, and only parsed the first time they are asked for. The
+		//document is freed once every entity that put off parsing part of it, and
+		//every copy of one, has been destroyed.
+
+		void ParseLazily(XMLNode *Document);
+
 		std::map<std::string,std::string> ExtAttributes() const;
 		std::map<std::string,std::string> ExtElements() const;
 
@@ -58,6 +66,17 @@ namespace MusicBrainz5
 		static std::string GetElementName();
 
 	protected:
+		//Build any elements with this name that a lazy parse put off. Accessors for
+		//entities that were parsed with ProcessLazyItem or ProcessRelationList call
+		//this before returning them.
+
+		void Materialise(CElementName::tName Name) const;
+
+		//The document this entity, or an entity that it was copied from, put off
+		//parsing part of, or 0 if it was parsed in full
+
+		const XMLNode *LazyDocument() const;
+
 		void ProcessRelationList(const XMLNode& Node, CRelationListList* & RetVal);
 
 		template<typename T>
@@ -66,6 +85,13 @@ namespace MusicBrainz5
 			RetVal=new T(Node);
 		}
 
+		template<typename T>
+		void ProcessLazyItem(const XMLNode& Node, T* & RetVal)
+		{
+			if (!Defer(Node))
+				ProcessItem(Node,RetVal);
+		}
+
 		template<class T>
 		void ProcessItem(const XMLNode& Node, T& RetVal)
 		{
@@ -100,6 +126,13 @@ namespace MusicBrainz5
 			}
 		}
 
+		//Numbers are converted without a stream, and regardless of the current locale
+
+		void ProcessItem(const XMLNode& Node, int& RetVal);
+		void ProcessItem(const XMLNode& Node, double& RetVal);
+		void ProcessItem(const std::string& Text, int& RetVal);
+		void ProcessItem(const std::string& Text, double& RetVal);
+
 		void ProcessItem(const XMLNode& Node, std::string& RetVal)
 		{
 			if (Node.getText())
@@ -113,6 +146,7 @@ namespace MusicBrainz5
 		CEntityPrivate *m_d;
 
 		void Cleanup();
+		bool Defer(const XMLNode& Node);
 	};
 }
 
@@ -0,0 +1,72 @@
+/* --------------------------------------------------------------------------
+
+   libmusicbrainz5 - Client library to access MusicBrainz
+
+   Copyright (C) 2012 Andrew Hawkins
+
+   This file is part of libmusicbrainz5.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   libmusicbrainz5 is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+     $Id$
+
+----------------------------------------------------------------------------*/
+
+#ifndef _MUSICBRAINZ5_FILE_TRANSPORT_H
+#define _MUSICBRAINZ5_FILE_TRANSPORT_H
+
+#include <string>
+
+#include "musicbrainz5/Transport.h"
+
+namespace MusicBrainz5
+{
+	class CFileTransportPrivate;
+
+	/**
+	 * @brief Transport serving responses from a directory
+	 *
+	 * Serves responses from files in a directory, without making any network requests.
+	 * This is useful for testing, and for benchmarking the parsing of responses.
+	 *
+	 * A request for /ws/2/release/ID?inc=labels is served from the file
+	 * Directory/ws/2/release/ID?inc=labels.xml if it exists, and from
+	 * Directory/ws/2/release/ID.xml otherwise. If neither exists, a 404 status is
+	 * returned.
+	 */
+	class CFileTransport: public CTransport
+	{
+	public:
+		/**
+		 * @brief Constructor
+		 *
+		 * Constructor
+		 *
+		 * @param Directory Directory containing the responses
+		 */
+
+		CFileTransport(const std::string& Directory);
+		virtual ~CFileTransport();
+
+		virtual void Fetch(const CTransportRequest& Request, CTransportResponse& Response);
+
+	private:
+		CFileTransport(const CFileTransport& Other);
+		CFileTransport& operator =(const CFileTransport& Other);
+
+		CFileTransportPrivate * const m_d;
+	};
+}
+
+#endif
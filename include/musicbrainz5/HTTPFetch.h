@@ -28,10 +28,13 @@
 
 #include <string>
 #include <vector>
+#include <map>
 
 namespace MusicBrainz5
 {
 	class CHTTPFetchPrivate;
+	class CHTTPSessionPoolPrivate;
+	class CHTTPSession;
 
 	class CExceptionBase: public std::exception
 	{
@@ -134,6 +137,117 @@ namespace MusicBrainz5
 			}
 	};
 
+	/**
+	 * @brief Pool of persistent HTTP sessions
+	 *
+	 * Keeps connections to the web server open between requests, so that consecutive
+	 * requests to the same server do not each pay for a new TCP connection. Sessions are
+	 * keyed by host, port, proxy and user name. The pool may be shared between several
+	 * MusicBrainz5::CHTTPFetch objects, and is safe to use from multiple threads.
+	 *
+	 */
+	class CHTTPSessionPool
+	{
+	public:
+		/**
+		 * @brief Constructor
+		 *
+		 * Constructor
+		 *
+		 * @param MaxConnections Maximum number of open connections (4 by default)
+		 * @param IdleTimeout Number of seconds an unused connection is kept open (60 by default)
+		 */
+
+		CHTTPSessionPool(int MaxConnections=4, int IdleTimeout=60);
+		~CHTTPSessionPool();
+
+		/**
+		 * @brief Set the maximum number of connections
+		 *
+		 * Set the maximum number of connections the pool will hold open at once. A request
+		 * made while this many connections are in use will wait for one to be released.
+		 *
+		 * @param MaxConnections Maximum number of connections
+		 */
+
+		void SetMaxConnections(int MaxConnections);
+
+		/**
+		 * @brief Return the maximum number of connections
+		 *
+		 * Return the maximum number of connections the pool will hold open at once
+		 *
+		 * @return Maximum number of connections
+		 */
+
+		int MaxConnections() const;
+
+		/**
+		 * @brief Set the idle timeout
+		 *
+		 * Set the number of seconds an unused connection is kept open before being closed.
+		 * A value of 0 closes connections as soon as each request completes.
+		 *
+		 * @param IdleTimeout Idle timeout in seconds
+		 */
+
+		void SetIdleTimeout(int IdleTimeout);
+
+		/**
+		 * @brief Return the number of open connections
+		 *
+		 * Return the number of connections currently open, both idle and in use
+		 *
+		 * @return Number of open connections
+		 */
+
+		int NumConnections() const;
+
+		/**
+		 * @brief Close all idle connections
+		 *
+		 * Close all connections not currently in use
+		 */
+
+		void Clear();
+
+	private:
+		friend class CHTTPFetch;
+
+		CHTTPSessionPool(const CHTTPSessionPool& Other);
+		CHTTPSessionPool& operator =(const CHTTPSessionPool& Other);
+
+		CHTTPSessionPoolPrivate * const m_d;
+	};
+
+	/**
+	 * @brief Interface for receiving a response body as it arrives
+	 *
+	 * Implement this interface to process the body of a response while it is still
+	 * being received, rather than waiting for the whole response to be buffered.
+	 */
+	class CHTTPBodyReader
+	{
+	public:
+		virtual ~CHTTPBodyReader() {}
+
+		/**
+		 * @brief Process a block of the response body
+		 *
+		 * Called for each block of a successful response body, in order, after any
+		 * decompression. An exception thrown here aborts the request. As it can't be
+		 * passed back through neon, MusicBrainz5::CHTTPFetch::Fetch throws a
+		 * MusicBrainz5::CFetchError in its place, or std::bad_alloc if that was thrown.
+		 *
+		 * @param Data Block of data received
+		 * @param Length Length of the block
+		 *
+		 * @return true to continue the request, false to abort it
+		 */
+
+		virtual bool Read(const char *Data, size_t Length)=0;
+	};
+
 	/**
 	 * @brief Object for making HTTP requests
 	 *
@@ -217,10 +331,81 @@ namespace MusicBrainz5
 
 		void SetProxyPassword(const std::string& ProxyPassword);
 
+		/**
+		 * @brief Set the session pool to use
+		 *
+		 * Set the pool to take persistent sessions from. If no pool is set, a new
+		 * connection is made for every request. Ownership of the pool remains with the caller,
+		 * and it must outlive this object.
+		 *
+		 * @param Pool Session pool to use
+		 */
+
+		void SetSessionPool(CHTTPSessionPool *Pool);
+
+		/**
+		 * @brief Enable or disable compression
+		 *
+		 * Request a gzip compressed response from the server, and decompress it as it is
+		 * received (enabled by default). Servers that do not support compression send the
+		 * response uncompressed as before.
+		 *
+		 * @param Compression true to request compressed responses, false otherwise
+		 */
+
+		void SetCompression(bool Compression);
+
+		/**
+		 * @brief Set the connection timeout
+		 *
+		 * Set the number of seconds to wait for a connection to the server to be
+		 * made (defaults to 30). Pass 0 to wait as long as the operating system allows.
+		 *
+		 * @param Seconds Connection timeout in seconds
+		 */
+
+		void SetConnectTimeout(int Seconds);
+
+		/**
+		 * @brief Set the read timeout
+		 *
+		 * Set the number of seconds to wait for the server to send more of its response
+		 * before giving up (defaults to 60). Pass 0 to wait indefinitely.
+		 *
+		 * @param Seconds Read timeout in seconds
+		 */
+
+		void SetReadTimeout(int Seconds);
+
+		/**
+		 * @brief Set the body reader to use
+		 *
+		 * Pass the response body to a reader as it arrives, instead of collecting it to be
+		 * returned by Data(). Ownership of the reader remains with the caller, and it must
+		 * outlive any requests made. Pass NULL to collect the body again.
+		 *
+		 * @param Reader Body reader to use
+		 */
+
+		void SetBodyReader(CHTTPBodyReader *Reader);
+
+		/**
+		 * @brief Set a request header
+		 *
+		 * Set an additional header to send with each request, for example the
+		 * If-None-Match header of a conditional request
+		 *
+		 * @param Name Name of the header
+		 * @param Value Value of the header
+		 */
+
+		void SetRequestHeader(const std::string& Name, const std::string& Value);
+
 		/**
 		 * @brief Make a request to the server
 		 *
-		 * Make a request to the server
+		 * Make a request to the server. A status of 304 (Not Modified) in reply to a
+		 * conditional request is not treated as an error, and returns no data.
 		 *
 		 * @param URL URL to request
 		 * @param Request Request type (GET by default)
@@ -240,13 +425,69 @@ namespace MusicBrainz5
 		/**
 		 * @brief Get the data receieved
 		 *
-		 * Get the data received from the request
+		 * Get the data received from the request. This is empty if a body reader
+		 * was set.
 		 *
 		 * @return Data received
 		 */
 
 		std::vector<unsigned char> Data() const;
 
+		/**
+		 * @brief Get a reference to the data received
+		 *
+		 * Get the data received from the request, without copying it. The reference
+		 * remains valid until the next request is made, or TakeData is called.
+		 *
+		 * @return Data received
+		 */
+
+		const std::vector<unsigned char>& DataBuffer() const;
+
+		/**
+		 * @brief Take ownership of the data received
+		 *
+		 * Move the data received from the request into the vector passed, without copying
+		 * it. Any previous contents of the vector are discarded, and Data() is left empty.
+		 *
+		 * @param Data Vector to receive the data
+		 */
+
+		void TakeData(std::vector<unsigned char>& Data);
+
+		/**
+		 * @brief Return the number of bytes received
+		 *
+		 * Return the size of the response body as sent by the server, before any
+		 * decompression
+		 *
+		 * @return Number of bytes received
+		 */
+
+		size_t CompressedBytes() const;
+
+		/**
+		 * @brief Return the number of bytes after decompression
+		 *
+		 * Return the size of the response body after decompression. This is the size of
+		 * the data returned by Data(), or passed to the body reader.
+		 *
+		 * @return Number of bytes after decompression
+		 */
+
+		size_t UncompressedBytes() const;
+
+		/**
+		 * @brief Return the connection time
+		 *
+		 * Return the time spent looking up the server and connecting to it for the last
+		 * request. This is 0 if an existing connection was reused.
+		 *
+		 * @return Connection time in seconds
+		 */
+
+		double ConnectTime() const;
+
 		/**
 		 * @brief libneon result code from the request
 		 *
@@ -277,12 +518,26 @@ namespace MusicBrainz5
 
 		std::string ErrorMessage() const;
 
+		/**
+		 * @brief Return the response headers
+		 *
+		 * Return the headers of the response to the request, keyed by name in lower case
+		 *
+		 * @return Response headers
+		 */
+
+		const std::map<std::string,std::string>& ResponseHeaders() const;
+
 	private:
 		CHTTPFetchPrivate * const m_d;
 
+		std::string SessionKey() const;
+		CHTTPSession *CreateSession();
+
 		static int httpAuth(void *userdata, const char *realm, int attempts, char *username, char *password);
 		static int proxyAuth(void *userdata, const char *realm, int attempts, char *username, char *password);
 		static int httpResponseReader(void *userdata, const char *buf, size_t len);
+		static int httpCountReader(void *userdata, const char *buf, size_t len);
 	};
 }
 
@@ -104,9 +104,7 @@ namespace MusicBrainz5
 	protected:
 		void ParseElement(const XMLNode& Node)
 		{
-			std::string NodeName=Node.getName();
-
-			if (T::GetElementName()==NodeName)
+			if (T::GetElementName()==Node.getName())
 			{
 				T *Item=0;
 
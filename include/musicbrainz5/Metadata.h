@@ -76,6 +76,12 @@ namespace MusicBrainz5
 
 		virtual CMetadata *Clone();
 
+		//Build everything that a lazy parse put off, by parsing the document again in
+		//full. Nothing is then built as the object is used, so it can be read from
+		//several threads at once.
+
+		void MaterialiseAll();
+
 		std::string XMLNS() const;
 		std::string XMLNSExt() const;
 		std::string Generator() const;
@@ -117,6 +123,16 @@ namespace MusicBrainz5
 		virtual void ParseElement(const XMLNode& Node);
 
 	private:
+		friend class CQueryPrivate;
+
+		//Hand an entity over to the caller, who then owns it. The metadata no longer
+		//has the entity afterwards.
+
+		void Detach(CArtist *& Item);
+		void Detach(CRecording *& Item);
+		void Detach(CRelease *& Item);
+		void Detach(CReleaseGroup *& Item);
+
 		void Cleanup();
 
 		CMetadataPrivate * const m_d;
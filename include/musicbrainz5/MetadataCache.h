@@ -0,0 +1,290 @@
+/* --------------------------------------------------------------------------
+
+   libmusicbrainz5 - Client library to access MusicBrainz
+
+   Copyright (C) 2012 Andrew Hawkins
+
+   This file is part of libmusicbrainz5.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   libmusicbrainz5 is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+     $Id$
+
+----------------------------------------------------------------------------*/
+
+#ifndef _MUSICBRAINZ5_METADATA_CACHE_H
+#define _MUSICBRAINZ5_METADATA_CACHE_H
+
+#include <string>
+
+#include "musicbrainz5/Metadata.h"
+
+namespace MusicBrainz5
+{
+	class CMetadataCachePrivate;
+
+	/**
+	 * @brief In-memory cache of query results
+	 *
+	 * Holds the parsed results of recent queries, so that repeated lookups of the same
+	 * entity are answered without a request to the server or another parse. Entries
+	 * are keyed by the query path, including its parameters, for example
+	 * <tt>/ws/2/release/ID?inc=artists</tt>.
+	 *
+	 * The cache is bounded by both the number of entries and the total size of the
+	 * responses they were parsed from. When either limit is exceeded, the least
+	 * recently used entries are discarded. Each entry also expires after a time to live
+	 * which may be set separately for each entity type.
+	 *
+	 * Install a cache using MusicBrainz5::CQuery::SetCache. One cache may be shared by
+	 * several MusicBrainz5::CQuery objects as long as they all use the same server and
+	 * credentials. The cache is safe to use from multiple threads.
+	 */
+	class CMetadataCache
+	{
+	public:
+		/**
+		 * @brief Constructor
+		 *
+		 * Constructor
+		 *
+		 * @param MaxEntries Maximum number of entries to hold
+		 * @param MaxBytes Maximum total size of the responses held, in bytes
+		 */
+
+		CMetadataCache(int MaxEntries=1000, size_t MaxBytes=16*1024*1024);
+		~CMetadataCache();
+
+		/**
+		 * @brief Set the size limits
+		 *
+		 * Set the maximum number of entries and the maximum total size of the responses
+		 * held. Entries are discarded immediately if the cache is over the new limits.
+		 *
+		 * @param MaxEntries Maximum number of entries to hold
+		 * @param MaxBytes Maximum total size of the responses held, in bytes
+		 */
+
+		void SetLimits(int MaxEntries, size_t MaxBytes);
+
+		/**
+		 * @brief Set the default time to live
+		 *
+		 * Set the number of seconds an entry is kept for entity types that have no time
+		 * to live of their own (defaults to one hour)
+		 *
+		 * @param Seconds Time to live in seconds, or 0 to not cache these entities
+		 */
+
+		void SetDefaultTTL(int Seconds);
+
+		/**
+		 * @brief Set the time to live for an entity type
+		 *
+		 * Set the number of seconds results for an entity type are kept. The entity type
+		 * is the first part of the query path, for example 'release' or 'discid'.
+		 *
+		 * @param Entity Entity type
+		 * @param Seconds Time to live in seconds, or 0 to not cache this entity type
+		 */
+
+		void SetTTL(const std::string& Entity, int Seconds);
+
+		/**
+		 * @brief Set the time to live for missing resources
+		 *
+		 * Set the number of seconds a query that failed because the resource does not
+		 * exist (404) is remembered (defaults to 10 minutes). Repeating the query within
+		 * this time fails immediately without contacting the server.
+		 *
+		 * @param Seconds Time to live in seconds, or 0 to not cache missing resources
+		 */
+
+		void SetNotFoundTTL(int Seconds);
+
+		/**
+		 * @brief Look up a query
+		 *
+		 * Look up the result of a query. Expired entries, and queries remembered as
+		 * failing because the resource does not exist, are treated as missing.
+		 *
+		 * @param Query Query path
+		 * @param Metadata Filled in with the cached result if there is one
+		 *
+		 * @return true if the query was found in the cache, false otherwise
+		 */
+
+		bool Get(const std::string& Query, CMetadata& Metadata);
+
+		/**
+		 * @brief Look up a query
+		 *
+		 * Look up the result of a query, including queries remembered as failing because
+		 * the resource does not exist. Expired entries are treated as missing.
+		 *
+		 * @param Query Query path
+		 * @param Metadata Filled in with the cached result if there is one
+		 * @param NotFound Set to true if the query is remembered as failing because the
+		 *                 resource does not exist, false otherwise
+		 *
+		 * @return true if the query was found in the cache, false otherwise
+		 */
+
+		bool Get(const std::string& Query, CMetadata& Metadata, bool& NotFound);
+
+		/**
+		 * @brief Look up a query for revalidation
+		 *
+		 * Look up the result of a query whether or not it has expired, as long as the
+		 * response it was parsed from carried an ETag or Last-Modified header. The
+		 * caller can then ask the server whether the result is still current. Lookups
+		 * made this way are not counted as hits or misses.
+		 *
+		 * @param Query Query path
+		 * @param Metadata Filled in with the cached result if there is one
+		 * @param ETag Filled in with the ETag of the cached response
+		 * @param LastModified Filled in with the Last-Modified date of the cached response
+		 *
+		 * @return true if the query was found in the cache, false otherwise
+		 */
+
+		bool GetStale(const std::string& Query, CMetadata& Metadata, std::string& ETag, std::string& LastModified);
+
+		/**
+		 * @brief Add a query result
+		 *
+		 * Add the result of a query to the cache, replacing any existing entry. Entries
+		 * with an ETag or Last-Modified date are kept after they expire, until they are
+		 * evicted, so that they can be revalidated.
+		 *
+		 * @param Query Query path
+		 * @param Metadata Result of the query
+		 * @param Bytes Size of the response the result was parsed from
+		 * @param ETag ETag header of the response, if any
+		 * @param LastModified Last-Modified header of the response, if any
+		 */
+
+		void Put(const std::string& Query, const CMetadata& Metadata, size_t Bytes, const std::string& ETag="", const std::string& LastModified="");
+
+		/**
+		 * @brief Remember a missing resource
+		 *
+		 * Record that a query failed because the resource does not exist, replacing any
+		 * existing entry
+		 *
+		 * @param Query Query path
+		 */
+
+		void PutNotFound(const std::string& Query);
+
+		/**
+		 * @brief Renew a query result
+		 *
+		 * Restart the time to live of an entry, for example because the server has
+		 * confirmed that it has not changed
+		 *
+		 * @param Query Query path
+		 */
+
+		void Touch(const std::string& Query);
+
+		/**
+		 * @brief Remove a query result
+		 *
+		 * Remove the result of a query from the cache, if present
+		 *
+		 * @param Query Query path
+		 */
+
+		void Remove(const std::string& Query);
+
+		/**
+		 * @brief Remove all entries
+		 *
+		 * Remove all entries from the cache. The counters are not reset.
+		 */
+
+		void Clear();
+
+		/**
+		 * @brief Return the number of entries
+		 *
+		 * Return the number of entries currently held
+		 *
+		 * @return Number of entries
+		 */
+
+		int NumEntries() const;
+
+		/**
+		 * @brief Return the size of the entries
+		 *
+		 * Return the total size of the responses currently held
+		 *
+		 * @return Size in bytes
+		 */
+
+		size_t Bytes() const;
+
+		/**
+		 * @brief Return the number of hits
+		 *
+		 * Return the number of lookups that were answered from the cache
+		 *
+		 * @return Number of hits
+		 */
+
+		int Hits() const;
+
+		/**
+		 * @brief Return the number of misses
+		 *
+		 * Return the number of lookups that were not found in the cache, or had expired
+		 *
+		 * @return Number of misses
+		 */
+
+		int Misses() const;
+
+		/**
+		 * @brief Return the number of evictions
+		 *
+		 * Return the number of entries discarded to keep the cache within its limits
+		 *
+		 * @return Number of evictions
+		 */
+
+		int Evictions() const;
+
+		/**
+		 * @brief Return the entity type of a query
+		 *
+		 * Return the entity type of a query path, which is the part following /ws/2/
+		 *
+		 * @param Query Query path
+		 *
+		 * @return Entity type
+		 */
+
+		static std::string Entity(const std::string& Query);
+
+	private:
+		CMetadataCache(const CMetadataCache& Other);
+		CMetadataCache& operator =(const CMetadataCache& Other);
+
+		CMetadataCachePrivate * const m_d;
+	};
+}
+
+#endif
@@ -0,0 +1,174 @@
+/* --------------------------------------------------------------------------
+
+   libmusicbrainz5 - Client library to access MusicBrainz
+
+   Copyright (C) 2012 Andrew Hawkins
+
+   This file is part of libmusicbrainz5.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   libmusicbrainz5 is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+     $Id$
+
+----------------------------------------------------------------------------*/
+
+#ifndef _MUSICBRAINZ5_NEON_TRANSPORT_H
+#define _MUSICBRAINZ5_NEON_TRANSPORT_H
+
+#include <string>
+
+#include "musicbrainz5/Transport.h"
+
+namespace MusicBrainz5
+{
+	class CNeonTransportPrivate;
+
+	/**
+	 * @brief Transport making HTTP requests using libneon
+	 *
+	 * The default transport, making requests to a web server using MusicBrainz5::CHTTPFetch.
+	 * Connections are kept open between requests in a MusicBrainz5::CHTTPSessionPool.
+	 */
+	class CNeonTransport: public CTransport
+	{
+	public:
+		/**
+		 * @brief Constructor
+		 *
+		 * Constructor
+		 *
+		 * @param UserAgent User agent string to send
+		 * @param Host Host name to connect to
+		 * @param Port Port to connect to (80 by default)
+		 */
+
+		CNeonTransport(const std::string& UserAgent, const std::string& Host, int Port=80);
+		virtual ~CNeonTransport();
+
+		/**
+		 * @brief Set the user name to use
+		 *
+		 * Set the user name to use when authenticating with the web server
+		 *
+		 * @param UserName User name to use
+		 */
+
+		void SetUserName(const std::string& UserName);
+
+		/**
+		 * @brief Set the password to use
+		 *
+		 * Set the password to use when authenticating with the web server
+		 *
+		 * @param Password Password to use
+		 */
+
+		void SetPassword(const std::string& Password);
+
+		/**
+		 * @brief Set the proxy server to use
+		 *
+		 * Set the proxy server to use when connecting with the web server
+		 *
+		 * @param ProxyHost Proxy server to use
+		 */
+
+		void SetProxyHost(const std::string& ProxyHost);
+
+		/**
+		 * @brief Set the proxy port to use
+		 *
+		 * Set the proxy server port to use when connecting to the web server
+		 *
+		 * @param ProxyPort Proxy server port to use
+		 */
+
+		void SetProxyPort(int ProxyPort);
+
+		/**
+		 * @brief Set the proxy user name to use
+		 *
+		 * Set the user name to use when authenticating with the proxy server
+		 *
+		 * @param ProxyUserName Proxy user name to use
+		 */
+
+		void SetProxyUserName(const std::string& ProxyUserName);
+
+		/**
+		 * @brief Set the proxy password to use
+		 *
+		 * Set the password to use when authenticating with the proxy server
+		 *
+		 * @param ProxyPassword Proxy server password to use
+		 */
+
+		void SetProxyPassword(const std::string& ProxyPassword);
+
+		/**
+		 * @brief Enable or disable compression
+		 *
+		 * Request gzip compressed responses from the server (enabled by default)
+		 *
+		 * @param Compression true to request compressed responses, false otherwise
+		 */
+
+		void SetCompression(bool Compression);
+
+		/**
+		 * @brief Set the connection timeout
+		 *
+		 * Set the number of seconds to wait for a connection to the server to be made
+		 * (defaults to 30)
+		 *
+		 * @param Seconds Connection timeout in seconds, or 0 for no timeout
+		 */
+
+		void SetConnectTimeout(int Seconds);
+
+		/**
+		 * @brief Set the read timeout
+		 *
+		 * Set the number of seconds to wait for the server to send more of its response
+		 * (defaults to 60). If a request is given less time than this with
+		 * MusicBrainz5::CTransportRequest::SetTimeout, both timeouts are cut down to fit,
+		 * but a server that keeps sending slowly can still make it overrun.
+		 *
+		 * @param Seconds Read timeout in seconds, or 0 for no timeout
+		 */
+
+		void SetReadTimeout(int Seconds);
+
+		/**
+		 * @brief Return the session pool
+		 *
+		 * Return the pool of connections used by this transport, so that its limits can
+		 * be configured
+		 *
+		 * @return Session pool
+		 */
+
+		CHTTPSessionPool& SessionPool();
+
+		virtual void Fetch(const CTransportRequest& Request, CTransportResponse& Response);
+
+	private:
+		CNeonTransport(const CNeonTransport& Other);
+		CNeonTransport& operator =(const CNeonTransport& Other);
+
+		CNeonTransportPrivate * const m_d;
+	};
+}
+
+#endif
@@ -32,6 +32,7 @@
 
 #include "musicbrainz5/ReleaseList.h"
 #include "musicbrainz5/Metadata.h"
+#include "musicbrainz5/QueryStats.h"
 
 #include "musicbrainz5/xmlParser.h"
 
@@ -158,6 +159,18 @@ catch (MusicBrainz5::CResourceNotFoundError& Error)
 namespace MusicBrainz5
 {
 	class CQueryPrivate;
+	class CRateLimiter;
+	class CMetadataCache;
+	class CDiskCache;
+	class CTransport;
+	class CTimingHistogram;
+	class CTraceHook;
+	class CArtist;
+	class CRecording;
+	class CReleaseGroup;
+	class CQueryFuture;
+	class CReleaseFuture;
+	class CReleaseListFuture;
 
 	/**
 	 * @brief Main object for generating queries to MusicBrainz
@@ -288,6 +301,357 @@ namespace MusicBrainz5
 
 		void SetProxyPassword(const std::string& ProxyPassword);
 
+		/**
+		 * @brief Set the maximum number of connections
+		 *
+		 * Set the maximum number of connections to the server that will be held open at
+		 * once. Connections are kept open between queries and reused, rather than making
+		 * a new connection for each query (defaults to 4).
+		 *
+		 * @param MaxConnections Maximum number of connections
+		 */
+
+		void SetMaxConnections(int MaxConnections);
+
+		/**
+		 * @brief Set the connection idle timeout
+		 *
+		 * Set the number of seconds an unused connection to the server is kept open
+		 * before it is closed (defaults to 60). Setting this to 0 disables connection reuse.
+		 *
+		 * @param IdleTimeout Idle timeout in seconds
+		 */
+
+		void SetConnectionIdleTimeout(int IdleTimeout);
+
+		/**
+		 * @brief Enable or disable compression
+		 *
+		 * Request gzip compressed responses from the server (enabled by default). This
+		 * greatly reduces the amount of data transferred for large lookups.
+		 *
+		 * @param Compression true to request compressed responses, false otherwise
+		 */
+
+		void SetCompression(bool Compression);
+
+		/**
+		 * @brief Set the connection timeout
+		 *
+		 * Set the number of seconds to wait for a connection to the server to be made
+		 * before failing with MusicBrainz5::CTimeoutError (defaults to 30)
+		 *
+		 * @param Seconds Connection timeout in seconds, or 0 for no timeout
+		 */
+
+		void SetConnectTimeout(int Seconds);
+
+		/**
+		 * @brief Set the read timeout
+		 *
+		 * Set the number of seconds to wait for the server to send more of a response
+		 * before failing with MusicBrainz5::CTimeoutError (defaults to 60)
+		 *
+		 * @param Seconds Read timeout in seconds, or 0 for no timeout
+		 */
+
+		void SetReadTimeout(int Seconds);
+
+		/**
+		 * @brief Set the time allowed for each query
+		 *
+		 * Set the longest time a query may take, covering the wait for the rate limiter,
+		 * any retries and the transfer itself (by default there is no limit). A query
+		 * that cannot be finished in time fails with MusicBrainz5::CTimeoutError as soon
+		 * as that is known, rather than waiting first. The time for an asynchronous query
+		 * starts when it is queued. Individual queries may be given their own limit.
+		 *
+		 * @param Seconds Time allowed in seconds, or 0 for no limit
+		 */
+
+		void SetQueryTimeout(double Seconds);
+
+		/**
+		 * @brief Choose how responses are parsed
+		 *
+		 * Choose whether responses are read straight into entities as they are parsed,
+		 * or whether a document is built from each response first and the entities built
+		 * from that (the default). Streaming builds no document, so uses less memory and
+		 * time overall, but the whole response is buffered and only parsed once it has
+		 * all arrived, whereas a document is parsed as the response arrives.
+		 *
+		 * @param Streaming true to use the streaming parser
+		 */
+
+		void SetStreamingParser(bool Streaming);
+
+		/**
+		 * @brief Build entities only when they are first used
+		 *
+		 * Keep the document built from each response with the metadata returned, and
+		 * only build the entities held by an entity (such as CRelease::MediumList or
+		 * CArtist::AliasList) the first time they are asked for. This saves building
+		 * parts of a large response that are never looked at. Lazy parsing needs a
+		 * document, so the streaming parser is not used while it is enabled. The
+		 * document is freed once the metadata and every copy of it have been destroyed,
+		 * or have built everything they held.
+		 *
+		 * Entities are built as they are asked for, so a lazily parsed object must not
+		 * be used from more than one thread at a time, even if only to read it. Copies
+		 * may be used from different threads. The results of asynchronous queries are
+		 * shared by every copy of their future, so they are always built in full before
+		 * they are returned (see MusicBrainz5::CMetadata::MaterialiseAll).
+		 *
+		 * @param Lazy true to build entities only when they are used
+		 */
+
+		void SetLazyParsing(bool Lazy);
+
+		/**
+		 * @brief Set the transport
+		 *
+		 * Make requests through an application supplied transport, instead of directly to
+		 * the server using libneon. Ownership of the transport remains with the caller, and
+		 * it must outlive this object. Pass NULL to return to the default transport.
+		 *
+		 * The connection, timeout, proxy, authentication and compression settings only
+		 * apply to the default transport. The rate limit and the time allowed for each
+		 * query apply to all transports.
+		 *
+		 * @param Transport Transport to use
+		 */
+
+		void SetTransport(CTransport *Transport);
+
+		/**
+		 * @brief Set the trace hook
+		 *
+		 * Pass the beginning and end of each phase of every query made through this
+		 * object to a hook, for tracing. Ownership of the hook remains with the caller,
+		 * and it must outlive this object. The hook should be set before any queries are
+		 * made, and must not throw. Pass NULL to stop tracing (the default).
+		 *
+		 * @param TraceHook Hook to use
+		 */
+
+		void SetTraceHook(CTraceHook *TraceHook);
+
+		/**
+		 * @brief Set the result cache
+		 *
+		 * Install a cache for the results of queries. Queries found in the cache are
+		 * answered without contacting the server, and the results of successful queries
+		 * are added to it. Ownership of the cache remains with the caller, and it must
+		 * outlive this object. Pass NULL to stop caching (the default).
+		 *
+		 * @param Cache Cache to use
+		 */
+
+		void SetCache(CMetadataCache *Cache);
+
+		/**
+		 * @brief Return the result cache
+		 *
+		 * Return the cache installed with SetCache
+		 *
+		 * @return Cache in use, or NULL if there is none
+		 */
+
+		CMetadataCache *Cache() const;
+
+		/**
+		 * @brief Set the disk cache
+		 *
+		 * Install a persistent cache for the responses to queries. It is checked after
+		 * the cache installed with SetCache, before contacting the server, and the
+		 * responses to successful queries are written to it. Ownership of the cache
+		 * remains with the caller, and it must outlive this object. Pass NULL to stop
+		 * using it (the default).
+		 *
+		 * @param DiskCache Cache to use
+		 */
+
+		void SetDiskCache(CDiskCache *DiskCache);
+
+		/**
+		 * @brief Return the disk cache
+		 *
+		 * Return the cache installed with SetDiskCache
+		 *
+		 * @return Cache in use, or NULL if there is none
+		 */
+
+		CDiskCache *DiskCache() const;
+
+		/**
+		 * @brief Set the rate limit
+		 *
+		 * Set the rate at which requests are made to the server. By default, requests to
+		 * musicbrainz.org are limited to one every two seconds, and requests to any other
+		 * server are not limited. @b Note The limit is shared by all MusicBrainz5::CQuery
+		 * objects using the same server.
+		 *
+		 * @param Rate Number of requests allowed per second, or 0 for no limit
+		 * @param Burst Number of requests that may be made back to back
+		 */
+
+		void SetRateLimit(double Rate, int Burst=1);
+
+		/**
+		 * @brief Set the rate limiter
+		 *
+		 * Replace the rate limiter shared by all queries to this server with an application
+		 * supplied one. Ownership of the limiter remains with the caller, and it must outlive
+		 * this object. Pass NULL to return to the shared limiter for the server.
+		 *
+		 * @param Limiter Rate limiter to use
+		 */
+
+		void SetRateLimiter(CRateLimiter *Limiter);
+
+		/**
+		 * @brief Return the rate limiter
+		 *
+		 * Return the rate limiter used by this object
+		 *
+		 * @return Rate limiter in use
+		 */
+
+		CRateLimiter *RateLimiter() const;
+
+		/**
+		 * @brief Set the maximum number of asynchronous queries in flight
+		 *
+		 * Set the maximum number of queries started with QueryAsync, LookupReleaseAsync or
+		 * LookupDiscIDAsync that will be performed at once (defaults to 4). Further queries
+		 * are queued until one completes. The maximum number of connections is raised to
+		 * match if necessary.
+		 *
+		 * @param MaxInFlight Maximum number of queries in flight
+		 */
+
+		void SetMaxInFlight(int MaxInFlight);
+
+		/**
+		 * @brief Set the maximum number of retries
+		 *
+		 * Set the number of times a query is retried when the server responds with 503
+		 * (Service Unavailable) or 429 (Too Many Requests) (defaults to 3). Pass 0 to
+		 * disable retries.
+		 *
+		 * @param MaxRetries Maximum number of retries
+		 */
+
+		void SetMaxRetries(int MaxRetries);
+
+		/**
+		 * @brief Set the delay between retries
+		 *
+		 * Set the delay before a refused query is retried. The delay starts at Initial
+		 * seconds and is multiplied by Multiplier after each attempt, up to Maximum
+		 * seconds (defaults to 1, 60 and 2). A random amount of up to half the delay
+		 * is taken off each time. If the server sends a Retry-After header, as either
+		 * a number of seconds or a date, the delay is at least that long, but never
+		 * more than Maximum. The delay is applied through the rate limiter, so all
+		 * queries to the server are held back while it lasts.
+		 *
+		 * @param Initial Delay before the first retry, in seconds
+		 * @param Maximum Maximum delay between retries, in seconds
+		 * @param Multiplier Factor the delay grows by after each retry
+		 */
+
+		void SetRetryBackoff(double Initial, double Maximum, double Multiplier=2);
+
+		/**
+		 * @brief Return the number of retries
+		 *
+		 * Return the number of times queries made through this object have been retried
+		 *
+		 * @return Number of retries
+		 */
+
+		int RetryCount() const;
+
+		/**
+		 * @brief Return the time spent backing off
+		 *
+		 * Return the total delay, in seconds, requested before retrying queries made
+		 * through this object
+		 *
+		 * @return Total backoff time in seconds
+		 */
+
+		double RetryBackoff() const;
+
+		/**
+		 * @brief Return the number of coalesced queries
+		 *
+		 * Return the number of queries that were not sent to the server because an
+		 * identical query made through this object was already in flight. These
+		 * queries wait for the first one to finish and share its result.
+		 *
+		 * @return Number of coalesced queries
+		 */
+
+		int CoalescedCount() const;
+
+		/**
+		 * @brief Return the number of revalidated queries
+		 *
+		 * Return the number of expired cache entries that the server confirmed were
+		 * unchanged (304 Not Modified), so that they were reused instead of fetched
+		 * again
+		 *
+		 * @return Number of revalidated queries
+		 */
+
+		int RevalidatedCount() const;
+
+		/**
+		 * @brief Return a histogram of the time spent in a phase of queries
+		 *
+		 * Return a histogram of the time spent in one phase of the queries made through
+		 * this object, including asynchronous ones. The network phases are only counted
+		 * for queries sent to the server, and the parse and build phases only for
+		 * responses that were parsed. The total is counted for every query.
+		 *
+		 * @param Timing Phase to return
+		 *
+		 * @return Histogram of times
+		 */
+
+		CTimingHistogram Timings(CQueryStats::tTiming Timing) const;
+
+		/**
+		 * @brief Return the number of bytes received
+		 *
+		 * Return the total size of the response bodies received from the server for
+		 * queries made through this object, before any decompression
+		 *
+		 * @return Number of bytes received
+		 */
+
+		size_t TotalWireBytes() const;
+
+		/**
+		 * @brief Return the number of bytes parsed
+		 *
+		 * Return the total size of the response bodies parsed for queries made through
+		 * this object, whether received from the server or read from the disk cache
+		 *
+		 * @return Number of bytes parsed
+		 */
+
+		size_t TotalBodyBytes() const;
+
+		/**
+		 * @brief Reset the statistics
+		 *
+		 * Clear the timing histograms and byte totals
+		 */
+
+		void ResetStats();
+
 		/**
 		 * @brief Return a list of releases that match a disc ID
 		 *
@@ -300,6 +664,22 @@ namespace MusicBrainz5
 
 		CReleaseList LookupDiscID(const std::string& DiscID);
 
+		/**
+		 * @brief Return a list of releases that match a disc ID, without throwing
+		 *
+		 * As LookupDiscID, but failures are reported through the return value rather than
+		 * by throwing an exception. If a cache is installed with SetCache, unknown disc
+		 * IDs are remembered, and looking them up again fails without contacting the
+		 * server.
+		 *
+		 * @param DiscID Disc id to match
+		 * @param ReleaseList Receives the matching releases
+		 *
+		 * @return Result of the query
+		 */
+
+		tQueryResult TryLookupDiscID(const std::string& DiscID, CReleaseList& ReleaseList);
+
 		/**
 		 * @brief Return full information about a release
 		 *
@@ -319,6 +699,96 @@ namespace MusicBrainz5
 
 		CRelease LookupRelease(const std::string& ReleaseID);
 
+		/**
+		 * @brief Return a list of releases that match a disc ID, asynchronously
+		 *
+		 * As LookupDiscID, but returns immediately. The query is performed in the
+		 * background, and the result collected from the returned future.
+		 *
+		 * @param DiscID Disc id to match
+		 *
+		 * @return MusicBrainz5::CReleaseListFuture object
+		 */
+
+		CReleaseListFuture LookupDiscIDAsync(const std::string& DiscID);
+
+		/**
+		 * @brief Return full information about a release, asynchronously
+		 *
+		 * As LookupRelease, but returns immediately. The query is performed in the
+		 * background, and the result collected from the returned future.
+		 *
+		 * @param ReleaseID MusicBrainz release ID to lookup
+		 *
+		 * @return MusicBrainz5::CReleaseFuture object
+		 */
+
+		CReleaseFuture LookupReleaseAsync(const std::string& ReleaseID);
+
+		/**
+		 * @brief Return information about a list of artists
+		 *
+		 * Look up several artists at once. The lookups are performed concurrently, subject
+		 * to SetMaxInFlight and the rate limit for the server, and each distinct ID is only
+		 * requested once. A failed lookup does not affect the others. Its entry in the
+		 * list is left empty and the reason is recorded in Results.
+		 *
+		 * @param ArtistIDs MusicBrainz artist IDs to lookup
+		 * @param Includes Space separated list of includes (e.g. "artists labels"), may be empty
+		 * @param Artists Receives the artists, in the same order as ArtistIDs
+		 * @param Results Receives the result of each lookup, in the same order as ArtistIDs
+		 */
+
+		void LookupArtists(const std::vector<std::string>& ArtistIDs, const std::string& Includes, CArtistList& Artists, std::vector<tQueryResult>& Results);
+
+		/**
+		 * @brief Return information about a list of recordings
+		 *
+		 * Look up several recordings at once. The lookups are performed concurrently, subject
+		 * to SetMaxInFlight and the rate limit for the server, and each distinct ID is only
+		 * requested once. A failed lookup does not affect the others. Its entry in the
+		 * list is left empty and the reason is recorded in Results.
+		 *
+		 * @param RecordingIDs MusicBrainz recording IDs to lookup
+		 * @param Includes Space separated list of includes (e.g. "artists labels"), may be empty
+		 * @param Recordings Receives the recordings, in the same order as RecordingIDs
+		 * @param Results Receives the result of each lookup, in the same order as RecordingIDs
+		 */
+
+		void LookupRecordings(const std::vector<std::string>& RecordingIDs, const std::string& Includes, CRecordingList& Recordings, std::vector<tQueryResult>& Results);
+
+		/**
+		 * @brief Return information about a list of releases
+		 *
+		 * Look up several releases at once. The lookups are performed concurrently, subject
+		 * to SetMaxInFlight and the rate limit for the server, and each distinct ID is only
+		 * requested once. A failed lookup does not affect the others. Its entry in the
+		 * list is left empty and the reason is recorded in Results.
+		 *
+		 * @param ReleaseIDs MusicBrainz release IDs to lookup
+		 * @param Includes Space separated list of includes (e.g. "artists labels"), may be empty
+		 * @param Releases Receives the releases, in the same order as ReleaseIDs
+		 * @param Results Receives the result of each lookup, in the same order as ReleaseIDs
+		 */
+
+		void LookupReleases(const std::vector<std::string>& ReleaseIDs, const std::string& Includes, CReleaseList& Releases, std::vector<tQueryResult>& Results);
+
+		/**
+		 * @brief Return information about a list of release groups
+		 *
+		 * Look up several release groups at once. The lookups are performed concurrently, subject
+		 * to SetMaxInFlight and the rate limit for the server, and each distinct ID is only
+		 * requested once. A failed lookup does not affect the others. Its entry in the
+		 * list is left empty and the reason is recorded in Results.
+		 *
+		 * @param ReleaseGroupIDs MusicBrainz release group IDs to lookup
+		 * @param Includes Space separated list of includes (e.g. "artists labels"), may be empty
+		 * @param ReleaseGroups Receives the release groups, in the same order as ReleaseGroupIDs
+		 * @param Results Receives the result of each lookup, in the same order as ReleaseGroupIDs
+		 */
+
+		void LookupReleaseGroups(const std::vector<std::string>& ReleaseGroupIDs, const std::string& Includes, CReleaseGroupList& ReleaseGroups, std::vector<tQueryResult>& Results);
+
 		/**
 		 * @brief Perform a generic query
 		 *
@@ -357,6 +827,72 @@ namespace MusicBrainz5
 
 		CMetadata Query(const std::string& Entity,const std::string& ID="",const std::string& Resource="",const tParamMap& Params=tParamMap());
 
+		/**
+		 * @brief Perform a generic query, within a time limit
+		 *
+		 * As Query, but allowing the query the given time, rather than the time set with
+		 * SetQueryTimeout.
+		 *
+		 * @param Entity Entity to lookup (e.g. artist, release, discid)
+		 * @param ID The MusicBrainz ID of the entity
+		 * @param Resource The resource (currently only used for collections)
+		 * @param Params Map of parameters to add to the query (e.g. inc)
+		 * @param Timeout Time allowed for the query in seconds, or 0 to use the time set
+		 *		with SetQueryTimeout
+		 *
+		 * @return MusicBrainz5::CMetadata object
+		 *
+		 * @throw CConnectionError An error occurred connecting to the web server
+		 * @throw CTimeoutError The query did not complete in time
+		 * @throw CAuthenticationError An authentication error occurred
+		 * @throw CFetchError An error occurred fetching data
+		 * @throw CRequestError The request was invalid
+		 * @throw CResourceNotFoundError The requested resource was not found
+		 */
+
+		CMetadata Query(const std::string& Entity,const std::string& ID,const std::string& Resource,const tParamMap& Params,double Timeout);
+
+		/**
+		 * @brief Perform a generic query, without throwing
+		 *
+		 * As Query, but failures are reported through the return value rather than by
+		 * throwing an exception. If a cache is installed with SetCache, queries for
+		 * resources that do not exist are remembered, and repeating them fails with
+		 * eQuery_ResourceNotFound without contacting the server.
+		 *
+		 * @param Metadata Receives the result of the query
+		 * @param Entity Entity to lookup (e.g. artist, release, discid)
+		 * @param ID The MusicBrainz ID of the entity
+		 * @param Resource The resource (currently only used for collections)
+		 * @param Params Map of parameters to add to the query (e.g. inc)
+		 * @param Timeout Time allowed for the query in seconds, or 0 to use the time set
+		 *		with SetQueryTimeout
+		 *
+		 * @return Result of the query
+		 */
+
+		tQueryResult TryQuery(CMetadata& Metadata,const std::string& Entity,const std::string& ID="",const std::string& Resource="",const tParamMap& Params=tParamMap(),double Timeout=0);
+
+		/**
+		 * @brief Perform a generic query, asynchronously
+		 *
+		 * As Query, but returns immediately. The query is performed in the background,
+		 * and the result collected from the returned future. Any errors are reported
+		 * when the result is collected. The MusicBrainz5::CQuery object must outlive
+		 * any queries started from it.
+		 *
+		 * @param Entity Entity to lookup (e.g. artist, release, discid)
+		 * @param ID The MusicBrainz ID of the entity
+		 * @param Resource The resource (currently only used for collections)
+		 * @param Params Map of parameters to add to the query (e.g. inc)
+		 * @param Timeout Time allowed for the query in seconds, or 0 to use the time set
+		 *		with SetQueryTimeout
+		 *
+		 * @return MusicBrainz5::CQueryFuture object
+		 */
+
+		CQueryFuture QueryAsync(const std::string& Entity,const std::string& ID="",const std::string& Resource="",const tParamMap& Params=tParamMap(),double Timeout=0);
+
 		/**
 		 * @brief Add entries to the specified collection
 		 *
@@ -425,6 +961,15 @@ namespace MusicBrainz5
 		 */
 		std::string LastErrorMessage() const;
 
+		/**
+		 * @brief Return timings from the last query
+		 *
+		 * Return the timings and transfer statistics for the last query
+		 *
+		 * @return Statistics for the last query
+		 */
+		CQueryStats LastStats() const;
+
 		/**
 		 * @brief Return the library version
 		 *
@@ -437,9 +982,9 @@ namespace MusicBrainz5
 	private:
 		CQueryPrivate * const m_d;
 
-		CMetadata PerformQuery(const std::string& Query);
+		CMetadata PerformQuery(const std::string& Query, double Timeout=0);
+		std::string BuildQuery(const std::string& Entity, const std::string& ID="", const std::string& Resource="", const tParamMap& Params=tParamMap());
 		void WaitRequest() const;
-		std::string UserAgent() const;
 		bool EditCollection(const std::string& CollectionID, const std::vector<std::string>& Entries, const std::string& Action);
 		std::string URIEscape(const std::string& URI);
 		std::string URLEncode(const std::map<std::string,std::string>& Params);
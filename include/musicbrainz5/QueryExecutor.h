@@ -0,0 +1,121 @@
+/* --------------------------------------------------------------------------
+
+   libmusicbrainz5 - Client library to access MusicBrainz
+
+   Copyright (C) 2012 Andrew Hawkins
+
+   This file is part of libmusicbrainz5.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   libmusicbrainz5 is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+     $Id$
+
+----------------------------------------------------------------------------*/
+
+#ifndef _MUSICBRAINZ5_QUERY_EXECUTOR_H
+#define _MUSICBRAINZ5_QUERY_EXECUTOR_H
+
+namespace MusicBrainz5
+{
+	class CQueryExecutorPrivate;
+
+	/**
+	 * @brief Unit of work run by a MusicBrainz5::CQueryExecutor
+	 *
+	 * Unit of work run by a MusicBrainz5::CQueryExecutor
+	 */
+	class CQueryJob
+	{
+	public:
+		virtual ~CQueryJob();
+
+		/**
+		 * @brief Run the job
+		 *
+		 * Run the job on one of the executor's worker threads. Any exception thrown
+		 * is discarded, so jobs should report errors through their own state.
+		 */
+
+		virtual void Run()=0;
+	};
+
+	/**
+	 * @brief Pool of worker threads used to run asynchronous queries
+	 *
+	 * Runs queued jobs on a bounded number of worker threads, which limits the number of
+	 * requests in flight at any one time. Worker threads are started on demand.
+	 */
+	class CQueryExecutor
+	{
+	public:
+		/**
+		 * @brief Constructor
+		 *
+		 * Constructor
+		 *
+		 * @param MaxInFlight Maximum number of jobs run at once
+		 */
+
+		CQueryExecutor(int MaxInFlight=4);
+
+		/**
+		 * @brief Destructor
+		 *
+		 * Runs any jobs still queued, then stops the worker threads
+		 */
+
+		~CQueryExecutor();
+
+		/**
+		 * @brief Set the maximum number of jobs run at once
+		 *
+		 * Set the maximum number of jobs run at once
+		 *
+		 * @param MaxInFlight Maximum number of jobs run at once
+		 */
+
+		void SetMaxInFlight(int MaxInFlight);
+
+		/**
+		 * @brief Return the maximum number of jobs run at once
+		 *
+		 * Return the maximum number of jobs run at once
+		 *
+		 * @return Maximum number of jobs run at once
+		 */
+
+		int MaxInFlight() const;
+
+		/**
+		 * @brief Queue a job
+		 *
+		 * Queue a job to be run. The executor takes ownership of the job, and deletes it
+		 * once it has been run.
+		 *
+		 * @param Job Job to run
+		 */
+
+		void Submit(CQueryJob *Job);
+
+	private:
+		CQueryExecutor(const CQueryExecutor& Other);
+		CQueryExecutor& operator =(const CQueryExecutor& Other);
+
+		static void *WorkerThread(void *UserData);
+
+		CQueryExecutorPrivate * const m_d;
+	};
+}
+
+#endif
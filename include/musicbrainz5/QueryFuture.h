@@ -0,0 +1,219 @@
+/* --------------------------------------------------------------------------
+
+   libmusicbrainz5 - Client library to access MusicBrainz
+
+   Copyright (C) 2012 Andrew Hawkins
+
+   This file is part of libmusicbrainz5.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   libmusicbrainz5 is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+     $Id$
+
+----------------------------------------------------------------------------*/
+
+#ifndef _MUSICBRAINZ5_QUERY_FUTURE_H
+#define _MUSICBRAINZ5_QUERY_FUTURE_H
+
+#include "musicbrainz5/Query.h"
+#include "musicbrainz5/Metadata.h"
+#include "musicbrainz5/QueryStats.h"
+#include "musicbrainz5/Release.h"
+#include "musicbrainz5/ReleaseList.h"
+
+#include <string>
+
+namespace MusicBrainz5
+{
+	class CQueryFuturePrivate;
+
+	/**
+	 * @brief Result of an asynchronous query
+	 *
+	 * Handle to the result of a query started with MusicBrainz5::CQuery::QueryAsync.
+	 * The query runs in the background, and the result can be collected with Get().
+	 * Copies of a future share the same result.
+	 */
+	class CQueryFuture
+	{
+	public:
+		CQueryFuture();
+		CQueryFuture(const CQueryFuture& Other);
+		CQueryFuture& operator =(const CQueryFuture& Other);
+		virtual ~CQueryFuture();
+
+		/**
+		 * @brief Check whether the future refers to a query
+		 *
+		 * Check whether the future refers to a query. Default constructed futures do not.
+		 *
+		 * @return true if the future refers to a query, false otherwise
+		 */
+
+		bool Valid() const;
+
+		/**
+		 * @brief Check whether the query has completed
+		 *
+		 * Check whether the query has completed, without waiting
+		 *
+		 * @return true if the query has completed, false otherwise
+		 */
+
+		bool Ready() const;
+
+		/**
+		 * @brief Wait for the query to complete
+		 *
+		 * Block until the query has completed
+		 */
+
+		void Wait() const;
+
+		/**
+		 * @brief Wait for the query to complete, with a timeout
+		 *
+		 * Block until the query has completed, or the timeout expires
+		 *
+		 * @param Milliseconds Maximum time to wait
+		 *
+		 * @return true if the query has completed, false if the timeout expired
+		 */
+
+		bool WaitFor(int Milliseconds) const;
+
+		/**
+		 * @brief Return the result of the query
+		 *
+		 * Wait for the query to complete and return its result. The returned object remains
+		 * valid for as long as this future, or any copy of it, exists.
+		 *
+		 * @return MusicBrainz5::CMetadata object
+		 *
+		 * @throw CConnectionError An error occurred connecting to the web server
+		 * @throw CTimeoutError A timeout occurred when connecting to the web server
+		 * @throw CAuthenticationError An authentication error occurred
+		 * @throw CFetchError An error occurred fetching data
+		 * @throw CRequestError The request was invalid
+		 * @throw CResourceNotFoundError The requested resource was not found
+		 */
+
+		const CMetadata& Get() const;
+
+		/**
+		 * @brief Return the status of the query
+		 *
+		 * Wait for the query to complete and return its status
+		 *
+		 * @return Status of the query
+		 */
+
+		CQuery::tQueryResult Result() const;
+
+		/**
+		 * @brief Return the HTTP code of the query
+		 *
+		 * Wait for the query to complete and return its HTTP code
+		 *
+		 * @return HTTP code of the query
+		 */
+
+		int HTTPCode() const;
+
+		/**
+		 * @brief Return the error message from the query
+		 *
+		 * Wait for the query to complete and return its error message
+		 *
+		 * @return Error message from the query
+		 */
+
+		std::string ErrorMessage() const;
+
+		/**
+		 * @brief Return timings from the query
+		 *
+		 * Wait for the query to complete and return its timings and transfer statistics
+		 *
+		 * @return Statistics for the query
+		 */
+
+		CQueryStats Stats() const;
+
+	private:
+		friend class CQueryPrivate;
+
+		void Start();
+		CMetadata& Target();
+		CQueryStats& TargetStats();
+		void SetResult(CQuery::tQueryResult Result, int HTTPCode, const std::string& ErrorMessage);
+		void Release();
+
+		CQueryFuturePrivate *m_d;
+	};
+
+	/**
+	 * @brief Result of an asynchronous release lookup
+	 *
+	 * Handle to the result of MusicBrainz5::CQuery::LookupReleaseAsync
+	 */
+	class CReleaseFuture: public CQueryFuture
+	{
+	public:
+		/**
+		 * @brief Return the release
+		 *
+		 * Wait for the lookup to complete and return the release
+		 *
+		 * @return MusicBrainz5::CRelease object
+		 *
+		 * @throw CConnectionError An error occurred connecting to the web server
+		 * @throw CTimeoutError A timeout occurred when connecting to the web server
+		 * @throw CAuthenticationError An authentication error occurred
+		 * @throw CFetchError An error occurred fetching data
+		 * @throw CRequestError The request was invalid
+		 * @throw CResourceNotFoundError The requested resource was not found
+		 */
+
+		CRelease Get() const;
+	};
+
+	/**
+	 * @brief Result of an asynchronous disc ID lookup
+	 *
+	 * Handle to the result of MusicBrainz5::CQuery::LookupDiscIDAsync
+	 */
+	class CReleaseListFuture: public CQueryFuture
+	{
+	public:
+		/**
+		 * @brief Return the list of releases
+		 *
+		 * Wait for the lookup to complete and return the releases matching the disc ID
+		 *
+		 * @return MusicBrainz5::CReleaseList object
+		 *
+		 * @throw CConnectionError An error occurred connecting to the web server
+		 * @throw CTimeoutError A timeout occurred when connecting to the web server
+		 * @throw CAuthenticationError An authentication error occurred
+		 * @throw CFetchError An error occurred fetching data
+		 * @throw CRequestError The request was invalid
+		 * @throw CResourceNotFoundError The requested resource was not found
+		 */
+
+		CReleaseList Get() const;
+	};
+}
+
+#endif
@@ -0,0 +1,189 @@
+/* --------------------------------------------------------------------------
+
+   libmusicbrainz5 - Client library to access MusicBrainz
+
+   Copyright (C) 2012 Andrew Hawkins
+
+   This file is part of libmusicbrainz5.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   libmusicbrainz5 is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+     $Id$
+
+----------------------------------------------------------------------------*/
+
+#ifndef _MUSICBRAINZ5_QUERY_STATS_H
+#define _MUSICBRAINZ5_QUERY_STATS_H
+
+#include <string>
+
+namespace MusicBrainz5
+{
+	class CQueryStatsPrivate;
+
+	/**
+	 * @brief Timings and transfer statistics for one query
+	 *
+	 * Breaks down where the time for a query went, so that a slow run can be identified
+	 * as throttled, network bound or limited by parsing. Returned by
+	 * MusicBrainz5::CQuery::LastStats and MusicBrainz5::CQueryFuture::Stats.
+	 *
+	 * The XML is parsed as the body arrives, so the parse time overlaps the transfer
+	 * time rather than following it.
+	 */
+	class CQueryStats
+	{
+	public:
+		/**
+		 * @brief Enumerated type for where the result came from
+		 *
+		 * Enumerated type for where the result of a query came from
+		 */
+		enum tSource
+		{
+			eSource_Network=0,
+			eSource_MemoryCache,
+			eSource_DiskCache,
+			eSource_Coalesced
+		};
+
+		/**
+		 * @brief Enumerated type for the phases of a query
+		 *
+		 * Enumerated type for the phases a query is timed in:
+		 *
+		 * - Wait: waiting for the rate limiter, including any back off before a retry
+		 * - Connect: looking up and connecting to the server, if a new connection was needed
+		 * - FirstByte: from sending the request to receiving the first byte of the body
+		 * - Transfer: from the first byte of the body to the last
+		 * - Parse: parsing the XML
+		 * - Build: building the MusicBrainz5::CMetadata from the parsed XML
+		 * - Total: the whole query, from start to finish
+		 *
+		 * With the streaming parser (see MusicBrainz5::CQuery::SetStreamingParser) the
+		 * metadata is built as the XML is parsed, and the time for both is reported as Parse.
+		 * With lazy parsing (see MusicBrainz5::CQuery::SetLazyParsing) Build only covers
+		 * the entities built during the query, not those built later as they are used.
+		 */
+		enum tTiming
+		{
+			eTiming_Wait=0,
+			eTiming_Connect,
+			eTiming_FirstByte,
+			eTiming_Transfer,
+			eTiming_Parse,
+			eTiming_Build,
+			eTiming_Total,
+			eTiming_Count
+		};
+
+		CQueryStats();
+		CQueryStats(const CQueryStats& Other);
+		CQueryStats& operator =(const CQueryStats& Other);
+		~CQueryStats();
+
+		/**
+		 * @brief Return the time spent in a phase
+		 *
+		 * Return the time spent in a phase of the query
+		 *
+		 * @param Timing Phase to return
+		 *
+		 * @return Time in seconds
+		 */
+
+		double Time(tTiming Timing) const;
+
+		/**
+		 * @brief Return the number of bytes received
+		 *
+		 * Return the size of the response body as sent by the server, before any
+		 * decompression
+		 *
+		 * @return Number of bytes received
+		 */
+
+		size_t WireBytes() const;
+
+		/**
+		 * @brief Return the size of the body
+		 *
+		 * Return the size of the response body after decompression
+		 *
+		 * @return Size of the body
+		 */
+
+		size_t BodyBytes() const;
+
+		/**
+		 * @brief Return the number of requests made
+		 *
+		 * Return the number of requests made to the server, including retries. This is 0
+		 * if the result was not fetched from the server.
+		 *
+		 * @return Number of requests made
+		 */
+
+		int Attempts() const;
+
+		/**
+		 * @brief Return where the result came from
+		 *
+		 * Return whether the result was fetched from the server, taken from a cache, or
+		 * shared with an identical query that was already in flight
+		 *
+		 * @return Source of the result
+		 */
+
+		tSource Source() const;
+
+		/**
+		 * @brief Return the request ID
+		 *
+		 * Return the ID given to the query, which is passed to any
+		 * MusicBrainz5::CTraceHook with the events for the query
+		 *
+		 * @return Request ID
+		 */
+
+		unsigned long RequestID() const;
+
+		/**
+		 * @brief Return the name of a phase
+		 *
+		 * Return a short name for a phase, for use in reports
+		 *
+		 * @param Timing Phase to return the name of
+		 *
+		 * @return Name of the phase
+		 */
+
+		static std::string TimingName(tTiming Timing);
+
+	private:
+		friend class CQueryPrivate;
+
+		void SetTime(tTiming Timing, double Seconds);
+		void AddTime(tTiming Timing, double Seconds);
+		void SetWireBytes(size_t WireBytes);
+		void SetBodyBytes(size_t BodyBytes);
+		void SetAttempts(int Attempts);
+		void SetSource(tSource Source);
+		void SetRequestID(unsigned long RequestID);
+
+		CQueryStatsPrivate * const m_d;
+	};
+}
+
+#endif
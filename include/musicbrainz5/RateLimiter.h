@@ -0,0 +1,153 @@
+/* --------------------------------------------------------------------------
+
+   libmusicbrainz5 - Client library to access MusicBrainz
+
+   Copyright (C) 2012 Andrew Hawkins
+
+   This file is part of libmusicbrainz5.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   libmusicbrainz5 is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+     $Id$
+
+----------------------------------------------------------------------------*/
+
+#ifndef _MUSICBRAINZ5_RATE_LIMITER_H
+#define _MUSICBRAINZ5_RATE_LIMITER_H
+
+#include <string>
+
+namespace MusicBrainz5
+{
+	class CRateLimiterPrivate;
+
+	/**
+	 * @brief Token bucket rate limiter
+	 *
+	 * Limits the rate at which requests are made to a server. Tokens are added to a bucket
+	 * at a fixed rate, up to a maximum burst size, and each request consumes one token.
+	 * A request made while the bucket is empty sleeps until the next token is due.
+	 *
+	 * One limiter is shared by every MusicBrainz5::CQuery object talking to the same
+	 * server, see ServerLimiter(). The limiter is safe to use from multiple threads.
+	 *
+	 * Applications may derive from this class and override Wait() to implement their
+	 * own throttling policy, and install it using MusicBrainz5::CQuery::SetRateLimiter.
+	 */
+	class CRateLimiter
+	{
+	public:
+		/**
+		 * @brief Constructor
+		 *
+		 * Constructor
+		 *
+		 * @param Rate Number of requests allowed per second, or 0 for no limit
+		 * @param Burst Number of requests that may be made back to back before throttling starts
+		 */
+
+		CRateLimiter(double Rate=0, int Burst=1);
+		virtual ~CRateLimiter();
+
+		/**
+		 * @brief Set the rate
+		 *
+		 * Set the number of requests allowed per second, and the number of requests that
+		 * may be made back to back
+		 *
+		 * @param Rate Number of requests allowed per second, or 0 for no limit
+		 * @param Burst Maximum burst size
+		 */
+
+		void SetRate(double Rate, int Burst=1);
+
+		/**
+		 * @brief Return the rate
+		 *
+		 * Return the number of requests allowed per second
+		 *
+		 * @return Number of requests per second, or 0 if unlimited
+		 */
+
+		double Rate() const;
+
+		/**
+		 * @brief Return the burst size
+		 *
+		 * Return the number of requests that may be made back to back
+		 *
+		 * @return Burst size
+		 */
+
+		int Burst() const;
+
+		/**
+		 * @brief Wait for permission to make a request
+		 *
+		 * Block until a token is available, and consume it
+		 */
+
+		virtual void Wait();
+
+		/**
+		 * @brief Wait for permission to make a request, with a timeout
+		 *
+		 * As Wait, but gives up straight away if a token would not be available
+		 * within the given time. No token is consumed in that case.
+		 *
+		 * @param Timeout Longest time to wait, in seconds
+		 *
+		 * @return true if a token was consumed, false otherwise
+		 */
+
+		virtual bool TryWait(double Timeout);
+
+		/**
+		 * @brief Hold off all requests for a time
+		 *
+		 * Stop any request being made through this limiter for the given time, for
+		 * example because the server has asked clients to back off. Calls to Wait
+		 * block until the time has passed.
+		 *
+		 * @param Seconds Number of seconds to hold off
+		 */
+
+		virtual void Penalise(double Seconds);
+
+		/**
+		 * @brief Return the limiter for a server
+		 *
+		 * Return the limiter shared by all queries to the specified server. The first call
+		 * for a server creates the limiter. Servers in the musicbrainz.org domain default to
+		 * one request every two seconds, all other servers are unlimited by default.
+		 *
+		 * The limiter remains owned by the library.
+		 *
+		 * @param Server Server name
+		 * @param Port Server port
+		 *
+		 * @return Limiter for the server
+		 */
+
+		static CRateLimiter *ServerLimiter(const std::string& Server, int Port);
+
+	private:
+		CRateLimiter(const CRateLimiter& Other);
+		CRateLimiter& operator =(const CRateLimiter& Other);
+
+		CRateLimiterPrivate * const m_d;
+	};
+}
+
+#endif
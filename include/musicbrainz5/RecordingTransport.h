@@ -0,0 +1,100 @@
+/* --------------------------------------------------------------------------
+
+   libmusicbrainz5 - Client library to access MusicBrainz
+
+   Copyright (C) 2012 Andrew Hawkins
+
+   This file is part of libmusicbrainz5.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   libmusicbrainz5 is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+     $Id$
+
+----------------------------------------------------------------------------*/
+
+#ifndef _MUSICBRAINZ5_RECORDING_TRANSPORT_H
+#define _MUSICBRAINZ5_RECORDING_TRANSPORT_H
+
+#include <string>
+
+#include "musicbrainz5/Transport.h"
+
+namespace MusicBrainz5
+{
+	class CRecordingTransportPrivate;
+
+	/**
+	 * @brief Transport recording requests made through another transport
+	 *
+	 * Passes each request on to another transport, and appends the request, the status,
+	 * the time taken and the body of the response to an archive file. The archive can be
+	 * served back later with MusicBrainz5::CReplayTransport, so that a run can be
+	 * repeated without a network.
+	 *
+	 * The archive starts with the line "MB5REPLAY 1". Each record is a short text header,
+	 * terminated by an empty line, followed by the body exactly as received:
+	 *
+	 * @verbatim
+request: GET /ws/2/release/ID?inc=labels
+status: 200
+time: 0.184213
+header: etag: "abc"
+length: 1234
+
+<1234 bytes of body>
+@endverbatim
+	 *
+	 * There is a "header:" line for each response header. A request that failed with an
+	 * exception has an additional "error:" line naming the exception and giving its
+	 * message.
+	 */
+	class CRecordingTransport: public CTransport
+	{
+	public:
+		/**
+		 * @brief Constructor
+		 *
+		 * Constructor. Records are appended to the archive if it already exists.
+		 *
+		 * @param Transport Transport to perform requests with. Ownership remains with the
+		 * 				caller, and it must outlive this object.
+		 * @param FileName Archive to record to
+		 *
+		 * @throw CFetchError The archive could not be opened
+		 */
+
+		CRecordingTransport(CTransport& Transport, const std::string& FileName);
+		virtual ~CRecordingTransport();
+
+		virtual void Fetch(const CTransportRequest& Request, CTransportResponse& Response);
+
+		/**
+		 * @brief Return the number of requests recorded
+		 *
+		 * Return the number of requests recorded since this object was created
+		 *
+		 * @return Number of requests recorded
+		 */
+
+		int NumRecorded() const;
+
+	private:
+		CRecordingTransport(const CRecordingTransport& Other);
+		CRecordingTransport& operator =(const CRecordingTransport& Other);
+
+		CRecordingTransportPrivate * const m_d;
+	};
+}
+
+#endif
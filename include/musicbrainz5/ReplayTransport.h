@@ -0,0 +1,130 @@
+/* --------------------------------------------------------------------------
+
+   libmusicbrainz5 - Client library to access MusicBrainz
+
+   Copyright (C) 2012 Andrew Hawkins
+
+   This file is part of libmusicbrainz5.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   libmusicbrainz5 is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+     $Id$
+
+----------------------------------------------------------------------------*/
+
+#ifndef _MUSICBRAINZ5_REPLAY_TRANSPORT_H
+#define _MUSICBRAINZ5_REPLAY_TRANSPORT_H
+
+#include <string>
+
+#include "musicbrainz5/Transport.h"
+
+namespace MusicBrainz5
+{
+	class CReplayTransportPrivate;
+
+	/**
+	 * @brief Transport serving responses from a recorded archive
+	 *
+	 * Serves the responses recorded by MusicBrainz5::CRecordingTransport, without making
+	 * any network requests. This allows the whole path from a query to the parsed
+	 * MusicBrainz5::CMetadata to be benchmarked, or a problem to be reproduced, offline.
+	 *
+	 * A request is matched on its method and URL. If the same request was recorded more
+	 * than once, the recorded responses are served in turn, starting again from the first
+	 * once they have all been used. Requests that were not recorded get a 404 status.
+	 *
+	 * By default responses are served immediately. They can instead be delayed by the
+	 * time they originally took, scaled by MusicBrainz5::CReplayTransport::SetLatencyScale,
+	 * to reproduce the latency of the recorded run.
+	 */
+	class CReplayTransport: public CTransport
+	{
+	public:
+		/**
+		 * @brief Constructor
+		 *
+		 * Constructor. The whole archive is read into memory.
+		 *
+		 * @param FileName Archive to serve responses from
+		 *
+		 * @throw CFetchError The archive could not be read
+		 */
+
+		CReplayTransport(const std::string& FileName);
+		virtual ~CReplayTransport();
+
+		virtual void Fetch(const CTransportRequest& Request, CTransportResponse& Response);
+
+		/**
+		 * @brief Set the simulated latency
+		 *
+		 * Delay each response by the time it took when it was recorded, multiplied by
+		 * Scale. A scale of 0 (the default) serves responses immediately, and 1 reproduces
+		 * the recorded latency.
+		 *
+		 * @param Scale Multiplier for the recorded time
+		 */
+
+		void SetLatencyScale(double Scale);
+
+		/**
+		 * @brief Set an additional fixed latency
+		 *
+		 * Delay each response by a fixed time, in addition to any scaled recorded time
+		 *
+		 * @param Seconds Additional delay in seconds
+		 */
+
+		void SetLatency(double Seconds);
+
+		/**
+		 * @brief Return the number of recorded responses
+		 *
+		 * Return the number of responses read from the archive
+		 *
+		 * @return Number of recorded responses
+		 */
+
+		int NumRecords() const;
+
+		/**
+		 * @brief Return the number of requests served
+		 *
+		 * Return the number of requests that were answered from the archive
+		 *
+		 * @return Number of requests served
+		 */
+
+		int NumServed() const;
+
+		/**
+		 * @brief Return the number of requests not found
+		 *
+		 * Return the number of requests that were not in the archive
+		 *
+		 * @return Number of requests not found
+		 */
+
+		int NumMissed() const;
+
+	private:
+		CReplayTransport(const CReplayTransport& Other);
+		CReplayTransport& operator =(const CReplayTransport& Other);
+
+		CReplayTransportPrivate * const m_d;
+	};
+}
+
+#endif
@@ -0,0 +1,170 @@
+/* --------------------------------------------------------------------------
+
+   libmusicbrainz5 - Client library to access MusicBrainz
+
+   Copyright (C) 2012 Andrew Hawkins
+
+   This file is part of libmusicbrainz5.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   libmusicbrainz5 is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+     $Id$
+
+----------------------------------------------------------------------------*/
+
+#ifndef _MUSICBRAINZ5_TIMING_HISTOGRAM_H
+#define _MUSICBRAINZ5_TIMING_HISTOGRAM_H
+
+namespace MusicBrainz5
+{
+	class CTimingHistogramPrivate;
+
+	/**
+	 * @brief Histogram of durations
+	 *
+	 * Collects durations into buckets whose limits double from 100 microseconds up to
+	 * about 100 seconds, with a final bucket for anything longer. Adding a duration is
+	 * cheap and takes constant space, so every query can be recorded.
+	 */
+	class CTimingHistogram
+	{
+	public:
+		CTimingHistogram();
+		CTimingHistogram(const CTimingHistogram& Other);
+		CTimingHistogram& operator =(const CTimingHistogram& Other);
+		~CTimingHistogram();
+
+		/**
+		 * @brief Add a duration
+		 *
+		 * Add a duration to the histogram
+		 *
+		 * @param Seconds Duration in seconds
+		 */
+
+		void Add(double Seconds);
+
+		/**
+		 * @brief Remove all durations
+		 *
+		 * Remove all durations from the histogram
+		 */
+
+		void Clear();
+
+		/**
+		 * @brief Return the number of durations
+		 *
+		 * Return the number of durations added
+		 *
+		 * @return Number of durations
+		 */
+
+		int Count() const;
+
+		/**
+		 * @brief Return the total of the durations
+		 *
+		 * Return the sum of all the durations added
+		 *
+		 * @return Total in seconds
+		 */
+
+		double Sum() const;
+
+		/**
+		 * @brief Return the mean duration
+		 *
+		 * Return the mean of the durations added, or 0 if there are none
+		 *
+		 * @return Mean in seconds
+		 */
+
+		double Mean() const;
+
+		/**
+		 * @brief Return the shortest duration
+		 *
+		 * Return the shortest duration added, or 0 if there are none
+		 *
+		 * @return Shortest duration in seconds
+		 */
+
+		double Min() const;
+
+		/**
+		 * @brief Return the longest duration
+		 *
+		 * Return the longest duration added, or 0 if there are none
+		 *
+		 * @return Longest duration in seconds
+		 */
+
+		double Max() const;
+
+		/**
+		 * @brief Return a percentile
+		 *
+		 * Return an estimate of a percentile of the durations, accurate to within a
+		 * factor of two. This is the upper limit of the bucket the percentile falls in,
+		 * clamped to the longest duration added.
+		 *
+		 * @param Percent Percentile to return, from 0 to 100
+		 *
+		 * @return Duration in seconds
+		 */
+
+		double Percentile(double Percent) const;
+
+		/**
+		 * @brief Return the number of buckets
+		 *
+		 * Return the number of buckets in the histogram
+		 *
+		 * @return Number of buckets
+		 */
+
+		int NumBuckets() const;
+
+		/**
+		 * @brief Return the upper limit of a bucket
+		 *
+		 * Return the longest duration counted in a bucket. The last bucket has no limit,
+		 * and returns 0.
+		 *
+		 * @param Bucket Bucket to return
+		 *
+		 * @return Upper limit in seconds
+		 */
+
+		double BucketLimit(int Bucket) const;
+
+		/**
+		 * @brief Return the count in a bucket
+		 *
+		 * Return the number of durations counted in a bucket
+		 *
+		 * @param Bucket Bucket to return
+		 *
+		 * @return Number of durations
+		 */
+
+		int BucketCount(int Bucket) const;
+
+	private:
+		CTimingHistogramPrivate * const m_d;
+	};
+}
+
+#endif
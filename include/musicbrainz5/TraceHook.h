@@ -0,0 +1,111 @@
+/* --------------------------------------------------------------------------
+
+   libmusicbrainz5 - Client library to access MusicBrainz
+
+   Copyright (C) 2012 Andrew Hawkins
+
+   This file is part of libmusicbrainz5.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   libmusicbrainz5 is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+     $Id$
+
+----------------------------------------------------------------------------*/
+
+#ifndef _MUSICBRAINZ5_TRACE_HOOK_H
+#define _MUSICBRAINZ5_TRACE_HOOK_H
+
+#include <string>
+
+namespace MusicBrainz5
+{
+	/**
+	 * @brief Interface for tracing queries
+	 *
+	 * Receives an event at the beginning and end of each phase of the queries made
+	 * through a MusicBrainz5::CQuery, so they can be passed on to a tracing system.
+	 * Install one with MusicBrainz5::CQuery::SetTraceHook.
+	 *
+	 * Every query is given a request ID, which is passed with each of its events and is
+	 * also returned by MusicBrainz5::CQueryStats::RequestID. The events for one query
+	 * are all sent from the thread performing it, and nest within its
+	 * eSpan_Query span. Implementations must be safe to call from several threads at
+	 * once, as asynchronous queries are performed in parallel.
+	 *
+	 * When no hook is installed the only cost is a pointer test at each span.
+	 */
+	class CTraceHook
+	{
+	public:
+		/**
+		 * @brief Enumerated type for the spans traced
+		 *
+		 * Enumerated type for the spans traced:
+		 *
+		 * - Query: the whole query, including any cache lookup
+		 * - Wait: waiting for the rate limiter
+		 * - Fetch: a request to the transport. The body is parsed as it arrives, so
+		 *   Parse spans occur within it.
+		 * - Parse: parsing a block of XML
+		 * - Build: building the MusicBrainz5::CMetadata from the parsed XML
+		 */
+		enum tSpan
+		{
+			eSpan_Query=0,
+			eSpan_Wait,
+			eSpan_Fetch,
+			eSpan_Parse,
+			eSpan_Build
+		};
+
+		virtual ~CTraceHook();
+
+		/**
+		 * @brief Called when a span begins
+		 *
+		 * Called when a span begins
+		 *
+		 * @param RequestID ID of the query the span belongs to
+		 * @param Span Span beginning
+		 * @param Detail The URL requested, for Query and Fetch spans. Empty otherwise.
+		 */
+
+		virtual void Begin(unsigned long RequestID, tSpan Span, const std::string& Detail)=0;
+
+		/**
+		 * @brief Called when a span ends
+		 *
+		 * Called when a span ends
+		 *
+		 * @param RequestID ID of the query the span belongs to
+		 * @param Span Span ending
+		 */
+
+		virtual void End(unsigned long RequestID, tSpan Span)=0;
+
+		/**
+		 * @brief Return the name of a span
+		 *
+		 * Return a short name for a span, for use in traces
+		 *
+		 * @param Span Span to return the name of
+		 *
+		 * @return Name of the span
+		 */
+
+		static std::string SpanName(tSpan Span);
+	};
+}
+
+#endif
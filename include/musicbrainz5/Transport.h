@@ -0,0 +1,363 @@
+/* --------------------------------------------------------------------------
+
+   libmusicbrainz5 - Client library to access MusicBrainz
+
+   Copyright (C) 2012 Andrew Hawkins
+
+   This file is part of libmusicbrainz5.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   libmusicbrainz5 is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+     $Id$
+
+----------------------------------------------------------------------------*/
+
+#ifndef _MUSICBRAINZ5_TRANSPORT_H
+#define _MUSICBRAINZ5_TRANSPORT_H
+
+#include <string>
+#include <vector>
+#include <map>
+
+#include "musicbrainz5/HTTPFetch.h"
+
+namespace MusicBrainz5
+{
+	class CTransportRequestPrivate;
+	class CTransportResponsePrivate;
+
+	/**
+	 * @brief A request to be made through a transport
+	 *
+	 * Describes a single request to the web service, to be performed by a
+	 * MusicBrainz5::CTransport
+	 */
+	class CTransportRequest
+	{
+	public:
+		/**
+		 * @brief Constructor
+		 *
+		 * Constructor
+		 *
+		 * @param URL Path and query string to request (e.g. /ws/2/release/ID?inc=labels)
+		 * @param Method Request method (GET by default)
+		 */
+
+		CTransportRequest(const std::string& URL, const std::string& Method="GET");
+		CTransportRequest(const CTransportRequest& Other);
+		CTransportRequest& operator =(const CTransportRequest& Other);
+		~CTransportRequest();
+
+		/**
+		 * @brief Return the URL to request
+		 *
+		 * Return the path and query string to request
+		 *
+		 * @return URL to request
+		 */
+
+		std::string URL() const;
+
+		/**
+		 * @brief Return the request method
+		 *
+		 * Return the request method (e.g. GET, PUT, DELETE)
+		 *
+		 * @return Request method
+		 */
+
+		std::string Method() const;
+
+		/**
+		 * @brief Set a request header
+		 *
+		 * Set an additional header to send with the request, replacing any previous
+		 * value for the same header
+		 *
+		 * @param Name Name of the header
+		 * @param Value Value of the header
+		 */
+
+		void SetHeader(const std::string& Name, const std::string& Value);
+
+		/**
+		 * @brief Return the request headers
+		 *
+		 * Return the additional headers to send with the request, keyed by name
+		 *
+		 * @return Request headers
+		 */
+
+		const std::map<std::string,std::string>& Headers() const;
+
+		/**
+		 * @brief Set the time allowed for the request
+		 *
+		 * Set the longest time the request may take, including connecting to the server
+		 * and receiving the whole body. Transports that can enforce it fail the request
+		 * with CTimeoutError once it has passed.
+		 *
+		 * @param Seconds Time allowed in seconds, or 0 for no limit (the default)
+		 */
+
+		void SetTimeout(double Seconds);
+
+		/**
+		 * @brief Return the time allowed for the request
+		 *
+		 * Return the longest time the request may take
+		 *
+		 * @return Time allowed in seconds, or 0 for no limit
+		 */
+
+		double Timeout() const;
+
+	private:
+		CTransportRequestPrivate * const m_d;
+	};
+
+	/**
+	 * @brief The response to a request made through a transport
+	 *
+	 * Receives the status and body of a response from a MusicBrainz5::CTransport. The body
+	 * is passed to a MusicBrainz5::CHTTPBodyReader as it arrives if one is supplied, and
+	 * collected in memory otherwise.
+	 */
+	class CTransportResponse: public CHTTPBodyReader
+	{
+	public:
+		/**
+		 * @brief Constructor
+		 *
+		 * Constructor
+		 *
+		 * @param Reader Reader to pass the body to, or NULL to collect it in memory.
+		 * 				Ownership remains with the caller.
+		 */
+
+		CTransportResponse(CHTTPBodyReader *Reader=0);
+		virtual ~CTransportResponse();
+
+		/**
+		 * @brief Add a block of the response body
+		 *
+		 * Called by the transport for each block of a successful response body, in order
+		 *
+		 * @param Data Block of data received
+		 * @param Length Length of the block
+		 *
+		 * @return true to continue the request, false to abort it
+		 */
+
+		virtual bool Read(const char *Data, size_t Length);
+
+		/**
+		 * @brief Set the HTTP status
+		 *
+		 * Set the HTTP status code of the response
+		 *
+		 * @param Status HTTP status code
+		 */
+
+		void SetStatus(int Status);
+
+		/**
+		 * @brief Set the error message
+		 *
+		 * Set the error message describing a failed request
+		 *
+		 * @param ErrorMessage Error message
+		 */
+
+		void SetErrorMessage(const std::string& ErrorMessage);
+
+		/**
+		 * @brief Set a response header
+		 *
+		 * Record a header received with the response. Header names are not case sensitive.
+		 *
+		 * @param Name Name of the header
+		 * @param Value Value of the header
+		 */
+
+		void SetHeader(const std::string& Name, const std::string& Value);
+
+		/**
+		 * @brief Set the connection time
+		 *
+		 * Set the time spent looking up the server and connecting to it. Transports that
+		 * reuse a connection, or cannot tell, leave this at 0.
+		 *
+		 * @param Seconds Connection time in seconds
+		 */
+
+		void SetConnectTime(double Seconds);
+
+		/**
+		 * @brief Set the number of bytes received
+		 *
+		 * Set the size of the body as sent by the server, before any decompression.
+		 * Transports that cannot tell leave this at 0, and the length of the body is
+		 * used instead.
+		 *
+		 * @param WireBytes Number of bytes received
+		 */
+
+		void SetWireBytes(size_t WireBytes);
+
+		/**
+		 * @brief Return the HTTP status
+		 *
+		 * Return the HTTP status code of the response
+		 *
+		 * @return HTTP status code
+		 */
+
+		int Status() const;
+
+		/**
+		 * @brief Return the error message
+		 *
+		 * Return the error message describing a failed request
+		 *
+		 * @return Error message
+		 */
+
+		std::string ErrorMessage() const;
+
+		/**
+		 * @brief Return a response header
+		 *
+		 * Return the value of a header received with the response
+		 *
+		 * @param Name Name of the header, which is not case sensitive
+		 *
+		 * @return Value of the header, or an empty string if it was not received
+		 */
+
+		std::string Header(const std::string& Name) const;
+
+		/**
+		 * @brief Return the response headers
+		 *
+		 * Return all the headers received with the response, keyed by lower case name
+		 *
+		 * @return Response headers
+		 */
+
+		const std::map<std::string,std::string>& Headers() const;
+
+		/**
+		 * @brief Return the connection time
+		 *
+		 * Return the time spent looking up the server and connecting to it
+		 *
+		 * @return Connection time in seconds
+		 */
+
+		double ConnectTime() const;
+
+		/**
+		 * @brief Return the number of bytes received
+		 *
+		 * Return the size of the body as sent by the server, before any decompression
+		 *
+		 * @return Number of bytes received
+		 */
+
+		size_t WireBytes() const;
+
+		/**
+		 * @brief Return the length of the body
+		 *
+		 * Return the number of bytes of body received
+		 *
+		 * @return Length of the body
+		 */
+
+		size_t Length() const;
+
+		/**
+		 * @brief Return the body
+		 *
+		 * Return the body collected in memory. This is empty if a reader was supplied.
+		 *
+		 * @return Body of the response
+		 */
+
+		const std::vector<unsigned char>& Data() const;
+
+	private:
+		CTransportResponse(const CTransportResponse& Other);
+		CTransportResponse& operator =(const CTransportResponse& Other);
+
+		CTransportResponsePrivate * const m_d;
+	};
+
+	/**
+	 * @brief Interface for performing requests to the web service
+	 *
+	 * MusicBrainz5::CQuery makes all its requests through a transport. By default this
+	 * is a MusicBrainz5::CNeonTransport, which talks HTTP to the server, but any other
+	 * implementation may be supplied with MusicBrainz5::CQuery::SetTransport.
+	 *
+	 * Implementations must be safe to call from several threads at once, as
+	 * asynchronous queries are performed in parallel.
+	 */
+	class CTransport
+	{
+	public:
+		virtual ~CTransport();
+
+		/**
+		 * @brief Perform a request
+		 *
+		 * Perform a request, setting the status of the response and passing it the body.
+		 * Failures that prevent a response being received are reported by throwing one of
+		 * the exceptions below. Error statuses may either be returned in the response, or
+		 * reported by throwing the matching exception.
+		 *
+		 * @param Request Request to perform
+		 * @param Response Response to fill in
+		 *
+		 * @throw CConnectionError An error occurred connecting to the web server
+		 * @throw CTimeoutError A timeout occurred when connecting to the web server
+		 * @throw CAuthenticationError An authentication error occurred
+		 * @throw CFetchError An error occurred fetching data
+		 */
+
+		virtual void Fetch(const CTransportRequest& Request, CTransportResponse& Response)=0;
+
+		/**
+		 * @brief Throw the exception matching an HTTP status
+		 *
+		 * Throw the exception corresponding to an HTTP status code, in the same way as
+		 * MusicBrainz5::CHTTPFetch::Fetch. Does nothing for a successful (2xx) status,
+		 * or for 304 (Not Modified) in reply to a conditional request.
+		 *
+		 * @param Status HTTP status code
+		 * @param ErrorMessage Error message to pass to the exception
+		 *
+		 * @throw CAuthenticationError An authentication error occurred
+		 * @throw CFetchError An error occurred fetching data
+		 * @throw CRequestError The request was invalid
+		 * @throw CResourceNotFoundError The requested resource was not found
+		 */
+
+		static void CheckStatus(int Status, const std::string& ErrorMessage);
+	};
+}
+
+#endif
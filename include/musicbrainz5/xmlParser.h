@@ -26,6 +26,7 @@
 #define _MUSICBRAINZ5_XMLPARSER_H
 
 #include <string>
+#include <vector>
 
 struct _xmlNode;
 typedef _xmlNode* xmlNodePtr;
@@ -36,6 +37,12 @@ typedef _xmlDoc* xmlDocPtr;
 struct _xmlAttr;
 typedef _xmlAttr* xmlAttrPtr;
 
+struct _xmlParserCtxt;
+typedef _xmlParserCtxt* xmlParserCtxtPtr;
+
+struct _xmlTextReader;
+typedef _xmlTextReader* xmlTextReaderPtr;
+
 struct XMLResults
 {
     std::string message;
@@ -48,6 +55,12 @@ struct XMLResults
 const int eXMLErrorNone = 0;
 
 class XMLAttribute;
+class XMLStreamParser;
+
+/* A node is either part of a document built by XMLRootNode or XMLPushParser,
+ * or the current element of an XMLStreamParser. Streamed nodes can only be
+ * read forwards: an element's attributes and text remain available until its
+ * next sibling is requested, and its children can be walked once. */
 class XMLNode
 {
     public:
@@ -68,11 +81,17 @@ class XMLNode
 
     protected:
         XMLNode(xmlNodePtr node);
+        XMLNode(xmlNodePtr node, XMLStreamParser *stream, int depth);
 
         xmlNodePtr mNode;
 
     private:
+        friend class XMLStreamParser;
+
         xmlAttrPtr getAttributeRaw(const char *name) const;
+
+        XMLStreamParser *mStream;
+        int mDepth;
 };
 
 bool operator !=(const XMLNode &lhs, const XMLNode &rhs);
@@ -81,16 +100,91 @@ class XMLRootNode: public XMLNode
 {
     public:
         static XMLNode* parseString(const std::string &xml, XMLResults *results);
+        static XMLNode* parseString(const char *xml, size_t len, XMLResults *results);
         static XMLNode* parseFile(const std::string &filename, XMLResults *results);
 
         virtual ~XMLRootNode();
 
     private:
+        friend class XMLPushParser;
+
         XMLRootNode(xmlDocPtr doc);
 
         xmlDocPtr mDoc;
 };
 
+/* Parsers reuse a context kept by the calling thread, rather than creating
+ * one for every document. Unless retain is set, the names in the document are
+ * kept in that context's dictionary, so the document must be freed by the
+ * same thread. Set it if the document is to be kept once parsing has
+ * finished, and so might be freed by another thread. */
+class XMLPushParser
+{
+    public:
+        explicit XMLPushParser(bool retain = false);
+        ~XMLPushParser();
+
+        void parseChunk(const char *data, size_t len);
+        XMLNode* finish(XMLResults *results);
+
+    private:
+        XMLPushParser(const XMLPushParser &other);
+        XMLPushParser &operator =(const XMLPushParser &other);
+
+        xmlParserCtxtPtr mCtxt;
+        bool mRetain;
+};
+
+/* Builds nothing but the element currently being read, using xmlTextReader,
+ * so a response can be turned straight into entities without a document
+ * being built for it first. The data must remain valid until finish() has
+ * been called. */
+class XMLStreamParser
+{
+    public:
+        XMLStreamParser(const char *xml, size_t len);
+        ~XMLStreamParser();
+
+        XMLNode root();
+        bool finish(XMLResults *results);
+
+    private:
+        friend class XMLNode;
+
+        enum State
+        {
+            eStart,
+            eText,
+            ePending,
+            eChildren,
+            eEnd
+        };
+
+        struct Frame
+        {
+            xmlNodePtr node;
+            State state;
+            bool textChecked;
+            bool hasText;
+            std::string text;
+        };
+
+        XMLStreamParser(const XMLStreamParser &other);
+        XMLStreamParser &operator =(const XMLStreamParser &other);
+
+        bool read();
+        XMLNode push(int depth);
+        XMLNode scan(int depth);
+        XMLNode firstChild(int depth);
+        XMLNode nextSibling(int depth);
+        const char *text(int depth);
+
+        xmlTextReaderPtr mReader;
+        std::vector<Frame> mFrames;
+        bool mFailed;
+        XMLResults mError;
+};
+
 class XMLAttribute
 {
     public:
@@ -7,7 +7,7 @@ Name: ${PROJECT_NAME}cc
 Description: The Musicbrainz Client Library.
 URL: http://musicbrainz.org/doc/libmusicbrainz
 Version: ${PROJECT_VERSION}
-Requires.private: neon >= 0.25 libxml-2.0
+Requires.private: neon >= 0.25 libxml-2.0${CURL_PC_REQUIRES}
 Libs: -L${LIB_INSTALL_DIR} -lmusicbrainz5cc
 Cflags: -I${INCLUDE_INSTALL_DIR}
 
@@ -27,6 +27,7 @@
 #include "musicbrainz5/defines.h"
 
 #include "musicbrainz5/Alias.h"
+#include "musicbrainz5/ElementName.h"
 
 class MusicBrainz5::CAliasPrivate
 {
@@ -92,31 +93,46 @@ MusicBrainz5::CAlias *MusicBrainz5::CAlias::Clone()
 
 void MusicBrainz5::CAlias::ParseAttribute(const std::string& Name, const std::string& Value)
 {
-	if ("locale"==Name)
-		m_d->m_Locale=Value;
-	else if ("sort-name"==Name)
-		m_d->m_SortName=Value;
-	else if ("type"==Name)
-		m_d->m_Type=Value;
-	else if ("primary"==Name)
-		m_d->m_Primary=Value;
-	else if ("begin-date"==Name)
-		m_d->m_BeginDate=Value;
-	else if ("end-date"==Name)
-		m_d->m_EndDate=Value;
-	else
+	switch (CElementName::Lookup(Name))
 	{
+		case CElementName::eName_Locale:
+			m_d->m_Locale=Value;
+			break;
+
+		case CElementName::eName_SortName:
+			m_d->m_SortName=Value;
+			break;
+
+		case CElementName::eName_Type:
+			m_d->m_Type=Value;
+			break;
+
+		case CElementName::eName_Primary:
+			m_d->m_Primary=Value;
+			break;
+
+		case CElementName::eName_BeginDate:
+			m_d->m_BeginDate=Value;
+			break;
+
+		case CElementName::eName_EndDate:
+			m_d->m_EndDate=Value;
+			break;
+
+		default:
 #ifdef _MB5_DEBUG_
-		std::cerr << "Unrecognised alias attribute: '" << Name << "'" << std::endl;
+			std::cerr << "Unrecognised alias attribute: '" << Name << "'" << std::endl;
 #endif
+			break;
 	}
 }
 
 void MusicBrainz5::CAlias::ParseElement(const XMLNode& Node)
 {
-	std::string NodeName=Node.getName();
 #ifdef _MB5_DEBUG_
-	std::cerr << "Unrecognised alias element: '" << NodeName << std::endl;
+	std::cerr << "Unrecognised alias element: '" << Node.getName() << std::endl;
+#else
+	(void)Node;
 #endif
 }
 
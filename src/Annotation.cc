@@ -27,6 +27,7 @@
 #include "musicbrainz5/defines.h"
 
 #include "musicbrainz5/Annotation.h"
+#include "musicbrainz5/ElementName.h"
 
 class MusicBrainz5::CAnnotationPrivate
 {
@@ -83,37 +84,41 @@ MusicBrainz5::CAnnotation *MusicBrainz5::CAnnotation::Clone()
 
 void MusicBrainz5::CAnnotation::ParseAttribute(const std::string& Name, const std::string& Value)
 {
-	if ("type"==Name)
-		m_d->m_Type=Value;
-	else
+	switch (CElementName::Lookup(Name))
 	{
+		case CElementName::eName_Type:
+			m_d->m_Type=Value;
+			break;
+
+		default:
 #ifdef _MB5_DEBUG_
-		std::cerr << "Unrecognised annotation attribute: '" << Name << "'" << std::endl;
+			std::cerr << "Unrecognised annotation attribute: '" << Name << "'" << std::endl;
 #endif
+			break;
 	}
 }
 
 void MusicBrainz5::CAnnotation::ParseElement(const XMLNode& Node)
 {
-	std::string NodeName=Node.getName();
-
-	if ("entity"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Entity);
-	}
-	else if ("name"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Name);
-	}
-	else if ("text"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Text);
-	}
-	else
+	switch (CElementName::Lookup(Node))
 	{
+		case CElementName::eName_Entity:
+			ProcessItem(Node,m_d->m_Entity);
+			break;
+
+		case CElementName::eName_Name:
+			ProcessItem(Node,m_d->m_Name);
+			break;
+
+		case CElementName::eName_Text:
+			ProcessItem(Node,m_d->m_Text);
+			break;
+
+		default:
 #ifdef _MB5_DEBUG_
-		std::cerr << "Unrecognised annotation element: '" << NodeName << "'" << std::endl;
+			std::cerr << "Unrecognised annotation element: '" << Node.getName() << "'" << std::endl;
 #endif
+			break;
 	}
 }
 
@@ -27,6 +27,7 @@
 #include "musicbrainz5/defines.h"
 
 #include "musicbrainz5/Artist.h"
+#include "musicbrainz5/ElementName.h"
 
 #include "musicbrainz5/Lifespan.h"
 #include "musicbrainz5/IPI.h"
@@ -228,103 +229,109 @@ MusicBrainz5::CArtist *MusicBrainz5::CArtist::Clone()
 
 void MusicBrainz5::CArtist::ParseAttribute(const std::string& Name, const std::string& Value)
 {
-	if ("id"==Name)
-		m_d->m_ID=Value;
-	else if ("type"==Name)
-		m_d->m_Type=Value;
-	else
+	switch (CElementName::Lookup(Name))
 	{
+		case CElementName::eName_ID:
+			m_d->m_ID=Value;
+			break;
+
+		case CElementName::eName_Type:
+			m_d->m_Type=Value;
+			break;
+
+		default:
 #ifdef _MB5_DEBUG_
-		std::cerr << "Unrecognised artist attribute: '" << Name << "'" << std::endl;
+			std::cerr << "Unrecognised artist attribute: '" << Name << "'" << std::endl;
 #endif
+			break;
 	}
 }
 
 void MusicBrainz5::CArtist::ParseElement(const XMLNode& Node)
 {
-	std::string NodeName=Node.getName();
-
-	if ("name"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Name);
-	}
-	else if ("sort-name"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_SortName);
-	}
-	else if ("gender"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Gender);
-	}
-	else if ("country"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Country);
-	}
-	else if ("disambiguation"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Disambiguation);
-	}
-	else if ("ipi"==NodeName)
-	{
-		//Ignore IPI
-	}
-	else if ("ipi-list"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_IPIList);
-	}
-	else if ("life-span"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Lifespan);
-	}
-	else if ("alias-list"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_AliasList);
-	}
-	else if ("recording-list"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_RecordingList);
-	}
-	else if ("release-list"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_ReleaseList);
-	}
-	else if ("release-group-list"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_ReleaseGroupList);
-	}
-	else if ("label-list"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_LabelList);
-	}
-	else if ("work-list"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_WorkList);
-	}
-	else if ("relation-list"==NodeName)
-	{
-		ProcessRelationList(Node,m_d->m_RelationListList);
-	}
-	else if ("tag-list"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_TagList);
-	}
-	else if ("user-tag-list"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_UserTagList);
-	}
-	else if ("rating"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Rating);
-	}
-	else if ("user-rating"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_UserRating);
-	}
-	else
+	switch (CElementName::Lookup(Node))
 	{
+		case CElementName::eName_Name:
+			ProcessItem(Node,m_d->m_Name);
+			break;
+
+		case CElementName::eName_SortName:
+			ProcessItem(Node,m_d->m_SortName);
+			break;
+
+		case CElementName::eName_Gender:
+			ProcessItem(Node,m_d->m_Gender);
+			break;
+
+		case CElementName::eName_Country:
+			ProcessItem(Node,m_d->m_Country);
+			break;
+
+		case CElementName::eName_Disambiguation:
+			ProcessItem(Node,m_d->m_Disambiguation);
+			break;
+
+		case CElementName::eName_IPI:
+			//Ignore IPI
+			break;
+
+		case CElementName::eName_IPIList:
+			ProcessLazyItem(Node,m_d->m_IPIList);
+			break;
+
+		case CElementName::eName_LifeSpan:
+			ProcessLazyItem(Node,m_d->m_Lifespan);
+			break;
+
+		case CElementName::eName_AliasList:
+			ProcessLazyItem(Node,m_d->m_AliasList);
+			break;
+
+		case CElementName::eName_RecordingList:
+			ProcessLazyItem(Node,m_d->m_RecordingList);
+			break;
+
+		case CElementName::eName_ReleaseList:
+			ProcessLazyItem(Node,m_d->m_ReleaseList);
+			break;
+
+		case CElementName::eName_ReleaseGroupList:
+			ProcessLazyItem(Node,m_d->m_ReleaseGroupList);
+			break;
+
+		case CElementName::eName_LabelList:
+			ProcessLazyItem(Node,m_d->m_LabelList);
+			break;
+
+		case CElementName::eName_WorkList:
+			ProcessLazyItem(Node,m_d->m_WorkList);
+			break;
+
+		case CElementName::eName_RelationList:
+			ProcessRelationList(Node,m_d->m_RelationListList);
+			break;
+
+		case CElementName::eName_TagList:
+			ProcessLazyItem(Node,m_d->m_TagList);
+			break;
+
+		case CElementName::eName_UserTagList:
+			ProcessLazyItem(Node,m_d->m_UserTagList);
+			break;
+
+		case CElementName::eName_Rating:
+			ProcessLazyItem(Node,m_d->m_Rating);
+			break;
+
+		case CElementName::eName_UserRating:
+			ProcessLazyItem(Node,m_d->m_UserRating);
+			break;
+
+		default:
 #ifdef _MB5_DEBUG_
-		std::cerr << "Unrecognised artist element: '" << NodeName << "'" << std::endl;
+			std::cerr << "Unrecognised artist element: '" << Node.getName() << "'" << std::endl;
 #endif
+			break;
 	}
 }
 
@@ -370,66 +377,92 @@ std::string MusicBrainz5::CArtist::Disambiguation() const
 
 MusicBrainz5::CIPIList *MusicBrainz5::CArtist::IPIList() const
 {
+	Materialise(CElementName::eName_IPIList);
+
 	return m_d->m_IPIList;
 }
 
 MusicBrainz5::CLifespan *MusicBrainz5::CArtist::Lifespan() const
 {
+	Materialise(CElementName::eName_LifeSpan);
+
 	return m_d->m_Lifespan;
 }
 
 MusicBrainz5::CAliasList *MusicBrainz5::CArtist::AliasList() const
 {
+	Materialise(CElementName::eName_AliasList);
+
 	return m_d->m_AliasList;
 }
 
 MusicBrainz5::CRecordingList *MusicBrainz5::CArtist::RecordingList() const
 {
+	Materialise(CElementName::eName_RecordingList);
+
 	return m_d->m_RecordingList;
 }
 
 MusicBrainz5::CReleaseList *MusicBrainz5::CArtist::ReleaseList() const
 {
+	Materialise(CElementName::eName_ReleaseList);
+
 	return m_d->m_ReleaseList;
 }
 
 MusicBrainz5::CReleaseGroupList *MusicBrainz5::CArtist::ReleaseGroupList() const
 {
+	Materialise(CElementName::eName_ReleaseGroupList);
+
 	return m_d->m_ReleaseGroupList;
 }
 
 MusicBrainz5::CLabelList *MusicBrainz5::CArtist::LabelList() const
 {
+	Materialise(CElementName::eName_LabelList);
+
 	return m_d->m_LabelList;
 }
 
 MusicBrainz5::CWorkList *MusicBrainz5::CArtist::WorkList() const
 {
+	Materialise(CElementName::eName_WorkList);
+
 	return m_d->m_WorkList;
 }
 
 MusicBrainz5::CRelationListList *MusicBrainz5::CArtist::RelationListList() const
 {
+	Materialise(CElementName::eName_RelationList);
+
 	return m_d->m_RelationListList;
 }
 
 MusicBrainz5::CTagList *MusicBrainz5::CArtist::TagList() const
 {
+	Materialise(CElementName::eName_TagList);
+
 	return m_d->m_TagList;
 }
 
 MusicBrainz5::CUserTagList *MusicBrainz5::CArtist::UserTagList() const
 {
+	Materialise(CElementName::eName_UserTagList);
+
 	return m_d->m_UserTagList;
 }
 
 MusicBrainz5::CRating *MusicBrainz5::CArtist::Rating() const
 {
+	Materialise(CElementName::eName_Rating);
+
 	return m_d->m_Rating;
 }
 
 MusicBrainz5::CUserRating *MusicBrainz5::CArtist::UserRating() const
 {
+	Materialise(CElementName::eName_UserRating);
+
 	return m_d->m_UserRating;
 }
 
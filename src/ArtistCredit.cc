@@ -27,6 +27,7 @@
 #include "musicbrainz5/defines.h"
 
 #include "musicbrainz5/ArtistCredit.h"
+#include "musicbrainz5/ElementName.h"
 
 #include "musicbrainz5/NameCreditList.h"
 #include "musicbrainz5/NameCredit.h"
@@ -50,9 +51,9 @@ MusicBrainz5::CArtistCredit::CArtistCredit(const XMLNode& Node)
 	{
 		//std::cout << "Artist credit node: " << std::endl << Node.createXMLString(true) << std::endl;
 
-		Parse(Node);
+		m_d->m_NameCreditList=new CNameCreditList;
 
-		m_d->m_NameCreditList=new CNameCreditList(Node);
+		Parse(Node);
 	}
 }
 
@@ -107,18 +108,24 @@ void MusicBrainz5::CArtistCredit::ParseAttribute(const std::string& Name, const
 
 void MusicBrainz5::CArtistCredit::ParseElement(const XMLNode& Node)
 {
-	std::string NodeName=Node.getName();
-
-	if ("name-credit"==NodeName)
-	{
-		//The artist credit element is a special case, in that all it contains is a list of name-credits
-		//Parsing of this list is handled in the constructor
-	}
-	else
+	switch (CElementName::Lookup(Node))
 	{
+		case CElementName::eName_NameCredit:
+		{
+			//The artist credit element is a special case, in that all it contains is a list of name-credits
+
+			CNameCredit *Item=0;
+
+			ProcessItem(Node,Item);
+			m_d->m_NameCreditList->AddItem(Item);
+			break;
+		}
+
+		default:
 #ifdef _MB5_DEBUG_
-		std::cerr << "Unrecognised artistcredit element: '" << NodeName << "'" << std::endl;
+			std::cerr << "Unrecognised artistcredit element: '" << Node.getName() << "'" << std::endl;
 #endif
+			break;
 	}
 }
 
@@ -89,10 +89,10 @@ void MusicBrainz5::CAttribute::ParseAttribute(const std::string& Name, const std
 
 void MusicBrainz5::CAttribute::ParseElement(const XMLNode& Node)
 {
-	std::string NodeName=Node.getName();
-
 #ifdef _MB5_DEBUG_
-	std::cerr << "Unrecognised attribute element: '" << NodeName << "'" << std::endl;
+	std::cerr << "Unrecognised attribute element: '" << Node.getName() << "'" << std::endl;
+#else
+	(void)Node;
 #endif
 }
 
@@ -27,6 +27,7 @@
 #include "musicbrainz5/defines.h"
 
 #include "musicbrainz5/CDStub.h"
+#include "musicbrainz5/ElementName.h"
 
 #include "musicbrainz5/NonMBTrackList.h"
 #include "musicbrainz5/NonMBTrack.h"
@@ -107,45 +108,49 @@ MusicBrainz5::CCDStub *MusicBrainz5::CCDStub::Clone()
 
 void MusicBrainz5::CCDStub::ParseAttribute(const std::string& Name, const std::string& Value)
 {
-	if ("id"==Name)
-		m_d->m_ID=Value;
-	else
+	switch (CElementName::Lookup(Name))
 	{
+		case CElementName::eName_ID:
+			m_d->m_ID=Value;
+			break;
+
+		default:
 #ifdef _MB5_DEBUG_
-		std::cerr << "Unrecognised cdstub attribute: '" << Name << "'" << std::endl;
+			std::cerr << "Unrecognised cdstub attribute: '" << Name << "'" << std::endl;
 #endif
+			break;
 	}
 }
 
 void MusicBrainz5::CCDStub::ParseElement(const XMLNode& Node)
 {
-	std::string NodeName=Node.getName();
-
-	if ("title"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Title);
-	}
-	else if ("artist"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Artist);
-	}
-	else if ("barcode"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Barcode);
-	}
-	else if ("comment"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Comment);
-	}
-	else if ("track-list"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_NonMBTrackList);
-	}
-	else
+	switch (CElementName::Lookup(Node))
 	{
+		case CElementName::eName_Title:
+			ProcessItem(Node,m_d->m_Title);
+			break;
+
+		case CElementName::eName_Artist:
+			ProcessItem(Node,m_d->m_Artist);
+			break;
+
+		case CElementName::eName_Barcode:
+			ProcessItem(Node,m_d->m_Barcode);
+			break;
+
+		case CElementName::eName_Comment:
+			ProcessItem(Node,m_d->m_Comment);
+			break;
+
+		case CElementName::eName_TrackList:
+			ProcessLazyItem(Node,m_d->m_NonMBTrackList);
+			break;
+
+		default:
 #ifdef _MB5_DEBUG_
-		std::cerr << "Unrecognised cd stub element: '" << NodeName << "'" << std::endl;
+			std::cerr << "Unrecognised cd stub element: '" << Node.getName() << "'" << std::endl;
 #endif
+			break;
 	}
 }
 
@@ -181,6 +186,8 @@ std::string MusicBrainz5::CCDStub::Comment() const
 
 MusicBrainz5::CNonMBTrackList *MusicBrainz5::CCDStub::NonMBTrackList() const
 {
+	Materialise(CElementName::eName_TrackList);
+
 	return m_d->m_NonMBTrackList;
 }
 
@@ -0,0 +1,65 @@
+/* --------------------------------------------------------------------------
+
+   libmusicbrainz5 - Client library to access MusicBrainz
+
+   Copyright (C) 2012 Andrew Hawkins
+
+   This file is part of libmusicbrainz5.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   libmusicbrainz5 is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+     $Id$
+
+----------------------------------------------------------------------------*/
+
+#include "config.h"
+#include "musicbrainz5/defines.h"
+
+#include "musicbrainz5/CallbackTransport.h"
+
+class MusicBrainz5::CCallbackTransportPrivate
+{
+	public:
+		CCallbackTransportPrivate()
+		:	m_Callback(0),
+			m_UserData(0)
+		{
+		}
+
+		CCallbackTransport::tCallback m_Callback;
+		void *m_UserData;
+};
+
+MusicBrainz5::CCallbackTransport::CCallbackTransport(tCallback Callback, void *UserData)
+:	m_d(new CCallbackTransportPrivate)
+{
+	m_d->m_Callback=Callback;
+	m_d->m_UserData=UserData;
+}
+
+MusicBrainz5::CCallbackTransport::~CCallbackTransport()
+{
+	delete m_d;
+}
+
+void MusicBrainz5::CCallbackTransport::Fetch(const CTransportRequest& Request, CTransportResponse& Response)
+{
+	if (m_d->m_Callback)
+		m_d->m_Callback(m_d->m_UserData,Request,Response);
+	else
+	{
+		Response.SetStatus(404);
+		Response.SetErrorMessage("No callback set");
+	}
+}
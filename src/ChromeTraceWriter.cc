@@ -0,0 +1,176 @@
+/* --------------------------------------------------------------------------
+
+   libmusicbrainz5 - Client library to access MusicBrainz
+
+   Copyright (C) 2012 Andrew Hawkins
+
+   This file is part of libmusicbrainz5.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   libmusicbrainz5 is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+     $Id$
+
+----------------------------------------------------------------------------*/
+
+#include "config.h"
+#include "musicbrainz5/defines.h"
+
+#include "musicbrainz5/ChromeTraceWriter.h"
+
+#include <vector>
+#include <cstdio>
+
+#include <pthread.h>
+#include <unistd.h>
+
+#include "musicbrainz5/HTTPFetch.h"
+#include "MonotonicTime.h"
+
+static std::string JSONEscape(const std::string& Str)
+{
+	std::string Ret;
+
+	for (std::string::size_type Pos=0;Pos<Str.length();Pos++)
+	{
+		unsigned char Char=Str[Pos];
+
+		if ('"'==Char || '\\'==Char)
+		{
+			Ret+='\\';
+			Ret+=Char;
+		}
+		else if (Char<0x20)
+		{
+			char Buffer[8];
+			snprintf(Buffer,sizeof(Buffer),"\\u%04x",Char);
+			Ret+=Buffer;
+		}
+		else
+			Ret+=Char;
+	}
+
+	return Ret;
+}
+
+class MusicBrainz5::CChromeTraceWriterPrivate
+{
+	public:
+		CChromeTraceWriterPrivate()
+		:	m_File(0),
+			m_Start(MonotonicTime()),
+			m_NumEvents(0)
+		{
+			pthread_mutex_init(&m_Lock,0);
+		}
+
+		~CChromeTraceWriterPrivate()
+		{
+			pthread_mutex_destroy(&m_Lock);
+		}
+
+		void Write(const std::string& Phase, unsigned long RequestID, CTraceHook::tSpan Span, const std::string& Detail);
+		int ThreadID();
+
+		FILE *m_File;
+		double m_Start;
+		int m_NumEvents;
+		std::vector<pthread_t> m_Threads;
+		mutable pthread_mutex_t m_Lock;
+};
+
+//Threads are numbered in the order they are first seen, which gives small stable track
+//IDs without relying on the representation of pthread_t. Called with the lock held.
+
+int MusicBrainz5::CChromeTraceWriterPrivate::ThreadID()
+{
+	pthread_t Self=pthread_self();
+
+	for (std::vector<pthread_t>::size_type count=0;count<m_Threads.size();count++)
+	{
+		if (pthread_equal(m_Threads[count],Self))
+			return count+1;
+	}
+
+	m_Threads.push_back(Self);
+
+	return m_Threads.size();
+}
+
+void MusicBrainz5::CChromeTraceWriterPrivate::Write(const std::string& Phase, unsigned long RequestID, CTraceHook::tSpan Span, const std::string& Detail)
+{
+	double Now=MonotonicTime();
+
+	pthread_mutex_lock(&m_Lock);
+
+	fprintf(m_File,"%s{\"name\":\"%s\",\"cat\":\"musicbrainz\",\"ph\":\"%s\",\"ts\":%.3f,\"pid\":%d,\"tid\":%d,\"args\":{\"id\":%lu",
+						m_NumEvents ? ",\n" : "",
+						CTraceHook::SpanName(Span).c_str(),
+						Phase.c_str(),
+						(Now-m_Start)*1e6,
+						(int)getpid(),
+						ThreadID(),
+						RequestID);
+
+	if (!Detail.empty())
+		fprintf(m_File,",\"url\":\"%s\"",JSONEscape(Detail).c_str());
+
+	fputs("}}",m_File);
+	fflush(m_File);
+
+	m_NumEvents++;
+
+	pthread_mutex_unlock(&m_Lock);
+}
+
+MusicBrainz5::CChromeTraceWriter::CChromeTraceWriter(const std::string& FileName)
+:	m_d(new CChromeTraceWriterPrivate)
+{
+	m_d->m_File=fopen(FileName.c_str(),"w");
+	if (!m_d->m_File)
+	{
+		delete m_d;
+		throw CFetchError("Unable to create "+FileName);
+	}
+
+	//The closing bracket is optional in the format, so an unfinished file still loads
+
+	fputs("[\n",m_d->m_File);
+}
+
+MusicBrainz5::CChromeTraceWriter::~CChromeTraceWriter()
+{
+	fputs("\n]\n",m_d->m_File);
+	fclose(m_d->m_File);
+
+	delete m_d;
+}
+
+void MusicBrainz5::CChromeTraceWriter::Begin(unsigned long RequestID, tSpan Span, const std::string& Detail)
+{
+	m_d->Write("B",RequestID,Span,Detail);
+}
+
+void MusicBrainz5::CChromeTraceWriter::End(unsigned long RequestID, tSpan Span)
+{
+	m_d->Write("E",RequestID,Span,"");
+}
+
+int MusicBrainz5::CChromeTraceWriter::NumEvents() const
+{
+	pthread_mutex_lock(&m_d->m_Lock);
+	int Ret=m_d->m_NumEvents;
+	pthread_mutex_unlock(&m_d->m_Lock);
+
+	return Ret;
+}
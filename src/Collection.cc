@@ -27,6 +27,7 @@
 #include "musicbrainz5/defines.h"
 
 #include "musicbrainz5/Collection.h"
+#include "musicbrainz5/ElementName.h"
 
 #include "musicbrainz5/ReleaseList.h"
 #include "musicbrainz5/Release.h"
@@ -102,37 +103,41 @@ MusicBrainz5::CCollection *MusicBrainz5::CCollection::Clone()
 
 void MusicBrainz5::CCollection::ParseAttribute(const std::string& Name, const std::string& Value)
 {
-	if ("id"==Name)
-		m_d->m_ID=Value;
-	else
+	switch (CElementName::Lookup(Name))
 	{
+		case CElementName::eName_ID:
+			m_d->m_ID=Value;
+			break;
+
+		default:
 #ifdef _MB5_DEBUG_
-		std::cerr << "Unrecognised collection attribute: '" << Name << "'" << std::endl;
+			std::cerr << "Unrecognised collection attribute: '" << Name << "'" << std::endl;
 #endif
+			break;
 	}
 }
 
 void MusicBrainz5::CCollection::ParseElement(const XMLNode& Node)
 {
-	std::string NodeName=Node.getName();
-
-	if ("name"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Name);
-	}
-	else if ("editor"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Editor);
-	}
-	else if ("release-list"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_ReleaseList);
-	}
-	else
+	switch (CElementName::Lookup(Node))
 	{
+		case CElementName::eName_Name:
+			ProcessItem(Node,m_d->m_Name);
+			break;
+
+		case CElementName::eName_Editor:
+			ProcessItem(Node,m_d->m_Editor);
+			break;
+
+		case CElementName::eName_ReleaseList:
+			ProcessLazyItem(Node,m_d->m_ReleaseList);
+			break;
+
+		default:
 #ifdef _MB5_DEBUG_
-		std::cerr << "Unrecognised collection element: '" << NodeName << "'" << std::endl;
+			std::cerr << "Unrecognised collection element: '" << Node.getName() << "'" << std::endl;
 #endif
+			break;
 	}
 }
 
@@ -158,6 +163,8 @@ std::string MusicBrainz5::CCollection::Editor() const
 
 MusicBrainz5::CReleaseList *MusicBrainz5::CCollection::ReleaseList() const
 {
+	Materialise(CElementName::eName_ReleaseList);
+
 	return m_d->m_ReleaseList;
 }
 
@@ -0,0 +1,707 @@
+/* --------------------------------------------------------------------------
+
+   libmusicbrainz5 - Client library to access MusicBrainz
+
+   Copyright (C) 2012 Andrew Hawkins
+
+   This file is part of libmusicbrainz5.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   libmusicbrainz5 is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+     $Id$
+
+----------------------------------------------------------------------------*/
+
+#include "config.h"
+#include "musicbrainz5/defines.h"
+
+#include "musicbrainz5/CurlTransport.h"
+
+#include <cmath>
+#include <deque>
+#include <set>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+#include <pthread.h>
+
+#include <curl/curl.h>
+
+//curl_multi_poll and curl_multi_wakeup were added in 7.68.0
+
+#if LIBCURL_VERSION_NUM<0x074400
+	#error libcurl 7.68.0 or later is required
+#endif
+
+#if defined(__GNUC__)
+__attribute__((constructor))
+#else
+	#error Non GCC compiler detected
+#endif
+static void initialize_curl()
+{
+	curl_global_init(CURL_GLOBAL_ALL);
+}
+
+#if defined(__GNUC__)
+__attribute__((destructor))
+#else
+	#error Non GCC compiler detected
+#endif
+static void destroy_curl()
+{
+	curl_global_cleanup();
+}
+
+//A single request, owned by the thread waiting for it and handed to the event loop
+//until it completes. The event loop only collects the body and headers as they
+//arrive. They are passed on to the response by the waiting thread, so that parsing
+//one response never holds up the transfer of the others.
+//
+//The body, headers and flags are protected by the transport's lock
+
+class CCurlRequest
+{
+	public:
+		CCurlRequest(MusicBrainz5::CTransportResponse& Response, pthread_mutex_t *Lock)
+		:	m_Response(Response),
+			m_Lock(Lock),
+			m_Handle(curl_easy_init()),
+			m_Headers(0),
+			m_Done(false),
+			m_Cancelled(false),
+			m_Result(CURLE_OK)
+		{
+			m_Error[0]='\0';
+			pthread_cond_init(&m_Ready,0);
+		}
+
+		~CCurlRequest()
+		{
+			if (m_Handle)
+				curl_easy_cleanup(m_Handle);
+
+			if (m_Headers)
+				curl_slist_free_all(m_Headers);
+
+			pthread_cond_destroy(&m_Ready);
+		}
+
+		MusicBrainz5::CTransportResponse& m_Response;
+		pthread_mutex_t *m_Lock;
+		CURL *m_Handle;
+		curl_slist *m_Headers;
+		bool m_Done;
+		bool m_Cancelled;
+		CURLcode m_Result;
+		char m_Error[CURL_ERROR_SIZE];
+		std::string m_Body;
+		std::vector<std::pair<std::string,std::string> > m_ResponseHeaders;
+		pthread_cond_t m_Ready;
+};
+
+class MusicBrainz5::CCurlTransportPrivate
+{
+	public:
+		CCurlTransportPrivate()
+		:	m_Port(80),
+			m_UseSSL(false),
+			m_ProxyPort(0),
+			m_Compression(true),
+			m_MaxConnections(2),
+			m_ConnectTimeout(30),
+			m_ReadTimeout(60),
+			m_PriorKnowledge(false),
+			m_Multi(curl_multi_init()),
+			m_Started(false),
+			m_Stopping(false),
+			m_Reconfigure(true),
+			m_Callers(0)
+		{
+			pthread_mutex_init(&m_Lock,0);
+			pthread_cond_init(&m_Completed,0);
+		}
+
+		~CCurlTransportPrivate()
+		{
+			if (m_Multi)
+				curl_multi_cleanup(m_Multi);
+
+			pthread_cond_destroy(&m_Completed);
+			pthread_mutex_destroy(&m_Lock);
+		}
+
+		void Configure();
+		void Complete(CURLMsg *Msg);
+		void Finish(CCurlRequest *Request, CURLcode Result);
+		void Abort();
+		void Receive(CCurlRequest& Request);
+
+		std::string m_UserAgent;
+		std::string m_Host;
+		int m_Port;
+		bool m_UseSSL;
+		std::string m_UserName;
+		std::string m_Password;
+		std::string m_ProxyHost;
+		int m_ProxyPort;
+		std::string m_ProxyUserName;
+		std::string m_ProxyPassword;
+		bool m_Compression;
+		int m_MaxConnections;
+		int m_ConnectTimeout;
+		int m_ReadTimeout;
+		bool m_PriorKnowledge;
+		CURLM *m_Multi;
+		pthread_t m_Thread;
+		bool m_Started;
+		bool m_Stopping;
+		bool m_Reconfigure;
+		std::deque<CCurlRequest *> m_Pending;
+		std::set<CCurlRequest *> m_Active;
+		int m_Callers;
+		pthread_mutex_t m_Lock;
+		pthread_cond_t m_Completed;
+};
+
+//The multi handle may only be used from the event loop thread, so changes to its
+//options are picked up from there. Called with the lock held.
+
+void MusicBrainz5::CCurlTransportPrivate::Configure()
+{
+	curl_multi_setopt(m_Multi, CURLMOPT_PIPELINING, (long)CURLPIPE_MULTIPLEX);
+	curl_multi_setopt(m_Multi, CURLMOPT_MAX_HOST_CONNECTIONS, (long)m_MaxConnections);
+
+	m_Reconfigure=false;
+}
+
+void MusicBrainz5::CCurlTransportPrivate::Complete(CURLMsg *Msg)
+{
+	CURL *Handle=Msg->easy_handle;
+	CURLcode Result=Msg->data.result;
+
+	char *Private=0;
+	curl_easy_getinfo(Handle, CURLINFO_PRIVATE, &Private);
+	CCurlRequest *Request=reinterpret_cast<CCurlRequest *>(Private);
+
+	curl_multi_remove_handle(m_Multi, Handle);
+
+	pthread_mutex_lock(&m_Lock);
+	Finish(Request,Result);
+	pthread_mutex_unlock(&m_Lock);
+}
+
+//Wake the thread waiting for a request once the event loop has finished with it.
+//Called with the lock held.
+
+void MusicBrainz5::CCurlTransportPrivate::Finish(CCurlRequest *Request, CURLcode Result)
+{
+	m_Active.erase(Request);
+
+	Request->m_Result=Result;
+	Request->m_Done=true;
+
+	pthread_cond_signal(&Request->m_Ready);
+}
+
+//Fail every request that has not completed, so that nothing is left waiting for an
+//event loop that is about to exit. Called from the event loop thread once it has
+//stopped, without the lock held, as removing a handle may call back into the
+//transport.
+
+void MusicBrainz5::CCurlTransportPrivate::Abort()
+{
+	std::set<CCurlRequest *>::const_iterator ThisRequest=m_Active.begin();
+	while (ThisRequest!=m_Active.end())
+	{
+		curl_multi_remove_handle(m_Multi, (*ThisRequest)->m_Handle);
+		++ThisRequest;
+	}
+
+	pthread_mutex_lock(&m_Lock);
+
+	while (!m_Pending.empty())
+	{
+		Finish(m_Pending.front(),CURLE_ABORTED_BY_CALLBACK);
+		m_Pending.pop_front();
+	}
+
+	while (!m_Active.empty())
+		Finish(*m_Active.begin(),CURLE_ABORTED_BY_CALLBACK);
+
+	pthread_mutex_unlock(&m_Lock);
+}
+
+//Pass the headers and body to the response as they arrive, until the request
+//completes. Once this returns the request no longer belongs to the transport. If
+//the response throws, the transfer is cancelled and the exception passed on once
+//the event loop has let go of the request.
+
+void MusicBrainz5::CCurlTransportPrivate::Receive(CCurlRequest& Request)
+{
+	bool Done=false;
+	bool Reading=true;
+
+	try
+	{
+		while (!Done)
+		{
+			std::string Body;
+			std::vector<std::pair<std::string,std::string> > Headers;
+
+			pthread_mutex_lock(&m_Lock);
+
+			while (!Request.m_Done && Request.m_Body.empty() && Request.m_ResponseHeaders.empty())
+				pthread_cond_wait(&Request.m_Ready,&m_Lock);
+
+			Body.swap(Request.m_Body);
+			Headers.swap(Request.m_ResponseHeaders);
+			Done=Request.m_Done;
+
+			pthread_mutex_unlock(&m_Lock);
+
+			for (std::vector<std::pair<std::string,std::string> >::size_type count=0;count<Headers.size();count++)
+				Request.m_Response.SetHeader(Headers[count].first,Headers[count].second);
+
+			if (Reading && !Body.empty() && !Request.m_Response.Read(Body.data(),Body.length()))
+			{
+				Reading=false;
+
+				pthread_mutex_lock(&m_Lock);
+				Request.m_Cancelled=true;
+				pthread_mutex_unlock(&m_Lock);
+			}
+		}
+	}
+
+	catch (...)
+	{
+		pthread_mutex_lock(&m_Lock);
+
+		Request.m_Cancelled=true;
+
+		while (!Request.m_Done)
+			pthread_cond_wait(&Request.m_Ready,&m_Lock);
+
+		if (0==--m_Callers)
+			pthread_cond_broadcast(&m_Completed);
+
+		pthread_mutex_unlock(&m_Lock);
+
+		throw;
+	}
+
+	//A response that refused the body fails, even if the rest of it had already arrived
+
+	if (!Reading && CURLE_OK==Request.m_Result)
+		Request.m_Result=CURLE_WRITE_ERROR;
+
+	pthread_mutex_lock(&m_Lock);
+
+	if (0==--m_Callers)
+		pthread_cond_broadcast(&m_Completed);
+
+	pthread_mutex_unlock(&m_Lock);
+}
+
+//Stops a transfer that the waiting thread has given up on, even if nothing more is
+//being received for it
+
+static int curlProgress(void *clientp, curl_off_t dltotal, curl_off_t dlnow, curl_off_t ultotal, curl_off_t ulnow)
+{
+	CCurlRequest *Request=reinterpret_cast<CCurlRequest *>(clientp);
+
+	(void)dltotal;
+	(void)dlnow;
+	(void)ultotal;
+	(void)ulnow;
+
+	pthread_mutex_lock(Request->m_Lock);
+	bool Cancelled=Request->m_Cancelled;
+	pthread_mutex_unlock(Request->m_Lock);
+
+	return Cancelled ? 1 : 0;
+}
+
+MusicBrainz5::CCurlTransport::CCurlTransport(const std::string& UserAgent, const std::string& Host, int Port, bool UseSSL)
+:	m_d(new CCurlTransportPrivate)
+{
+	m_d->m_UserAgent=UserAgent;
+
+	for (std::string::size_type Pos=0;Pos<m_d->m_UserAgent.length();Pos++)
+		if (m_d->m_UserAgent[Pos]=='-')
+			m_d->m_UserAgent[Pos]='/';
+
+	m_d->m_Host=Host;
+	m_d->m_Port=Port;
+	m_d->m_UseSSL=UseSSL;
+}
+
+//Any requests still in progress fail, and the destructor waits for the threads that
+//made them to finish with the transport
+
+MusicBrainz5::CCurlTransport::~CCurlTransport()
+{
+	pthread_mutex_lock(&m_d->m_Lock);
+
+	bool Started=m_d->m_Started;
+	m_d->m_Stopping=true;
+
+	pthread_mutex_unlock(&m_d->m_Lock);
+
+	if (Started)
+	{
+		curl_multi_wakeup(m_d->m_Multi);
+		pthread_join(m_d->m_Thread,0);
+	}
+
+	pthread_mutex_lock(&m_d->m_Lock);
+
+	while (0!=m_d->m_Callers)
+		pthread_cond_wait(&m_d->m_Completed,&m_d->m_Lock);
+
+	pthread_mutex_unlock(&m_d->m_Lock);
+
+	delete m_d;
+}
+
+void MusicBrainz5::CCurlTransport::SetUserName(const std::string& UserName)
+{
+	m_d->m_UserName=UserName;
+}
+
+void MusicBrainz5::CCurlTransport::SetPassword(const std::string& Password)
+{
+	m_d->m_Password=Password;
+}
+
+void MusicBrainz5::CCurlTransport::SetProxyHost(const std::string& ProxyHost)
+{
+	m_d->m_ProxyHost=ProxyHost;
+}
+
+void MusicBrainz5::CCurlTransport::SetProxyPort(int ProxyPort)
+{
+	m_d->m_ProxyPort=ProxyPort;
+}
+
+void MusicBrainz5::CCurlTransport::SetProxyUserName(const std::string& ProxyUserName)
+{
+	m_d->m_ProxyUserName=ProxyUserName;
+}
+
+void MusicBrainz5::CCurlTransport::SetProxyPassword(const std::string& ProxyPassword)
+{
+	m_d->m_ProxyPassword=ProxyPassword;
+}
+
+void MusicBrainz5::CCurlTransport::SetCompression(bool Compression)
+{
+	m_d->m_Compression=Compression;
+}
+
+void MusicBrainz5::CCurlTransport::SetMaxConnections(int MaxConnections)
+{
+	pthread_mutex_lock(&m_d->m_Lock);
+
+	m_d->m_MaxConnections=MaxConnections>0 ? MaxConnections : 1;
+	m_d->m_Reconfigure=true;
+
+	pthread_mutex_unlock(&m_d->m_Lock);
+
+	if (m_d->m_Multi)
+		curl_multi_wakeup(m_d->m_Multi);
+}
+
+void MusicBrainz5::CCurlTransport::SetConnectTimeout(int Seconds)
+{
+	m_d->m_ConnectTimeout=Seconds>0 ? Seconds : 0;
+}
+
+void MusicBrainz5::CCurlTransport::SetReadTimeout(int Seconds)
+{
+	m_d->m_ReadTimeout=Seconds>0 ? Seconds : 0;
+}
+
+void MusicBrainz5::CCurlTransport::SetHTTP2PriorKnowledge(bool PriorKnowledge)
+{
+	m_d->m_PriorKnowledge=PriorKnowledge;
+}
+
+void MusicBrainz5::CCurlTransport::Fetch(const CTransportRequest& Request, CTransportResponse& Response)
+{
+	CCurlRequest Curl(Response,&m_d->m_Lock);
+	CURL *Handle=Curl.m_Handle;
+
+	if (!Handle || !m_d->m_Multi)
+		throw CFetchError("Unable to initialise libcurl");
+
+	std::stringstream URL;
+	URL << (m_d->m_UseSSL ? "https" : "http") << "://" << m_d->m_Host << ":" << m_d->m_Port << Request.URL();
+
+	curl_easy_setopt(Handle, CURLOPT_URL, URL.str().c_str());
+	curl_easy_setopt(Handle, CURLOPT_USERAGENT, m_d->m_UserAgent.c_str());
+	curl_easy_setopt(Handle, CURLOPT_PRIVATE, &Curl);
+	curl_easy_setopt(Handle, CURLOPT_WRITEFUNCTION, curlWriter);
+	curl_easy_setopt(Handle, CURLOPT_WRITEDATA, &Curl);
+	curl_easy_setopt(Handle, CURLOPT_HEADERFUNCTION, curlHeader);
+	curl_easy_setopt(Handle, CURLOPT_HEADERDATA, &Curl);
+	curl_easy_setopt(Handle, CURLOPT_XFERINFOFUNCTION, curlProgress);
+	curl_easy_setopt(Handle, CURLOPT_XFERINFODATA, &Curl);
+	curl_easy_setopt(Handle, CURLOPT_NOPROGRESS, 0L);
+	curl_easy_setopt(Handle, CURLOPT_ERRORBUFFER, Curl.m_Error);
+	curl_easy_setopt(Handle, CURLOPT_NOSIGNAL, 1L);
+
+	//Wait for a connection that can take another stream, rather than opening a new
+	//one, so that requests are multiplexed wherever possible
+
+	curl_easy_setopt(Handle, CURLOPT_PIPEWAIT, 1L);
+	curl_easy_setopt(Handle, CURLOPT_HTTP_VERSION, m_d->m_PriorKnowledge ? (long)CURL_HTTP_VERSION_2_PRIOR_KNOWLEDGE : (long)CURL_HTTP_VERSION_2TLS);
+
+	//A request that receives nothing for the read timeout counts as stalled. The time
+	//allowed for the request as a whole, if any, is enforced by curl itself.
+
+	curl_easy_setopt(Handle, CURLOPT_CONNECTTIMEOUT, (long)m_d->m_ConnectTimeout);
+
+	if (m_d->m_ReadTimeout>0)
+	{
+		curl_easy_setopt(Handle, CURLOPT_LOW_SPEED_LIMIT, 1L);
+		curl_easy_setopt(Handle, CURLOPT_LOW_SPEED_TIME, (long)m_d->m_ReadTimeout);
+	}
+
+	if (Request.Timeout()>0)
+		curl_easy_setopt(Handle, CURLOPT_TIMEOUT_MS, (long)ceil(Request.Timeout()*1000));
+
+	if (m_d->m_Compression)
+		curl_easy_setopt(Handle, CURLOPT_ACCEPT_ENCODING, "");
+
+	if (!m_d->m_UserName.empty())
+	{
+		curl_easy_setopt(Handle, CURLOPT_HTTPAUTH, (long)CURLAUTH_ANY);
+		curl_easy_setopt(Handle, CURLOPT_USERNAME, m_d->m_UserName.c_str());
+		curl_easy_setopt(Handle, CURLOPT_PASSWORD, m_d->m_Password.c_str());
+	}
+
+	if (!m_d->m_ProxyHost.empty())
+	{
+		curl_easy_setopt(Handle, CURLOPT_PROXY, m_d->m_ProxyHost.c_str());
+
+		if (0!=m_d->m_ProxyPort)
+			curl_easy_setopt(Handle, CURLOPT_PROXYPORT, (long)m_d->m_ProxyPort);
+
+		if (!m_d->m_ProxyUserName.empty())
+		{
+			curl_easy_setopt(Handle, CURLOPT_PROXYAUTH, (long)CURLAUTH_ANY);
+			curl_easy_setopt(Handle, CURLOPT_PROXYUSERNAME, m_d->m_ProxyUserName.c_str());
+			curl_easy_setopt(Handle, CURLOPT_PROXYPASSWORD, m_d->m_ProxyPassword.c_str());
+		}
+	}
+
+	if (Request.Method()=="PUT")
+	{
+		curl_easy_setopt(Handle, CURLOPT_POSTFIELDS, "");
+		curl_easy_setopt(Handle, CURLOPT_POSTFIELDSIZE, 0L);
+	}
+
+	if (Request.Method()!="GET")
+		curl_easy_setopt(Handle, CURLOPT_CUSTOMREQUEST, Request.Method().c_str());
+
+	std::map<std::string,std::string>::const_iterator ThisHeader=Request.Headers().begin();
+	while (ThisHeader!=Request.Headers().end())
+	{
+		Curl.m_Headers=curl_slist_append(Curl.m_Headers,((*ThisHeader).first+": "+(*ThisHeader).second).c_str());
+		++ThisHeader;
+	}
+
+	if (Curl.m_Headers)
+		curl_easy_setopt(Handle, CURLOPT_HTTPHEADER, Curl.m_Headers);
+
+	pthread_mutex_lock(&m_d->m_Lock);
+
+	if (m_d->m_Stopping)
+	{
+		pthread_mutex_unlock(&m_d->m_Lock);
+		throw CFetchError("libcurl transport is being destroyed");
+	}
+
+	if (!m_d->m_Started)
+	{
+		if (0!=pthread_create(&m_d->m_Thread,0,EventLoop,m_d))
+		{
+			pthread_mutex_unlock(&m_d->m_Lock);
+			throw CFetchError("Unable to start libcurl event loop");
+		}
+
+		m_d->m_Started=true;
+	}
+
+	m_d->m_Pending.push_back(&Curl);
+	m_d->m_Callers++;
+
+	pthread_mutex_unlock(&m_d->m_Lock);
+
+	curl_multi_wakeup(m_d->m_Multi);
+
+	m_d->Receive(Curl);
+
+	long Status=0;
+	curl_easy_getinfo(Handle, CURLINFO_RESPONSE_CODE, &Status);
+
+	Response.SetStatus(Status);
+
+	//The connection time includes the name lookup, and is close to 0 when a connection
+	//is reused. The download size is counted before any decompression.
+
+	curl_off_t ConnectTime=0;
+	curl_easy_getinfo(Handle, CURLINFO_CONNECT_TIME_T, &ConnectTime);
+	Response.SetConnectTime(ConnectTime/1e6);
+
+	curl_off_t WireBytes=0;
+	curl_easy_getinfo(Handle, CURLINFO_SIZE_DOWNLOAD_T, &WireBytes);
+	Response.SetWireBytes((size_t)WireBytes);
+
+	if (CURLE_OK!=Curl.m_Result)
+		Response.SetErrorMessage(Curl.m_Error[0] ? Curl.m_Error : curl_easy_strerror(Curl.m_Result));
+	else if (2!=Status/100 && 304!=Status)
+	{
+		std::stringstream Message;
+		Message << "HTTP status " << Status;
+		Response.SetErrorMessage(Message.str());
+	}
+
+	switch (Curl.m_Result)
+	{
+		case CURLE_OK:
+			break;
+
+		case CURLE_COULDNT_RESOLVE_PROXY:
+		case CURLE_COULDNT_RESOLVE_HOST:
+		case CURLE_COULDNT_CONNECT:
+			throw CConnectionError(Response.ErrorMessage());
+			break;
+
+		case CURLE_OPERATION_TIMEDOUT:
+			throw CTimeoutError(Response.ErrorMessage());
+			break;
+
+		case CURLE_LOGIN_DENIED:
+			throw CAuthenticationError(Response.ErrorMessage());
+			break;
+
+		default:
+			throw CFetchError(Response.ErrorMessage());
+			break;
+	}
+}
+
+void *MusicBrainz5::CCurlTransport::EventLoop(void *userdata)
+{
+	MusicBrainz5::CCurlTransportPrivate *Transport=reinterpret_cast<MusicBrainz5::CCurlTransportPrivate *>(userdata);
+
+	pthread_mutex_lock(&Transport->m_Lock);
+
+	while (!Transport->m_Stopping)
+	{
+		if (Transport->m_Reconfigure)
+			Transport->Configure();
+
+		while (!Transport->m_Pending.empty())
+		{
+			CCurlRequest *Request=Transport->m_Pending.front();
+
+			curl_multi_add_handle(Transport->m_Multi, Request->m_Handle);
+			Transport->m_Active.insert(Request);
+			Transport->m_Pending.pop_front();
+		}
+
+		pthread_mutex_unlock(&Transport->m_Lock);
+
+		int Running=0;
+		curl_multi_perform(Transport->m_Multi, &Running);
+
+		CURLMsg *Msg;
+		int Remaining=0;
+		while (0!=(Msg=curl_multi_info_read(Transport->m_Multi, &Remaining)))
+		{
+			if (CURLMSG_DONE==Msg->msg)
+				Transport->Complete(Msg);
+		}
+
+		curl_multi_poll(Transport->m_Multi, 0, 0, 1000, 0);
+
+		pthread_mutex_lock(&Transport->m_Lock);
+	}
+
+	pthread_mutex_unlock(&Transport->m_Lock);
+
+	Transport->Abort();
+
+	return 0;
+}
+
+//Only successful response bodies are passed on, in the same way as the neon transport.
+//Bodies of intermediate responses, such as an authentication challenge, are discarded.
+//The body is only collected here, for the waiting thread to pass on.
+
+size_t MusicBrainz5::CCurlTransport::curlWriter(char *ptr, size_t size, size_t nmemb, void *userdata)
+{
+	CCurlRequest *Request=reinterpret_cast<CCurlRequest *>(userdata);
+	size_t Length=size*nmemb;
+
+	long Status=0;
+	curl_easy_getinfo(Request->m_Handle, CURLINFO_RESPONSE_CODE, &Status);
+
+	pthread_mutex_lock(Request->m_Lock);
+
+	bool Cancelled=Request->m_Cancelled;
+
+	if (!Cancelled && 2==Status/100)
+	{
+		Request->m_Body.append(ptr,Length);
+		pthread_cond_signal(&Request->m_Ready);
+	}
+
+	pthread_mutex_unlock(Request->m_Lock);
+
+	return Cancelled ? 0 : Length;
+}
+
+size_t MusicBrainz5::CCurlTransport::curlHeader(char *ptr, size_t size, size_t nitems, void *userdata)
+{
+	CCurlRequest *Request=reinterpret_cast<CCurlRequest *>(userdata);
+	size_t Length=size*nitems;
+
+	std::string Line(ptr,Length);
+
+	std::string::size_type Colon=Line.find(':');
+	if (std::string::npos!=Colon)
+	{
+		std::string::size_type ValueStart=Line.find_first_not_of(" \t",Colon+1);
+		std::string::size_type ValueEnd=Line.find_last_not_of(" \t\r\n");
+
+		std::string Value;
+		if (std::string::npos!=ValueStart && ValueEnd>=ValueStart)
+			Value=Line.substr(ValueStart,ValueEnd-ValueStart+1);
+
+		pthread_mutex_lock(Request->m_Lock);
+
+		Request->m_ResponseHeaders.push_back(std::make_pair(Line.substr(0,Colon),Value));
+		pthread_cond_signal(&Request->m_Ready);
+
+		pthread_mutex_unlock(Request->m_Lock);
+	}
+
+	return Length;
+}
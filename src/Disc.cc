@@ -27,6 +27,7 @@
 #include "musicbrainz5/defines.h"
 
 #include "musicbrainz5/Disc.h"
+#include "musicbrainz5/ElementName.h"
 
 #include "musicbrainz5/OffsetList.h"
 #include "musicbrainz5/Offset.h"
@@ -110,37 +111,41 @@ MusicBrainz5::CDisc *MusicBrainz5::CDisc::Clone()
 
 void MusicBrainz5::CDisc::ParseAttribute(const std::string& Name, const std::string& Value)
 {
-	if ("id"==Name)
-		ProcessItem(Value,m_d->m_ID);
-	else
+	switch (CElementName::Lookup(Name))
 	{
+		case CElementName::eName_ID:
+			ProcessItem(Value,m_d->m_ID);
+			break;
+
+		default:
 #ifdef _MB5_DEBUG_
-		std::cerr << "Unrecognised disc attribute: '" << Name << "'" << std::endl;
+			std::cerr << "Unrecognised disc attribute: '" << Name << "'" << std::endl;
 #endif
+			break;
 	}
 }
 
 void MusicBrainz5::CDisc::ParseElement(const XMLNode& Node)
 {
-	std::string NodeName=Node.getName();
-
-	if ("sectors"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Sectors);
-	}
-	else if ("offset-list"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_OffsetList);
-	}
-	else if ("release-list"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_ReleaseList);
-	}
-	else
+	switch (CElementName::Lookup(Node))
 	{
+		case CElementName::eName_Sectors:
+			ProcessItem(Node,m_d->m_Sectors);
+			break;
+
+		case CElementName::eName_OffsetList:
+			ProcessLazyItem(Node,m_d->m_OffsetList);
+			break;
+
+		case CElementName::eName_ReleaseList:
+			ProcessLazyItem(Node,m_d->m_ReleaseList);
+			break;
+
+		default:
 #ifdef _MB5_DEBUG_
-		std::cerr << "Unrecognised disc element: '" << NodeName << "'" << std::endl;
+			std::cerr << "Unrecognised disc element: '" << Node.getName() << "'" << std::endl;
 #endif
+			break;
 	}
 }
 
@@ -161,11 +166,15 @@ int MusicBrainz5::CDisc::Sectors() const
 
 MusicBrainz5::COffsetList *MusicBrainz5::CDisc::OffsetList() const
 {
+	Materialise(CElementName::eName_OffsetList);
+
 	return m_d->m_OffsetList;
 }
 
 MusicBrainz5::CReleaseList *MusicBrainz5::CDisc::ReleaseList() const
 {
+	Materialise(CElementName::eName_ReleaseList);
+
 	return m_d->m_ReleaseList;
 }
 
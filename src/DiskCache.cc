@@ -0,0 +1,667 @@
+/* --------------------------------------------------------------------------
+
+   libmusicbrainz5 - Client library to access MusicBrainz
+
+   Copyright (C) 2012 Andrew Hawkins
+
+   This file is part of libmusicbrainz5.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   libmusicbrainz5 is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+     $Id$
+
+----------------------------------------------------------------------------*/
+
+#include "config.h"
+#include "musicbrainz5/defines.h"
+
+#include "musicbrainz5/DiskCache.h"
+
+#include <map>
+#include <vector>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <utime.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include "musicbrainz5/MetadataCache.h"
+#include "musicbrainz5/QueryExecutor.h"
+
+//Each entry starts with a short text header, terminated by an empty line, followed
+//by the response body exactly as received
+
+static const char CacheMagic[]="MB5CACHE 1\n";
+static const char CollectStamp[]=".collect";
+static const char TempPrefix[]=".tmp";
+
+//Temporary files left behind by a process that died while writing are removed once
+//they are this old
+
+static const int TempMaxAge=3600;
+
+class CDiskCacheFile
+{
+	public:
+		CDiskCacheFile(const std::string& Path, time_t Modified, off_t Size)
+		:	m_Path(Path),
+			m_Modified(Modified),
+			m_Size(Size)
+		{
+		}
+
+		bool operator <(const CDiskCacheFile& Other) const
+		{
+			//Newest first
+
+			return m_Modified>Other.m_Modified;
+		}
+
+		std::string m_Path;
+		time_t m_Modified;
+		off_t m_Size;
+};
+
+//Split the header from the body of a cache file. Returns false if the file is not a
+//valid cache entry.
+
+static bool ParseEntry(const char *Data, size_t Length, std::map<std::string,std::string>& Header, size_t& BodyOffset)
+{
+	size_t MagicLength=strlen(CacheMagic);
+	if (Length<MagicLength || 0!=memcmp(Data,CacheMagic,MagicLength))
+		return false;
+
+	size_t Pos=MagicLength;
+	while (Pos<Length)
+	{
+		const char *EndOfLine=static_cast<const char *>(memchr(Data+Pos,'\n',Length-Pos));
+		if (!EndOfLine)
+			return false;
+
+		size_t LineLength=EndOfLine-(Data+Pos);
+		if (0==LineLength)
+		{
+			BodyOffset=Pos+1;
+			return true;
+		}
+
+		std::string Line(Data+Pos,LineLength);
+		std::string::size_type Colon=Line.find(": ");
+		if (std::string::npos!=Colon)
+			Header[Line.substr(0,Colon)]=Line.substr(Colon+2);
+
+		Pos+=LineLength+1;
+	}
+
+	return false;
+}
+
+//A cache file mapped into memory, with its header parsed
+
+class CDiskCacheEntry
+{
+	public:
+		CDiskCacheEntry(const std::string& Path)
+		:	m_Map(MAP_FAILED),
+			m_Size(0),
+			m_Modified(0),
+			m_Valid(false),
+			m_Body(0),
+			m_BodyLength(0)
+		{
+			int FD=open(Path.c_str(),O_RDONLY);
+			if (FD>=0)
+			{
+				struct stat Info;
+				if (0==fstat(FD,&Info) && Info.st_size>0)
+				{
+					m_Map=mmap(0,Info.st_size,PROT_READ,MAP_PRIVATE,FD,0);
+					if (MAP_FAILED!=m_Map)
+					{
+						m_Size=Info.st_size;
+						m_Modified=Info.st_mtime;
+
+						size_t BodyOffset=0;
+						m_Valid=ParseEntry(static_cast<const char *>(m_Map),m_Size,m_Header,BodyOffset);
+						if (m_Valid)
+						{
+							m_Body=static_cast<const char *>(m_Map)+BodyOffset;
+							m_BodyLength=m_Size-BodyOffset;
+						}
+					}
+				}
+
+				close(FD);
+			}
+		}
+
+		~CDiskCacheEntry()
+		{
+			if (MAP_FAILED!=m_Map)
+				munmap(m_Map,m_Size);
+		}
+
+		//Check the query as well as the hash, in case of a collision
+
+		bool Matches(const std::string& Query) const
+		{
+			std::map<std::string,std::string>::const_iterator URL=m_Header.find("url");
+
+			return m_Valid && m_Header.end()!=URL && (*URL).second==Query;
+		}
+
+		std::string Header(const std::string& Name) const
+		{
+			std::map<std::string,std::string>::const_iterator Value=m_Header.find(Name);
+			if (m_Header.end()!=Value)
+				return (*Value).second;
+
+			return "";
+		}
+
+		bool HasValidators() const
+		{
+			return !Header("etag").empty() || !Header("last-modified").empty();
+		}
+
+		void *m_Map;
+		size_t m_Size;
+		time_t m_Modified;
+		bool m_Valid;
+		std::map<std::string,std::string> m_Header;
+		const char *m_Body;
+		size_t m_BodyLength;
+
+	private:
+		CDiskCacheEntry(const CDiskCacheEntry& Other);
+		CDiskCacheEntry& operator =(const CDiskCacheEntry& Other);
+};
+
+class MusicBrainz5::CDiskCachePrivate
+{
+	public:
+		CDiskCachePrivate()
+		:	m_MaxBytes(256*1024*1024),
+			m_DefaultTTL(86400),
+			m_CollectInterval(3600),
+			m_MaxStale(30*86400),
+			m_TempCount(0),
+			m_Hits(0),
+			m_Misses(0),
+			m_Writes(0),
+			m_Collected(0),
+			m_NextCollectCheck(0),
+			m_Collector(new CQueryExecutor(1))
+		{
+			pthread_mutex_init(&m_Lock,0);
+		}
+
+		~CDiskCachePrivate()
+		{
+			//Wait for any collection still running before anything it uses goes
+
+			delete m_Collector;
+
+			pthread_mutex_destroy(&m_Lock);
+		}
+
+		std::string Path(const std::string& Query) const;
+		int TTL(const std::string& Query);
+		bool CollectDue();
+		void Count(int& Counter);
+
+		std::string m_Directory;
+		size_t m_MaxBytes;
+		int m_DefaultTTL;
+		std::map<std::string,int> m_TTLs;
+		int m_CollectInterval;
+		int m_MaxStale;
+		int m_TempCount;
+		int m_Hits;
+		int m_Misses;
+		int m_Writes;
+		int m_Collected;
+		time_t m_NextCollectCheck;
+		CQueryExecutor *m_Collector;
+		mutable pthread_mutex_t m_Lock;
+};
+
+//Runs a collection on the collector's thread, so that the query which added the entry
+//that made it due is not held up by the directory scan
+
+class CCollectJob: public MusicBrainz5::CQueryJob
+{
+	public:
+		CCollectJob(MusicBrainz5::CDiskCache& Cache)
+		:	m_Cache(Cache)
+		{
+		}
+
+		virtual void Run()
+		{
+			m_Cache.Collect();
+		}
+
+	private:
+		MusicBrainz5::CDiskCache& m_Cache;
+};
+
+//32 bit FNV-1a hash of part of the query, reading it forwards or backwards
+
+static unsigned long HashQuery(const std::string& Query, bool Backwards)
+{
+	unsigned long Hash=2166136261UL;
+
+	for (std::string::size_type count=0;count<Query.length();count++)
+	{
+		Hash^=(unsigned char)Query[Backwards ? Query.length()-count-1 : count];
+		Hash=(Hash*16777619UL)&0xffffffffUL;
+	}
+
+	return Hash;
+}
+
+//64 bit hash of the query, as 16 hex digits. Made from two 32 bit halves, so that it
+//only needs the integer types of C++98.
+
+static std::string HashQuery(const std::string& Query)
+{
+	char Hex[17];
+	snprintf(Hex,sizeof(Hex),"%08lx%08lx",HashQuery(Query,false),HashQuery(Query,true));
+
+	return Hex;
+}
+
+static bool WriteAll(int FD, const char *Data, size_t Length)
+{
+	while (Length)
+	{
+		ssize_t Written=write(FD,Data,Length);
+		if (Written<0)
+		{
+			if (EINTR==errno)
+				continue;
+
+			return false;
+		}
+
+		Data+=Written;
+		Length-=Written;
+	}
+
+	return true;
+}
+
+std::string MusicBrainz5::CDiskCachePrivate::Path(const std::string& Query) const
+{
+	std::string Hash=HashQuery(Query);
+
+	return m_Directory+"/"+Hash.substr(0,2)+"/"+Hash;
+}
+
+int MusicBrainz5::CDiskCachePrivate::TTL(const std::string& Query)
+{
+	std::string Entity=CMetadataCache::Entity(Query);
+
+	pthread_mutex_lock(&m_Lock);
+
+	int TTL=m_DefaultTTL;
+	std::map<std::string,int>::const_iterator ThisTTL=m_TTLs.find(Entity);
+	if (m_TTLs.end()!=ThisTTL)
+		TTL=(*ThisTTL).second;
+
+	pthread_mutex_unlock(&m_Lock);
+
+	return TTL;
+}
+
+//Check whether a collection has been run, by any process, within the collection
+//interval. The stamp file is touched before returning true so that other processes
+//do not start collecting at the same time.
+//
+//The stamp is only looked at once the interval since the collection it last showed
+//has passed, rather than on every write.
+
+bool MusicBrainz5::CDiskCachePrivate::CollectDue()
+{
+	time_t Now=time(0);
+
+	pthread_mutex_lock(&m_Lock);
+	int Interval=m_CollectInterval;
+	bool Check=Interval>0 && Now>=m_NextCollectCheck;
+	if (Check)
+		m_NextCollectCheck=Now+Interval;
+	pthread_mutex_unlock(&m_Lock);
+
+	if (!Check)
+		return false;
+
+	std::string Stamp=m_Directory+"/"+CollectStamp;
+
+	struct stat Info;
+	if (0==stat(Stamp.c_str(),&Info) && Info.st_mtime+Interval>Now)
+	{
+		pthread_mutex_lock(&m_Lock);
+		m_NextCollectCheck=Info.st_mtime+Interval;
+		pthread_mutex_unlock(&m_Lock);
+
+		return false;
+	}
+
+	int FD=open(Stamp.c_str(),O_WRONLY|O_CREAT,0644);
+	if (FD<0)
+		return false;
+
+	close(FD);
+	utime(Stamp.c_str(),0);
+
+	return true;
+}
+
+void MusicBrainz5::CDiskCachePrivate::Count(int& Counter)
+{
+	pthread_mutex_lock(&m_Lock);
+	Counter++;
+	pthread_mutex_unlock(&m_Lock);
+}
+
+MusicBrainz5::CDiskCache::CDiskCache(const std::string& Directory, size_t MaxBytes)
+:	m_d(new CDiskCachePrivate)
+{
+	m_d->m_Directory=Directory;
+	m_d->m_MaxBytes=MaxBytes;
+}
+
+MusicBrainz5::CDiskCache::~CDiskCache()
+{
+	delete m_d;
+}
+
+std::string MusicBrainz5::CDiskCache::Directory() const
+{
+	return m_d->m_Directory;
+}
+
+void MusicBrainz5::CDiskCache::SetMaxBytes(size_t MaxBytes)
+{
+	pthread_mutex_lock(&m_d->m_Lock);
+	m_d->m_MaxBytes=MaxBytes;
+	pthread_mutex_unlock(&m_d->m_Lock);
+}
+
+void MusicBrainz5::CDiskCache::SetDefaultTTL(int Seconds)
+{
+	pthread_mutex_lock(&m_d->m_Lock);
+	m_d->m_DefaultTTL=Seconds;
+	pthread_mutex_unlock(&m_d->m_Lock);
+}
+
+void MusicBrainz5::CDiskCache::SetTTL(const std::string& Entity, int Seconds)
+{
+	pthread_mutex_lock(&m_d->m_Lock);
+	m_d->m_TTLs[Entity]=Seconds;
+	pthread_mutex_unlock(&m_d->m_Lock);
+}
+
+void MusicBrainz5::CDiskCache::SetCollectInterval(int Seconds)
+{
+	pthread_mutex_lock(&m_d->m_Lock);
+	m_d->m_CollectInterval=Seconds;
+	m_d->m_NextCollectCheck=0;
+	pthread_mutex_unlock(&m_d->m_Lock);
+}
+
+void MusicBrainz5::CDiskCache::SetMaxStale(int Seconds)
+{
+	pthread_mutex_lock(&m_d->m_Lock);
+	m_d->m_MaxStale=Seconds;
+	pthread_mutex_unlock(&m_d->m_Lock);
+}
+
+bool MusicBrainz5::CDiskCache::Get(const std::string& Query, CHTTPBodyReader& Reader)
+{
+	std::string ETag;
+	std::string LastModified;
+
+	return Get(Query,Reader,ETag,LastModified);
+}
+
+bool MusicBrainz5::CDiskCache::Get(const std::string& Query, CHTTPBodyReader& Reader, std::string& ETag, std::string& LastModified)
+{
+	bool Found=false;
+	bool Expired=false;
+
+	std::string Path=m_d->Path(Query);
+
+	{
+		CDiskCacheEntry Entry(Path);
+		if (Entry.Matches(Query))
+		{
+			if (Entry.m_Modified+m_d->TTL(Query)>time(0))
+			{
+				ETag=Entry.Header("etag");
+				LastModified=Entry.Header("last-modified");
+				Found=Reader.Read(Entry.m_Body,Entry.m_BodyLength);
+			}
+			else if (!Entry.HasValidators())
+				Expired=true;
+		}
+	}
+
+	//Expired entries are kept for revalidation if the server gave us a way to do it
+
+	if (Expired)
+		unlink(Path.c_str());
+
+	m_d->Count(Found ? m_d->m_Hits : m_d->m_Misses);
+
+	return Found;
+}
+
+bool MusicBrainz5::CDiskCache::Validators(const std::string& Query, std::string& ETag, std::string& LastModified)
+{
+	CDiskCacheEntry Entry(m_d->Path(Query));
+	if (!Entry.Matches(Query) || !Entry.HasValidators())
+		return false;
+
+	ETag=Entry.Header("etag");
+	LastModified=Entry.Header("last-modified");
+
+	return true;
+}
+
+void MusicBrainz5::CDiskCache::Put(const std::string& Query, const char *Data, size_t Length, const std::string& ETag, const std::string& LastModified)
+{
+	if (m_d->TTL(Query)<=0 || std::string::npos!=(Query+ETag+LastModified).find('\n'))
+		return;
+
+	std::string Path=m_d->Path(Query);
+	std::string Directory=Path.substr(0,Path.rfind('/'));
+
+	mkdir(m_d->m_Directory.c_str(),0755);
+	mkdir(Directory.c_str(),0755);
+
+	pthread_mutex_lock(&m_d->m_Lock);
+	int TempCount=m_d->m_TempCount++;
+	pthread_mutex_unlock(&m_d->m_Lock);
+
+	char TempName[64];
+	snprintf(TempName,sizeof(TempName),"/%s.%ld.%d",TempPrefix,(long)getpid(),TempCount);
+	std::string TempPath=Directory+TempName;
+
+	int FD=open(TempPath.c_str(),O_WRONLY|O_CREAT|O_EXCL,0644);
+	if (FD<0)
+		return;
+
+	std::string Header=std::string(CacheMagic)+"url: "+Query+"\n";
+	if (!ETag.empty())
+		Header+="etag: "+ETag+"\n";
+	if (!LastModified.empty())
+		Header+="last-modified: "+LastModified+"\n";
+	Header+="\n";
+
+	bool Written=WriteAll(FD,Header.c_str(),Header.length()) && WriteAll(FD,Data,Length);
+
+	if (0!=close(FD))
+		Written=false;
+
+	if (Written && 0==rename(TempPath.c_str(),Path.c_str()))
+		m_d->Count(m_d->m_Writes);
+	else
+		unlink(TempPath.c_str());
+
+	if (m_d->CollectDue())
+		m_d->m_Collector->Submit(new CCollectJob(*this));
+}
+
+void MusicBrainz5::CDiskCache::Touch(const std::string& Query)
+{
+	utime(m_d->Path(Query).c_str(),0);
+}
+
+void MusicBrainz5::CDiskCache::Remove(const std::string& Query)
+{
+	unlink(m_d->Path(Query).c_str());
+}
+
+void MusicBrainz5::CDiskCache::Collect()
+{
+	pthread_mutex_lock(&m_d->m_Lock);
+
+	size_t MaxBytes=m_d->m_MaxBytes;
+	int MaxTTL=m_d->m_DefaultTTL;
+
+	std::map<std::string,int>::const_iterator ThisTTL=m_d->m_TTLs.begin();
+	while (ThisTTL!=m_d->m_TTLs.end())
+	{
+		if ((*ThisTTL).second>MaxTTL)
+			MaxTTL=(*ThisTTL).second;
+
+		++ThisTTL;
+	}
+
+	int MaxAge=MaxTTL+m_d->m_MaxStale;
+
+	pthread_mutex_unlock(&m_d->m_Lock);
+
+	time_t Now=time(0);
+	std::vector<CDiskCacheFile> Files;
+	int Collected=0;
+
+	DIR *Top=opendir(m_d->m_Directory.c_str());
+	if (!Top)
+		return;
+
+	struct dirent *SubDir;
+	while (0!=(SubDir=readdir(Top)))
+	{
+		if ('.'==SubDir->d_name[0])
+			continue;
+
+		std::string SubDirPath=m_d->m_Directory+"/"+SubDir->d_name;
+
+		DIR *Entries=opendir(SubDirPath.c_str());
+		if (!Entries)
+			continue;
+
+		struct dirent *Entry;
+		while (0!=(Entry=readdir(Entries)))
+		{
+			std::string Name=Entry->d_name;
+			if ("."==Name || ".."==Name)
+				continue;
+
+			std::string Path=SubDirPath+"/"+Name;
+
+			struct stat Info;
+			if (0!=stat(Path.c_str(),&Info) || !S_ISREG(Info.st_mode))
+				continue;
+
+			bool Temp=(0==Name.compare(0,strlen(TempPrefix),TempPrefix));
+
+			if ((Temp && Info.st_mtime+TempMaxAge<=Now) || (!Temp && Info.st_mtime+MaxAge<=Now))
+			{
+				if (0==unlink(Path.c_str()))
+					Collected++;
+			}
+			else if (!Temp)
+				Files.push_back(CDiskCacheFile(Path,Info.st_mtime,Info.st_size));
+		}
+
+		closedir(Entries);
+	}
+
+	closedir(Top);
+
+	//Keep the newest entries that fit within the size limit
+
+	std::sort(Files.begin(),Files.end());
+
+	size_t Bytes=0;
+	for (std::vector<CDiskCacheFile>::const_iterator ThisFile=Files.begin();ThisFile!=Files.end();++ThisFile)
+	{
+		Bytes+=(*ThisFile).m_Size;
+		if (Bytes>MaxBytes && 0==unlink((*ThisFile).m_Path.c_str()))
+			Collected++;
+	}
+
+	pthread_mutex_lock(&m_d->m_Lock);
+	m_d->m_Collected+=Collected;
+	pthread_mutex_unlock(&m_d->m_Lock);
+}
+
+int MusicBrainz5::CDiskCache::Hits() const
+{
+	pthread_mutex_lock(&m_d->m_Lock);
+	int Hits=m_d->m_Hits;
+	pthread_mutex_unlock(&m_d->m_Lock);
+
+	return Hits;
+}
+
+int MusicBrainz5::CDiskCache::Misses() const
+{
+	pthread_mutex_lock(&m_d->m_Lock);
+	int Misses=m_d->m_Misses;
+	pthread_mutex_unlock(&m_d->m_Lock);
+
+	return Misses;
+}
+
+int MusicBrainz5::CDiskCache::Writes() const
+{
+	pthread_mutex_lock(&m_d->m_Lock);
+	int Writes=m_d->m_Writes;
+	pthread_mutex_unlock(&m_d->m_Lock);
+
+	return Writes;
+}
+
+int MusicBrainz5::CDiskCache::Collected() const
+{
+	pthread_mutex_lock(&m_d->m_Lock);
+	int Collected=m_d->m_Collected;
+	pthread_mutex_unlock(&m_d->m_Lock);
+
+	return Collected;
+}
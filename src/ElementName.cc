@@ -0,0 +1,207 @@
+/* --------------------------------------------------------------------------
+
+   libmusicbrainz5 - Client library to access MusicBrainz
+
+   Copyright (C) 2012 Andrew Hawkins
+
+   This file is part of libmusicbrainz5.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   libmusicbrainz5 is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+     $Id$
+
+----------------------------------------------------------------------------*/
+
+#include "config.h"
+#include "musicbrainz5/defines.h"
+
+#include "musicbrainz5/ElementName.h"
+
+#include <string.h>
+#include <pthread.h>
+
+//In the same order as MusicBrainz5::CElementName::tName
+
+static const char *Names[MusicBrainz5::CElementName::eName_NumNames]=
+{
+	0,
+	"alias-list",
+	"annotation-list",
+	"artist",
+	"artist-credit",
+	"artist-list",
+	"asin",
+	"attribute-list",
+	"barcode",
+	"begin",
+	"begin-date",
+	"catalog-number",
+	"category",
+	"cdstub",
+	"cdstub-list",
+	"collection",
+	"collection-list",
+	"comment",
+	"count",
+	"country",
+	"created",
+	"date",
+	"direction",
+	"disambiguation",
+	"disc",
+	"disc-list",
+	"editor",
+	"end",
+	"end-date",
+	"ended",
+	"entity",
+	"first-release-date",
+	"format",
+	"freedb-disc-list",
+	"gender",
+	"generator",
+	"id",
+	"ipi",
+	"ipi-list",
+	"isrc",
+	"isrc-list",
+	"iswc-list",
+	"joinphrase",
+	"label",
+	"label-code",
+	"label-info-list",
+	"label-list",
+	"language",
+	"length",
+	"life-span",
+	"locale",
+	"medium-list",
+	"message",
+	"name",
+	"name-credit",
+	"nonmb-track-list",
+	"number",
+	"offset",
+	"offset-list",
+	"packaging",
+	"position",
+	"primary",
+	"primary-type",
+	"puid",
+	"puid-list",
+	"quality",
+	"rating",
+	"recording",
+	"recording-list",
+	"relation-list",
+	"release",
+	"release-group",
+	"release-group-list",
+	"release-list",
+	"script",
+	"secondary-type-list",
+	"sectors",
+	"sort-name",
+	"status",
+	"tag-list",
+	"target",
+	"target-type",
+	"text",
+	"text-representation",
+	"title",
+	"track-count",
+	"track-list",
+	"type",
+	"user-rating",
+	"user-tag-list",
+	"votes-count",
+	"work",
+	"work-list",
+	"xmlns",
+	"xmlns:ext",
+	"year",
+};
+
+//Open addressing hash table of names, built on first use. It is kept no more than half
+//full so that lookups rarely need more than one comparison. Empty slots hold
+//eName_Unknown.
+
+static const unsigned int TableSize=256;
+static unsigned char Table[TableSize];
+static pthread_once_t TableOnce=PTHREAD_ONCE_INIT;
+
+static unsigned int Hash(const char *Name, size_t Length)
+{
+	//FNV-1a
+
+	unsigned int Hash=2166136261U;
+
+	for (size_t count=0;count<Length;count++)
+	{
+		Hash^=(unsigned char)Name[count];
+		Hash*=16777619U;
+	}
+
+	return Hash;
+}
+
+static void BuildTable()
+{
+	for (int Name=1;Name<MusicBrainz5::CElementName::eName_NumNames;Name++)
+	{
+		unsigned int Slot=Hash(Names[Name],strlen(Names[Name]))%TableSize;
+
+		while (Table[Slot])
+			Slot=(Slot+1)%TableSize;
+
+		Table[Slot]=(unsigned char)Name;
+	}
+}
+
+static MusicBrainz5::CElementName::tName Find(const char *Name, size_t Length)
+{
+	pthread_once(&TableOnce,BuildTable);
+
+	unsigned int Slot=Hash(Name,Length)%TableSize;
+
+	while (Table[Slot])
+	{
+		const char *ThisName=Names[Table[Slot]];
+
+		if (0==strncmp(ThisName,Name,Length) && 0==ThisName[Length])
+			return (MusicBrainz5::CElementName::tName)Table[Slot];
+
+		Slot=(Slot+1)%TableSize;
+	}
+
+	return MusicBrainz5::CElementName::eName_Unknown;
+}
+
+MusicBrainz5::CElementName::tName MusicBrainz5::CElementName::Lookup(const char *Name)
+{
+	if (!Name)
+		return eName_Unknown;
+
+	return Find(Name,strlen(Name));
+}
+
+MusicBrainz5::CElementName::tName MusicBrainz5::CElementName::Lookup(const std::string& Name)
+{
+	return Find(Name.data(),Name.length());
+}
+
+MusicBrainz5::CElementName::tName MusicBrainz5::CElementName::Lookup(const XMLNode& Node)
+{
+	return Lookup(Node.getName());
+}
@@ -31,15 +31,136 @@
 #include "musicbrainz5/RelationList.h"
 #include "musicbrainz5/RelationListList.h"
 
+#include <limits.h>
+#include <locale>
+#include <vector>
+
+#include <pthread.h>
+
+//A document being parsed lazily. Every entity with elements still to parse holds a
+//reference to it, and copies of entities share it, so it must outlive all of them.
+
+class CLazyDocument
+{
+	public:
+		CLazyDocument(XMLNode *Document)
+		:	m_Document(Document),
+			m_RefCount(1)
+		{
+			pthread_mutex_init(&m_Lock,0);
+		}
+
+		const XMLNode *Document() const
+		{
+			return m_Document;
+		}
+
+		void AddRef()
+		{
+			pthread_mutex_lock(&m_Lock);
+			++m_RefCount;
+			pthread_mutex_unlock(&m_Lock);
+		}
+
+		void Release()
+		{
+			pthread_mutex_lock(&m_Lock);
+			bool Last=(0==--m_RefCount);
+			pthread_mutex_unlock(&m_Lock);
+
+			if (Last)
+				delete this;
+		}
+
+	private:
+		~CLazyDocument()
+		{
+			delete m_Document;
+			pthread_mutex_destroy(&m_Lock);
+		}
+
+		XMLNode *m_Document;
+		int m_RefCount;
+		pthread_mutex_t m_Lock;
+};
+
+//Entities are built by their constructors, which only see a node, so the document
+//that the node belongs to is kept here while a lazy parse is under way on this thread.
+//Entities built during it put off their own elements in the same way.
+
+static pthread_key_t CurrentDocumentKey;
+static pthread_once_t CurrentDocumentOnce=PTHREAD_ONCE_INIT;
+
+static void CreateCurrentDocumentKey()
+{
+	pthread_key_create(&CurrentDocumentKey,0);
+}
+
+static CLazyDocument *CurrentDocument()
+{
+	pthread_once(&CurrentDocumentOnce,CreateCurrentDocumentKey);
+
+	return static_cast<CLazyDocument *>(pthread_getspecific(CurrentDocumentKey));
+}
+
+class CCurrentDocumentScope
+{
+	public:
+		CCurrentDocumentScope(CLazyDocument *Document)
+		:	m_Previous(CurrentDocument())
+		{
+			pthread_setspecific(CurrentDocumentKey,Document);
+		}
+
+		~CCurrentDocumentScope()
+		{
+			pthread_setspecific(CurrentDocumentKey,m_Previous);
+		}
+
+	private:
+		CLazyDocument *m_Previous;
+};
+
+//Marks an entity as building the elements that a lazy parse put off, so that they are
+//not put off again, until the scope is left, even by an exception
+
+class CMaterialiseScope
+{
+	public:
+		CMaterialiseScope(bool& Materialising)
+		:	m_Materialising(Materialising)
+		{
+			m_Materialising=true;
+		}
+
+		~CMaterialiseScope()
+		{
+			m_Materialising=false;
+		}
+
+	private:
+		bool& m_Materialising;
+};
+
 class MusicBrainz5::CEntityPrivate
 {
 	public:
 		CEntityPrivate()
+		:	m_Document(0),
+			m_Materialising(false)
 		{
 		}
 
 		std::map<std::string,std::string> m_ExtAttributes;
 		std::map<std::string,std::string> m_ExtElements;
+
+		//Elements put off by a lazy parse, in document order, and the document they
+		//belong to. The document is kept until the entity is destroyed, even once
+		//everything has been built, so that it can be parsed again in full.
+
+		CLazyDocument *m_Document;
+		std::vector<XMLNode> m_Pending;
+		bool m_Materialising;
 };
 
 MusicBrainz5::CEntity::CEntity()
@@ -61,6 +182,13 @@ MusicBrainz5::CEntity& MusicBrainz5::CEntity::operator =(const CEntity& Other)
 
 		m_d->m_ExtAttributes=Other.m_d->m_ExtAttributes;
 		m_d->m_ExtElements=Other.m_d->m_ExtElements;
+
+		if (Other.m_d->m_Document)
+		{
+			m_d->m_Document=Other.m_d->m_Document;
+			m_d->m_Document->AddRef();
+			m_d->m_Pending=Other.m_d->m_Pending;
+		}
 	}
 
 	return *this;
@@ -75,6 +203,13 @@ MusicBrainz5::CEntity::~CEntity()
 
 void MusicBrainz5::CEntity::Cleanup()
 {
+	m_d->m_Pending.clear();
+
+	if (m_d->m_Document)
+	{
+		m_d->m_Document->Release();
+		m_d->m_Document=0;
+	}
 }
 
 void MusicBrainz5::CEntity::Parse(const XMLNode& Node)
@@ -88,7 +223,7 @@ void MusicBrainz5::CEntity::Parse(const XMLNode& Node)
 			std::string Name=Attr.name();
 			std::string Value=Attr.value();
 
-			if ("ext:"==Name.substr(0,4))
+			if (0==Name.compare(0,4,"ext:"))
 				m_d->m_ExtAttributes[Name.substr(4)]=Value;
 			else
 				ParseAttribute(Name,Value);
@@ -101,18 +236,92 @@ void MusicBrainz5::CEntity::Parse(const XMLNode& Node)
 		     ChildNode = ChildNode.next())
 		{
 			std::string Name=ChildNode.getName();
-			std::string Value;
-			if (ChildNode.getText())
-				Value=ChildNode.getText();
 
-			if ("ext:"==Name.substr(0,4))
+			if (0==Name.compare(0,4,"ext:"))
+			{
+				std::string Value;
+				if (ChildNode.getText())
+					Value=ChildNode.getText();
+
 				m_d->m_ExtElements[Name.substr(4)]=Value;
+			}
 			else
 				ParseElement(ChildNode);
 		}
 	}
 }
 
+void MusicBrainz5::CEntity::ParseLazily(XMLNode *Document)
+{
+	CLazyDocument *LazyDocument=new CLazyDocument(Document);
+
+	{
+		CCurrentDocumentScope Scope(LazyDocument);
+
+		Parse(*Document);
+	}
+
+	LazyDocument->Release();
+}
+
+//Keep an element to be parsed later, if a lazy parse is under way. Elements are only
+//kept from one document per entity; should an entity be parsed again from another,
+//they are parsed straight away instead.
+
+bool MusicBrainz5::CEntity::Defer(const XMLNode& Node)
+{
+	if (m_d->m_Materialising)
+		return false;
+
+	CLazyDocument *Document=CurrentDocument();
+	if (!Document || (m_d->m_Document && m_d->m_Document!=Document))
+		return false;
+
+	if (!m_d->m_Document)
+	{
+		m_d->m_Document=Document;
+		m_d->m_Document->AddRef();
+	}
+
+	m_d->m_Pending.push_back(Node);
+
+	return true;
+}
+
+void MusicBrainz5::CEntity::Materialise(CElementName::tName Name) const
+{
+	if (m_d->m_Pending.empty())
+		return;
+
+	std::vector<XMLNode> Nodes;
+	std::vector<XMLNode> Remaining;
+
+	for (std::vector<XMLNode>::const_iterator ThisNode=m_d->m_Pending.begin();ThisNode!=m_d->m_Pending.end();++ThisNode)
+	{
+		if (CElementName::Lookup(*ThisNode)==Name)
+			Nodes.push_back(*ThisNode);
+		else
+			Remaining.push_back(*ThisNode);
+	}
+
+	if (Nodes.empty())
+		return;
+
+	m_d->m_Pending.swap(Remaining);
+
+	CCurrentDocumentScope DocumentScope(m_d->m_Document);
+	CMaterialiseScope MaterialiseScope(m_d->m_Materialising);
+
+	CEntity *Entity=const_cast<CEntity *>(this);
+	for (std::vector<XMLNode>::const_iterator ThisNode=Nodes.begin();ThisNode!=Nodes.end();++ThisNode)
+		Entity->ParseElement(*ThisNode);
+}
+
+const XMLNode *MusicBrainz5::CEntity::LazyDocument() const
+{
+	return m_d->m_Document ? m_d->m_Document->Document() : 0;
+}
+
 std::map<std::string,std::string> MusicBrainz5::CEntity::ExtAttributes() const
 {
 	return m_d->m_ExtAttributes;
@@ -125,6 +334,9 @@ std::map<std::string,std::string> MusicBrainz5::CEntity::ExtElements() const
 
 void MusicBrainz5::CEntity::ProcessRelationList(const XMLNode& Node, CRelationListList* & RetVal)
 {
+	if (Defer(Node))
+		return;
+
 	if (0==RetVal)
 		RetVal=new CRelationListList;
 
@@ -134,6 +346,227 @@ void MusicBrainz5::CEntity::ProcessRelationList(const XMLNode& Node, CRelationLi
 	delete RelationList;
 }
 
+//The conversions below accept what reading from a stream in the classic locale would:
+//leading white space, an optional sign, and as much of a number as is present. The
+//value is left alone if there is no text, is set to 0 if the text isn't a number, and
+//is clamped if an int is out of range.
+
+static bool IsSpace(char Char)
+{
+	return ' '==Char || '\t'==Char || '\n'==Char || '\v'==Char || '\f'==Char || '\r'==Char;
+}
+
+static bool IsDigit(char Char)
+{
+	return Char>='0' && Char<='9';
+}
+
+static bool ConvertInt(const char *Text, int& RetVal)
+{
+	if (!Text)
+		return false;
+
+	while (IsSpace(*Text))
+		Text++;
+
+	if (!*Text)
+		return false;
+
+	RetVal=0;
+
+	bool Negative='-'==*Text;
+	if ('-'==*Text || '+'==*Text)
+		Text++;
+
+	if (!IsDigit(*Text))
+		return false;
+
+	//Accumulate as a negative number, as that has the larger range
+
+	int Value=0;
+	bool Overflow=false;
+
+	for (;IsDigit(*Text);Text++)
+	{
+		int Digit=*Text-'0';
+
+		if (Value<(INT_MIN+Digit)/10)
+			Overflow=true;
+		else if (!Overflow)
+			Value=Value*10-Digit;
+	}
+
+	if (!Negative && !Overflow && Value<-INT_MAX)
+		Overflow=true;
+
+	if (Overflow)
+	{
+		RetVal=Negative ? INT_MIN : INT_MAX;
+		return false;
+	}
+
+	RetVal=Negative ? Value : -Value;
+
+	return true;
+}
+
+static bool ConvertDoubleStream(const char *Text, double& RetVal)
+{
+	std::istringstream is(Text);
+	is.imbue(std::locale::classic());
+
+	is >> RetVal;
+
+	return !is.fail();
+}
+
+static bool ConvertDouble(const char *Text, double& RetVal)
+{
+	//Powers of ten that can be represented exactly
+
+	static const double PowersOfTen[]={
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+
+	if (!Text)
+		return false;
+
+	const char *Start=Text;
+
+	while (IsSpace(*Text))
+		Text++;
+
+	if (!*Text)
+		return false;
+
+	RetVal=0;
+
+	bool Negative='-'==*Text;
+	if ('-'==*Text || '+'==*Text)
+		Text++;
+
+	//Collect up to 15 significant digits, which are held exactly in a double
+
+	double Mantissa=0;
+	int Digits=0;
+	int Exponent=0;
+	bool Seen=false;
+
+	for (;IsDigit(*Text);Text++)
+	{
+		Seen=true;
+
+		if (Digits<15)
+		{
+			Mantissa=Mantissa*10+(*Text-'0');
+			if (Mantissa!=0)
+				Digits++;
+		}
+		else
+		{
+			Digits++;
+			Exponent++;
+		}
+	}
+
+	if ('.'==*Text)
+	{
+		Text++;
+
+		for (;IsDigit(*Text);Text++)
+		{
+			Seen=true;
+
+			if (Digits<15)
+			{
+				Mantissa=Mantissa*10+(*Text-'0');
+				Exponent--;
+				if (Mantissa!=0)
+					Digits++;
+			}
+			else
+				Digits++;
+		}
+	}
+
+	if (!Seen)
+		return false;
+
+	if ('e'==*Text || 'E'==*Text)
+	{
+		Text++;
+
+		bool NegativeExponent='-'==*Text;
+		if ('-'==*Text || '+'==*Text)
+			Text++;
+
+		if (!IsDigit(*Text))
+			return false;
+
+		int Power=0;
+		for (;IsDigit(*Text);Text++)
+		{
+			if (Power<10000)
+				Power=Power*10+(*Text-'0');
+		}
+
+		Exponent+=NegativeExponent ? -Power : Power;
+	}
+
+	//With no more than 15 digits and an exactly representable power of ten, one
+	//multiplication or division gives the correctly rounded result. Anything else
+	//is left to the stream.
+
+	if (Digits>15 || Exponent>22 || Exponent<-22)
+		return ConvertDoubleStream(Start,RetVal);
+
+	if (Exponent<0)
+		Mantissa/=PowersOfTen[-Exponent];
+	else
+		Mantissa*=PowersOfTen[Exponent];
+
+	RetVal=Negative ? -Mantissa : Mantissa;
+
+	return true;
+}
+
+static void ReportError(const char *Text)
+{
+#ifdef _MB5_DEBUG_
+	std::cerr << "Error parsing value '";
+	if (Text)
+		std::cerr << Text;
+	std::cerr << "'" << std::endl;
+#else
+	(void)Text;
+#endif
+}
+
+void MusicBrainz5::CEntity::ProcessItem(const XMLNode& Node, int& RetVal)
+{
+	if (!ConvertInt(Node.getText(),RetVal))
+		ReportError(Node.getText());
+}
+
+void MusicBrainz5::CEntity::ProcessItem(const XMLNode& Node, double& RetVal)
+{
+	if (!ConvertDouble(Node.getText(),RetVal))
+		ReportError(Node.getText());
+}
+
+void MusicBrainz5::CEntity::ProcessItem(const std::string& Text, int& RetVal)
+{
+	if (!ConvertInt(Text.c_str(),RetVal))
+		ReportError(Text.c_str());
+}
+
+void MusicBrainz5::CEntity::ProcessItem(const std::string& Text, double& RetVal)
+{
+	if (!ConvertDouble(Text.c_str(),RetVal))
+		ReportError(Text.c_str());
+}
+
 std::ostream& MusicBrainz5::CEntity::Serialise(std::ostream& os) const
 {
 	if (!ExtAttributes().empty())
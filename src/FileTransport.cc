@@ -0,0 +1,97 @@
+/* --------------------------------------------------------------------------
+
+   libmusicbrainz5 - Client library to access MusicBrainz
+
+   Copyright (C) 2012 Andrew Hawkins
+
+   This file is part of libmusicbrainz5.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   libmusicbrainz5 is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+     $Id$
+
+----------------------------------------------------------------------------*/
+
+#include "config.h"
+#include "musicbrainz5/defines.h"
+
+#include "musicbrainz5/FileTransport.h"
+
+#include <stdio.h>
+
+class MusicBrainz5::CFileTransportPrivate
+{
+	public:
+		std::string m_Directory;
+};
+
+MusicBrainz5::CFileTransport::CFileTransport(const std::string& Directory)
+:	m_d(new CFileTransportPrivate)
+{
+	m_d->m_Directory=Directory;
+}
+
+MusicBrainz5::CFileTransport::~CFileTransport()
+{
+	delete m_d;
+}
+
+void MusicBrainz5::CFileTransport::Fetch(const CTransportRequest& Request, CTransportResponse& Response)
+{
+	std::string URL=Request.URL();
+
+	std::string FileName=m_d->m_Directory+URL+".xml";
+	FILE *fptr=fopen(FileName.c_str(),"rb");
+
+	std::string::size_type QueryPos=URL.find('?');
+	if (!fptr && std::string::npos!=QueryPos)
+	{
+		FileName=m_d->m_Directory+URL.substr(0,QueryPos)+".xml";
+		fptr=fopen(FileName.c_str(),"rb");
+	}
+
+	if (!fptr)
+	{
+		Response.SetStatus(404);
+		Response.SetErrorMessage("No response found for "+URL);
+		return;
+	}
+
+	Response.SetStatus(200);
+
+	//Pass the file on in blocks, as a network transport would
+
+	char Buffer[65536];
+	size_t Length;
+	bool Continue=true;
+
+	while (Continue && 0!=(Length=fread(Buffer,1,sizeof(Buffer),fptr)))
+		Continue=Response.Read(Buffer,Length);
+
+	bool Failed=ferror(fptr)!=0;
+
+	fclose(fptr);
+
+	if (!Continue)
+	{
+		Response.SetErrorMessage("Request aborted");
+		throw CFetchError(Response.ErrorMessage());
+	}
+
+	if (Failed)
+	{
+		Response.SetErrorMessage("Error reading "+FileName);
+		throw CFetchError(Response.ErrorMessage());
+	}
+}
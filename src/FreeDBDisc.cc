@@ -27,6 +27,7 @@
 #include "musicbrainz5/defines.h"
 
 #include "musicbrainz5/FreeDBDisc.h"
+#include "musicbrainz5/ElementName.h"
 
 #include "musicbrainz5/NonMBTrackList.h"
 #include "musicbrainz5/NonMBTrack.h"
@@ -107,45 +108,49 @@ MusicBrainz5::CFreeDBDisc *MusicBrainz5::CFreeDBDisc::Clone()
 
 void MusicBrainz5::CFreeDBDisc::ParseAttribute(const std::string& Name, const std::string& Value)
 {
-	if ("id"==Name)
-		m_d->m_ID=Value;
-	else
+	switch (CElementName::Lookup(Name))
 	{
+		case CElementName::eName_ID:
+			m_d->m_ID=Value;
+			break;
+
+		default:
 #ifdef _MB5_DEBUG_
-		std::cerr << "Unrecognised freedb disc attribute: '" << Name << "'" << std::endl;
+			std::cerr << "Unrecognised freedb disc attribute: '" << Name << "'" << std::endl;
 #endif
+			break;
 	}
 }
 
 void MusicBrainz5::CFreeDBDisc::ParseElement(const XMLNode& Node)
 {
-	std::string NodeName=Node.getName();
-
-	if ("title"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Title);
-	}
-	else if ("artist"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Artist);
-	}
-	else if ("category"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Category);
-	}
-	else if ("year"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Year);
-	}
-	else if ("nonmb-track-list"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_NonMBTrackList);
-	}
-	else
+	switch (CElementName::Lookup(Node))
 	{
+		case CElementName::eName_Title:
+			ProcessItem(Node,m_d->m_Title);
+			break;
+
+		case CElementName::eName_Artist:
+			ProcessItem(Node,m_d->m_Artist);
+			break;
+
+		case CElementName::eName_Category:
+			ProcessItem(Node,m_d->m_Category);
+			break;
+
+		case CElementName::eName_Year:
+			ProcessItem(Node,m_d->m_Year);
+			break;
+
+		case CElementName::eName_NonmbTrackList:
+			ProcessLazyItem(Node,m_d->m_NonMBTrackList);
+			break;
+
+		default:
 #ifdef _MB5_DEBUG_
-		std::cerr << "Unrecognised freedb disc element: '" << NodeName << "'" << std::endl;
+			std::cerr << "Unrecognised freedb disc element: '" << Node.getName() << "'" << std::endl;
 #endif
+			break;
 	}
 }
 
@@ -181,6 +186,8 @@ std::string MusicBrainz5::CFreeDBDisc::Year() const
 
 MusicBrainz5::CNonMBTrackList *MusicBrainz5::CFreeDBDisc::NonMBTrackList() const
 {
+	Materialise(CElementName::eName_NonmbTrackList);
+
 	return m_d->m_NonMBTrackList;
 }
 
@@ -27,14 +27,22 @@
 #include "musicbrainz5/defines.h"
 
 #include "musicbrainz5/HTTPFetch.h"
+#include "MonotonicTime.h"
+
+#include <list>
+#include <map>
+#include <new>
+#include <sstream>
 
 #include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
 
 #include "ne_session.h"
 #include "ne_auth.h"
 #include "ne_string.h"
 #include "ne_request.h"
+#include "ne_compress.h"
 
 #if defined(__GNUC__)
 __attribute__((constructor))
@@ -56,6 +64,291 @@ static void destroy_neon()
 	ne_sock_exit();
 }
 
+//Upper limit on the buffer reserved from a Content-Length header, so a bogus header
+//can't cause a huge allocation up front
+
+static const unsigned long MaxReserve=64*1024*1024;
+
+//Times the lookup and connection, when neon has to open a new connection for a request
+
+class CConnectTimer
+{
+	public:
+		CConnectTimer()
+		:	m_Start(0),
+			m_Time(0)
+		{
+		}
+
+		double m_Start;
+		double m_Time;
+};
+
+static void ConnectNotifier(void *userdata, ne_session_status status, const ne_session_status_info *info)
+{
+	info=info;
+
+	CConnectTimer *Timer=reinterpret_cast<CConnectTimer *>(userdata);
+
+	switch (status)
+	{
+		case ne_status_lookup:
+		case ne_status_connecting:
+			if (0==Timer->m_Start)
+				Timer->m_Start=MusicBrainz5::MonotonicTime();
+			break;
+
+		case ne_status_connected:
+			if (0!=Timer->m_Start)
+				Timer->m_Time+=MusicBrainz5::MonotonicTime()-Timer->m_Start;
+			Timer->m_Start=0;
+			break;
+
+		default:
+			break;
+	}
+}
+
+class MusicBrainz5::CHTTPSession
+{
+	public:
+		CHTTPSession(const std::string& Key, ne_session *Session)
+		:	m_Key(Key),
+			m_Session(Session),
+			m_Fetch(0),
+			m_Buffer(0),
+			m_LastUsed(0)
+		{
+		}
+
+		~CHTTPSession()
+		{
+			if (m_Session)
+				ne_session_destroy(m_Session);
+		}
+
+		std::string m_Key;
+		ne_session *m_Session;
+		CHTTPFetch *m_Fetch;
+		std::vector<unsigned char> *m_Buffer;
+		double m_LastUsed;
+};
+
+//Size the buffer from Content-Length before the body arrives, so it is allocated
+//once rather than grown as each block is appended. A compressed body's length says
+//little about its decoded size, so those are left to grow as usual.
+
+static void ReserveBuffer(ne_request *req, void *userdata, const ne_status *status)
+{
+	MusicBrainz5::CHTTPSession *Session=(MusicBrainz5::CHTTPSession *)userdata;
+
+	if (Session->m_Buffer && 2==status->klass && !ne_get_response_header(req, "Content-Encoding"))
+	{
+		const char *Length=ne_get_response_header(req, "Content-Length");
+		if (Length)
+		{
+			unsigned long Size=strtoul(Length, 0, 10);
+			if (Size>0 && Size<=MaxReserve)
+				Session->m_Buffer->reserve(Size);
+		}
+	}
+}
+
+class MusicBrainz5::CHTTPSessionPoolPrivate
+{
+	public:
+		CHTTPSessionPoolPrivate()
+		:	m_MaxConnections(4),
+			m_IdleTimeout(60),
+			m_NumConnections(0)
+		{
+			pthread_mutex_init(&m_Lock,0);
+			pthread_cond_init(&m_Released,0);
+		}
+
+		~CHTTPSessionPoolPrivate()
+		{
+			pthread_cond_destroy(&m_Released);
+			pthread_mutex_destroy(&m_Lock);
+		}
+
+		CHTTPSession *Acquire(const std::string& Key);
+		void Release(CHTTPSession *Session, bool Reusable);
+		void Trim(bool ExpiredOnly);
+
+		int m_MaxConnections;
+		int m_IdleTimeout;
+		int m_NumConnections;
+		std::list<CHTTPSession *> m_Idle;
+		pthread_mutex_t m_Lock;
+		pthread_cond_t m_Released;
+};
+
+//Must be called with m_Lock held. Idle sessions are kept most recently used first,
+//so expired or surplus sessions are always at the back of the list
+
+void MusicBrainz5::CHTTPSessionPoolPrivate::Trim(bool ExpiredOnly)
+{
+	double Now=MonotonicTime();
+
+	while (!m_Idle.empty())
+	{
+		CHTTPSession *Oldest=m_Idle.back();
+
+		bool Expired=Now-Oldest->m_LastUsed>=m_IdleTimeout;
+		bool Surplus=m_NumConnections>m_MaxConnections;
+
+		if (!Expired && (ExpiredOnly || !Surplus))
+			break;
+
+		m_Idle.pop_back();
+		delete Oldest;
+		--m_NumConnections;
+	}
+}
+
+//Return an idle session matching Key, or 0 if the caller should create a new
+//session. In the latter case a connection slot has been reserved for it.
+
+MusicBrainz5::CHTTPSession *MusicBrainz5::CHTTPSessionPoolPrivate::Acquire(const std::string& Key)
+{
+	CHTTPSession *Ret=0;
+
+	pthread_mutex_lock(&m_Lock);
+
+	for (;;)
+	{
+		Trim(true);
+
+		std::list<CHTTPSession *>::iterator ThisSession=m_Idle.begin();
+		while (ThisSession!=m_Idle.end() && (*ThisSession)->m_Key!=Key)
+			++ThisSession;
+
+		if (ThisSession!=m_Idle.end())
+		{
+			Ret=*ThisSession;
+			m_Idle.erase(ThisSession);
+			break;
+		}
+
+		if (m_NumConnections<m_MaxConnections)
+		{
+			++m_NumConnections;
+			break;
+		}
+
+		if (!m_Idle.empty())
+		{
+			//Close the least recently used session to another server and take its slot
+
+			delete m_Idle.back();
+			m_Idle.pop_back();
+			break;
+		}
+
+		pthread_cond_wait(&m_Released,&m_Lock);
+	}
+
+	pthread_mutex_unlock(&m_Lock);
+
+	return Ret;
+}
+
+void MusicBrainz5::CHTTPSessionPoolPrivate::Release(CHTTPSession *Session, bool Reusable)
+{
+	pthread_mutex_lock(&m_Lock);
+
+	Session->m_Fetch=0;
+
+	if (Reusable && Session->m_Session && m_IdleTimeout>0 && m_NumConnections<=m_MaxConnections)
+	{
+		Session->m_LastUsed=MonotonicTime();
+		m_Idle.push_front(Session);
+	}
+	else
+	{
+		delete Session;
+		--m_NumConnections;
+	}
+
+	Trim(true);
+
+	pthread_cond_broadcast(&m_Released);
+	pthread_mutex_unlock(&m_Lock);
+}
+
+MusicBrainz5::CHTTPSessionPool::CHTTPSessionPool(int MaxConnections, int IdleTimeout)
+:	m_d(new CHTTPSessionPoolPrivate)
+{
+	m_d->m_MaxConnections=MaxConnections>0 ? MaxConnections : 1;
+	m_d->m_IdleTimeout=IdleTimeout;
+}
+
+MusicBrainz5::CHTTPSessionPool::~CHTTPSessionPool()
+{
+	Clear();
+
+	delete m_d;
+}
+
+void MusicBrainz5::CHTTPSessionPool::SetMaxConnections(int MaxConnections)
+{
+	pthread_mutex_lock(&m_d->m_Lock);
+
+	m_d->m_MaxConnections=MaxConnections>0 ? MaxConnections : 1;
+	m_d->Trim(false);
+
+	pthread_cond_broadcast(&m_d->m_Released);
+	pthread_mutex_unlock(&m_d->m_Lock);
+}
+
+int MusicBrainz5::CHTTPSessionPool::MaxConnections() const
+{
+	pthread_mutex_lock(&m_d->m_Lock);
+
+	int Ret=m_d->m_MaxConnections;
+
+	pthread_mutex_unlock(&m_d->m_Lock);
+
+	return Ret;
+}
+
+void MusicBrainz5::CHTTPSessionPool::SetIdleTimeout(int IdleTimeout)
+{
+	pthread_mutex_lock(&m_d->m_Lock);
+
+	m_d->m_IdleTimeout=IdleTimeout;
+	m_d->Trim(true);
+
+	pthread_mutex_unlock(&m_d->m_Lock);
+}
+
+int MusicBrainz5::CHTTPSessionPool::NumConnections() const
+{
+	pthread_mutex_lock(&m_d->m_Lock);
+
+	int Ret=m_d->m_NumConnections;
+
+	pthread_mutex_unlock(&m_d->m_Lock);
+
+	return Ret;
+}
+
+void MusicBrainz5::CHTTPSessionPool::Clear()
+{
+	pthread_mutex_lock(&m_d->m_Lock);
+
+	while (!m_d->m_Idle.empty())
+	{
+		delete m_d->m_Idle.back();
+		m_d->m_Idle.pop_back();
+		--m_d->m_NumConnections;
+	}
+
+	pthread_cond_broadcast(&m_d->m_Released);
+	pthread_mutex_unlock(&m_d->m_Lock);
+}
+
 class MusicBrainz5::CHTTPFetchPrivate
 {
 	public:
@@ -63,7 +356,17 @@ class MusicBrainz5::CHTTPFetchPrivate
 		:	m_Port(80),
 			m_Result(0),
 			m_Status(0),
-			m_ProxyPort(0)
+			m_ProxyPort(0),
+			m_Pool(0),
+			m_Compression(true),
+			m_ConnectTimeout(30),
+			m_ReadTimeout(60),
+			m_CompressedBytes(0),
+			m_UncompressedBytes(0),
+			m_ConnectTime(0),
+			m_BodyReader(0),
+			m_ReaderFailed(false),
+			m_ReaderOutOfMemory(false)
 		{
 		}
 
@@ -80,6 +383,19 @@ class MusicBrainz5::CHTTPFetchPrivate
 		int m_ProxyPort;
 		std::string m_ProxyUserName;
 		std::string m_ProxyPassword;
+		CHTTPSessionPool *m_Pool;
+		bool m_Compression;
+		int m_ConnectTimeout;
+		int m_ReadTimeout;
+		size_t m_CompressedBytes;
+		size_t m_UncompressedBytes;
+		double m_ConnectTime;
+		CHTTPBodyReader *m_BodyReader;
+		bool m_ReaderFailed;
+		bool m_ReaderOutOfMemory;
+		std::string m_ReaderError;
+		std::map<std::string,std::string> m_RequestHeaders;
+		std::map<std::string,std::string> m_Headers;
 };
 
 MusicBrainz5::CHTTPFetch::CHTTPFetch(const std::string& UserAgent, const std::string& Host, int Port)
@@ -161,25 +477,104 @@ void MusicBrainz5::CHTTPFetch::SetProxyPassword(const std::string& ProxyPassword
 	m_d->m_ProxyPassword=ProxyPassword;
 }
 
-int MusicBrainz5::CHTTPFetch::Fetch(const std::string& URL, const std::string& Request)
+void MusicBrainz5::CHTTPFetch::SetSessionPool(CHTTPSessionPool *Pool)
 {
-	int Ret=0;
+	m_d->m_Pool=Pool;
+}
 
-	m_d->m_Data.clear();
+void MusicBrainz5::CHTTPFetch::SetCompression(bool Compression)
+{
+	m_d->m_Compression=Compression;
+}
 
+void MusicBrainz5::CHTTPFetch::SetConnectTimeout(int Seconds)
+{
+	m_d->m_ConnectTimeout=Seconds>0 ? Seconds : 0;
+}
+
+void MusicBrainz5::CHTTPFetch::SetReadTimeout(int Seconds)
+{
+	m_d->m_ReadTimeout=Seconds>0 ? Seconds : 0;
+}
+
+void MusicBrainz5::CHTTPFetch::SetBodyReader(CHTTPBodyReader *Reader)
+{
+	m_d->m_BodyReader=Reader;
+}
+
+void MusicBrainz5::CHTTPFetch::SetRequestHeader(const std::string& Name, const std::string& Value)
+{
+	m_d->m_RequestHeaders[Name]=Value;
+}
+
+std::string MusicBrainz5::CHTTPFetch::SessionKey() const
+{
+	std::stringstream os;
+
+	os << m_d->m_Host << ":" << m_d->m_Port << "|";
+	os << m_d->m_ProxyHost << ":" << m_d->m_ProxyPort << "|";
+	os << m_d->m_UserName << "|" << m_d->m_ProxyUserName;
+
+	return os.str();
+}
+
+MusicBrainz5::CHTTPSession *MusicBrainz5::CHTTPFetch::CreateSession()
+{
 	ne_session *sess=ne_session_create("http", m_d->m_Host.c_str(), m_d->m_Port);
+
+	CHTTPSession *Session=new CHTTPSession(SessionKey(),sess);
+
 	if (sess)
 	{
-		ne_set_useragent(sess, m_d->m_UserAgent.c_str());
+		//The callbacks are registered once for the lifetime of the session, and find
+		//the credentials through whichever CHTTPFetch is currently using it
 
-		ne_set_server_auth(sess, httpAuth, this);
+		ne_set_server_auth(sess, httpAuth, Session);
+		ne_hook_post_headers(sess, ReserveBuffer, Session);
 
 		// Use proxy server
 		if (!m_d->m_ProxyHost.empty())
 		{
 			ne_session_proxy(sess, m_d->m_ProxyHost.c_str(), m_d->m_ProxyPort);
-			ne_set_proxy_auth(sess, proxyAuth, this);
+			ne_set_proxy_auth(sess, proxyAuth, Session);
 		}
+	}
+
+	return Session;
+}
+
+int MusicBrainz5::CHTTPFetch::Fetch(const std::string& URL, const std::string& Request)
+{
+	int Ret=0;
+
+	m_d->m_Data.clear();
+	m_d->m_CompressedBytes=0;
+	m_d->m_UncompressedBytes=0;
+	m_d->m_ConnectTime=0;
+	m_d->m_Headers.clear();
+	m_d->m_ReaderFailed=false;
+	m_d->m_ReaderOutOfMemory=false;
+	m_d->m_ReaderError.clear();
+
+	CHTTPSession *Session=0;
+	if (m_d->m_Pool)
+		Session=m_d->m_Pool->m_d->Acquire(SessionKey());
+
+	if (!Session)
+		Session=CreateSession();
+
+	Session->m_Fetch=this;
+	Session->m_Buffer=m_d->m_BodyReader ? 0 : &m_d->m_Data;
+
+	ne_session *sess=Session->m_Session;
+	if (sess)
+	{
+		ne_set_useragent(sess, m_d->m_UserAgent.c_str());
+
+		//Pooled sessions may have been used with other timeouts, so set them every time
+
+		ne_set_connect_timeout(sess, m_d->m_ConnectTimeout);
+		ne_set_read_timeout(sess, m_d->m_ReadTimeout);
 
 		ne_request *req = ne_request_create(sess, Request.c_str(), URL.c_str());
 		if (Request=="PUT")
@@ -188,19 +583,72 @@ int MusicBrainz5::CHTTPFetch::Fetch(const std::string& URL, const std::string& R
 		if (Request!="GET")
 			ne_set_request_flag(req, NE_REQFLAG_IDEMPOTENT, 0);
 
-		ne_add_response_body_reader(req, ne_accept_2xx, httpResponseReader, &m_d->m_Data);
+		std::map<std::string,std::string>::const_iterator ThisHeader=m_d->m_RequestHeaders.begin();
+		while (ThisHeader!=m_d->m_RequestHeaders.end())
+		{
+			ne_add_request_header(req, (*ThisHeader).first.c_str(), (*ThisHeader).second.c_str());
+			++ThisHeader;
+		}
+
+		//The decompressing reader sends Accept-Encoding: gzip and decodes the body as it
+		//arrives. The second reader sees the body as sent, to count the bytes on the wire.
+
+		ne_decompress *Decompress=0;
+
+		if (m_d->m_Compression)
+			Decompress=ne_decompress_reader(req, ne_accept_2xx, httpResponseReader, m_d);
+		else
+			ne_add_response_body_reader(req, ne_accept_2xx, httpResponseReader, m_d);
+
+		ne_add_response_body_reader(req, ne_accept_2xx, httpCountReader, &m_d->m_CompressedBytes);
+
+		//The notifier is per session, so only install it while this request owns it
+
+		CConnectTimer ConnectTimer;
+		ne_set_notifier(sess, ConnectNotifier, &ConnectTimer);
 
 		m_d->m_Result = ne_request_dispatch(req);
 		m_d->m_Status = ne_get_status(req)->code;
 
-		Ret=m_d->m_Data.size();
+		ne_set_notifier(sess, 0, 0);
+		m_d->m_ConnectTime=ConnectTimer.m_Time;
+
+		//neon passes header names in lower case
+
+		const char *Name, *Value;
+		void *Cursor=0;
+		while (0!=(Cursor=ne_response_header_iterate(req, Cursor, &Name, &Value)))
+			m_d->m_Headers[Name]=Value;
+
+		Ret=m_d->m_UncompressedBytes;
+
+		if (Decompress)
+			ne_decompress_destroy(Decompress);
 
 		ne_request_destroy(req);
 
 		m_d->m_ErrorMessage = ne_get_error(sess);
+	}
+
+	//Only hand a session back to the pool if the request completed cleanly, so a
+	//connection in an unknown state is never reused
+
+	if (m_d->m_Pool)
+		m_d->m_Pool->m_d->Release(Session,sess && NE_OK==m_d->m_Result);
+	else
+		delete Session;
 
-		ne_session_destroy(sess);
+	//Exceptions can't be thrown through neon, so one thrown while the body was being
+	//read is caught there and its replacement thrown here
 
+	if (m_d->m_ReaderOutOfMemory)
+		throw std::bad_alloc();
+
+	if (m_d->m_ReaderFailed)
+		throw CFetchError("Error reading response: "+m_d->m_ReaderError);
+
+	if (sess)
+	{
 		switch (m_d->m_Result)
 		{
 			case NE_OK:
@@ -225,26 +673,31 @@ int MusicBrainz5::CHTTPFetch::Fetch(const std::string& URL, const std::string& R
 				break;
 		}
 
-		switch (m_d->m_Status)
+		//Any 2xx status is a success
+
+		if (2!=m_d->m_Status/100)
 		{
-			case 200:
-				break;
+			switch (m_d->m_Status)
+			{
+				case 304:
+					break;
 
-			case 400:
-				throw CRequestError(m_d->m_ErrorMessage);
-				break;
+				case 400:
+					throw CRequestError(m_d->m_ErrorMessage);
+					break;
 
-			case 401:
-				throw CAuthenticationError(m_d->m_ErrorMessage);
-				break;
+				case 401:
+					throw CAuthenticationError(m_d->m_ErrorMessage);
+					break;
 
-			case 404:
-				throw CResourceNotFoundError(m_d->m_ErrorMessage);
-				break;
+				case 404:
+					throw CResourceNotFoundError(m_d->m_ErrorMessage);
+					break;
 
-			default:
-				throw CFetchError(m_d->m_ErrorMessage);
-				break;
+				default:
+					throw CFetchError(m_d->m_ErrorMessage);
+					break;
+			}
 		}
 	}
 
@@ -256,7 +709,7 @@ int MusicBrainz5::CHTTPFetch::httpAuth(void *userdata, const char *realm, int at
 {
 	realm=realm;
 
-	MusicBrainz5::CHTTPFetch *Fetch = (MusicBrainz5::CHTTPFetch *)userdata;
+	MusicBrainz5::CHTTPFetch *Fetch = ((MusicBrainz5::CHTTPSession *)userdata)->m_Fetch;
 	strncpy(username, Fetch->m_d->m_UserName.c_str(), NE_ABUFSIZ);
 	strncpy(password, Fetch->m_d->m_Password.c_str(), NE_ABUFSIZ);
 	return attempts;
@@ -267,7 +720,7 @@ int MusicBrainz5::CHTTPFetch::proxyAuth(void *userdata, const char *realm, int a
 {
 	realm=realm;
 
-	MusicBrainz5::CHTTPFetch *Fetch = (MusicBrainz5::CHTTPFetch *)userdata;
+	MusicBrainz5::CHTTPFetch *Fetch = ((MusicBrainz5::CHTTPSession *)userdata)->m_Fetch;
 	strncpy(username, Fetch->m_d->m_ProxyUserName.c_str(), NE_ABUFSIZ);
 	strncpy(password, Fetch->m_d->m_ProxyPassword.c_str(), NE_ABUFSIZ);
 	return attempts;
@@ -275,9 +728,46 @@ int MusicBrainz5::CHTTPFetch::proxyAuth(void *userdata, const char *realm, int a
 
 int MusicBrainz5::CHTTPFetch::httpResponseReader(void *userdata, const char *buf, size_t len)
 {
-	std::vector<unsigned char> *buffer = reinterpret_cast<std::vector<unsigned char> *>(userdata);
+	MusicBrainz5::CHTTPFetchPrivate *Fetch = reinterpret_cast<MusicBrainz5::CHTTPFetchPrivate *>(userdata);
 
-	buffer->insert(buffer->end(),buf,buf+len);
+	Fetch->m_UncompressedBytes+=len;
+
+	try
+	{
+		if (Fetch->m_BodyReader)
+			return Fetch->m_BodyReader->Read(buf,len) ? 0 : -1;
+
+		Fetch->m_Data.insert(Fetch->m_Data.end(),buf,buf+len);
+	}
+
+	catch (const std::bad_alloc&)
+	{
+		Fetch->m_ReaderOutOfMemory=true;
+		return -1;
+	}
+
+	catch (const std::exception& Error)
+	{
+		Fetch->m_ReaderFailed=true;
+		Fetch->m_ReaderError=Error.what();
+		return -1;
+	}
+
+	catch (...)
+	{
+		Fetch->m_ReaderFailed=true;
+		Fetch->m_ReaderError="unknown exception";
+		return -1;
+	}
+
+	return 0;
+}
+
+int MusicBrainz5::CHTTPFetch::httpCountReader(void *userdata, const char *buf, size_t len)
+{
+	buf=buf;
+
+	*reinterpret_cast<size_t *>(userdata)+=len;
 
 	return 0;
 }
@@ -287,6 +777,32 @@ std::vector<unsigned char> MusicBrainz5::CHTTPFetch::Data() const
 	return m_d->m_Data;
 }
 
+const std::vector<unsigned char>& MusicBrainz5::CHTTPFetch::DataBuffer() const
+{
+	return m_d->m_Data;
+}
+
+void MusicBrainz5::CHTTPFetch::TakeData(std::vector<unsigned char>& Data)
+{
+	Data.clear();
+	Data.swap(m_d->m_Data);
+}
+
+size_t MusicBrainz5::CHTTPFetch::CompressedBytes() const
+{
+	return m_d->m_CompressedBytes;
+}
+
+double MusicBrainz5::CHTTPFetch::ConnectTime() const
+{
+	return m_d->m_ConnectTime;
+}
+
+size_t MusicBrainz5::CHTTPFetch::UncompressedBytes() const
+{
+	return m_d->m_UncompressedBytes;
+}
+
 int MusicBrainz5::CHTTPFetch::Result() const
 {
 	return m_d->m_Result;
@@ -301,3 +817,8 @@ std::string MusicBrainz5::CHTTPFetch::ErrorMessage() const
 {
 	return m_d->m_ErrorMessage;
 }
+
+const std::map<std::string,std::string>& MusicBrainz5::CHTTPFetch::ResponseHeaders() const
+{
+	return m_d->m_Headers;
+}
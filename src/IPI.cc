@@ -95,10 +95,10 @@ void MusicBrainz5::CIPI::ParseAttribute(const std::string& Name, const std::stri
 
 void MusicBrainz5::CIPI::ParseElement(const XMLNode& Node)
 {
-	std::string Name=Node.getName();
-
 #ifdef _MB5_DEBUG_
-	std::cerr << "Unrecognised IPI element: '" << Name << "'" << std::endl;
+	std::cerr << "Unrecognised IPI element: '" << Node.getName() << "'" << std::endl;
+#else
+	(void)Node;
 #endif
 }
 
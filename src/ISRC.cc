@@ -27,6 +27,7 @@
 #include "musicbrainz5/defines.h"
 
 #include "musicbrainz5/ISRC.h"
+#include "musicbrainz5/ElementName.h"
 
 #include "musicbrainz5/RecordingList.h"
 #include "musicbrainz5/Recording.h"
@@ -99,29 +100,33 @@ MusicBrainz5::CISRC *MusicBrainz5::CISRC::Clone()
 
 void MusicBrainz5::CISRC::ParseAttribute(const std::string& Name, const std::string& Value)
 {
-	if ("id"==Name)
-		m_d->m_ID=Value;
-	else
+	switch (CElementName::Lookup(Name))
 	{
+		case CElementName::eName_ID:
+			m_d->m_ID=Value;
+			break;
+
+		default:
 #ifdef _MB5_DEBUG_
-		std::cerr << "Unrecognised isrc attribute: '" << Name << "'" << std::endl;
+			std::cerr << "Unrecognised isrc attribute: '" << Name << "'" << std::endl;
 #endif
+			break;
 	}
 }
 
 void MusicBrainz5::CISRC::ParseElement(const XMLNode& Node)
 {
-	std::string NodeName=Node.getName();
-
-	if ("recording-list"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_RecordingList);
-	}
-	else
+	switch (CElementName::Lookup(Node))
 	{
+		case CElementName::eName_RecordingList:
+			ProcessLazyItem(Node,m_d->m_RecordingList);
+			break;
+
+		default:
 #ifdef _MB5_DEBUG_
-		std::cerr << "Unrecognised ISRC element: '" << NodeName << "'" << std::endl;
+			std::cerr << "Unrecognised ISRC element: '" << Node.getName() << "'" << std::endl;
 #endif
+			break;
 	}
 }
 
@@ -137,6 +142,8 @@ std::string MusicBrainz5::CISRC::ID() const
 
 MusicBrainz5::CRecordingList *MusicBrainz5::CISRC::RecordingList() const
 {
+	Materialise(CElementName::eName_RecordingList);
+
 	return m_d->m_RecordingList;
 }
 
@@ -101,10 +101,10 @@ void MusicBrainz5::CISWC::ParseAttribute(const std::string& Name, const std::str
 
 void MusicBrainz5::CISWC::ParseElement(const XMLNode& Node)
 {
-	std::string NodeName=Node.getName();
-
 #ifdef _MB5_DEBUG_
-	std::cerr << "Unrecognised ISWC element: '" << NodeName << "'" << std::endl;
+	std::cerr << "Unrecognised ISWC element: '" << Node.getName() << "'" << std::endl;
+#else
+	(void)Node;
 #endif
 }
 
@@ -27,6 +27,7 @@
 #include "musicbrainz5/defines.h"
 
 #include "musicbrainz5/Label.h"
+#include "musicbrainz5/ElementName.h"
 
 #include <iostream>
 
@@ -191,87 +192,93 @@ MusicBrainz5::CLabel *MusicBrainz5::CLabel::Clone()
 
 void MusicBrainz5::CLabel::ParseAttribute(const std::string& Name, const std::string& Value)
 {
-	if ("id"==Name)
-		m_d->m_ID=Value;
-	else if ("type"==Name)
-		m_d->m_Type=Value;
-	else
+	switch (CElementName::Lookup(Name))
 	{
+		case CElementName::eName_ID:
+			m_d->m_ID=Value;
+			break;
+
+		case CElementName::eName_Type:
+			m_d->m_Type=Value;
+			break;
+
+		default:
 #ifdef _MB5_DEBUG_
-		std::cerr << "Unrecognised label attribute: '" << Name << "'" << std::endl;
+			std::cerr << "Unrecognised label attribute: '" << Name << "'" << std::endl;
 #endif
+			break;
 	}
 }
 
 void MusicBrainz5::CLabel::ParseElement(const XMLNode& Node)
 {
-	std::string NodeName=Node.getName();
-
-	if ("name"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Name);
-	}
-	else if ("sort-name"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_SortName);
-	}
-	else if ("label-code"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_LabelCode);
-	}
-	else if ("ipi"==NodeName)
-	{
-		//Ignore IPI
-	}
-	else if ("ipi-list"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_IPIList);
-	}
-	else if ("disambiguation"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Disambiguation);
-	}
-	else if ("country"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Country);
-	}
-	else if ("life-span"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Lifespan);
-	}
-	else if ("alias-list"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_AliasList);
-	}
-	else if ("release-list"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_ReleaseList);
-	}
-	else if ("relation-list"==NodeName)
-	{
-		ProcessRelationList(Node,m_d->m_RelationListList);
-	}
-	else if ("tag-list"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_TagList);
-	}
-	else if ("user-tag-list"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_UserTagList);
-	}
-	else if ("rating"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Rating);
-	}
-	else if ("user-rating"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_UserRating);
-	}
-	else
+	switch (CElementName::Lookup(Node))
 	{
+		case CElementName::eName_Name:
+			ProcessItem(Node,m_d->m_Name);
+			break;
+
+		case CElementName::eName_SortName:
+			ProcessItem(Node,m_d->m_SortName);
+			break;
+
+		case CElementName::eName_LabelCode:
+			ProcessItem(Node,m_d->m_LabelCode);
+			break;
+
+		case CElementName::eName_IPI:
+			//Ignore IPI
+			break;
+
+		case CElementName::eName_IPIList:
+			ProcessLazyItem(Node,m_d->m_IPIList);
+			break;
+
+		case CElementName::eName_Disambiguation:
+			ProcessItem(Node,m_d->m_Disambiguation);
+			break;
+
+		case CElementName::eName_Country:
+			ProcessItem(Node,m_d->m_Country);
+			break;
+
+		case CElementName::eName_LifeSpan:
+			ProcessLazyItem(Node,m_d->m_Lifespan);
+			break;
+
+		case CElementName::eName_AliasList:
+			ProcessLazyItem(Node,m_d->m_AliasList);
+			break;
+
+		case CElementName::eName_ReleaseList:
+			ProcessLazyItem(Node,m_d->m_ReleaseList);
+			break;
+
+		case CElementName::eName_RelationList:
+			ProcessRelationList(Node,m_d->m_RelationListList);
+			break;
+
+		case CElementName::eName_TagList:
+			ProcessLazyItem(Node,m_d->m_TagList);
+			break;
+
+		case CElementName::eName_UserTagList:
+			ProcessLazyItem(Node,m_d->m_UserTagList);
+			break;
+
+		case CElementName::eName_Rating:
+			ProcessLazyItem(Node,m_d->m_Rating);
+			break;
+
+		case CElementName::eName_UserRating:
+			ProcessLazyItem(Node,m_d->m_UserRating);
+			break;
+
+		default:
 #ifdef _MB5_DEBUG_
-		std::cerr << "Unrecognised label element: '" << NodeName << "'" << std::endl;
+			std::cerr << "Unrecognised label element: '" << Node.getName() << "'" << std::endl;
 #endif
+			break;
 	}
 }
 
@@ -307,6 +314,8 @@ int MusicBrainz5::CLabel::LabelCode() const
 
 MusicBrainz5::CIPIList *MusicBrainz5::CLabel::IPIList() const
 {
+	Materialise(CElementName::eName_IPIList);
+
 	return m_d->m_IPIList;
 }
 
@@ -322,41 +331,57 @@ std::string MusicBrainz5::CLabel::Country() const
 
 MusicBrainz5::CLifespan *MusicBrainz5::CLabel::Lifespan() const
 {
+	Materialise(CElementName::eName_LifeSpan);
+
 	return m_d->m_Lifespan;
 }
 
 MusicBrainz5::CAliasList *MusicBrainz5::CLabel::AliasList() const
 {
+	Materialise(CElementName::eName_AliasList);
+
 	return m_d->m_AliasList;
 }
 
 MusicBrainz5::CReleaseList *MusicBrainz5::CLabel::ReleaseList() const
 {
+	Materialise(CElementName::eName_ReleaseList);
+
 	return m_d->m_ReleaseList;
 }
 
 MusicBrainz5::CRelationListList *MusicBrainz5::CLabel::RelationListList() const
 {
+	Materialise(CElementName::eName_RelationList);
+
 	return m_d->m_RelationListList;
 }
 
 MusicBrainz5::CTagList *MusicBrainz5::CLabel::TagList() const
 {
+	Materialise(CElementName::eName_TagList);
+
 	return m_d->m_TagList;
 }
 
 MusicBrainz5::CUserTagList *MusicBrainz5::CLabel::UserTagList() const
 {
+	Materialise(CElementName::eName_UserTagList);
+
 	return m_d->m_UserTagList;
 }
 
 MusicBrainz5::CRating *MusicBrainz5::CLabel::Rating() const
 {
+	Materialise(CElementName::eName_Rating);
+
 	return m_d->m_Rating;
 }
 
 MusicBrainz5::CUserRating *MusicBrainz5::CLabel::UserRating() const
 {
+	Materialise(CElementName::eName_UserRating);
+
 	return m_d->m_UserRating;
 }
 
@@ -27,6 +27,7 @@
 #include "musicbrainz5/defines.h"
 
 #include "musicbrainz5/LabelInfo.h"
+#include "musicbrainz5/ElementName.h"
 
 #include "musicbrainz5/Label.h"
 
@@ -107,21 +108,21 @@ void MusicBrainz5::CLabelInfo::ParseAttribute(const std::string& Name, const std
 
 void MusicBrainz5::CLabelInfo::ParseElement(const XMLNode& Node)
 {
-	std::string NodeName=Node.getName();
-
-	if ("catalog-number"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_CatalogNumber);
-	}
-	else if ("label"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Label);
-	}
-	else
+	switch (CElementName::Lookup(Node))
 	{
+		case CElementName::eName_CatalogNumber:
+			ProcessItem(Node,m_d->m_CatalogNumber);
+			break;
+
+		case CElementName::eName_Label:
+			ProcessLazyItem(Node,m_d->m_Label);
+			break;
+
+		default:
 #ifdef _MB5_DEBUG_
-		std::cerr << "Unrecognised label info element: '" << NodeName << "'" << std::endl;
+			std::cerr << "Unrecognised label info element: '" << Node.getName() << "'" << std::endl;
 #endif
+			break;
 	}
 }
 
@@ -137,6 +138,8 @@ std::string MusicBrainz5::CLabelInfo::CatalogNumber() const
 
 MusicBrainz5::CLabel *MusicBrainz5::CLabelInfo::Label() const
 {
+	Materialise(CElementName::eName_Label);
+
 	return m_d->m_Label;
 }
 
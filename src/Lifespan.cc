@@ -27,6 +27,7 @@
 #include "musicbrainz5/defines.h"
 
 #include "musicbrainz5/Lifespan.h"
+#include "musicbrainz5/ElementName.h"
 
 class MusicBrainz5::CLifespanPrivate
 {
@@ -90,25 +91,25 @@ void MusicBrainz5::CLifespan::ParseAttribute(const std::string& Name, const std:
 
 void MusicBrainz5::CLifespan::ParseElement(const XMLNode& Node)
 {
-	std::string NodeName=Node.getName();
-
-	if ("begin"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Begin);
-	}
-	else if ("end"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_End);
-	}
-	else if ("ended"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Ended);
-	}
-	else
+	switch (CElementName::Lookup(Node))
 	{
+		case CElementName::eName_Begin:
+			ProcessItem(Node,m_d->m_Begin);
+			break;
+
+		case CElementName::eName_End:
+			ProcessItem(Node,m_d->m_End);
+			break;
+
+		case CElementName::eName_Ended:
+			ProcessItem(Node,m_d->m_Ended);
+			break;
+
+		default:
 #ifdef _MB5_DEBUG_
-		std::cerr << "Unrecognised lifespan element: '" << NodeName << "'" << std::endl;
+			std::cerr << "Unrecognised lifespan element: '" << Node.getName() << "'" << std::endl;
 #endif
+			break;
 	}
 }
 
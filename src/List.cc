@@ -27,6 +27,7 @@
 #include "musicbrainz5/defines.h"
 
 #include "musicbrainz5/List.h"
+#include "musicbrainz5/ElementName.h"
 
 #include <vector>
 
@@ -103,24 +104,30 @@ MusicBrainz5::CList *MusicBrainz5::CList::Clone()
 
 void MusicBrainz5::CList::ParseAttribute(const std::string& Name, const std::string& Value)
 {
-	if ("offset"==Name)
-		ProcessItem(Value,m_d->m_Offset);
-	else if ("count"==Name)
-		ProcessItem(Value,m_d->m_Count);
-	else
+	switch (CElementName::Lookup(Name))
 	{
+		case CElementName::eName_Offset:
+			ProcessItem(Value,m_d->m_Offset);
+			break;
+
+		case CElementName::eName_Count:
+			ProcessItem(Value,m_d->m_Count);
+			break;
+
+		default:
 #ifdef _MB5_DEBUG_
-		std::cerr << "Unrecognised list attribute: '" << Name << "'" << std::endl;
+			std::cerr << "Unrecognised list attribute: '" << Name << "'" << std::endl;
 #endif
+			break;
 	}
 }
 
 void MusicBrainz5::CList::ParseElement(const XMLNode& Node)
 {
-	std::string NodeName=Node.getName();
-
 #ifdef _MB5_DEBUG_
-	std::cerr << "Unrecognised list element: '" << NodeName << "'" << std::endl;
+	std::cerr << "Unrecognised list element: '" << Node.getName() << "'" << std::endl;
+#else
+	(void)Node;
 #endif
 }
 
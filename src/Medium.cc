@@ -27,6 +27,7 @@
 #include "musicbrainz5/defines.h"
 
 #include "musicbrainz5/Medium.h"
+#include "musicbrainz5/ElementName.h"
 
 #include "musicbrainz5/Disc.h"
 #include "musicbrainz5/DiscList.h"
@@ -123,33 +124,33 @@ void MusicBrainz5::CMedium::ParseAttribute(const std::string& Name, const std::s
 
 void MusicBrainz5::CMedium::ParseElement(const XMLNode& Node)
 {
-	std::string NodeName=Node.getName();
-
-	if ("title"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Title);
-	}
-	else if ("position"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Position);
-	}
-	else if ("format"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Format);
-	}
-	else if ("disc-list"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_DiscList);
-	}
-	else if ("track-list"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_TrackList);
-	}
-	else
+	switch (CElementName::Lookup(Node))
 	{
+		case CElementName::eName_Title:
+			ProcessItem(Node,m_d->m_Title);
+			break;
+
+		case CElementName::eName_Position:
+			ProcessItem(Node,m_d->m_Position);
+			break;
+
+		case CElementName::eName_Format:
+			ProcessItem(Node,m_d->m_Format);
+			break;
+
+		case CElementName::eName_DiscList:
+			ProcessLazyItem(Node,m_d->m_DiscList);
+			break;
+
+		case CElementName::eName_TrackList:
+			ProcessLazyItem(Node,m_d->m_TrackList);
+			break;
+
+		default:
 #ifdef _MB5_DEBUG_
-		std::cerr << "Unrecognised medium element: '" << NodeName << "'" << std::endl;
+			std::cerr << "Unrecognised medium element: '" << Node.getName() << "'" << std::endl;
 #endif
+			break;
 	}
 }
 
@@ -175,11 +176,15 @@ std::string MusicBrainz5::CMedium::Format() const
 
 MusicBrainz5::CDiscList *MusicBrainz5::CMedium::DiscList() const
 {
+	Materialise(CElementName::eName_DiscList);
+
 	return m_d->m_DiscList;
 }
 
 MusicBrainz5::CTrackList *MusicBrainz5::CMedium::TrackList() const
 {
+	Materialise(CElementName::eName_TrackList);
+
 	return m_d->m_TrackList;
 }
 
@@ -187,11 +192,12 @@ bool MusicBrainz5::CMedium::ContainsDiscID(const std::string& DiscID) const
 {
 	bool RetVal=false;
 
-	if (m_d->m_DiscList)
+	CDiscList *Discs=DiscList();
+	if (Discs)
 	{
-		for (int count=0;!RetVal && count<m_d->m_DiscList->NumItems();count++)
+		for (int count=0;!RetVal && count<Discs->NumItems();count++)
 		{
-			CDisc *Disc=m_d->m_DiscList->Item(count);
+			CDisc *Disc=Discs->Item(count);
 
 			if (Disc->ID()==DiscID)
 				RetVal=true;
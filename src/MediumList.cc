@@ -27,6 +27,7 @@
 #include "musicbrainz5/defines.h"
 
 #include "musicbrainz5/MediumList.h"
+#include "musicbrainz5/ElementName.h"
 
 #include "musicbrainz5/Medium.h"
 
@@ -89,15 +90,15 @@ void MusicBrainz5::CMediumList::ParseAttribute(const std::string& Name, const st
 
 void MusicBrainz5::CMediumList::ParseElement(const XMLNode& Node)
 {
-	std::string NodeName=Node.getName();
-
-	if ("track-count"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_TrackCount);
-	}
-	else
+	switch (CElementName::Lookup(Node))
 	{
-		CListImpl<CMedium>::ParseElement(Node);
+		case CElementName::eName_TrackCount:
+			ProcessItem(Node,m_d->m_TrackCount);
+			break;
+
+		default:
+			CListImpl<CMedium>::ParseElement(Node);
+			break;
 	}
 }
 
@@ -27,6 +27,7 @@
 #include "musicbrainz5/defines.h"
 
 #include "musicbrainz5/Message.h"
+#include "musicbrainz5/ElementName.h"
 
 class MusicBrainz5::CMessagePrivate
 {
@@ -86,15 +87,17 @@ void MusicBrainz5::CMessage::ParseAttribute(const std::string& Name, const std::
 
 void MusicBrainz5::CMessage::ParseElement(const XMLNode& Node)
 {
-	std::string NodeName=Node.getName();
-
-	if (NodeName=="text")
-		ProcessItem(Node,m_d->m_Text);
-	else
+	switch (CElementName::Lookup(Node))
 	{
+		case CElementName::eName_Text:
+			ProcessItem(Node,m_d->m_Text);
+			break;
+
+		default:
 #ifdef _MB5_DEBUG_
-		std::cerr << "Unrecognised message element: '" << NodeName << "'" << std::endl;
+			std::cerr << "Unrecognised message element: '" << Node.getName() << "'" << std::endl;
 #endif
+			break;
 	}
 }
 
@@ -27,6 +27,7 @@
 #include "musicbrainz5/defines.h"
 
 #include "musicbrainz5/Metadata.h"
+#include "musicbrainz5/ElementName.h"
 
 #include "musicbrainz5/Artist.h"
 #include "musicbrainz5/ArtistList.h"
@@ -350,141 +351,189 @@ MusicBrainz5::CMetadata *MusicBrainz5::CMetadata::Clone()
 	return new CMetadata(*this);
 }
 
+void MusicBrainz5::CMetadata::MaterialiseAll()
+{
+	//A lazily parsed document always has the metadata at its root, so the whole
+	//object can be rebuilt from it. The document stays alive until the rebuilt
+	//object replaces this one.
+
+	const XMLNode *Document=LazyDocument();
+	if (Document)
+	{
+		CMetadata Metadata(*Document);
+		*this=Metadata;
+	}
+}
+
+void MusicBrainz5::CMetadata::Detach(CArtist *& Item)
+{
+	Item=Artist();
+	m_d->m_Artist=0;
+}
+
+void MusicBrainz5::CMetadata::Detach(CRecording *& Item)
+{
+	Item=Recording();
+	m_d->m_Recording=0;
+}
+
+void MusicBrainz5::CMetadata::Detach(CRelease *& Item)
+{
+	Item=Release();
+	m_d->m_Release=0;
+}
+
+void MusicBrainz5::CMetadata::Detach(CReleaseGroup *& Item)
+{
+	Item=ReleaseGroup();
+	m_d->m_ReleaseGroup=0;
+}
+
 void MusicBrainz5::CMetadata::ParseAttribute(const std::string& Name, const std::string& Value)
 {
-	if ("xmlns"==Name)
-		m_d->m_XMLNS=Value;
-	else if ("xmlns:ext"==Name)
-		m_d->m_XMLNSExt=Value;
-	else if ("generator"==Name)
-		m_d->m_Generator=Value;
-	else if ("created"==Name)
-		m_d->m_Created=Value;
-	else
+	switch (CElementName::Lookup(Name))
 	{
+		case CElementName::eName_XMLNS:
+			m_d->m_XMLNS=Value;
+			break;
+
+		case CElementName::eName_XMLNSExt:
+			m_d->m_XMLNSExt=Value;
+			break;
+
+		case CElementName::eName_Generator:
+			m_d->m_Generator=Value;
+			break;
+
+		case CElementName::eName_Created:
+			m_d->m_Created=Value;
+			break;
+
+		default:
 #ifdef _MB5_DEBUG_
-		std::cerr << "Unrecognised metadata attribute: '" << Name << "'" << std::endl;
+			std::cerr << "Unrecognised metadata attribute: '" << Name << "'" << std::endl;
 #endif
+			break;
 	}
 }
 
 void MusicBrainz5::CMetadata::ParseElement(const XMLNode& Node)
 {
-	std::string NodeName=Node.getName();
-
-	if ("artist"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Artist);
-	}
-	else if ("release"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Release);
-	}
-	else if ("release-group"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_ReleaseGroup);
-	}
-	else if ("recording"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Recording);
-	}
-	else if ("label"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Label);
-	}
-	else if ("work"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Work);
-	}
-	else if ("puid"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_PUID);
-	}
-	else if ("isrc"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_ISRC);
-	}
-	else if ("disc"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Disc);
-	}
-	else if ("rating"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Rating);
-	}
-	else if ("user-rating"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_UserRating);
-	}
-	else if ("collection"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Collection);
-	}
-	else if ("artist-list"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_ArtistList);
-	}
-	else if ("release-list"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_ReleaseList);
-	}
-	else if ("release-group-list"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_ReleaseGroupList);
-	}
-	else if ("recording-list"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_RecordingList);
-	}
-	else if ("label-list"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_LabelList);
-	}
-	else if ("work-list"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_WorkList);
-	}
-	else if ("isrc-list"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_ISRCList);
-	}
-	else if ("annotation-list"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_AnnotationList);
-	}
-	else if ("cdstub-list"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_CDStubList);
-	}
-	else if ("freedb-disc-list"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_FreeDBDiscList);
-	}
-	else if ("tag-list"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_TagList);
-	}
-	else if ("user-tag-list"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_UserTagList);
-	}
-	else if ("collection-list"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_CollectionList);
-	}
-	else if ("cdstub"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_CDStub);
-	}
-	else if ("message"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Message);
-	}
-	else
+	switch (CElementName::Lookup(Node))
 	{
+		case CElementName::eName_Artist:
+			ProcessLazyItem(Node,m_d->m_Artist);
+			break;
+
+		case CElementName::eName_Release:
+			ProcessLazyItem(Node,m_d->m_Release);
+			break;
+
+		case CElementName::eName_ReleaseGroup:
+			ProcessLazyItem(Node,m_d->m_ReleaseGroup);
+			break;
+
+		case CElementName::eName_Recording:
+			ProcessLazyItem(Node,m_d->m_Recording);
+			break;
+
+		case CElementName::eName_Label:
+			ProcessLazyItem(Node,m_d->m_Label);
+			break;
+
+		case CElementName::eName_Work:
+			ProcessLazyItem(Node,m_d->m_Work);
+			break;
+
+		case CElementName::eName_PUID:
+			ProcessLazyItem(Node,m_d->m_PUID);
+			break;
+
+		case CElementName::eName_ISRC:
+			ProcessLazyItem(Node,m_d->m_ISRC);
+			break;
+
+		case CElementName::eName_Disc:
+			ProcessLazyItem(Node,m_d->m_Disc);
+			break;
+
+		case CElementName::eName_Rating:
+			ProcessLazyItem(Node,m_d->m_Rating);
+			break;
+
+		case CElementName::eName_UserRating:
+			ProcessLazyItem(Node,m_d->m_UserRating);
+			break;
+
+		case CElementName::eName_Collection:
+			ProcessLazyItem(Node,m_d->m_Collection);
+			break;
+
+		case CElementName::eName_ArtistList:
+			ProcessLazyItem(Node,m_d->m_ArtistList);
+			break;
+
+		case CElementName::eName_ReleaseList:
+			ProcessLazyItem(Node,m_d->m_ReleaseList);
+			break;
+
+		case CElementName::eName_ReleaseGroupList:
+			ProcessLazyItem(Node,m_d->m_ReleaseGroupList);
+			break;
+
+		case CElementName::eName_RecordingList:
+			ProcessLazyItem(Node,m_d->m_RecordingList);
+			break;
+
+		case CElementName::eName_LabelList:
+			ProcessLazyItem(Node,m_d->m_LabelList);
+			break;
+
+		case CElementName::eName_WorkList:
+			ProcessLazyItem(Node,m_d->m_WorkList);
+			break;
+
+		case CElementName::eName_ISRCList:
+			ProcessLazyItem(Node,m_d->m_ISRCList);
+			break;
+
+		case CElementName::eName_AnnotationList:
+			ProcessLazyItem(Node,m_d->m_AnnotationList);
+			break;
+
+		case CElementName::eName_CDStubList:
+			ProcessLazyItem(Node,m_d->m_CDStubList);
+			break;
+
+		case CElementName::eName_FreeDBDiscList:
+			ProcessLazyItem(Node,m_d->m_FreeDBDiscList);
+			break;
+
+		case CElementName::eName_TagList:
+			ProcessLazyItem(Node,m_d->m_TagList);
+			break;
+
+		case CElementName::eName_UserTagList:
+			ProcessLazyItem(Node,m_d->m_UserTagList);
+			break;
+
+		case CElementName::eName_CollectionList:
+			ProcessLazyItem(Node,m_d->m_CollectionList);
+			break;
+
+		case CElementName::eName_CDStub:
+			ProcessLazyItem(Node,m_d->m_CDStub);
+			break;
+
+		case CElementName::eName_Message:
+			ProcessLazyItem(Node,m_d->m_Message);
+			break;
+
+		default:
 #ifdef _MB5_DEBUG_
-		std::cerr << "Unrecognised metadata element: '" << NodeName << "'" << std::endl;
+			std::cerr << "Unrecognised metadata element: '" << Node.getName() << "'" << std::endl;
 #endif
+			break;
 	}
 }
 
@@ -515,46 +564,64 @@ std::string MusicBrainz5::CMetadata::Created() const
 
 MusicBrainz5::CArtist *MusicBrainz5::CMetadata::Artist() const
 {
+	Materialise(CElementName::eName_Artist);
+
 	return m_d->m_Artist;
 }
 
 MusicBrainz5::CRelease *MusicBrainz5::CMetadata::Release() const
 {
+	Materialise(CElementName::eName_Release);
+
 	return m_d->m_Release;
 }
 
 MusicBrainz5::CReleaseGroup *MusicBrainz5::CMetadata::ReleaseGroup() const
 {
+	Materialise(CElementName::eName_ReleaseGroup);
+
 	return m_d->m_ReleaseGroup;
 }
 
 MusicBrainz5::CRecording *MusicBrainz5::CMetadata::Recording() const
 {
+	Materialise(CElementName::eName_Recording);
+
 	return m_d->m_Recording;
 }
 
 MusicBrainz5::CLabel *MusicBrainz5::CMetadata::Label() const
 {
+	Materialise(CElementName::eName_Label);
+
 	return m_d->m_Label;
 }
 
 MusicBrainz5::CWork *MusicBrainz5::CMetadata::Work() const
 {
+	Materialise(CElementName::eName_Work);
+
 	return m_d->m_Work;
 }
 
 MusicBrainz5::CPUID *MusicBrainz5::CMetadata::PUID() const
 {
+	Materialise(CElementName::eName_PUID);
+
 	return m_d->m_PUID;
 }
 
 MusicBrainz5::CISRC *MusicBrainz5::CMetadata::ISRC() const
 {
+	Materialise(CElementName::eName_ISRC);
+
 	return m_d->m_ISRC;
 }
 
 MusicBrainz5::CDisc *MusicBrainz5::CMetadata::Disc() const
 {
+	Materialise(CElementName::eName_Disc);
+
 	return m_d->m_Disc;
 }
 
@@ -565,91 +632,127 @@ MusicBrainz5::CLabelInfoList *MusicBrainz5::CMetadata::LabelInfoList() const
 
 MusicBrainz5::CRating *MusicBrainz5::CMetadata::Rating() const
 {
+	Materialise(CElementName::eName_Rating);
+
 	return m_d->m_Rating;
 }
 
 MusicBrainz5::CUserRating *MusicBrainz5::CMetadata::UserRating() const
 {
+	Materialise(CElementName::eName_UserRating);
+
 	return m_d->m_UserRating;
 }
 
 MusicBrainz5::CCollection *MusicBrainz5::CMetadata::Collection() const
 {
+	Materialise(CElementName::eName_Collection);
+
 	return m_d->m_Collection;
 }
 
 MusicBrainz5::CArtistList *MusicBrainz5::CMetadata::ArtistList() const
 {
+	Materialise(CElementName::eName_ArtistList);
+
 	return m_d->m_ArtistList;
 }
 
 MusicBrainz5::CReleaseList *MusicBrainz5::CMetadata::ReleaseList() const
 {
+	Materialise(CElementName::eName_ReleaseList);
+
 	return m_d->m_ReleaseList;
 }
 
 MusicBrainz5::CReleaseGroupList *MusicBrainz5::CMetadata::ReleaseGroupList() const
 {
+	Materialise(CElementName::eName_ReleaseGroupList);
+
 	return m_d->m_ReleaseGroupList;
 }
 
 MusicBrainz5::CRecordingList *MusicBrainz5::CMetadata::RecordingList() const
 {
+	Materialise(CElementName::eName_RecordingList);
+
 	return m_d->m_RecordingList;
 }
 
 MusicBrainz5::CLabelList *MusicBrainz5::CMetadata::LabelList() const
 {
+	Materialise(CElementName::eName_LabelList);
+
 	return m_d->m_LabelList;
 }
 
 MusicBrainz5::CWorkList *MusicBrainz5::CMetadata::WorkList() const
 {
+	Materialise(CElementName::eName_WorkList);
+
 	return m_d->m_WorkList;
 }
 
 MusicBrainz5::CISRCList *MusicBrainz5::CMetadata::ISRCList() const
 {
+	Materialise(CElementName::eName_ISRCList);
+
 	return m_d->m_ISRCList;
 }
 
 MusicBrainz5::CAnnotationList *MusicBrainz5::CMetadata::AnnotationList() const
 {
+	Materialise(CElementName::eName_AnnotationList);
+
 	return m_d->m_AnnotationList;
 }
 
 MusicBrainz5::CCDStubList *MusicBrainz5::CMetadata::CDStubList() const
 {
+	Materialise(CElementName::eName_CDStubList);
+
 	return m_d->m_CDStubList;
 }
 
 MusicBrainz5::CFreeDBDiscList *MusicBrainz5::CMetadata::FreeDBDiscList() const
 {
+	Materialise(CElementName::eName_FreeDBDiscList);
+
 	return m_d->m_FreeDBDiscList;
 }
 
 MusicBrainz5::CTagList *MusicBrainz5::CMetadata::TagList() const
 {
+	Materialise(CElementName::eName_TagList);
+
 	return m_d->m_TagList;
 }
 
 MusicBrainz5::CUserTagList *MusicBrainz5::CMetadata::UserTagList() const
 {
+	Materialise(CElementName::eName_UserTagList);
+
 	return m_d->m_UserTagList;
 }
 
 MusicBrainz5::CCollectionList *MusicBrainz5::CMetadata::CollectionList() const
 {
+	Materialise(CElementName::eName_CollectionList);
+
 	return m_d->m_CollectionList;
 }
 
 MusicBrainz5::CCDStub *MusicBrainz5::CMetadata::CDStub() const
 {
+	Materialise(CElementName::eName_CDStub);
+
 	return m_d->m_CDStub;
 }
 
 MusicBrainz5::CMessage *MusicBrainz5::CMetadata::Message() const
 {
+	Materialise(CElementName::eName_Message);
+
 	return m_d->m_Message;
 }
 
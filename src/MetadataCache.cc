@@ -0,0 +1,445 @@
+/* --------------------------------------------------------------------------
+
+   libmusicbrainz5 - Client library to access MusicBrainz
+
+   Copyright (C) 2012 Andrew Hawkins
+
+   This file is part of libmusicbrainz5.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   libmusicbrainz5 is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+     $Id$
+
+----------------------------------------------------------------------------*/
+
+#include "config.h"
+#include "musicbrainz5/defines.h"
+
+#include "musicbrainz5/MetadataCache.h"
+#include "MonotonicTime.h"
+
+#include <list>
+#include <map>
+
+#include <pthread.h>
+
+//A cached response, which is never changed once it has been stored. Lookups take a
+//reference to it and copy it once the cache's lock has been released, so that one
+//large copy does not hold up every other thread using the cache. The reference count
+//is only changed with the cache's lock held.
+
+class CCachedMetadata
+{
+	public:
+		CCachedMetadata(const MusicBrainz5::CMetadata& Metadata)
+		:	m_Metadata(Metadata),
+			m_RefCount(1)
+		{
+		}
+
+		const MusicBrainz5::CMetadata m_Metadata;
+		int m_RefCount;
+};
+
+class CMetadataCacheEntry
+{
+	public:
+		CMetadataCacheEntry()
+		:	m_Metadata(0)
+		{
+		}
+
+		CCachedMetadata *m_Metadata;
+		size_t m_Bytes;
+		double m_Expires;
+		std::string m_ETag;
+		std::string m_LastModified;
+		bool m_NotFound;
+		std::list<std::string>::iterator m_Use;
+};
+
+class MusicBrainz5::CMetadataCachePrivate
+{
+	public:
+		CMetadataCachePrivate()
+		:	m_MaxEntries(1000),
+			m_MaxBytes(16*1024*1024),
+			m_DefaultTTL(3600),
+			m_NotFoundTTL(600),
+			m_Bytes(0),
+			m_Hits(0),
+			m_Misses(0),
+			m_Evictions(0)
+		{
+			pthread_mutex_init(&m_Lock,0);
+		}
+
+		~CMetadataCachePrivate()
+		{
+			while (!m_Entries.empty())
+				Erase(m_Entries.begin());
+
+			pthread_mutex_destroy(&m_Lock);
+		}
+
+		void Release(CCachedMetadata *Metadata);
+		void Erase(std::map<std::string,CMetadataCacheEntry>::iterator Entry);
+		void Trim();
+		int TTL(const std::string& Query) const;
+		CMetadataCacheEntry *Insert(const std::string& Query, int TTL, size_t Bytes);
+
+		int m_MaxEntries;
+		size_t m_MaxBytes;
+		int m_DefaultTTL;
+		int m_NotFoundTTL;
+		std::map<std::string,int> m_TTLs;
+		std::map<std::string,CMetadataCacheEntry> m_Entries;
+
+		//Most recently used at the front
+
+		std::list<std::string> m_Uses;
+		size_t m_Bytes;
+		int m_Hits;
+		int m_Misses;
+		int m_Evictions;
+		mutable pthread_mutex_t m_Lock;
+};
+
+//Drop a reference to a cached response, deleting it if it was the last. Must be called
+//without the lock held.
+
+void MusicBrainz5::CMetadataCachePrivate::Release(CCachedMetadata *Metadata)
+{
+	if (Metadata)
+	{
+		pthread_mutex_lock(&m_Lock);
+		bool Last=(0==--Metadata->m_RefCount);
+		pthread_mutex_unlock(&m_Lock);
+
+		if (Last)
+			delete Metadata;
+	}
+}
+
+//Must be called with the lock held
+
+void MusicBrainz5::CMetadataCachePrivate::Erase(std::map<std::string,CMetadataCacheEntry>::iterator Entry)
+{
+	CCachedMetadata *Metadata=(*Entry).second.m_Metadata;
+	if (Metadata && 0==--Metadata->m_RefCount)
+		delete Metadata;
+
+	m_Bytes-=(*Entry).second.m_Bytes;
+	m_Uses.erase((*Entry).second.m_Use);
+	m_Entries.erase(Entry);
+}
+
+//Discard least recently used entries until the cache is within its limits. Must be
+//called with the lock held.
+
+void MusicBrainz5::CMetadataCachePrivate::Trim()
+{
+	while (!m_Uses.empty() && ((int)m_Entries.size()>m_MaxEntries || m_Bytes>m_MaxBytes))
+	{
+		Erase(m_Entries.find(m_Uses.back()));
+		m_Evictions++;
+	}
+}
+
+//Return the time to live for a query. Must be called with the lock held.
+
+int MusicBrainz5::CMetadataCachePrivate::TTL(const std::string& Query) const
+{
+	std::map<std::string,int>::const_iterator ThisTTL=m_TTLs.find(CMetadataCache::Entity(Query));
+	if (m_TTLs.end()!=ThisTTL)
+		return (*ThisTTL).second;
+
+	return m_DefaultTTL;
+}
+
+//Replace the entry for a query with a new one, which is returned for the caller to
+//fill in. Returns NULL if the entry should not be cached. Must be called with the lock
+//held, and the caller must call Trim once the entry is filled in.
+
+CMetadataCacheEntry *MusicBrainz5::CMetadataCachePrivate::Insert(const std::string& Query, int TTL, size_t Bytes)
+{
+	std::map<std::string,CMetadataCacheEntry>::iterator Entry=m_Entries.find(Query);
+	if (m_Entries.end()!=Entry)
+		Erase(Entry);
+
+	if (TTL<=0 || Bytes>m_MaxBytes)
+		return 0;
+
+	m_Uses.push_front(Query);
+
+	CMetadataCacheEntry& NewEntry=m_Entries[Query];
+	NewEntry.m_Bytes=Bytes;
+	NewEntry.m_Expires=MonotonicTime()+TTL;
+	NewEntry.m_NotFound=false;
+	NewEntry.m_Use=m_Uses.begin();
+
+	m_Bytes+=Bytes;
+
+	return &NewEntry;
+}
+
+MusicBrainz5::CMetadataCache::CMetadataCache(int MaxEntries, size_t MaxBytes)
+:	m_d(new CMetadataCachePrivate)
+{
+	m_d->m_MaxEntries=MaxEntries;
+	m_d->m_MaxBytes=MaxBytes;
+}
+
+MusicBrainz5::CMetadataCache::~CMetadataCache()
+{
+	delete m_d;
+}
+
+void MusicBrainz5::CMetadataCache::SetLimits(int MaxEntries, size_t MaxBytes)
+{
+	pthread_mutex_lock(&m_d->m_Lock);
+
+	m_d->m_MaxEntries=MaxEntries;
+	m_d->m_MaxBytes=MaxBytes;
+	m_d->Trim();
+
+	pthread_mutex_unlock(&m_d->m_Lock);
+}
+
+void MusicBrainz5::CMetadataCache::SetDefaultTTL(int Seconds)
+{
+	pthread_mutex_lock(&m_d->m_Lock);
+	m_d->m_DefaultTTL=Seconds;
+	pthread_mutex_unlock(&m_d->m_Lock);
+}
+
+void MusicBrainz5::CMetadataCache::SetTTL(const std::string& Entity, int Seconds)
+{
+	pthread_mutex_lock(&m_d->m_Lock);
+	m_d->m_TTLs[Entity]=Seconds;
+	pthread_mutex_unlock(&m_d->m_Lock);
+}
+
+void MusicBrainz5::CMetadataCache::SetNotFoundTTL(int Seconds)
+{
+	pthread_mutex_lock(&m_d->m_Lock);
+	m_d->m_NotFoundTTL=Seconds;
+	pthread_mutex_unlock(&m_d->m_Lock);
+}
+
+bool MusicBrainz5::CMetadataCache::Get(const std::string& Query, CMetadata& Metadata)
+{
+	bool NotFound=false;
+
+	return Get(Query,Metadata,NotFound) && !NotFound;
+}
+
+bool MusicBrainz5::CMetadataCache::Get(const std::string& Query, CMetadata& Metadata, bool& NotFound)
+{
+	bool Found=false;
+	CCachedMetadata *Cached=0;
+	NotFound=false;
+
+	pthread_mutex_lock(&m_d->m_Lock);
+
+	std::map<std::string,CMetadataCacheEntry>::iterator Entry=m_d->m_Entries.find(Query);
+	if (m_d->m_Entries.end()!=Entry)
+	{
+		if ((*Entry).second.m_Expires>MonotonicTime())
+		{
+			m_d->m_Uses.splice(m_d->m_Uses.begin(),m_d->m_Uses,(*Entry).second.m_Use);
+			NotFound=(*Entry).second.m_NotFound;
+			if (!NotFound)
+			{
+				Cached=(*Entry).second.m_Metadata;
+				Cached->m_RefCount++;
+			}
+
+			Found=true;
+		}
+		else if ((*Entry).second.m_ETag.empty() && (*Entry).second.m_LastModified.empty())
+			m_d->Erase(Entry);
+	}
+
+	if (Found)
+		m_d->m_Hits++;
+	else
+		m_d->m_Misses++;
+
+	pthread_mutex_unlock(&m_d->m_Lock);
+
+	if (Cached)
+	{
+		Metadata=Cached->m_Metadata;
+		m_d->Release(Cached);
+	}
+
+	return Found;
+}
+
+bool MusicBrainz5::CMetadataCache::GetStale(const std::string& Query, CMetadata& Metadata, std::string& ETag, std::string& LastModified)
+{
+	CCachedMetadata *Cached=0;
+
+	pthread_mutex_lock(&m_d->m_Lock);
+
+	std::map<std::string,CMetadataCacheEntry>::iterator Entry=m_d->m_Entries.find(Query);
+	if (m_d->m_Entries.end()!=Entry && (!(*Entry).second.m_ETag.empty() || !(*Entry).second.m_LastModified.empty()))
+	{
+		m_d->m_Uses.splice(m_d->m_Uses.begin(),m_d->m_Uses,(*Entry).second.m_Use);
+		Cached=(*Entry).second.m_Metadata;
+		Cached->m_RefCount++;
+		ETag=(*Entry).second.m_ETag;
+		LastModified=(*Entry).second.m_LastModified;
+	}
+
+	pthread_mutex_unlock(&m_d->m_Lock);
+
+	if (!Cached)
+		return false;
+
+	Metadata=Cached->m_Metadata;
+	m_d->Release(Cached);
+
+	return true;
+}
+
+void MusicBrainz5::CMetadataCache::Put(const std::string& Query, const CMetadata& Metadata, size_t Bytes, const std::string& ETag, const std::string& LastModified)
+{
+	CCachedMetadata *Cached=new CCachedMetadata(Metadata);
+
+	pthread_mutex_lock(&m_d->m_Lock);
+
+	CMetadataCacheEntry *NewEntry=m_d->Insert(Query,m_d->TTL(Query),Bytes);
+	if (NewEntry)
+	{
+		NewEntry->m_Metadata=Cached;
+		NewEntry->m_ETag=ETag;
+		NewEntry->m_LastModified=LastModified;
+		Cached=0;
+
+		m_d->Trim();
+	}
+
+	pthread_mutex_unlock(&m_d->m_Lock);
+
+	delete Cached;
+}
+
+void MusicBrainz5::CMetadataCache::PutNotFound(const std::string& Query)
+{
+	pthread_mutex_lock(&m_d->m_Lock);
+
+	CMetadataCacheEntry *NewEntry=m_d->Insert(Query,m_d->m_NotFoundTTL,0);
+	if (NewEntry)
+	{
+		NewEntry->m_NotFound=true;
+
+		m_d->Trim();
+	}
+
+	pthread_mutex_unlock(&m_d->m_Lock);
+}
+
+void MusicBrainz5::CMetadataCache::Touch(const std::string& Query)
+{
+	pthread_mutex_lock(&m_d->m_Lock);
+
+	std::map<std::string,CMetadataCacheEntry>::iterator Entry=m_d->m_Entries.find(Query);
+	if (m_d->m_Entries.end()!=Entry && !(*Entry).second.m_NotFound)
+		(*Entry).second.m_Expires=MonotonicTime()+m_d->TTL(Query);
+
+	pthread_mutex_unlock(&m_d->m_Lock);
+}
+
+void MusicBrainz5::CMetadataCache::Remove(const std::string& Query)
+{
+	pthread_mutex_lock(&m_d->m_Lock);
+
+	std::map<std::string,CMetadataCacheEntry>::iterator Entry=m_d->m_Entries.find(Query);
+	if (m_d->m_Entries.end()!=Entry)
+		m_d->Erase(Entry);
+
+	pthread_mutex_unlock(&m_d->m_Lock);
+}
+
+void MusicBrainz5::CMetadataCache::Clear()
+{
+	pthread_mutex_lock(&m_d->m_Lock);
+
+	while (!m_d->m_Entries.empty())
+		m_d->Erase(m_d->m_Entries.begin());
+
+	pthread_mutex_unlock(&m_d->m_Lock);
+}
+
+int MusicBrainz5::CMetadataCache::NumEntries() const
+{
+	pthread_mutex_lock(&m_d->m_Lock);
+	int NumEntries=m_d->m_Entries.size();
+	pthread_mutex_unlock(&m_d->m_Lock);
+
+	return NumEntries;
+}
+
+size_t MusicBrainz5::CMetadataCache::Bytes() const
+{
+	pthread_mutex_lock(&m_d->m_Lock);
+	size_t Bytes=m_d->m_Bytes;
+	pthread_mutex_unlock(&m_d->m_Lock);
+
+	return Bytes;
+}
+
+int MusicBrainz5::CMetadataCache::Hits() const
+{
+	pthread_mutex_lock(&m_d->m_Lock);
+	int Hits=m_d->m_Hits;
+	pthread_mutex_unlock(&m_d->m_Lock);
+
+	return Hits;
+}
+
+int MusicBrainz5::CMetadataCache::Misses() const
+{
+	pthread_mutex_lock(&m_d->m_Lock);
+	int Misses=m_d->m_Misses;
+	pthread_mutex_unlock(&m_d->m_Lock);
+
+	return Misses;
+}
+
+int MusicBrainz5::CMetadataCache::Evictions() const
+{
+	pthread_mutex_lock(&m_d->m_Lock);
+	int Evictions=m_d->m_Evictions;
+	pthread_mutex_unlock(&m_d->m_Lock);
+
+	return Evictions;
+}
+
+std::string MusicBrainz5::CMetadataCache::Entity(const std::string& Query)
+{
+	static const std::string Prefix="/ws/2/";
+
+	std::string::size_type Start=0;
+	if (0==Query.compare(0,Prefix.length(),Prefix))
+		Start=Prefix.length();
+
+	std::string::size_type End=Query.find_first_of("/?",Start);
+	if (std::string::npos==End)
+		End=Query.length();
+
+	return Query.substr(Start,End-Start);
+}
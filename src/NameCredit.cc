@@ -27,6 +27,7 @@
 #include "musicbrainz5/defines.h"
 
 #include "musicbrainz5/NameCredit.h"
+#include "musicbrainz5/ElementName.h"
 
 #include "musicbrainz5/Artist.h"
 
@@ -100,33 +101,37 @@ MusicBrainz5::CNameCredit *MusicBrainz5::CNameCredit::Clone()
 
 void MusicBrainz5::CNameCredit::ParseAttribute(const std::string& Name, const std::string& Value)
 {
-	if ("joinphrase"==Name)
-		m_d->m_JoinPhrase=Value;
-	else
+	switch (CElementName::Lookup(Name))
 	{
+		case CElementName::eName_Joinphrase:
+			m_d->m_JoinPhrase=Value;
+			break;
+
+		default:
 #ifdef _MB5_DEBUG_
-		std::cerr << "Unrecognised namecredit attribute: '" << Name << "'" << std::endl;
+			std::cerr << "Unrecognised namecredit attribute: '" << Name << "'" << std::endl;
 #endif
+			break;
 	}
 }
 
 void MusicBrainz5::CNameCredit::ParseElement(const XMLNode& Node)
 {
-	std::string NodeName=Node.getName();
-
-	if ("name"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Name);
-	}
-	else if ("artist"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Artist);
-	}
-	else
+	switch (CElementName::Lookup(Node))
 	{
+		case CElementName::eName_Name:
+			ProcessItem(Node,m_d->m_Name);
+			break;
+
+		case CElementName::eName_Artist:
+			ProcessLazyItem(Node,m_d->m_Artist);
+			break;
+
+		default:
 #ifdef _MB5_DEBUG_
-		std::cerr << "Unrecognised name credit element: '" << NodeName << "'" << std::endl;
+			std::cerr << "Unrecognised name credit element: '" << Node.getName() << "'" << std::endl;
 #endif
+			break;
 	}
 }
 
@@ -147,6 +152,8 @@ std::string MusicBrainz5::CNameCredit::Name() const
 
 MusicBrainz5::CArtist *MusicBrainz5::CNameCredit::Artist() const
 {
+	Materialise(CElementName::eName_Artist);
+
 	return m_d->m_Artist;
 }
 
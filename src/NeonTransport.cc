@@ -0,0 +1,210 @@
+/* --------------------------------------------------------------------------
+
+   libmusicbrainz5 - Client library to access MusicBrainz
+
+   Copyright (C) 2012 Andrew Hawkins
+
+   This file is part of libmusicbrainz5.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   libmusicbrainz5 is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+     $Id$
+
+----------------------------------------------------------------------------*/
+
+#include "config.h"
+#include "musicbrainz5/defines.h"
+
+#include "musicbrainz5/NeonTransport.h"
+
+#include <cmath>
+
+static void CopyResponse(const MusicBrainz5::CHTTPFetch& Fetch, MusicBrainz5::CTransportResponse& Response)
+{
+	Response.SetStatus(Fetch.Status());
+	Response.SetErrorMessage(Fetch.ErrorMessage());
+	Response.SetConnectTime(Fetch.ConnectTime());
+	Response.SetWireBytes(Fetch.CompressedBytes());
+
+	const std::map<std::string,std::string>& Headers=Fetch.ResponseHeaders();
+
+	std::map<std::string,std::string>::const_iterator ThisHeader=Headers.begin();
+	while (ThisHeader!=Headers.end())
+	{
+		Response.SetHeader((*ThisHeader).first,(*ThisHeader).second);
+
+		++ThisHeader;
+	}
+}
+
+class MusicBrainz5::CNeonTransportPrivate
+{
+	public:
+		CNeonTransportPrivate()
+		:	m_Port(80),
+			m_ProxyPort(0),
+			m_Compression(true),
+			m_ConnectTimeout(30),
+			m_ReadTimeout(60)
+		{
+		}
+
+		std::string m_UserAgent;
+		std::string m_Host;
+		int m_Port;
+		std::string m_UserName;
+		std::string m_Password;
+		std::string m_ProxyHost;
+		int m_ProxyPort;
+		std::string m_ProxyUserName;
+		std::string m_ProxyPassword;
+		bool m_Compression;
+		int m_ConnectTimeout;
+		int m_ReadTimeout;
+		CHTTPSessionPool m_SessionPool;
+};
+
+MusicBrainz5::CNeonTransport::CNeonTransport(const std::string& UserAgent, const std::string& Host, int Port)
+:	m_d(new CNeonTransportPrivate)
+{
+	m_d->m_UserAgent=UserAgent;
+	m_d->m_Host=Host;
+	m_d->m_Port=Port;
+}
+
+MusicBrainz5::CNeonTransport::~CNeonTransport()
+{
+	delete m_d;
+}
+
+void MusicBrainz5::CNeonTransport::SetUserName(const std::string& UserName)
+{
+	m_d->m_UserName=UserName;
+}
+
+void MusicBrainz5::CNeonTransport::SetPassword(const std::string& Password)
+{
+	m_d->m_Password=Password;
+}
+
+void MusicBrainz5::CNeonTransport::SetProxyHost(const std::string& ProxyHost)
+{
+	m_d->m_ProxyHost=ProxyHost;
+}
+
+void MusicBrainz5::CNeonTransport::SetProxyPort(int ProxyPort)
+{
+	m_d->m_ProxyPort=ProxyPort;
+}
+
+void MusicBrainz5::CNeonTransport::SetProxyUserName(const std::string& ProxyUserName)
+{
+	m_d->m_ProxyUserName=ProxyUserName;
+}
+
+void MusicBrainz5::CNeonTransport::SetProxyPassword(const std::string& ProxyPassword)
+{
+	m_d->m_ProxyPassword=ProxyPassword;
+}
+
+void MusicBrainz5::CNeonTransport::SetCompression(bool Compression)
+{
+	m_d->m_Compression=Compression;
+}
+
+void MusicBrainz5::CNeonTransport::SetConnectTimeout(int Seconds)
+{
+	m_d->m_ConnectTimeout=Seconds;
+}
+
+void MusicBrainz5::CNeonTransport::SetReadTimeout(int Seconds)
+{
+	m_d->m_ReadTimeout=Seconds;
+}
+
+MusicBrainz5::CHTTPSessionPool& MusicBrainz5::CNeonTransport::SessionPool()
+{
+	return m_d->m_SessionPool;
+}
+
+void MusicBrainz5::CNeonTransport::Fetch(const CTransportRequest& Request, CTransportResponse& Response)
+{
+	CHTTPFetch Fetch(m_d->m_UserAgent,m_d->m_Host,m_d->m_Port);
+
+	Fetch.SetSessionPool(&m_d->m_SessionPool);
+	Fetch.SetCompression(m_d->m_Compression);
+	Fetch.SetBodyReader(&Response);
+
+	//neon can only time out individual operations, not the whole request, so the best
+	//that can be done with a time limit is to make sure no single step outlasts it
+
+	int ConnectTimeout=m_d->m_ConnectTimeout;
+	int ReadTimeout=m_d->m_ReadTimeout;
+
+	if (Request.Timeout()>0)
+	{
+		int Limit=(int)ceil(Request.Timeout());
+
+		if (ConnectTimeout<=0 || ConnectTimeout>Limit)
+			ConnectTimeout=Limit;
+
+		if (ReadTimeout<=0 || ReadTimeout>Limit)
+			ReadTimeout=Limit;
+	}
+
+	Fetch.SetConnectTimeout(ConnectTimeout);
+	Fetch.SetReadTimeout(ReadTimeout);
+
+	std::map<std::string,std::string>::const_iterator ThisHeader=Request.Headers().begin();
+	while (ThisHeader!=Request.Headers().end())
+	{
+		Fetch.SetRequestHeader((*ThisHeader).first,(*ThisHeader).second);
+		++ThisHeader;
+	}
+
+	//Only override settings that have been made, so that any proxy picked up from
+	//the environment by CHTTPFetch is kept
+
+	if (!m_d->m_UserName.empty())
+		Fetch.SetUserName(m_d->m_UserName);
+
+	if (!m_d->m_Password.empty())
+		Fetch.SetPassword(m_d->m_Password);
+
+	if (!m_d->m_ProxyHost.empty())
+		Fetch.SetProxyHost(m_d->m_ProxyHost);
+
+	if (0!=m_d->m_ProxyPort)
+		Fetch.SetProxyPort(m_d->m_ProxyPort);
+
+	if (!m_d->m_ProxyUserName.empty())
+		Fetch.SetProxyUserName(m_d->m_ProxyUserName);
+
+	if (!m_d->m_ProxyPassword.empty())
+		Fetch.SetProxyPassword(m_d->m_ProxyPassword);
+
+	try
+	{
+		Fetch.Fetch(Request.URL(),Request.Method());
+	}
+
+	catch (CExceptionBase& Error)
+	{
+		CopyResponse(Fetch,Response);
+
+		throw;
+	}
+
+	CopyResponse(Fetch,Response);
+}
@@ -27,6 +27,7 @@
 #include "musicbrainz5/defines.h"
 
 #include "musicbrainz5/NonMBTrack.h"
+#include "musicbrainz5/ElementName.h"
 
 class MusicBrainz5::CNonMBTrackPrivate
 {
@@ -95,25 +96,25 @@ void MusicBrainz5::CNonMBTrack::ParseAttribute(const std::string& Name, const st
 
 void MusicBrainz5::CNonMBTrack::ParseElement(const XMLNode& Node)
 {
-	std::string NodeName=Node.getName();
-
-	if ("title"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Title);
-	}
-	else if ("artist"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Artist);
-	}
-	else if ("length"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Length);
-	}
-	else
+	switch (CElementName::Lookup(Node))
 	{
+		case CElementName::eName_Title:
+			ProcessItem(Node,m_d->m_Title);
+			break;
+
+		case CElementName::eName_Artist:
+			ProcessItem(Node,m_d->m_Artist);
+			break;
+
+		case CElementName::eName_Length:
+			ProcessItem(Node,m_d->m_Length);
+			break;
+
+		default:
 #ifdef _MB5_DEBUG_
-		std::cerr << "Unrecognised non MB track element: '" << NodeName << "'" << std::endl;
+			std::cerr << "Unrecognised non MB track element: '" << Node.getName() << "'" << std::endl;
 #endif
+			break;
 	}
 }
 
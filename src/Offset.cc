@@ -27,6 +27,7 @@
 #include "musicbrainz5/defines.h"
 
 #include "musicbrainz5/Offset.h"
+#include "musicbrainz5/ElementName.h"
 
 class MusicBrainz5::COffsetPrivate
 {
@@ -96,13 +97,17 @@ MusicBrainz5::COffset *MusicBrainz5::COffset::Clone()
 
 void MusicBrainz5::COffset::ParseAttribute(const std::string& Name, const std::string& Value)
 {
-	if ("position"==Name)
-		ProcessItem(Value,m_d->m_Position);
-	else
+	switch (CElementName::Lookup(Name))
 	{
+		case CElementName::eName_Position:
+			ProcessItem(Value,m_d->m_Position);
+			break;
+
+		default:
 #ifdef _MB5_DEBUG_
-		std::cerr << "Unrecognised offset attribute: '" << Name << "'" << std::endl;
+			std::cerr << "Unrecognised offset attribute: '" << Name << "'" << std::endl;
 #endif
+			break;
 	}
 }
 
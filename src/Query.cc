@@ -35,50 +35,1087 @@
 #include <sstream>
 #include <iostream>
 #include <cstdlib>
+#include <cmath>
 
-#include <string.h>
-#include <unistd.h>
-#include <sys/time.h>
+#include <pthread.h>
+#include <time.h>
 
 #include <ne_uri.h>
+#include <ne_dates.h>
 
 #include "musicbrainz5/HTTPFetch.h"
+#include "musicbrainz5/RateLimiter.h"
+#include "musicbrainz5/MetadataCache.h"
+#include "musicbrainz5/DiskCache.h"
+#include "musicbrainz5/NeonTransport.h"
+#include "musicbrainz5/QueryExecutor.h"
+#include "musicbrainz5/QueryFuture.h"
+#include "musicbrainz5/TimingHistogram.h"
+#include "musicbrainz5/TraceHook.h"
 #include "musicbrainz5/Disc.h"
 #include "musicbrainz5/Message.h"
 #include "musicbrainz5/ReleaseList.h"
 #include "musicbrainz5/Release.h"
+#include "musicbrainz5/Artist.h"
+#include "musicbrainz5/Recording.h"
+#include "musicbrainz5/ReleaseGroup.h"
+#include "MonotonicTime.h"
+
+static std::string FullUserAgent(const std::string& UserAgent)
+{
+	std::string FullUserAgent=UserAgent;
+	if (!FullUserAgent.empty())
+		FullUserAgent+=" ";
+	FullUserAgent+=PACKAGE "/v" VERSION;
+
+	return FullUserAgent;
+}
+
+//A query currently being fetched. Identical queries made while it is in flight wait
+//on its future rather than fetching the same thing again.
+
+class CQueryFlight
+{
+	public:
+		CQueryFlight()
+		:	m_Waiters(0)
+		{
+		}
+
+		MusicBrainz5::CQueryFuture m_Future;
+		int m_Waiters;
+};
+
+class CXMLBodyReader;
 
 class MusicBrainz5::CQueryPrivate
 {
-	public:
-		CQueryPrivate()
-		:	m_Port(80),
-			m_ProxyPort(0),
-			m_LastResult(CQuery::eQuery_Success),
-			m_LastHTTPCode(200)
+	public:
+		CQueryPrivate(const std::string& UserAgent, const std::string& Server, int Port)
+		:	m_UserAgent(UserAgent),
+			m_Server(Server),
+			m_Port(Port),
+			m_LastResult(CQuery::eQuery_Success),
+			m_LastHTTPCode(200),
+			m_RateLimiter(0),
+			m_NeonTransport(FullUserAgent(UserAgent),Server,Port),
+			m_Transport(0),
+			m_TraceHook(0),
+			m_Cache(0),
+			m_DiskCache(0),
+			m_MaxRetries(3),
+			m_RetryInitialDelay(1),
+			m_RetryMaxDelay(60),
+			m_RetryMultiplier(2),
+			m_QueryTimeout(0),
+			m_StreamingParser(false),
+			m_LazyParsing(false),
+			m_RetryCount(0),
+			m_RetryBackoff(0),
+			m_RetrySeed((unsigned int)time(0)^(unsigned int)(size_t)this),
+			m_CoalescedCount(0),
+			m_RevalidatedCount(0),
+			m_TotalWireBytes(0),
+			m_TotalBodyBytes(0),
+			m_NextRequestID(1)
+		{
+			pthread_mutex_init(&m_RetryLock,0);
+			pthread_mutex_init(&m_FlightLock,0);
+			pthread_mutex_init(&m_StatsLock,0);
+		}
+
+		~CQueryPrivate()
+		{
+			pthread_mutex_destroy(&m_StatsLock);
+			pthread_mutex_destroy(&m_FlightLock);
+			pthread_mutex_destroy(&m_RetryLock);
+		}
+
+		std::string m_UserAgent;
+		std::string m_Server;
+		int m_Port;
+		CQuery::tQueryResult m_LastResult;
+		int m_LastHTTPCode;
+		std::string m_LastErrorMessage;
+		CQueryStats m_LastStats;
+		CRateLimiter *m_RateLimiter;
+		CNeonTransport m_NeonTransport;
+		CTransport *m_Transport;
+		CTraceHook *m_TraceHook;
+		CMetadataCache *m_Cache;
+		CDiskCache *m_DiskCache;
+		int m_MaxRetries;
+		double m_RetryInitialDelay;
+		double m_RetryMaxDelay;
+		double m_RetryMultiplier;
+		double m_QueryTimeout;
+		bool m_StreamingParser;
+		bool m_LazyParsing;
+		int m_RetryCount;
+		double m_RetryBackoff;
+		unsigned int m_RetrySeed;
+		pthread_mutex_t m_RetryLock;
+		std::map<std::string,CQueryFlight> m_Flights;
+		int m_CoalescedCount;
+		int m_RevalidatedCount;
+		pthread_mutex_t m_FlightLock;
+		CTimingHistogram m_Timings[CQueryStats::eTiming_Count];
+		size_t m_TotalWireBytes;
+		size_t m_TotalBodyBytes;
+		unsigned long m_NextRequestID;
+		pthread_mutex_t m_StatsLock;
+
+		//Declared last so that it is destroyed first, and any queries still running
+		//on its worker threads finish while the rest of this object is intact
+
+		CQueryExecutor m_Executor;
+
+		CRateLimiter *RateLimiter() const;
+		CTransport *Transport();
+		double RetryDelay(int Attempt, const CTransportResponse& Response);
+		double Deadline(double Timeout) const;
+		size_t LoadQuery(const std::string& Query, CMetadata& Metadata, std::string& ETag, std::string& LastModified, CQuery::tQueryResult& Result, int& HTTPCode, std::string& ErrorMessage, CQueryStats& Stats, double Deadline);
+		size_t ReadDiskCache(const std::string& Query, CMetadata& Metadata, std::string& ETag, std::string& LastModified, CQueryStats& Stats);
+		size_t FetchQuery(const std::string& Query, CMetadata& Metadata, std::string& ETag, std::string& LastModified, bool& NotModified, CQuery::tQueryResult& Result, int& HTTPCode, std::string& ErrorMessage, CQueryStats& Stats, double Deadline);
+		void RecordTransfer(const CTransportResponse& Response, const CXMLBodyReader& Reader, double Start, CQueryStats& Stats);
+		void RecordParse(const CXMLBodyReader& Reader, CQueryStats& Stats);
+		void RecordStats(double Start, CQueryStats& Stats);
+		void EndFlight(const std::string& Query, CQueryFuture& Future, const CMetadata& Metadata, CQuery::tQueryResult Result, int HTTPCode, const std::string& ErrorMessage);
+		void PerformQuery(const std::string& Query, CMetadata& Metadata, CQuery::tQueryResult& Result, int& HTTPCode, std::string& ErrorMessage, CQueryStats& Stats, double Deadline, bool Throw=true);
+		void ResolveQuery(const std::string& Query, CMetadata& Metadata, CQuery::tQueryResult& Result, int& HTTPCode, std::string& ErrorMessage, CQueryStats& Stats, double Deadline, bool Throw);
+		void PerformQueryAsync(const std::string& Query, CQueryFuture& Future, double Deadline);
+		void RunAsync(const std::string& Query, CQueryFuture& Future, double Deadline);
+
+		template <class T>
+		void LookupEntities(CQuery& Query, const std::string& Entity, const std::vector<std::string>& IDs, const std::string& Includes,
+												CListImpl<T>& Entities, std::vector<CQuery::tQueryResult>& Results);
+};
+
+//Feeds the response body into the XML parser as it is received, so parsing overlaps
+//with the transfer and the body is never buffered.
+//
+//In streaming mode the body is buffered instead, and read once it is complete straight
+//into the metadata, without a document being built for it.
+//
+//In lazy mode the document is handed over to the metadata, which builds entities from
+//it as they are asked for
+
+class CXMLBodyReader: public MusicBrainz5::CHTTPBodyReader
+{
+	public:
+		CXMLBodyReader(MusicBrainz5::CTraceHook *TraceHook, unsigned long RequestID, bool Streaming, bool Lazy, std::vector<char> *Copy=0)
+		:	m_Parser(Lazy),
+			m_TraceHook(TraceHook),
+			m_RequestID(RequestID),
+			m_Streaming(Streaming && !Lazy),
+			m_Lazy(Lazy),
+			m_Copy(Copy),
+			m_Length(0),
+			m_FirstByte(0),
+			m_ParseTime(0),
+			m_BuildTime(0)
+		{
+		}
+
+		virtual bool Read(const char *Data, size_t Length)
+		{
+			double Start=MusicBrainz5::MonotonicTime();
+			if (0==m_FirstByte)
+				m_FirstByte=Start;
+
+			if (m_Streaming)
+			{
+				m_Body.insert(m_Body.end(),Data,Data+Length);
+				m_Length+=Length;
+				return true;
+			}
+
+			if (m_TraceHook)
+				m_TraceHook->Begin(m_RequestID,MusicBrainz5::CTraceHook::eSpan_Parse,"");
+
+			m_Parser.parseChunk(Data,Length);
+			m_Length+=Length;
+
+			if (m_TraceHook)
+				m_TraceHook->End(m_RequestID,MusicBrainz5::CTraceHook::eSpan_Parse);
+
+			m_ParseTime+=MusicBrainz5::MonotonicTime()-Start;
+
+			if (m_Copy)
+				m_Copy->insert(m_Copy->end(),Data,Data+Length);
+
+			return true;
+		}
+
+		//Finish parsing and fill in the metadata. Returns false if the body was not
+		//a valid metadata document.
+
+		bool Parse(MusicBrainz5::CMetadata& Metadata)
+		{
+			if (m_Streaming)
+				return ParseStream(Metadata);
+
+			bool Parsed=false;
+
+			double Start=MusicBrainz5::MonotonicTime();
+
+			if (m_TraceHook)
+				m_TraceHook->Begin(m_RequestID,MusicBrainz5::CTraceHook::eSpan_Parse,"");
+
+			XMLResults Results;
+			XMLNode *TopNode = m_Parser.finish(&Results);
+
+			if (m_TraceHook)
+			{
+				m_TraceHook->End(m_RequestID,MusicBrainz5::CTraceHook::eSpan_Parse);
+				m_TraceHook->Begin(m_RequestID,MusicBrainz5::CTraceHook::eSpan_Build,"");
+			}
+
+			double Finished=MusicBrainz5::MonotonicTime();
+			m_ParseTime+=Finished-Start;
+
+			if (Results.code==eXMLErrorNone)
+			{
+				XMLNode MetadataNode=*TopNode;
+				if (!MetadataNode.isEmpty())
+				{
+					if (m_Lazy)
+					{
+						Metadata.ParseLazily(TopNode);
+						TopNode=0;
+					}
+					else
+						Metadata.Parse(MetadataNode);
+
+					Parsed=true;
+				}
+			}
+			delete TopNode;
+
+			if (m_TraceHook)
+				m_TraceHook->End(m_RequestID,MusicBrainz5::CTraceHook::eSpan_Build);
+
+			m_BuildTime=MusicBrainz5::MonotonicTime()-Finished;
+
+			return Parsed;
+		}
+
+		size_t Length() const
+		{
+			return m_Length;
+		}
+
+		//When the first block of the body arrived, or 0 if none has
+
+		double FirstByte() const
+		{
+			return m_FirstByte;
+		}
+
+		double ParseTime() const
+		{
+			return m_ParseTime;
+		}
+
+		double BuildTime() const
+		{
+			return m_BuildTime;
+		}
+
+	private:
+		XMLPushParser m_Parser;
+		MusicBrainz5::CTraceHook *m_TraceHook;
+		unsigned long m_RequestID;
+		bool m_Streaming;
+		bool m_Lazy;
+		std::vector<char> m_Body;
+
+		//If set, the body is also copied here so it can be written to the disk cache
+
+		std::vector<char> *m_Copy;
+		size_t m_Length;
+		double m_FirstByte;
+		double m_ParseTime;
+		double m_BuildTime;
+
+		//Parsing and building the metadata happen together here, so all of the time
+		//is reported as parse time
+
+		bool ParseStream(MusicBrainz5::CMetadata& Metadata)
+		{
+			bool Parsed=false;
+
+			double Start=MusicBrainz5::MonotonicTime();
+
+			if (m_TraceHook)
+				m_TraceHook->Begin(m_RequestID,MusicBrainz5::CTraceHook::eSpan_Parse,"");
+
+			if (!m_Body.empty())
+			{
+				XMLStreamParser Parser(&m_Body[0],m_Body.size());
+
+				XMLNode MetadataNode=Parser.root();
+				if (!MetadataNode.isEmpty())
+					Metadata.Parse(MetadataNode);
+
+				//Errors are only found as the parser reaches them, so anything taken
+				//from a document that turns out to be bad is thrown away
+
+				XMLResults Results;
+				if (Parser.finish(&Results) && !MetadataNode.isEmpty())
+					Parsed=true;
+				else
+					Metadata=MusicBrainz5::CMetadata();
+			}
+
+			if (m_TraceHook)
+				m_TraceHook->End(m_RequestID,MusicBrainz5::CTraceHook::eSpan_Parse);
+
+			m_ParseTime=MusicBrainz5::MonotonicTime()-Start;
+			m_BuildTime=0;
+
+			if (m_Copy)
+				m_Copy->swap(m_Body);
+
+			return Parsed;
+		}
+};
+
+class CAsyncQueryJob: public MusicBrainz5::CQueryJob
+{
+	public:
+		CAsyncQueryJob(MusicBrainz5::CQueryPrivate *Query, const std::string& URL, const MusicBrainz5::CQueryFuture& Future, double Deadline)
+		:	m_Query(Query),
+			m_URL(URL),
+			m_Future(Future),
+			m_Deadline(Deadline)
+		{
+		}
+
+		virtual void Run()
+		{
+			m_Query->RunAsync(m_URL,m_Future,m_Deadline);
+		}
+
+	private:
+		MusicBrainz5::CQueryPrivate *m_Query;
+		std::string m_URL;
+		MusicBrainz5::CQueryFuture m_Future;
+		double m_Deadline;
+};
+
+static const char AsyncErrorMessage[]="Query failed";
+
+static const char CachedNotFoundMessage[]="Resource not found (cached)";
+
+static const char DeadlineMessage[]="Query timed out";
+
+static const char LookupReleaseIncludes[]="artists labels recordings release-groups url-rels discids artist-credits";
+
+MusicBrainz5::CRateLimiter *MusicBrainz5::CQueryPrivate::RateLimiter() const
+{
+	if (m_RateLimiter)
+		return m_RateLimiter;
+
+	return CRateLimiter::ServerLimiter(m_Server,m_Port);
+}
+
+MusicBrainz5::CTransport *MusicBrainz5::CQueryPrivate::Transport()
+{
+	if (m_Transport)
+		return m_Transport;
+
+	return &m_NeonTransport;
+}
+
+//Work out how long to wait before retrying a request the server refused with 503 or
+//429. The delay grows exponentially with each attempt, with random jitter so that
+//separate clients do not retry in step, but is never shorter than any Retry-After
+//interval the server asked for, up to the maximum delay.
+
+double MusicBrainz5::CQueryPrivate::RetryDelay(int Attempt, const CTransportResponse& Response)
+{
+	double Delay=m_RetryInitialDelay*pow(m_RetryMultiplier,Attempt);
+	if (Delay>m_RetryMaxDelay)
+		Delay=m_RetryMaxDelay;
+
+	pthread_mutex_lock(&m_RetryLock);
+
+	Delay=Delay/2+Delay/2*(rand_r(&m_RetrySeed)/(RAND_MAX+1.0));
+
+	//Retry-After is either a number of seconds or an HTTP date
+
+	std::string RetryAfter=Response.Header("Retry-After");
+	if (!RetryAfter.empty())
+	{
+		double Seconds=0;
+
+		char *End=0;
+		long Interval=strtol(RetryAfter.c_str(),&End,10);
+		if (End!=RetryAfter.c_str())
+			Seconds=Interval;
+		else
+		{
+			time_t Date=ne_httpdate_parse(RetryAfter.c_str());
+			if ((time_t)-1!=Date)
+				Seconds=difftime(Date,time(0));
+		}
+
+		if (Seconds>m_RetryMaxDelay)
+			Seconds=m_RetryMaxDelay;
+
+		if (Seconds>Delay)
+			Delay=Seconds;
+	}
+
+	m_RetryCount++;
+	m_RetryBackoff+=Delay;
+
+	pthread_mutex_unlock(&m_RetryLock);
+
+	return Delay;
+}
+
+//Work out when a query started now must finish, from the time allowed for it or the
+//default for all queries. Returns 0 if there is no limit.
+
+double MusicBrainz5::CQueryPrivate::Deadline(double Timeout) const
+{
+	if (Timeout<=0)
+		Timeout=m_QueryTimeout;
+
+	if (Timeout<=0)
+		return 0;
+
+	return MonotonicTime()+Timeout;
+}
+
+//Perform a query without touching any of the 'Last' members, so it can be run from any
+//thread. The result fields are only written on failure, matching the behaviour of
+//CQuery::LastResult() and friends. If Throw is false, failures are only reported
+//through the result fields. Stats is always filled in, and added to the histograms.
+//If Deadline is not 0, the query fails with a timeout if it has not finished by then.
+
+void MusicBrainz5::CQueryPrivate::PerformQuery(const std::string& Query, CMetadata& Metadata, CQuery::tQueryResult& Result, int& HTTPCode, std::string& ErrorMessage, CQueryStats& Stats, double Deadline, bool Throw)
+{
+	double Start=MonotonicTime();
+
+	Stats=CQueryStats();
+
+	pthread_mutex_lock(&m_StatsLock);
+	Stats.SetRequestID(m_NextRequestID++);
+	pthread_mutex_unlock(&m_StatsLock);
+
+	CTraceHook *TraceHook=m_TraceHook;
+	if (TraceHook)
+		TraceHook->Begin(Stats.RequestID(),CTraceHook::eSpan_Query,Query);
+
+	try
+	{
+		ResolveQuery(Query,Metadata,Result,HTTPCode,ErrorMessage,Stats,Deadline,Throw);
+	}
+
+	catch (...)
+	{
+		if (TraceHook)
+			TraceHook->End(Stats.RequestID(),CTraceHook::eSpan_Query);
+
+		RecordStats(Start,Stats);
+
+		throw;
+	}
+
+	if (TraceHook)
+		TraceHook->End(Stats.RequestID(),CTraceHook::eSpan_Query);
+
+	RecordStats(Start,Stats);
+}
+
+//Results are taken from the cache if one is installed, including resources that are
+//remembered as not existing. Otherwise, if the same query is already in flight on
+//another thread, wait for it and share its result instead of fetching and parsing it
+//again.
+
+void MusicBrainz5::CQueryPrivate::ResolveQuery(const std::string& Query, CMetadata& Metadata, CQuery::tQueryResult& Result, int& HTTPCode, std::string& ErrorMessage, CQueryStats& Stats, double Deadline, bool Throw)
+{
+	CMetadataCache *Cache=m_Cache;
+	bool NotFound=false;
+
+	if (Cache && Cache->Get(Query,Metadata,NotFound))
+	{
+		Stats.SetSource(CQueryStats::eSource_MemoryCache);
+
+		if (NotFound)
+		{
+			Result=CQuery::eQuery_ResourceNotFound;
+			HTTPCode=404;
+			ErrorMessage=CachedNotFoundMessage;
+
+			if (Throw)
+				throw CResourceNotFoundError(ErrorMessage);
+		}
+
+		return;
+	}
+
+	pthread_mutex_lock(&m_FlightLock);
+
+	std::map<std::string,CQueryFlight>::iterator ThisFlight=m_Flights.find(Query);
+	if (m_Flights.end()!=ThisFlight)
+	{
+		CQueryFuture Future=ThisFlight->second.m_Future;
+		ThisFlight->second.m_Waiters++;
+		m_CoalescedCount++;
+
+		pthread_mutex_unlock(&m_FlightLock);
+
+		Stats.SetSource(CQueryStats::eSource_Coalesced);
+
+		//Only wait for the other query as long as this one is allowed to take
+
+		if (Deadline>0)
+		{
+			double Remaining=Deadline-MonotonicTime();
+
+			if (!Future.WaitFor(Remaining>0 ? (int)ceil(Remaining*1000) : 0))
+			{
+				Result=CQuery::eQuery_Timeout;
+				HTTPCode=0;
+				ErrorMessage=DeadlineMessage;
+
+				if (Throw)
+					throw CTimeoutError(ErrorMessage);
+
+				return;
+			}
+		}
+
+		if (CQuery::eQuery_Success!=Future.Result())
+		{
+			Result=Future.Result();
+			HTTPCode=Future.HTTPCode();
+			ErrorMessage=Future.ErrorMessage();
+
+			//Get throws the exception matching the result
+
+			if (Throw)
+				Future.Get();
+
+			return;
+		}
+
+		Metadata=Future.Get();
+
+		return;
+	}
+
+	CQueryFuture Future;
+	Future.Start();
+	m_Flights[Query].m_Future=Future;
+
+	pthread_mutex_unlock(&m_FlightLock);
+
+	CQuery::tQueryResult FlightResult=CQuery::eQuery_Success;
+	int FlightHTTPCode=200;
+	std::string FlightErrorMessage;
+
+	try
+	{
+		std::string ETag;
+		std::string LastModified;
+
+		size_t Bytes=LoadQuery(Query,Metadata,ETag,LastModified,FlightResult,FlightHTTPCode,FlightErrorMessage,Stats,Deadline);
+
+		//Only cache responses that were parsed successfully
+
+		if (Cache && Bytes)
+			Cache->Put(Query,Metadata,Bytes,ETag,LastModified);
+	}
+
+	catch (...)
+	{
+		if (CQuery::eQuery_Success==FlightResult)
+			FlightResult=CQuery::eQuery_FetchError;
+
+		Result=FlightResult;
+		HTTPCode=FlightHTTPCode;
+		ErrorMessage=FlightErrorMessage;
+
+		if (Cache && CQuery::eQuery_ResourceNotFound==FlightResult)
+			Cache->PutNotFound(Query);
+
+		EndFlight(Query,Future,Metadata,FlightResult,FlightHTTPCode,FlightErrorMessage);
+
+		if (Throw)
+			throw;
+
+		return;
+	}
+
+	EndFlight(Query,Future,Metadata,FlightResult,FlightHTTPCode,FlightErrorMessage);
+}
+
+void MusicBrainz5::CQueryPrivate::EndFlight(const std::string& Query, CQueryFuture& Future, const CMetadata& Metadata, CQuery::tQueryResult Result, int HTTPCode, const std::string& ErrorMessage)
+{
+	pthread_mutex_lock(&m_FlightLock);
+
+	std::map<std::string,CQueryFlight>::iterator ThisFlight=m_Flights.find(Query);
+	int Waiters=ThisFlight->second.m_Waiters;
+	m_Flights.erase(ThisFlight);
+
+	pthread_mutex_unlock(&m_FlightLock);
+
+	//Nobody can join the flight now it has been removed, so the metadata only needs
+	//copying if somebody already has
+
+	if (Waiters && CQuery::eQuery_Success==Result)
+		Future.Target()=Metadata;
+
+	Future.SetResult(Result,HTTPCode,ErrorMessage);
+}
+
+//Look up a query in the disk cache, if there is one. Returns the size of the response
+//if it was found and parsed successfully, or 0 otherwise.
+
+size_t MusicBrainz5::CQueryPrivate::ReadDiskCache(const std::string& Query, CMetadata& Metadata, std::string& ETag, std::string& LastModified, CQueryStats& Stats)
+{
+	CDiskCache *DiskCache=m_DiskCache;
+	if (!DiskCache)
+		return 0;
+
+	//The cached file is mapped, so the document parser reads it straight from the page
+	//cache. The streaming parser copies it first, as it needs the whole body in one
+	//buffer that lasts until parsing has finished.
+
+	CXMLBodyReader Reader(m_TraceHook,Stats.RequestID(),m_StreamingParser,m_LazyParsing);
+	if (!DiskCache->Get(Query,Reader,ETag,LastModified) || !Reader.Parse(Metadata))
+		return 0;
+
+	RecordParse(Reader,Stats);
+
+	return Reader.Length();
+}
+
+//Load a query that is not in the memory cache, from the disk cache or the server. If
+//either cache holds an expired copy with an ETag or Last-Modified date, ask the server
+//whether it has changed and reuse it if not. Returns the size of the response if one
+//was parsed that should be added to the memory cache, or 0 otherwise, along with its
+//validators.
+
+size_t MusicBrainz5::CQueryPrivate::LoadQuery(const std::string& Query, CMetadata& Metadata, std::string& ETag, std::string& LastModified, CQuery::tQueryResult& Result, int& HTTPCode, std::string& ErrorMessage, CQueryStats& Stats, double Deadline)
+{
+	size_t Bytes=ReadDiskCache(Query,Metadata,ETag,LastModified,Stats);
+	if (Bytes)
+	{
+		Stats.SetSource(CQueryStats::eSource_DiskCache);
+		return Bytes;
+	}
+
+	CMetadataCache *Cache=m_Cache;
+	CDiskCache *DiskCache=m_DiskCache;
+
+	CMetadata Stale;
+	bool HaveStale=Cache && Cache->GetStale(Query,Stale,ETag,LastModified);
+	if (!HaveStale && DiskCache)
+		DiskCache->Validators(Query,ETag,LastModified);
+
+	bool NotModified=false;
+	Bytes=FetchQuery(Query,Metadata,ETag,LastModified,NotModified,Result,HTTPCode,ErrorMessage,Stats,Deadline);
+	if (!NotModified)
+		return Bytes;
+
+	pthread_mutex_lock(&m_FlightLock);
+	m_RevalidatedCount++;
+	pthread_mutex_unlock(&m_FlightLock);
+
+	if (DiskCache)
+		DiskCache->Touch(Query);
+
+	if (HaveStale)
+	{
+		Cache->Touch(Query);
+		Metadata=Stale;
+
+		return 0;
+	}
+
+	Bytes=ReadDiskCache(Query,Metadata,ETag,LastModified,Stats);
+	if (Bytes)
+		return Bytes;
+
+	//The cached copy was removed after we read its validators, so fetch it in full
+
+	ETag.clear();
+	LastModified.clear();
+
+	return FetchQuery(Query,Metadata,ETag,LastModified,NotModified,Result,HTTPCode,ErrorMessage,Stats,Deadline);
+}
+
+//Fetch and parse a query, retrying if the server asks us to back off. Returns the size
+//of the response if it was parsed successfully, or 0 otherwise.
+//
+//If ETag or LastModified are set the request is made conditional on them, and
+//NotModified is set if the server replies 304. Otherwise they are replaced with the
+//validators of the new response.
+//
+//If Deadline is not 0, the wait for the rate limiter, any retries and the transfer
+//must all be over by then. Rather than wait for a request that could not be made in
+//time, fail straight away with a timeout. A transport treats a timeout of 0 as no
+//limit at all, so a request is never made once no time is left for it.
+
+size_t MusicBrainz5::CQueryPrivate::FetchQuery(const std::string& Query, CMetadata& Metadata, std::string& ETag, std::string& LastModified, bool& NotModified, CQuery::tQueryResult& Result, int& HTTPCode, std::string& ErrorMessage, CQueryStats& Stats, double Deadline)
+{
+	CTransportRequest Request(Query);
+
+	if (!ETag.empty())
+		Request.SetHeader("If-None-Match",ETag);
+
+	if (!LastModified.empty())
+		Request.SetHeader("If-Modified-Since",LastModified);
+
+	CDiskCache *DiskCache=m_DiskCache;
+	CTraceHook *TraceHook=m_TraceHook;
+
+	Stats.SetSource(CQueryStats::eSource_Network);
+
+	int LastStatus=0;
+
+	for (int Attempt=0;;Attempt++)
+	{
+		if (TraceHook)
+			TraceHook->Begin(Stats.RequestID(),CTraceHook::eSpan_Wait,"");
+
+		bool Permitted=true;
+		double WaitStart=MonotonicTime();
+		double Remaining=0;
+
+		if (Deadline>0)
+			Permitted=Deadline>WaitStart && RateLimiter()->TryWait(Deadline-WaitStart);
+		else
+			RateLimiter()->Wait();
+
+		double WaitEnd=MonotonicTime();
+		Stats.AddTime(CQueryStats::eTiming_Wait,WaitEnd-WaitStart);
+
+		if (TraceHook)
+			TraceHook->End(Stats.RequestID(),CTraceHook::eSpan_Wait);
+
+		if (Permitted && Deadline>0)
+		{
+			Remaining=Deadline-WaitEnd;
+			Permitted=Remaining>0;
+		}
+
+		if (!Permitted)
+		{
+			Result=CQuery::eQuery_Timeout;
+			HTTPCode=LastStatus;
+			ErrorMessage=DeadlineMessage;
+
+			throw CTimeoutError(ErrorMessage);
+		}
+
+		Stats.SetAttempts(Attempt+1);
+
+		if (Deadline>0)
+			Request.SetTimeout(Remaining);
+
+		std::vector<char> Body;
+		CXMLBodyReader Reader(TraceHook,Stats.RequestID(),m_StreamingParser,m_LazyParsing,DiskCache ? &Body : 0);
+		CTransportResponse Response(&Reader);
+
+		try
+		{
+			if (TraceHook)
+				TraceHook->Begin(Stats.RequestID(),CTraceHook::eSpan_Fetch,Query);
+
+			double FetchStart=MonotonicTime();
+
+			try
+			{
+				Transport()->Fetch(Request,Response);
+			}
+
+			catch (...)
+			{
+				RecordTransfer(Response,Reader,FetchStart,Stats);
+
+				if (TraceHook)
+					TraceHook->End(Stats.RequestID(),CTraceHook::eSpan_Fetch);
+
+				throw;
+			}
+
+			RecordTransfer(Response,Reader,FetchStart,Stats);
+
+			if (TraceHook)
+				TraceHook->End(Stats.RequestID(),CTraceHook::eSpan_Fetch);
+
+			CTransport::CheckStatus(Response.Status(),Response.ErrorMessage());
+
+			if (304==Response.Status())
+			{
+				NotModified=true;
+				return 0;
+			}
+
+			ETag=Response.Header("ETag");
+			LastModified=Response.Header("Last-Modified");
+
+#ifdef _MB5_DEBUG_
+			//std::cerr << "Ret: " << Response.Length() << std::endl;
+#endif
+
+			size_t Parsed=0;
+
+			if (Response.Length()>0 && Reader.Parse(Metadata))
+			{
+				RecordParse(Reader,Stats);
+
+				Parsed=Response.Length();
+
+				if (DiskCache)
+					DiskCache->Put(Query,&Body[0],Body.size(),ETag,LastModified);
+			}
+
+			return Parsed;
+		}
+
+		catch (CConnectionError& Error)
+		{
+			Result=CQuery::eQuery_ConnectionError;
+			HTTPCode=Response.Status();
+			ErrorMessage=Response.ErrorMessage();
+
+			throw;
+		}
+
+		catch (CTimeoutError& Error)
+		{
+			Result=CQuery::eQuery_Timeout;
+			HTTPCode=Response.Status();
+			ErrorMessage=Response.ErrorMessage();
+
+			throw;
+		}
+
+		catch (CAuthenticationError& Error)
+		{
+			Result=CQuery::eQuery_AuthenticationError;
+			HTTPCode=Response.Status();
+			ErrorMessage=Response.ErrorMessage();
+
+			throw;
+		}
+
+		catch (CFetchError& Error)
+		{
+			if ((503==Response.Status() || 429==Response.Status()) && Attempt<m_MaxRetries)
+			{
+				//The server is overloaded or we are being throttled. Hold back every
+				//request to the server, not just this one, then try again, unless the
+				//deadline will have passed before the retry could be made.
+
+				double Delay=RetryDelay(Attempt,Response);
+
+				if (Deadline>0 && MonotonicTime()+Delay>=Deadline)
+				{
+					Result=CQuery::eQuery_Timeout;
+					HTTPCode=Response.Status();
+					ErrorMessage=DeadlineMessage;
+
+					throw CTimeoutError(ErrorMessage);
+				}
+
+				RateLimiter()->Penalise(Delay);
+				LastStatus=Response.Status();
+				continue;
+			}
+
+			Result=CQuery::eQuery_FetchError;
+			HTTPCode=Response.Status();
+			ErrorMessage=Response.ErrorMessage();
+
+			throw;
+		}
+
+		catch (CRequestError& Error)
+		{
+			Result=CQuery::eQuery_RequestError;
+			HTTPCode=Response.Status();
+			ErrorMessage=Response.ErrorMessage();
+
+			throw;
+		}
+
+		catch (CResourceNotFoundError& Error)
+		{
+			Result=CQuery::eQuery_ResourceNotFound;
+			HTTPCode=Response.Status();
+			ErrorMessage=Response.ErrorMessage();
+
+			throw;
+		}
+	}
+}
+
+//Split the time taken by a request into connecting, waiting for the first byte of the
+//body, and receiving the rest of it
+
+void MusicBrainz5::CQueryPrivate::RecordTransfer(const CTransportResponse& Response, const CXMLBodyReader& Reader, double Start, CQueryStats& Stats)
+{
+	double End=MonotonicTime();
+	double FirstByte=Reader.FirstByte() ? Reader.FirstByte() : End;
+
+	Stats.SetTime(CQueryStats::eTiming_Connect,Response.ConnectTime());
+	Stats.SetTime(CQueryStats::eTiming_FirstByte,FirstByte-Start-Response.ConnectTime());
+	Stats.SetTime(CQueryStats::eTiming_Transfer,End-FirstByte);
+	Stats.SetWireBytes(Response.WireBytes() ? Response.WireBytes() : Response.Length());
+	Stats.SetBodyBytes(Response.Length());
+}
+
+void MusicBrainz5::CQueryPrivate::RecordParse(const CXMLBodyReader& Reader, CQueryStats& Stats)
+{
+	Stats.SetTime(CQueryStats::eTiming_Parse,Reader.ParseTime());
+	Stats.SetTime(CQueryStats::eTiming_Build,Reader.BuildTime());
+	Stats.SetBodyBytes(Reader.Length());
+}
+
+void MusicBrainz5::CQueryPrivate::RecordStats(double Start, CQueryStats& Stats)
+{
+	Stats.SetTime(CQueryStats::eTiming_Total,MonotonicTime()-Start);
+
+	bool Fetched=Stats.Attempts()>0;
+	bool Parsed=CQueryStats::eSource_Network==Stats.Source() || CQueryStats::eSource_DiskCache==Stats.Source();
+
+	pthread_mutex_lock(&m_StatsLock);
+
+	if (Fetched)
+	{
+		m_Timings[CQueryStats::eTiming_Wait].Add(Stats.Time(CQueryStats::eTiming_Wait));
+		m_Timings[CQueryStats::eTiming_Connect].Add(Stats.Time(CQueryStats::eTiming_Connect));
+		m_Timings[CQueryStats::eTiming_FirstByte].Add(Stats.Time(CQueryStats::eTiming_FirstByte));
+		m_Timings[CQueryStats::eTiming_Transfer].Add(Stats.Time(CQueryStats::eTiming_Transfer));
+		m_TotalWireBytes+=Stats.WireBytes();
+	}
+
+	if (Parsed && Stats.BodyBytes())
+	{
+		m_Timings[CQueryStats::eTiming_Parse].Add(Stats.Time(CQueryStats::eTiming_Parse));
+		m_Timings[CQueryStats::eTiming_Build].Add(Stats.Time(CQueryStats::eTiming_Build));
+		m_TotalBodyBytes+=Stats.BodyBytes();
+	}
+
+	m_Timings[CQueryStats::eTiming_Total].Add(Stats.Time(CQueryStats::eTiming_Total));
+
+	pthread_mutex_unlock(&m_StatsLock);
+}
+
+void MusicBrainz5::CQueryPrivate::PerformQueryAsync(const std::string& Query, CQueryFuture& Future, double Deadline)
+{
+	Future.Start();
+
+	m_Executor.Submit(new CAsyncQueryJob(this,Query,Future,Deadline));
+}
+
+void MusicBrainz5::CQueryPrivate::RunAsync(const std::string& Query, CQueryFuture& Future, double Deadline)
+{
+	CQuery::tQueryResult Result=CQuery::eQuery_Success;
+	int HTTPCode=200;
+	std::string ErrorMessage;
+
+	//Failures are reported through the result, but anything else thrown, such as by
+	//running out of memory or by the trace hook, must still complete the future, or
+	//anybody waiting for it would wait forever
+
+	try
+	{
+		PerformQuery(Query,Future.Target(),Result,HTTPCode,ErrorMessage,Future.TargetStats(),Deadline,false);
+
+		//Copies of the future share the metadata, and may read it from several threads
+		//at once, so nothing may be left to build as it is used
+
+		if (CQuery::eQuery_Success==Result)
+			Future.Target().MaterialiseAll();
+	}
+
+	catch (...)
+	{
+		if (CQuery::eQuery_Success==Result)
 		{
+			Result=CQuery::eQuery_FetchError;
+			HTTPCode=0;
 		}
 
-		std::string m_UserAgent;
-		std::string m_Server;
-		int m_Port;
-		std::string m_UserName;
-		std::string m_Password;
-		std::string m_ProxyHost;
-		int m_ProxyPort;
-		std::string m_ProxyUserName;
-		std::string m_ProxyPassword;
-		CQuery::tQueryResult m_LastResult;
-		int m_LastHTTPCode;
-		std::string m_LastErrorMessage;
-};
+		if (ErrorMessage.empty())
+			ErrorMessage=AsyncErrorMessage;
+	}
+
+	Future.SetResult(Result,HTTPCode,ErrorMessage);
+}
+
+//Look up a list of entities concurrently. Each distinct ID is queued once, and the
+//results are then collected in the order requested.
+//
+//Nothing else reads the metadata of these futures once they have completed, so each
+//entity is taken out of its metadata rather than copied. Only an ID that was asked for
+//more than once needs a copy, for its later entries.
+
+template <class T>
+void MusicBrainz5::CQueryPrivate::LookupEntities(CQuery& Query, const std::string& Entity, const std::vector<std::string>& IDs, const std::string& Includes,
+																									CListImpl<T>& Entities, std::vector<CQuery::tQueryResult>& Results)
+{
+	CQuery::tParamMap Params;
+	if (!Includes.empty())
+		Params["inc"]=Includes;
+
+	std::map<std::string,CQueryFuture> Futures;
+
+	std::vector<std::string>::const_iterator ThisID=IDs.begin();
+	while (ThisID!=IDs.end())
+	{
+		if (Futures.end()==Futures.find(*ThisID))
+			Futures[*ThisID]=Query.QueryAsync(Entity,*ThisID,"",Params);
+
+		++ThisID;
+	}
+
+	std::map<std::string,int> Taken;
+
+	Entities=CListImpl<T>();
+	Results.assign(IDs.size(),CQuery::eQuery_Success);
+
+	for (std::vector<std::string>::size_type count=0;count<IDs.size();count++)
+	{
+		CQueryFuture& Future=Futures[IDs[count]];
+		T *Item=0;
+
+		Results[count]=Future.Result();
+		if (CQuery::eQuery_Success==Results[count])
+		{
+			std::map<std::string,int>::const_iterator First=Taken.find(IDs[count]);
+			if (Taken.end()!=First)
+				Item=new T(*Entities.Item(First->second));
+			else
+			{
+				Future.Target().Detach(Item);
+				if (Item)
+					Taken[IDs[count]]=count;
+				else
+					Results[count]=CQuery::eQuery_FetchError;
+			}
+		}
+
+		if (!Item)
+			Item=new T;
+
+		Entities.AddItem(Item);
+	}
+}
 
 MusicBrainz5::CQuery::CQuery(const std::string& UserAgent, const std::string& Server, int Port)
-:	m_d(new CQueryPrivate)
+:	m_d(new CQueryPrivate(UserAgent,Server,Port))
 {
-	m_d->m_UserAgent=UserAgent;
-	m_d->m_Server=Server;
-	m_d->m_Port=Port;
 }
 
 MusicBrainz5::CQuery::~CQuery()
@@ -88,149 +1125,129 @@ MusicBrainz5::CQuery::~CQuery()
 
 void MusicBrainz5::CQuery::SetUserName(const std::string& UserName)
 {
-	m_d->m_UserName=UserName;
+	m_d->m_NeonTransport.SetUserName(UserName);
 }
 
 void MusicBrainz5::CQuery::SetPassword(const std::string& Password)
 {
-	m_d->m_Password=Password;
+	m_d->m_NeonTransport.SetPassword(Password);
 }
 
 void MusicBrainz5::CQuery::SetProxyHost(const std::string& ProxyHost)
 {
-	m_d->m_ProxyHost=ProxyHost;
+	m_d->m_NeonTransport.SetProxyHost(ProxyHost);
 }
 
 void MusicBrainz5::CQuery::SetProxyPort(int ProxyPort)
 {
-	m_d->m_ProxyPort=ProxyPort;
+	m_d->m_NeonTransport.SetProxyPort(ProxyPort);
 }
 
 void MusicBrainz5::CQuery::SetProxyUserName(const std::string& ProxyUserName)
 {
-	m_d->m_ProxyUserName=ProxyUserName;
+	m_d->m_NeonTransport.SetProxyUserName(ProxyUserName);
 }
 
 void MusicBrainz5::CQuery::SetProxyPassword(const std::string& ProxyPassword)
 {
-	m_d->m_ProxyPassword=ProxyPassword;
+	m_d->m_NeonTransport.SetProxyPassword(ProxyPassword);
 }
 
-MusicBrainz5::CMetadata MusicBrainz5::CQuery::PerformQuery(const std::string& Query)
+void MusicBrainz5::CQuery::SetMaxConnections(int MaxConnections)
 {
-	WaitRequest();
-
-	CMetadata Metadata;
-
-	CHTTPFetch Fetch(UserAgent(),m_d->m_Server,m_d->m_Port);
-
-	if (!m_d->m_UserName.empty())
-		Fetch.SetUserName(m_d->m_UserName);
-
-	if (!m_d->m_Password.empty())
-		Fetch.SetPassword(m_d->m_Password);
-
-	if (!m_d->m_ProxyHost.empty())
-		Fetch.SetProxyHost(m_d->m_ProxyHost);
-
-	if (0!=m_d->m_ProxyPort)
-		Fetch.SetProxyPort(m_d->m_ProxyPort);
-
-	if (!m_d->m_ProxyUserName.empty())
-		Fetch.SetProxyUserName(m_d->m_ProxyUserName);
+	m_d->m_NeonTransport.SessionPool().SetMaxConnections(MaxConnections);
+}
 
-	if (!m_d->m_ProxyPassword.empty())
-		Fetch.SetProxyPassword(m_d->m_ProxyPassword);
+void MusicBrainz5::CQuery::SetConnectionIdleTimeout(int IdleTimeout)
+{
+	m_d->m_NeonTransport.SessionPool().SetIdleTimeout(IdleTimeout);
+}
 
-	try
-	{
-		int Ret=Fetch.Fetch(Query);
+void MusicBrainz5::CQuery::SetCompression(bool Compression)
+{
+	m_d->m_NeonTransport.SetCompression(Compression);
+}
 
-#ifdef _MB5_DEBUG_
-		//std::cerr << "Ret: " << Ret << std::endl;
-#endif
+void MusicBrainz5::CQuery::SetConnectTimeout(int Seconds)
+{
+	m_d->m_NeonTransport.SetConnectTimeout(Seconds);
+}
 
-		if (Ret>0)
-		{
-			std::vector<unsigned char> Data=Fetch.Data();
-			std::string strData(Data.begin(),Data.end());
+void MusicBrainz5::CQuery::SetReadTimeout(int Seconds)
+{
+	m_d->m_NeonTransport.SetReadTimeout(Seconds);
+}
 
-#ifdef _MB5_DEBUG_
-			//std::cerr << "Ret is '" << strData << "'" << std::endl;
-#endif
+void MusicBrainz5::CQuery::SetQueryTimeout(double Seconds)
+{
+	m_d->m_QueryTimeout=Seconds>0 ? Seconds : 0;
+}
 
-			XMLResults Results;
-			XMLNode *TopNode = XMLRootNode::parseString(strData, &Results);
-			if (Results.code==eXMLErrorNone)
-			{
-				XMLNode MetadataNode=*TopNode;
-				if (!MetadataNode.isEmpty())
-				{
-					Metadata=CMetadata(MetadataNode);
-				}
-			}
-			delete TopNode;
-		}
-	}
+void MusicBrainz5::CQuery::SetStreamingParser(bool Streaming)
+{
+	m_d->m_StreamingParser=Streaming;
+}
 
-	catch (CConnectionError& Error)
-	{
-		m_d->m_LastResult=CQuery::eQuery_ConnectionError;
-		m_d->m_LastHTTPCode=Fetch.Status();
-		m_d->m_LastErrorMessage=Fetch.ErrorMessage();
+void MusicBrainz5::CQuery::SetLazyParsing(bool Lazy)
+{
+	m_d->m_LazyParsing=Lazy;
+}
 
-		throw;
-	}
+void MusicBrainz5::CQuery::SetTransport(CTransport *Transport)
+{
+	m_d->m_Transport=Transport;
+}
 
-	catch (CTimeoutError& Error)
-	{
-		m_d->m_LastResult=CQuery::eQuery_Timeout;
-		m_d->m_LastHTTPCode=Fetch.Status();
-		m_d->m_LastErrorMessage=Fetch.ErrorMessage();
+void MusicBrainz5::CQuery::SetTraceHook(CTraceHook *TraceHook)
+{
+	m_d->m_TraceHook=TraceHook;
+}
 
-		throw;
-	}
+void MusicBrainz5::CQuery::SetCache(CMetadataCache *Cache)
+{
+	m_d->m_Cache=Cache;
+}
 
-	catch (CAuthenticationError& Error)
-	{
-		m_d->m_LastResult=CQuery::eQuery_AuthenticationError;
-		m_d->m_LastHTTPCode=Fetch.Status();
-		m_d->m_LastErrorMessage=Fetch.ErrorMessage();
+MusicBrainz5::CMetadataCache *MusicBrainz5::CQuery::Cache() const
+{
+	return m_d->m_Cache;
+}
 
-		throw;
-	}
+void MusicBrainz5::CQuery::SetDiskCache(CDiskCache *DiskCache)
+{
+	m_d->m_DiskCache=DiskCache;
+}
 
-	catch (CFetchError& Error)
-	{
-		m_d->m_LastResult=CQuery::eQuery_FetchError;
-		m_d->m_LastHTTPCode=Fetch.Status();
-		m_d->m_LastErrorMessage=Fetch.ErrorMessage();
+MusicBrainz5::CDiskCache *MusicBrainz5::CQuery::DiskCache() const
+{
+	return m_d->m_DiskCache;
+}
 
-		throw;
-	}
+void MusicBrainz5::CQuery::SetRateLimit(double Rate, int Burst)
+{
+	RateLimiter()->SetRate(Rate,Burst);
+}
 
-	catch (CRequestError& Error)
-	{
-		m_d->m_LastResult=CQuery::eQuery_RequestError;
-		m_d->m_LastHTTPCode=Fetch.Status();
-		m_d->m_LastErrorMessage=Fetch.ErrorMessage();
+void MusicBrainz5::CQuery::SetRateLimiter(CRateLimiter *Limiter)
+{
+	m_d->m_RateLimiter=Limiter;
+}
 
-		throw;
-	}
+MusicBrainz5::CRateLimiter *MusicBrainz5::CQuery::RateLimiter() const
+{
+	return m_d->RateLimiter();
+}
 
-	catch (CResourceNotFoundError& Error)
-	{
-		m_d->m_LastResult=CQuery::eQuery_ResourceNotFound;
-		m_d->m_LastHTTPCode=Fetch.Status();
-		m_d->m_LastErrorMessage=Fetch.ErrorMessage();
+MusicBrainz5::CMetadata MusicBrainz5::CQuery::PerformQuery(const std::string& Query, double Timeout)
+{
+	CMetadata Metadata;
 
-		throw;
-	}
+	m_d->PerformQuery(Query,Metadata,m_d->m_LastResult,m_d->m_LastHTTPCode,m_d->m_LastErrorMessage,m_d->m_LastStats,m_d->Deadline(Timeout));
 
 	return Metadata;
 }
 
-MusicBrainz5::CMetadata MusicBrainz5::CQuery::Query(const std::string& Entity, const std::string& ID, const std::string& Resource, const tParamMap& Params)
+std::string MusicBrainz5::CQuery::BuildQuery(const std::string& Entity, const std::string& ID, const std::string& Resource, const tParamMap& Params)
 {
 	std::stringstream os;
 
@@ -251,7 +1268,38 @@ MusicBrainz5::CMetadata MusicBrainz5::CQuery::Query(const std::string& Entity, c
 	//std::cerr << "Query is '" << os.str() << "'" << std::endl;
 #endif
 
-	return PerformQuery(os.str());
+	return os.str();
+}
+
+MusicBrainz5::CMetadata MusicBrainz5::CQuery::Query(const std::string& Entity, const std::string& ID, const std::string& Resource, const tParamMap& Params)
+{
+	return PerformQuery(BuildQuery(Entity,ID,Resource,Params));
+}
+
+MusicBrainz5::CMetadata MusicBrainz5::CQuery::Query(const std::string& Entity, const std::string& ID, const std::string& Resource, const tParamMap& Params, double Timeout)
+{
+	return PerformQuery(BuildQuery(Entity,ID,Resource,Params),Timeout);
+}
+
+MusicBrainz5::CQuery::tQueryResult MusicBrainz5::CQuery::TryQuery(CMetadata& Metadata, const std::string& Entity, const std::string& ID, const std::string& Resource, const tParamMap& Params, double Timeout)
+{
+	tQueryResult Result=eQuery_Success;
+
+	m_d->PerformQuery(BuildQuery(Entity,ID,Resource,Params),Metadata,Result,m_d->m_LastHTTPCode,m_d->m_LastErrorMessage,m_d->m_LastStats,m_d->Deadline(Timeout),false);
+
+	if (eQuery_Success!=Result)
+		m_d->m_LastResult=Result;
+
+	return Result;
+}
+
+MusicBrainz5::CQueryFuture MusicBrainz5::CQuery::QueryAsync(const std::string& Entity, const std::string& ID, const std::string& Resource, const tParamMap& Params, double Timeout)
+{
+	CQueryFuture Future;
+
+	m_d->PerformQueryAsync(BuildQuery(Entity,ID,Resource,Params),Future,m_d->Deadline(Timeout));
+
+	return Future;
 }
 
 MusicBrainz5::CReleaseList MusicBrainz5::CQuery::LookupDiscID(const std::string& DiscID)
@@ -270,12 +1318,25 @@ MusicBrainz5::CReleaseList MusicBrainz5::CQuery::LookupDiscID(const std::string&
 	return ReleaseList;
 }
 
+MusicBrainz5::CQuery::tQueryResult MusicBrainz5::CQuery::TryLookupDiscID(const std::string& DiscID, CReleaseList& ReleaseList)
+{
+	CMetadata Metadata;
+
+	tQueryResult Result=TryQuery(Metadata,"discid",DiscID);
+
+	CDisc *Disc=Metadata.Disc();
+	if (Disc && Disc->ReleaseList())
+		ReleaseList=*Disc->ReleaseList();
+
+	return Result;
+}
+
 MusicBrainz5::CRelease MusicBrainz5::CQuery::LookupRelease(const std::string& ReleaseID)
 {
 	MusicBrainz5::CRelease Release;
 
 	tParamMap Params;
-	Params["inc"]="artists labels recordings release-groups url-rels discids artist-credits";
+	Params["inc"]=LookupReleaseIncludes;
 
 	CMetadata Metadata=Query("release",ReleaseID,"",Params);
 	if (Metadata.Release())
@@ -284,32 +1345,154 @@ MusicBrainz5::CRelease MusicBrainz5::CQuery::LookupRelease(const std::string& Re
 	return Release;
 }
 
-void MusicBrainz5::CQuery::WaitRequest() const
+MusicBrainz5::CReleaseListFuture MusicBrainz5::CQuery::LookupDiscIDAsync(const std::string& DiscID)
 {
-	if (m_d->m_Server.find("musicbrainz.org")!=std::string::npos)
-	{
-		static struct timeval LastRequest;
-		const int TimeBetweenRequests=2;
+	CReleaseListFuture Future;
 
-		struct timeval TimeNow;
-		gettimeofday(&TimeNow,0);
+	m_d->PerformQueryAsync(BuildQuery("discid",DiscID),Future,m_d->Deadline(0));
 
-		if (LastRequest.tv_sec!=0 || LastRequest.tv_usec!=0)
-		{
-			struct timeval Diff;
+	return Future;
+}
 
-			do
-			{
-				gettimeofday(&TimeNow,0);
-				timersub(&TimeNow,&LastRequest,&Diff);
+MusicBrainz5::CReleaseFuture MusicBrainz5::CQuery::LookupReleaseAsync(const std::string& ReleaseID)
+{
+	CReleaseFuture Future;
 
-				if (Diff.tv_sec<TimeBetweenRequests)
-					usleep(100000);
-			}	while (Diff.tv_sec<TimeBetweenRequests);
-		}
+	tParamMap Params;
+	Params["inc"]=LookupReleaseIncludes;
+
+	m_d->PerformQueryAsync(BuildQuery("release",ReleaseID,"",Params),Future,m_d->Deadline(0));
+
+	return Future;
+}
+
+void MusicBrainz5::CQuery::LookupArtists(const std::vector<std::string>& ArtistIDs, const std::string& Includes, CArtistList& Artists, std::vector<tQueryResult>& Results)
+{
+	m_d->LookupEntities(*this,"artist",ArtistIDs,Includes,Artists,Results);
+}
+
+void MusicBrainz5::CQuery::LookupRecordings(const std::vector<std::string>& RecordingIDs, const std::string& Includes, CRecordingList& Recordings, std::vector<tQueryResult>& Results)
+{
+	m_d->LookupEntities(*this,"recording",RecordingIDs,Includes,Recordings,Results);
+}
+
+void MusicBrainz5::CQuery::LookupReleases(const std::vector<std::string>& ReleaseIDs, const std::string& Includes, CReleaseList& Releases, std::vector<tQueryResult>& Results)
+{
+	m_d->LookupEntities(*this,"release",ReleaseIDs,Includes,Releases,Results);
+}
+
+void MusicBrainz5::CQuery::LookupReleaseGroups(const std::vector<std::string>& ReleaseGroupIDs, const std::string& Includes, CReleaseGroupList& ReleaseGroups, std::vector<tQueryResult>& Results)
+{
+	m_d->LookupEntities(*this,"release-group",ReleaseGroupIDs,Includes,ReleaseGroups,Results);
+}
+
+void MusicBrainz5::CQuery::SetMaxInFlight(int MaxInFlight)
+{
+	m_d->m_Executor.SetMaxInFlight(MaxInFlight);
+
+	//There is no point allowing more queries in flight than there are connections
+	//for them to use
+
+	if (m_d->m_NeonTransport.SessionPool().MaxConnections()<MaxInFlight)
+		m_d->m_NeonTransport.SessionPool().SetMaxConnections(MaxInFlight);
+}
+
+void MusicBrainz5::CQuery::SetMaxRetries(int MaxRetries)
+{
+	m_d->m_MaxRetries=MaxRetries;
+}
+
+void MusicBrainz5::CQuery::SetRetryBackoff(double Initial, double Maximum, double Multiplier)
+{
+	m_d->m_RetryInitialDelay=Initial;
+	m_d->m_RetryMaxDelay=Maximum;
+	m_d->m_RetryMultiplier=Multiplier;
+}
+
+int MusicBrainz5::CQuery::RetryCount() const
+{
+	pthread_mutex_lock(&m_d->m_RetryLock);
+	int RetryCount=m_d->m_RetryCount;
+	pthread_mutex_unlock(&m_d->m_RetryLock);
+
+	return RetryCount;
+}
 
-		memcpy(&LastRequest,&TimeNow,sizeof(LastRequest));
+double MusicBrainz5::CQuery::RetryBackoff() const
+{
+	pthread_mutex_lock(&m_d->m_RetryLock);
+	double RetryBackoff=m_d->m_RetryBackoff;
+	pthread_mutex_unlock(&m_d->m_RetryLock);
+
+	return RetryBackoff;
+}
+
+int MusicBrainz5::CQuery::CoalescedCount() const
+{
+	pthread_mutex_lock(&m_d->m_FlightLock);
+	int CoalescedCount=m_d->m_CoalescedCount;
+	pthread_mutex_unlock(&m_d->m_FlightLock);
+
+	return CoalescedCount;
+}
+
+MusicBrainz5::CTimingHistogram MusicBrainz5::CQuery::Timings(CQueryStats::tTiming Timing) const
+{
+	CTimingHistogram Ret;
+
+	if (Timing>=0 && Timing<CQueryStats::eTiming_Count)
+	{
+		pthread_mutex_lock(&m_d->m_StatsLock);
+		Ret=m_d->m_Timings[Timing];
+		pthread_mutex_unlock(&m_d->m_StatsLock);
 	}
+
+	return Ret;
+}
+
+size_t MusicBrainz5::CQuery::TotalWireBytes() const
+{
+	pthread_mutex_lock(&m_d->m_StatsLock);
+	size_t TotalWireBytes=m_d->m_TotalWireBytes;
+	pthread_mutex_unlock(&m_d->m_StatsLock);
+
+	return TotalWireBytes;
+}
+
+size_t MusicBrainz5::CQuery::TotalBodyBytes() const
+{
+	pthread_mutex_lock(&m_d->m_StatsLock);
+	size_t TotalBodyBytes=m_d->m_TotalBodyBytes;
+	pthread_mutex_unlock(&m_d->m_StatsLock);
+
+	return TotalBodyBytes;
+}
+
+void MusicBrainz5::CQuery::ResetStats()
+{
+	pthread_mutex_lock(&m_d->m_StatsLock);
+
+	for (int count=0;count<CQueryStats::eTiming_Count;count++)
+		m_d->m_Timings[count].Clear();
+
+	m_d->m_TotalWireBytes=0;
+	m_d->m_TotalBodyBytes=0;
+
+	pthread_mutex_unlock(&m_d->m_StatsLock);
+}
+
+int MusicBrainz5::CQuery::RevalidatedCount() const
+{
+	pthread_mutex_lock(&m_d->m_FlightLock);
+	int RevalidatedCount=m_d->m_RevalidatedCount;
+	pthread_mutex_unlock(&m_d->m_FlightLock);
+
+	return RevalidatedCount;
+}
+
+void MusicBrainz5::CQuery::WaitRequest() const
+{
+	m_d->RateLimiter()->Wait();
 }
 
 bool MusicBrainz5::CQuery::AddCollectionEntries(const std::string& CollectionID, const std::vector<std::string>& Entries)
@@ -354,25 +1537,7 @@ bool MusicBrainz5::CQuery::EditCollection(const std::string& CollectionID, const
 
 		Query+="?client="+m_d->m_UserAgent;
 
-		CHTTPFetch Fetch(UserAgent(),m_d->m_Server,m_d->m_Port);
-
-		if (!m_d->m_UserName.empty())
-			Fetch.SetUserName(m_d->m_UserName);
-
-		if (!m_d->m_Password.empty())
-			Fetch.SetPassword(m_d->m_Password);
-
-		if (!m_d->m_ProxyHost.empty())
-			Fetch.SetProxyHost(m_d->m_ProxyHost);
-
-		if (0!=m_d->m_ProxyPort)
-			Fetch.SetProxyPort(m_d->m_ProxyPort);
-
-		if (!m_d->m_ProxyUserName.empty())
-			Fetch.SetProxyUserName(m_d->m_ProxyUserName);
-
-		if (!m_d->m_ProxyPassword.empty())
-			Fetch.SetProxyPassword(m_d->m_ProxyPassword);
+		CTransportResponse Response;
 
 		try
 		{
@@ -380,23 +1545,26 @@ bool MusicBrainz5::CQuery::EditCollection(const std::string& CollectionID, const
 			//std::cerr << "Collection " << Action << " Query is '" << Query << "'" << std::endl;
 #endif
 
-			int Ret=Fetch.Fetch(Query,Action);
+			CTransportRequest Request(Query,Action);
+			Request.SetTimeout(m_d->m_QueryTimeout);
+
+			m_d->Transport()->Fetch(Request,Response);
+			CTransport::CheckStatus(Response.Status(),Response.ErrorMessage());
 
 #ifdef _MB5_DEBUG_
-			//std::cerr << "Collection Ret: " << Ret << std::endl;
+			//std::cerr << "Collection Ret: " << Response.Length() << std::endl;
 #endif
 
-			if (Ret>0)
+			if (Response.Length()>0)
 			{
-				std::vector<unsigned char> Data=Fetch.Data();
-				std::string strData(Data.begin(),Data.end());
+				const std::vector<unsigned char>& Data=Response.Data();
 
 #ifdef _MB5_DEBUG_
-				//std::cerr << "Collection " << Action << " ret is '" << strData << "'" << std::endl;
+				//std::cerr << "Collection " << Action << " ret is '" << std::string(Data.begin(),Data.end()) << "'" << std::endl;
 #endif
 
 				XMLResults Results;
-				XMLNode *TopNode = XMLRootNode::parseString(strData, &Results);
+				XMLNode *TopNode = XMLRootNode::parseString(reinterpret_cast<const char *>(&Data[0]), Data.size(), &Results);
 				if (Results.code==eXMLErrorNone)
 				{
 					XMLNode MetadataNode=*TopNode;
@@ -415,8 +1583,8 @@ bool MusicBrainz5::CQuery::EditCollection(const std::string& CollectionID, const
 		catch (CConnectionError& Error)
 		{
 			m_d->m_LastResult=CQuery::eQuery_ConnectionError;
-			m_d->m_LastHTTPCode=Fetch.Status();
-			m_d->m_LastErrorMessage=Fetch.ErrorMessage();
+			m_d->m_LastHTTPCode=Response.Status();
+			m_d->m_LastErrorMessage=Response.ErrorMessage();
 
 			throw;
 		}
@@ -424,8 +1592,8 @@ bool MusicBrainz5::CQuery::EditCollection(const std::string& CollectionID, const
 		catch (CTimeoutError& Error)
 		{
 			m_d->m_LastResult=CQuery::eQuery_Timeout;
-			m_d->m_LastHTTPCode=Fetch.Status();
-			m_d->m_LastErrorMessage=Fetch.ErrorMessage();
+			m_d->m_LastHTTPCode=Response.Status();
+			m_d->m_LastErrorMessage=Response.ErrorMessage();
 
 			throw;
 		}
@@ -433,8 +1601,8 @@ bool MusicBrainz5::CQuery::EditCollection(const std::string& CollectionID, const
 		catch (CAuthenticationError& Error)
 		{
 			m_d->m_LastResult=CQuery::eQuery_AuthenticationError;
-			m_d->m_LastHTTPCode=Fetch.Status();
-			m_d->m_LastErrorMessage=Fetch.ErrorMessage();
+			m_d->m_LastHTTPCode=Response.Status();
+			m_d->m_LastErrorMessage=Response.ErrorMessage();
 
 			throw;
 		}
@@ -442,8 +1610,8 @@ bool MusicBrainz5::CQuery::EditCollection(const std::string& CollectionID, const
 		catch (CFetchError& Error)
 		{
 			m_d->m_LastResult=CQuery::eQuery_FetchError;
-			m_d->m_LastHTTPCode=Fetch.Status();
-			m_d->m_LastErrorMessage=Fetch.ErrorMessage();
+			m_d->m_LastHTTPCode=Response.Status();
+			m_d->m_LastErrorMessage=Response.ErrorMessage();
 
 			throw;
 		}
@@ -451,8 +1619,8 @@ bool MusicBrainz5::CQuery::EditCollection(const std::string& CollectionID, const
 		catch (CRequestError& Error)
 		{
 			m_d->m_LastResult=CQuery::eQuery_RequestError;
-			m_d->m_LastHTTPCode=Fetch.Status();
-			m_d->m_LastErrorMessage=Fetch.ErrorMessage();
+			m_d->m_LastHTTPCode=Response.Status();
+			m_d->m_LastErrorMessage=Response.ErrorMessage();
 
 			throw;
 		}
@@ -460,8 +1628,8 @@ bool MusicBrainz5::CQuery::EditCollection(const std::string& CollectionID, const
 		catch (CResourceNotFoundError& Error)
 		{
 			m_d->m_LastResult=CQuery::eQuery_ResourceNotFound;
-			m_d->m_LastHTTPCode=Fetch.Status();
-			m_d->m_LastErrorMessage=Fetch.ErrorMessage();
+			m_d->m_LastHTTPCode=Response.Status();
+			m_d->m_LastErrorMessage=Response.ErrorMessage();
 
 			throw;
 		}
@@ -470,16 +1638,6 @@ bool MusicBrainz5::CQuery::EditCollection(const std::string& CollectionID, const
 	return RetVal;
 }
 
-std::string MusicBrainz5::CQuery::UserAgent() const
-{
-	std::string UserAgent=m_d->m_UserAgent;
-	if (!UserAgent.empty())
-		UserAgent+=" ";
-	UserAgent+=PACKAGE "/v" VERSION;
-
-	return UserAgent;
-}
-
 std::string MusicBrainz5::CQuery::URIEscape(const std::string &URI)
 {
 	char *EscURIStr = ne_path_escape(URI.c_str());
@@ -520,6 +1678,11 @@ std::string MusicBrainz5::CQuery::LastErrorMessage() const
 	return m_d->m_LastErrorMessage;
 }
 
+MusicBrainz5::CQueryStats MusicBrainz5::CQuery::LastStats() const
+{
+	return m_d->m_LastStats;
+}
+
 std::string MusicBrainz5::CQuery::Version() const
 {
 	return PACKAGE "-v" VERSION;
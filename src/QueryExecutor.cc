@@ -0,0 +1,205 @@
+/* --------------------------------------------------------------------------
+
+   libmusicbrainz5 - Client library to access MusicBrainz
+
+   Copyright (C) 2012 Andrew Hawkins
+
+   This file is part of libmusicbrainz5.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   libmusicbrainz5 is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+     $Id$
+
+----------------------------------------------------------------------------*/
+
+#include "config.h"
+#include "musicbrainz5/defines.h"
+
+#include "musicbrainz5/QueryExecutor.h"
+
+#include <deque>
+#include <vector>
+
+#include <pthread.h>
+
+class MusicBrainz5::CQueryExecutorPrivate
+{
+	public:
+		CQueryExecutorPrivate()
+		:	m_MaxInFlight(4),
+			m_Idle(0),
+			m_Running(0),
+			m_Stopping(false)
+		{
+			pthread_mutex_init(&m_Lock,0);
+			pthread_cond_init(&m_JobQueued,0);
+		}
+
+		~CQueryExecutorPrivate()
+		{
+			pthread_cond_destroy(&m_JobQueued);
+			pthread_mutex_destroy(&m_Lock);
+		}
+
+		int m_MaxInFlight;
+		int m_Idle;
+		int m_Running;
+		bool m_Stopping;
+		std::deque<CQueryJob *> m_Queue;
+		std::vector<pthread_t> m_Threads;
+		pthread_mutex_t m_Lock;
+		pthread_cond_t m_JobQueued;
+};
+
+MusicBrainz5::CQueryJob::~CQueryJob()
+{
+}
+
+MusicBrainz5::CQueryExecutor::CQueryExecutor(int MaxInFlight)
+:	m_d(new CQueryExecutorPrivate)
+{
+	m_d->m_MaxInFlight=MaxInFlight>0 ? MaxInFlight : 1;
+}
+
+MusicBrainz5::CQueryExecutor::~CQueryExecutor()
+{
+	pthread_mutex_lock(&m_d->m_Lock);
+
+	m_d->m_Stopping=true;
+	pthread_cond_broadcast(&m_d->m_JobQueued);
+
+	pthread_mutex_unlock(&m_d->m_Lock);
+
+	//Workers only exit once the queue is empty, so every queued job is run and
+	//nobody is left waiting on a result that will never arrive
+
+	std::vector<pthread_t>::const_iterator ThisThread=m_d->m_Threads.begin();
+	while (ThisThread!=m_d->m_Threads.end())
+	{
+		pthread_join(*ThisThread,0);
+		++ThisThread;
+	}
+
+	delete m_d;
+}
+
+void MusicBrainz5::CQueryExecutor::SetMaxInFlight(int MaxInFlight)
+{
+	pthread_mutex_lock(&m_d->m_Lock);
+
+	m_d->m_MaxInFlight=MaxInFlight>0 ? MaxInFlight : 1;
+	pthread_cond_broadcast(&m_d->m_JobQueued);
+
+	pthread_mutex_unlock(&m_d->m_Lock);
+}
+
+int MusicBrainz5::CQueryExecutor::MaxInFlight() const
+{
+	pthread_mutex_lock(&m_d->m_Lock);
+
+	int Ret=m_d->m_MaxInFlight;
+
+	pthread_mutex_unlock(&m_d->m_Lock);
+
+	return Ret;
+}
+
+void MusicBrainz5::CQueryExecutor::Submit(CQueryJob *Job)
+{
+	bool RunNow=false;
+
+	pthread_mutex_lock(&m_d->m_Lock);
+
+	if (0==m_d->m_Idle && (int)m_d->m_Threads.size()<m_d->m_MaxInFlight)
+	{
+		pthread_t Thread;
+		if (0==pthread_create(&Thread,0,WorkerThread,m_d))
+			m_d->m_Threads.push_back(Thread);
+	}
+
+	//If no worker could be started at all, run the job on the caller's thread
+
+	if (m_d->m_Threads.empty())
+		RunNow=true;
+	else
+	{
+		m_d->m_Queue.push_back(Job);
+		pthread_cond_signal(&m_d->m_JobQueued);
+	}
+
+	pthread_mutex_unlock(&m_d->m_Lock);
+
+	if (RunNow)
+	{
+		try
+		{
+			Job->Run();
+		}
+
+		catch (...)
+		{
+		}
+
+		delete Job;
+	}
+}
+
+void *MusicBrainz5::CQueryExecutor::WorkerThread(void *UserData)
+{
+	CQueryExecutorPrivate *d=reinterpret_cast<CQueryExecutorPrivate *>(UserData);
+
+	pthread_mutex_lock(&d->m_Lock);
+
+	for (;;)
+	{
+		//Lowering the limit leaves surplus workers parked here rather than
+		//running more jobs than allowed
+
+		while (!d->m_Stopping && (d->m_Queue.empty() || d->m_Running>=d->m_MaxInFlight))
+		{
+			++d->m_Idle;
+			pthread_cond_wait(&d->m_JobQueued,&d->m_Lock);
+			--d->m_Idle;
+		}
+
+		if (d->m_Queue.empty())
+			break;
+
+		CQueryJob *Job=d->m_Queue.front();
+		d->m_Queue.pop_front();
+		++d->m_Running;
+
+		pthread_mutex_unlock(&d->m_Lock);
+
+		try
+		{
+			Job->Run();
+		}
+
+		catch (...)
+		{
+		}
+
+		delete Job;
+
+		pthread_mutex_lock(&d->m_Lock);
+
+		--d->m_Running;
+		pthread_cond_signal(&d->m_JobQueued);
+	}
+
+	pthread_mutex_unlock(&d->m_Lock);
+
+	return 0;
+}
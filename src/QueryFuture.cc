@@ -0,0 +1,321 @@
+/* --------------------------------------------------------------------------
+
+   libmusicbrainz5 - Client library to access MusicBrainz
+
+   Copyright (C) 2012 Andrew Hawkins
+
+   This file is part of libmusicbrainz5.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   libmusicbrainz5 is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+     $Id$
+
+----------------------------------------------------------------------------*/
+
+#include "config.h"
+#include "musicbrainz5/defines.h"
+
+#include "musicbrainz5/QueryFuture.h"
+
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "musicbrainz5/HTTPFetch.h"
+#include "musicbrainz5/Disc.h"
+
+class MusicBrainz5::CQueryFuturePrivate
+{
+	public:
+		CQueryFuturePrivate()
+		:	m_RefCount(1),
+			m_Ready(false),
+			m_Result(CQuery::eQuery_Success),
+			m_HTTPCode(200)
+		{
+			pthread_mutex_init(&m_Lock,0);
+
+			//Timed waits are measured on the monotonic clock, so that they are not
+			//cut short or stretched if the system time is changed
+
+			pthread_condattr_t Attributes;
+			pthread_condattr_init(&Attributes);
+			pthread_condattr_setclock(&Attributes,CLOCK_MONOTONIC);
+			pthread_cond_init(&m_Completed,&Attributes);
+			pthread_condattr_destroy(&Attributes);
+		}
+
+		~CQueryFuturePrivate()
+		{
+			pthread_cond_destroy(&m_Completed);
+			pthread_mutex_destroy(&m_Lock);
+		}
+
+		int m_RefCount;
+		bool m_Ready;
+		CMetadata m_Metadata;
+		CQueryStats m_Stats;
+		CQuery::tQueryResult m_Result;
+		int m_HTTPCode;
+		std::string m_ErrorMessage;
+		pthread_mutex_t m_Lock;
+		pthread_cond_t m_Completed;
+};
+
+MusicBrainz5::CQueryFuture::CQueryFuture()
+:	m_d(0)
+{
+}
+
+MusicBrainz5::CQueryFuture::CQueryFuture(const CQueryFuture& Other)
+:	m_d(0)
+{
+	*this=Other;
+}
+
+MusicBrainz5::CQueryFuture& MusicBrainz5::CQueryFuture::operator =(const CQueryFuture& Other)
+{
+	if (this!=&Other)
+	{
+		Release();
+
+		m_d=Other.m_d;
+
+		if (m_d)
+		{
+			pthread_mutex_lock(&m_d->m_Lock);
+			++m_d->m_RefCount;
+			pthread_mutex_unlock(&m_d->m_Lock);
+		}
+	}
+
+	return *this;
+}
+
+MusicBrainz5::CQueryFuture::~CQueryFuture()
+{
+	Release();
+}
+
+void MusicBrainz5::CQueryFuture::Start()
+{
+	Release();
+
+	m_d=new CQueryFuturePrivate;
+}
+
+void MusicBrainz5::CQueryFuture::Release()
+{
+	if (m_d)
+	{
+		pthread_mutex_lock(&m_d->m_Lock);
+		bool Last=(0==--m_d->m_RefCount);
+		pthread_mutex_unlock(&m_d->m_Lock);
+
+		if (Last)
+			delete m_d;
+
+		m_d=0;
+	}
+}
+
+//The metadata and statistics are filled in place by the worker before SetResult is
+//called. Nothing else may touch them until the future is ready, so no lock is needed
+//here.
+
+MusicBrainz5::CMetadata& MusicBrainz5::CQueryFuture::Target()
+{
+	return m_d->m_Metadata;
+}
+
+MusicBrainz5::CQueryStats& MusicBrainz5::CQueryFuture::TargetStats()
+{
+	return m_d->m_Stats;
+}
+
+void MusicBrainz5::CQueryFuture::SetResult(CQuery::tQueryResult Result, int HTTPCode, const std::string& ErrorMessage)
+{
+	if (m_d)
+	{
+		pthread_mutex_lock(&m_d->m_Lock);
+
+		m_d->m_Result=Result;
+		m_d->m_HTTPCode=HTTPCode;
+		m_d->m_ErrorMessage=ErrorMessage;
+		m_d->m_Ready=true;
+
+		pthread_cond_broadcast(&m_d->m_Completed);
+		pthread_mutex_unlock(&m_d->m_Lock);
+	}
+}
+
+bool MusicBrainz5::CQueryFuture::Valid() const
+{
+	return 0!=m_d;
+}
+
+bool MusicBrainz5::CQueryFuture::Ready() const
+{
+	bool Ret=false;
+
+	if (m_d)
+	{
+		pthread_mutex_lock(&m_d->m_Lock);
+		Ret=m_d->m_Ready;
+		pthread_mutex_unlock(&m_d->m_Lock);
+	}
+
+	return Ret;
+}
+
+void MusicBrainz5::CQueryFuture::Wait() const
+{
+	if (m_d)
+	{
+		pthread_mutex_lock(&m_d->m_Lock);
+
+		while (!m_d->m_Ready)
+			pthread_cond_wait(&m_d->m_Completed,&m_d->m_Lock);
+
+		pthread_mutex_unlock(&m_d->m_Lock);
+	}
+}
+
+bool MusicBrainz5::CQueryFuture::WaitFor(int Milliseconds) const
+{
+	bool Ret=false;
+
+	if (m_d)
+	{
+		struct timespec Deadline;
+		clock_gettime(CLOCK_MONOTONIC,&Deadline);
+
+		Deadline.tv_sec+=Milliseconds/1000;
+		Deadline.tv_nsec+=(Milliseconds%1000)*1000000L;
+		if (Deadline.tv_nsec>=1000000000L)
+		{
+			++Deadline.tv_sec;
+			Deadline.tv_nsec-=1000000000L;
+		}
+
+		pthread_mutex_lock(&m_d->m_Lock);
+
+		int Status=0;
+		while (!m_d->m_Ready && ETIMEDOUT!=Status)
+			Status=pthread_cond_timedwait(&m_d->m_Completed,&m_d->m_Lock,&Deadline);
+
+		Ret=m_d->m_Ready;
+
+		pthread_mutex_unlock(&m_d->m_Lock);
+	}
+
+	return Ret;
+}
+
+const MusicBrainz5::CMetadata& MusicBrainz5::CQueryFuture::Get() const
+{
+	static const CMetadata Empty;
+
+	if (!m_d)
+		return Empty;
+
+	Wait();
+
+	//The result is never modified once the future is ready, so it can be read
+	//without holding the lock
+
+	switch (m_d->m_Result)
+	{
+		case CQuery::eQuery_Success:
+			break;
+
+		case CQuery::eQuery_ConnectionError:
+			throw CConnectionError(m_d->m_ErrorMessage);
+			break;
+
+		case CQuery::eQuery_Timeout:
+			throw CTimeoutError(m_d->m_ErrorMessage);
+			break;
+
+		case CQuery::eQuery_AuthenticationError:
+			throw CAuthenticationError(m_d->m_ErrorMessage);
+			break;
+
+		case CQuery::eQuery_RequestError:
+			throw CRequestError(m_d->m_ErrorMessage);
+			break;
+
+		case CQuery::eQuery_ResourceNotFound:
+			throw CResourceNotFoundError(m_d->m_ErrorMessage);
+			break;
+
+		default:
+			throw CFetchError(m_d->m_ErrorMessage);
+			break;
+	}
+
+	return m_d->m_Metadata;
+}
+
+MusicBrainz5::CQuery::tQueryResult MusicBrainz5::CQueryFuture::Result() const
+{
+	Wait();
+
+	return m_d ? m_d->m_Result : CQuery::eQuery_Success;
+}
+
+int MusicBrainz5::CQueryFuture::HTTPCode() const
+{
+	Wait();
+
+	return m_d ? m_d->m_HTTPCode : 0;
+}
+
+std::string MusicBrainz5::CQueryFuture::ErrorMessage() const
+{
+	Wait();
+
+	return m_d ? m_d->m_ErrorMessage : "";
+}
+
+MusicBrainz5::CQueryStats MusicBrainz5::CQueryFuture::Stats() const
+{
+	Wait();
+
+	return m_d ? m_d->m_Stats : CQueryStats();
+}
+
+MusicBrainz5::CRelease MusicBrainz5::CReleaseFuture::Get() const
+{
+	MusicBrainz5::CRelease Release;
+
+	const CMetadata& Metadata=CQueryFuture::Get();
+	if (Metadata.Release())
+		Release=*Metadata.Release();
+
+	return Release;
+}
+
+MusicBrainz5::CReleaseList MusicBrainz5::CReleaseListFuture::Get() const
+{
+	MusicBrainz5::CReleaseList ReleaseList;
+
+	const CMetadata& Metadata=CQueryFuture::Get();
+
+	CDisc *Disc=Metadata.Disc();
+	if (Disc && Disc->ReleaseList())
+		ReleaseList=*Disc->ReleaseList();
+
+	return ReleaseList;
+}
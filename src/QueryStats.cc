@@ -0,0 +1,177 @@
+/* --------------------------------------------------------------------------
+
+   libmusicbrainz5 - Client library to access MusicBrainz
+
+   Copyright (C) 2012 Andrew Hawkins
+
+   This file is part of libmusicbrainz5.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   libmusicbrainz5 is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+     $Id$
+
+----------------------------------------------------------------------------*/
+
+#include "config.h"
+#include "musicbrainz5/defines.h"
+
+#include "musicbrainz5/QueryStats.h"
+
+class MusicBrainz5::CQueryStatsPrivate
+{
+	public:
+		CQueryStatsPrivate()
+		:	m_WireBytes(0),
+			m_BodyBytes(0),
+			m_Attempts(0),
+			m_Source(CQueryStats::eSource_Network),
+			m_RequestID(0)
+		{
+			for (int count=0;count<CQueryStats::eTiming_Count;count++)
+				m_Times[count]=0;
+		}
+
+		double m_Times[CQueryStats::eTiming_Count];
+		size_t m_WireBytes;
+		size_t m_BodyBytes;
+		int m_Attempts;
+		CQueryStats::tSource m_Source;
+		unsigned long m_RequestID;
+};
+
+MusicBrainz5::CQueryStats::CQueryStats()
+:	m_d(new CQueryStatsPrivate)
+{
+}
+
+MusicBrainz5::CQueryStats::CQueryStats(const CQueryStats& Other)
+:	m_d(new CQueryStatsPrivate)
+{
+	*this=Other;
+}
+
+MusicBrainz5::CQueryStats& MusicBrainz5::CQueryStats::operator =(const CQueryStats& Other)
+{
+	if (this!=&Other)
+		*m_d=*Other.m_d;
+
+	return *this;
+}
+
+MusicBrainz5::CQueryStats::~CQueryStats()
+{
+	delete m_d;
+}
+
+double MusicBrainz5::CQueryStats::Time(tTiming Timing) const
+{
+	if (Timing>=0 && Timing<eTiming_Count)
+		return m_d->m_Times[Timing];
+
+	return 0;
+}
+
+size_t MusicBrainz5::CQueryStats::WireBytes() const
+{
+	return m_d->m_WireBytes;
+}
+
+size_t MusicBrainz5::CQueryStats::BodyBytes() const
+{
+	return m_d->m_BodyBytes;
+}
+
+int MusicBrainz5::CQueryStats::Attempts() const
+{
+	return m_d->m_Attempts;
+}
+
+MusicBrainz5::CQueryStats::tSource MusicBrainz5::CQueryStats::Source() const
+{
+	return m_d->m_Source;
+}
+
+unsigned long MusicBrainz5::CQueryStats::RequestID() const
+{
+	return m_d->m_RequestID;
+}
+
+std::string MusicBrainz5::CQueryStats::TimingName(tTiming Timing)
+{
+	switch (Timing)
+	{
+		case eTiming_Wait:
+			return "wait";
+
+		case eTiming_Connect:
+			return "connect";
+
+		case eTiming_FirstByte:
+			return "first-byte";
+
+		case eTiming_Transfer:
+			return "transfer";
+
+		case eTiming_Parse:
+			return "parse";
+
+		case eTiming_Build:
+			return "build";
+
+		case eTiming_Total:
+			return "total";
+
+		default:
+			break;
+	}
+
+	return "";
+}
+
+void MusicBrainz5::CQueryStats::SetTime(tTiming Timing, double Seconds)
+{
+	if (Timing>=0 && Timing<eTiming_Count)
+		m_d->m_Times[Timing]=Seconds>0 ? Seconds : 0;
+}
+
+void MusicBrainz5::CQueryStats::AddTime(tTiming Timing, double Seconds)
+{
+	if (Timing>=0 && Timing<eTiming_Count && Seconds>0)
+		m_d->m_Times[Timing]+=Seconds;
+}
+
+void MusicBrainz5::CQueryStats::SetWireBytes(size_t WireBytes)
+{
+	m_d->m_WireBytes=WireBytes;
+}
+
+void MusicBrainz5::CQueryStats::SetBodyBytes(size_t BodyBytes)
+{
+	m_d->m_BodyBytes=BodyBytes;
+}
+
+void MusicBrainz5::CQueryStats::SetAttempts(int Attempts)
+{
+	m_d->m_Attempts=Attempts;
+}
+
+void MusicBrainz5::CQueryStats::SetSource(tSource Source)
+{
+	m_d->m_Source=Source;
+}
+
+void MusicBrainz5::CQueryStats::SetRequestID(unsigned long RequestID)
+{
+	m_d->m_RequestID=RequestID;
+}
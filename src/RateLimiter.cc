@@ -0,0 +1,262 @@
+/* --------------------------------------------------------------------------
+
+   libmusicbrainz5 - Client library to access MusicBrainz
+
+   Copyright (C) 2012 Andrew Hawkins
+
+   This file is part of libmusicbrainz5.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   libmusicbrainz5 is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+     $Id$
+
+----------------------------------------------------------------------------*/
+
+#include "config.h"
+#include "musicbrainz5/defines.h"
+
+#include "musicbrainz5/RateLimiter.h"
+#include "MonotonicTime.h"
+
+#include <map>
+#include <sstream>
+
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+
+static pthread_mutex_t ServerLimitersLock=PTHREAD_MUTEX_INITIALIZER;
+static std::map<std::string,MusicBrainz5::CRateLimiter *> *ServerLimiters=0;
+
+#if defined(__GNUC__)
+__attribute__((destructor))
+#else
+	#error Non GCC compiler detected
+#endif
+static void destroy_server_limiters()
+{
+	if (ServerLimiters)
+	{
+		std::map<std::string,MusicBrainz5::CRateLimiter *>::iterator ThisLimiter=ServerLimiters->begin();
+		while (ThisLimiter!=ServerLimiters->end())
+		{
+			delete (*ThisLimiter).second;
+			++ThisLimiter;
+		}
+
+		delete ServerLimiters;
+		ServerLimiters=0;
+	}
+}
+
+class MusicBrainz5::CRateLimiterPrivate
+{
+	public:
+		CRateLimiterPrivate()
+		:	m_Rate(0),
+			m_Burst(1),
+			m_Tokens(1),
+			m_LastRefill(MonotonicTime()),
+			m_HoldUntil(0)
+		{
+			pthread_mutex_init(&m_Lock,0);
+		}
+
+		~CRateLimiterPrivate()
+		{
+			pthread_mutex_destroy(&m_Lock);
+		}
+
+		double Reserve(double MaxDelay);
+
+		double m_Rate;
+		int m_Burst;
+		double m_Tokens;
+		double m_LastRefill;
+		double m_HoldUntil;
+		pthread_mutex_t m_Lock;
+};
+
+//Take a token, returning how long the caller must wait before using it. If MaxDelay is
+//not negative and the wait would be longer, no token is taken and -1 is returned.
+
+double MusicBrainz5::CRateLimiterPrivate::Reserve(double MaxDelay)
+{
+	double Delay=0;
+
+	pthread_mutex_lock(&m_Lock);
+
+	double Now=MonotonicTime();
+
+	if (m_Rate>0)
+	{
+		m_Tokens+=(Now-m_LastRefill)*m_Rate;
+		if (m_Tokens>m_Burst)
+			m_Tokens=m_Burst;
+
+		m_LastRefill=Now;
+
+		if (m_Tokens<1)
+			Delay=(1-m_Tokens)/m_Rate;
+	}
+
+	if (m_HoldUntil-Now>Delay)
+		Delay=m_HoldUntil-Now;
+
+	if (MaxDelay>=0 && Delay>MaxDelay)
+	{
+		pthread_mutex_unlock(&m_Lock);
+		return -1;
+	}
+
+	//Take the token now even if the bucket is empty. The balance going negative
+	//reserves the next token for this caller, so concurrent callers queue up
+	//behind each other rather than all waking for the same token
+
+	if (m_Rate>0)
+		m_Tokens-=1;
+
+	pthread_mutex_unlock(&m_Lock);
+
+	return Delay;
+}
+
+static void Sleep(double Delay)
+{
+	if (Delay>0)
+	{
+		struct timespec Remaining;
+		Remaining.tv_sec=(time_t)Delay;
+		Remaining.tv_nsec=(long)((Delay-Remaining.tv_sec)*1e9);
+
+		while (-1==nanosleep(&Remaining,&Remaining) && EINTR==errno)
+		{
+		}
+	}
+}
+
+MusicBrainz5::CRateLimiter::CRateLimiter(double Rate, int Burst)
+:	m_d(new CRateLimiterPrivate)
+{
+	SetRate(Rate,Burst);
+}
+
+MusicBrainz5::CRateLimiter::~CRateLimiter()
+{
+	delete m_d;
+}
+
+void MusicBrainz5::CRateLimiter::SetRate(double Rate, int Burst)
+{
+	pthread_mutex_lock(&m_d->m_Lock);
+
+	m_d->m_Rate=Rate>0 ? Rate : 0;
+	m_d->m_Burst=Burst>0 ? Burst : 1;
+	m_d->m_Tokens=m_d->m_Burst;
+	m_d->m_LastRefill=MonotonicTime();
+
+	pthread_mutex_unlock(&m_d->m_Lock);
+}
+
+double MusicBrainz5::CRateLimiter::Rate() const
+{
+	pthread_mutex_lock(&m_d->m_Lock);
+
+	double Ret=m_d->m_Rate;
+
+	pthread_mutex_unlock(&m_d->m_Lock);
+
+	return Ret;
+}
+
+int MusicBrainz5::CRateLimiter::Burst() const
+{
+	pthread_mutex_lock(&m_d->m_Lock);
+
+	int Ret=m_d->m_Burst;
+
+	pthread_mutex_unlock(&m_d->m_Lock);
+
+	return Ret;
+}
+
+void MusicBrainz5::CRateLimiter::Wait()
+{
+	Sleep(m_d->Reserve(-1));
+}
+
+bool MusicBrainz5::CRateLimiter::TryWait(double Timeout)
+{
+	double Delay=m_d->Reserve(Timeout>0 ? Timeout : 0);
+	if (Delay<0)
+		return false;
+
+	Sleep(Delay);
+
+	return true;
+}
+
+void MusicBrainz5::CRateLimiter::Penalise(double Seconds)
+{
+	pthread_mutex_lock(&m_d->m_Lock);
+
+	double Now=MonotonicTime();
+	double HoldUntil=Now+Seconds;
+
+	if (HoldUntil>m_d->m_HoldUntil)
+	{
+		m_d->m_HoldUntil=HoldUntil;
+
+		//Start refilling the bucket only once the hold ends, with a single token in it,
+		//so that waiting callers resume one at a time at the normal rate rather than
+		//all at once
+
+		if (m_d->m_Rate>0)
+		{
+			m_d->m_Tokens+=(Now-m_d->m_LastRefill)*m_d->m_Rate;
+			if (m_d->m_Tokens>1)
+				m_d->m_Tokens=1;
+
+			m_d->m_LastRefill=HoldUntil;
+		}
+	}
+
+	pthread_mutex_unlock(&m_d->m_Lock);
+}
+
+MusicBrainz5::CRateLimiter *MusicBrainz5::CRateLimiter::ServerLimiter(const std::string& Server, int Port)
+{
+	std::stringstream os;
+	os << Server << ":" << Port;
+
+	pthread_mutex_lock(&ServerLimitersLock);
+
+	if (!ServerLimiters)
+		ServerLimiters=new std::map<std::string,CRateLimiter *>;
+
+	CRateLimiter *Ret=(*ServerLimiters)[os.str()];
+	if (!Ret)
+	{
+		if (Server.find("musicbrainz.org")!=std::string::npos)
+			Ret=new CRateLimiter(0.5,1);
+		else
+			Ret=new CRateLimiter;
+
+		(*ServerLimiters)[os.str()]=Ret;
+	}
+
+	pthread_mutex_unlock(&ServerLimitersLock);
+
+	return Ret;
+}
@@ -27,6 +27,7 @@
 #include "musicbrainz5/defines.h"
 
 #include "musicbrainz5/Rating.h"
+#include "musicbrainz5/ElementName.h"
 
 class MusicBrainz5::CRatingPrivate
 {
@@ -90,24 +91,26 @@ MusicBrainz5::CRating *MusicBrainz5::CRating::Clone()
 
 void MusicBrainz5::CRating::ParseAttribute(const std::string& Name, const std::string& Value)
 {
-	if ("votes-count"==Name)
-	{
-		ProcessItem(Value,m_d->m_VotesCount);
-	}
-	else
+	switch (CElementName::Lookup(Name))
 	{
+		case CElementName::eName_VotesCount:
+			ProcessItem(Value,m_d->m_VotesCount);
+			break;
+
+		default:
 #ifdef _MB5_DEBUG_
-		std::cerr << "Unrecognised rating attribute: '" << Name << "'" << std::endl;
+			std::cerr << "Unrecognised rating attribute: '" << Name << "'" << std::endl;
 #endif
+			break;
 	}
 }
 
 void MusicBrainz5::CRating::ParseElement(const XMLNode& Node)
 {
-	std::string NodeName=Node.getName();
-
 #ifdef _MB5_DEBUG_
-	std::cerr << "Unrecognised rating attribute: '" << NodeName << "'" << std::endl;
+	std::cerr << "Unrecognised rating attribute: '" << Node.getName() << "'" << std::endl;
+#else
+	(void)Node;
 #endif
 }
 
@@ -27,6 +27,7 @@
 #include "musicbrainz5/defines.h"
 
 #include "musicbrainz5/Recording.h"
+#include "musicbrainz5/ElementName.h"
 
 #include "musicbrainz5/ArtistCredit.h"
 #include "musicbrainz5/Rating.h"
@@ -153,73 +154,77 @@ MusicBrainz5::CRecording *MusicBrainz5::CRecording::Clone()
 
 void MusicBrainz5::CRecording::ParseAttribute(const std::string& Name, const std::string& Value)
 {
-	if ("id"==Name)
-		m_d->m_ID=Value;
-	else
+	switch (CElementName::Lookup(Name))
 	{
+		case CElementName::eName_ID:
+			m_d->m_ID=Value;
+			break;
+
+		default:
 #ifdef _MB5_DEBUG_
-		std::cerr << "Unrecognised recording attribute: '" << Name << "'" << std::endl;
+			std::cerr << "Unrecognised recording attribute: '" << Name << "'" << std::endl;
 #endif
+			break;
 	}
 }
 
 void MusicBrainz5::CRecording::ParseElement(const XMLNode& Node)
 {
-	std::string NodeName=Node.getName();
-
-	if ("title"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Title);
-	}
-	else if ("length"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Length);
-	}
-	else if ("disambiguation"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Disambiguation);
-	}
-	else if ("artist-credit"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_ArtistCredit);
-	}
-	else if ("release-list"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_ReleaseList);
-	}
-	else if ("puid-list"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_PUIDList);
-	}
-	else if ("isrc-list"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_ISRCList);
-	}
-	else if ("relation-list"==NodeName)
-	{
-		ProcessRelationList(Node,m_d->m_RelationListList);
-	}
-	else if ("tag-list"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_TagList);
-	}
-	else if ("user-tag-list"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_UserTagList);
-	}
-	else if ("rating"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Rating);
-	}
-	else if ("user-rating"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_UserRating);
-	}
-	else
+	switch (CElementName::Lookup(Node))
 	{
+		case CElementName::eName_Title:
+			ProcessItem(Node,m_d->m_Title);
+			break;
+
+		case CElementName::eName_Length:
+			ProcessItem(Node,m_d->m_Length);
+			break;
+
+		case CElementName::eName_Disambiguation:
+			ProcessItem(Node,m_d->m_Disambiguation);
+			break;
+
+		case CElementName::eName_ArtistCredit:
+			ProcessLazyItem(Node,m_d->m_ArtistCredit);
+			break;
+
+		case CElementName::eName_ReleaseList:
+			ProcessLazyItem(Node,m_d->m_ReleaseList);
+			break;
+
+		case CElementName::eName_PUIDList:
+			ProcessLazyItem(Node,m_d->m_PUIDList);
+			break;
+
+		case CElementName::eName_ISRCList:
+			ProcessLazyItem(Node,m_d->m_ISRCList);
+			break;
+
+		case CElementName::eName_RelationList:
+			ProcessRelationList(Node,m_d->m_RelationListList);
+			break;
+
+		case CElementName::eName_TagList:
+			ProcessLazyItem(Node,m_d->m_TagList);
+			break;
+
+		case CElementName::eName_UserTagList:
+			ProcessLazyItem(Node,m_d->m_UserTagList);
+			break;
+
+		case CElementName::eName_Rating:
+			ProcessLazyItem(Node,m_d->m_Rating);
+			break;
+
+		case CElementName::eName_UserRating:
+			ProcessLazyItem(Node,m_d->m_UserRating);
+			break;
+
+		default:
 #ifdef _MB5_DEBUG_
-		std::cerr << "Unrecognised recording element: '" << NodeName << "'" << std::endl;
+			std::cerr << "Unrecognised recording element: '" << Node.getName() << "'" << std::endl;
 #endif
+			break;
 	}
 }
 
@@ -280,46 +285,64 @@ std::string MusicBrainz5::CRecording::Disambiguation() const
 
 MusicBrainz5::CArtistCredit *MusicBrainz5::CRecording::ArtistCredit() const
 {
+	Materialise(CElementName::eName_ArtistCredit);
+
 	return m_d->m_ArtistCredit;
 }
 
 MusicBrainz5::CReleaseList *MusicBrainz5::CRecording::ReleaseList() const
 {
+	Materialise(CElementName::eName_ReleaseList);
+
 	return m_d->m_ReleaseList;
 }
 
 MusicBrainz5::CPUIDList *MusicBrainz5::CRecording::PUIDList() const
 {
+	Materialise(CElementName::eName_PUIDList);
+
 	return m_d->m_PUIDList;
 }
 
 MusicBrainz5::CISRCList *MusicBrainz5::CRecording::ISRCList() const
 {
+	Materialise(CElementName::eName_ISRCList);
+
 	return m_d->m_ISRCList;
 }
 
 MusicBrainz5::CRelationListList *MusicBrainz5::CRecording::RelationListList() const
 {
+	Materialise(CElementName::eName_RelationList);
+
 	return m_d->m_RelationListList;
 }
 
 MusicBrainz5::CTagList *MusicBrainz5::CRecording::TagList() const
 {
+	Materialise(CElementName::eName_TagList);
+
 	return m_d->m_TagList;
 }
 
 MusicBrainz5::CUserTagList *MusicBrainz5::CRecording::UserTagList() const
 {
+	Materialise(CElementName::eName_UserTagList);
+
 	return m_d->m_UserTagList;
 }
 
 MusicBrainz5::CRating *MusicBrainz5::CRecording::Rating() const
 {
+	Materialise(CElementName::eName_Rating);
+
 	return m_d->m_Rating;
 }
 
 MusicBrainz5::CUserRating *MusicBrainz5::CRecording::UserRating() const
 {
+	Materialise(CElementName::eName_UserRating);
+
 	return m_d->m_UserRating;
 }
 
@@ -0,0 +1,236 @@
+/* --------------------------------------------------------------------------
+
+   libmusicbrainz5 - Client library to access MusicBrainz
+
+   Copyright (C) 2012 Andrew Hawkins
+
+   This file is part of libmusicbrainz5.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   libmusicbrainz5 is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+     $Id$
+
+----------------------------------------------------------------------------*/
+
+#include "config.h"
+#include "musicbrainz5/defines.h"
+
+#include "musicbrainz5/RecordingTransport.h"
+#include "MonotonicTime.h"
+
+#include <map>
+#include <cstdio>
+
+#include <pthread.h>
+
+static const char ArchiveMagic[]="MB5REPLAY 1\n";
+
+//Header values must stay on one line
+
+static std::string OneLine(const std::string& Str)
+{
+	std::string Ret=Str;
+
+	for (std::string::size_type Pos=0;Pos<Ret.length();Pos++)
+	{
+		if ('\r'==Ret[Pos] || '\n'==Ret[Pos])
+			Ret[Pos]=' ';
+	}
+
+	return Ret;
+}
+
+static std::string ErrorName(const MusicBrainz5::CExceptionBase& Error)
+{
+	if (dynamic_cast<const MusicBrainz5::CConnectionError *>(&Error))
+		return "connection";
+
+	if (dynamic_cast<const MusicBrainz5::CTimeoutError *>(&Error))
+		return "timeout";
+
+	if (dynamic_cast<const MusicBrainz5::CAuthenticationError *>(&Error))
+		return "authentication";
+
+	if (dynamic_cast<const MusicBrainz5::CRequestError *>(&Error))
+		return "request";
+
+	if (dynamic_cast<const MusicBrainz5::CResourceNotFoundError *>(&Error))
+		return "notfound";
+
+	return "fetch";
+}
+
+//Copies everything the wrapped transport set on its response, apart from the body,
+//which the reader has already passed on. Any field added to CTransportResponse must
+//be copied here too.
+
+static void CopyResponse(const MusicBrainz5::CTransportResponse& From, MusicBrainz5::CTransportResponse& To)
+{
+	To.SetStatus(From.Status());
+	To.SetErrorMessage(From.ErrorMessage());
+	To.SetConnectTime(From.ConnectTime());
+	To.SetWireBytes(From.WireBytes());
+
+	std::map<std::string,std::string>::const_iterator ThisHeader=From.Headers().begin();
+	while (ThisHeader!=From.Headers().end())
+	{
+		To.SetHeader((*ThisHeader).first,(*ThisHeader).second);
+		++ThisHeader;
+	}
+}
+
+//Passes the body on to the real response, keeping a copy to record
+
+class CRecordingReader: public MusicBrainz5::CHTTPBodyReader
+{
+	public:
+		CRecordingReader(MusicBrainz5::CTransportResponse& Response)
+		:	m_Response(Response)
+		{
+		}
+
+		virtual bool Read(const char *Data, size_t Length)
+		{
+			m_Body.append(Data,Length);
+
+			return m_Response.Read(Data,Length);
+		}
+
+		MusicBrainz5::CTransportResponse& m_Response;
+		std::string m_Body;
+};
+
+class MusicBrainz5::CRecordingTransportPrivate
+{
+	public:
+		CRecordingTransportPrivate(CTransport& Transport)
+		:	m_Transport(Transport),
+			m_File(0),
+			m_NumRecorded(0)
+		{
+			pthread_mutex_init(&m_Lock,0);
+		}
+
+		~CRecordingTransportPrivate()
+		{
+			if (m_File)
+				fclose(m_File);
+
+			pthread_mutex_destroy(&m_Lock);
+		}
+
+		void Record(const CTransportRequest& Request, const CTransportResponse& Response,
+									double Time, const std::string& Body, const std::string& Error);
+
+		CTransport& m_Transport;
+		FILE *m_File;
+		int m_NumRecorded;
+		mutable pthread_mutex_t m_Lock;
+};
+
+void MusicBrainz5::CRecordingTransportPrivate::Record(const CTransportRequest& Request, const CTransportResponse& Response,
+									double Time, const std::string& Body, const std::string& Error)
+{
+	std::string Header="request: "+Request.Method()+" "+OneLine(Request.URL())+"\n";
+
+	char Buffer[64];
+	snprintf(Buffer,sizeof(Buffer),"status: %d\ntime: %.6f\n",Response.Status(),Time);
+	Header+=Buffer;
+
+	std::map<std::string,std::string>::const_iterator ThisHeader=Response.Headers().begin();
+	while (ThisHeader!=Response.Headers().end())
+	{
+		Header+="header: "+(*ThisHeader).first+": "+OneLine((*ThisHeader).second)+"\n";
+		++ThisHeader;
+	}
+
+	if (!Error.empty())
+		Header+="error: "+OneLine(Error)+"\n";
+
+	snprintf(Buffer,sizeof(Buffer),"length: %lu\n\n",(unsigned long)Body.length());
+	Header+=Buffer;
+
+	pthread_mutex_lock(&m_Lock);
+
+	fwrite(Header.data(),1,Header.length(),m_File);
+	fwrite(Body.data(),1,Body.length(),m_File);
+	fputc('\n',m_File);
+	fflush(m_File);
+
+	m_NumRecorded++;
+
+	pthread_mutex_unlock(&m_Lock);
+}
+
+MusicBrainz5::CRecordingTransport::CRecordingTransport(CTransport& Transport, const std::string& FileName)
+:	m_d(new CRecordingTransportPrivate(Transport))
+{
+	m_d->m_File=fopen(FileName.c_str(),"ab");
+	if (!m_d->m_File)
+	{
+		delete m_d;
+		throw CFetchError("Unable to open "+FileName);
+	}
+
+	if (0==ftell(m_d->m_File))
+	{
+		fputs(ArchiveMagic,m_d->m_File);
+		fflush(m_d->m_File);
+	}
+}
+
+MusicBrainz5::CRecordingTransport::~CRecordingTransport()
+{
+	delete m_d;
+}
+
+void MusicBrainz5::CRecordingTransport::Fetch(const CTransportRequest& Request, CTransportResponse& Response)
+{
+	CRecordingReader Reader(Response);
+	CTransportResponse Recorded(&Reader);
+
+	double Start=MonotonicTime();
+
+	try
+	{
+		m_d->m_Transport.Fetch(Request,Recorded);
+	}
+
+	catch (CExceptionBase& Error)
+	{
+		std::string ErrorMessage=Recorded.ErrorMessage();
+		if (ErrorMessage.empty())
+			ErrorMessage=Error.what();
+
+		CopyResponse(Recorded,Response);
+		Response.SetErrorMessage(ErrorMessage);
+
+		m_d->Record(Request,Response,MonotonicTime()-Start,Reader.m_Body,ErrorName(Error)+" "+ErrorMessage);
+
+		throw;
+	}
+
+	CopyResponse(Recorded,Response);
+
+	m_d->Record(Request,Response,MonotonicTime()-Start,Reader.m_Body,"");
+}
+
+int MusicBrainz5::CRecordingTransport::NumRecorded() const
+{
+	pthread_mutex_lock(&m_d->m_Lock);
+	int Ret=m_d->m_NumRecorded;
+	pthread_mutex_unlock(&m_d->m_Lock);
+
+	return Ret;
+}
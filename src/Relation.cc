@@ -27,6 +27,7 @@
 #include "musicbrainz5/defines.h"
 
 #include "musicbrainz5/Relation.h"
+#include "musicbrainz5/ElementName.h"
 
 #include "musicbrainz5/Artist.h"
 #include "musicbrainz5/Release.h"
@@ -164,73 +165,77 @@ MusicBrainz5::CRelation *MusicBrainz5::CRelation::Clone()
 
 void MusicBrainz5::CRelation::ParseAttribute(const std::string& Name, const std::string& Value)
 {
-	if ("type"==Name)
-		m_d->m_Type=Value;
-	else
+	switch (CElementName::Lookup(Name))
 	{
+		case CElementName::eName_Type:
+			m_d->m_Type=Value;
+			break;
+
+		default:
 #ifdef _MB5_DEBUG_
-		std::cerr << "Unrecognised relation attribute: '" << Name << "'" << std::endl;
+			std::cerr << "Unrecognised relation attribute: '" << Name << "'" << std::endl;
 #endif
+			break;
 	}
 }
 
 void MusicBrainz5::CRelation::ParseElement(const XMLNode& Node)
 {
-	std::string NodeName=Node.getName();
-
-	if ("target"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Target);
-	}
-	else if ("direction"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Direction);
-	}
-	else if ("attribute-list"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_AttributeList);
-	}
-	else if ("begin"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Begin);
-	}
-	else if ("end"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_End);
-	}
-	else if ("ended"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Ended);
-	}
-	else if ("artist"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Artist);
-	}
-	else if ("release"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Release);
-	}
-	else if ("release-group"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_ReleaseGroup);
-	}
-	else if ("recording"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Recording);
-	}
-	else if ("label"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Label);
-	}
-	else if ("work"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Work);
-	}
-	else
+	switch (CElementName::Lookup(Node))
 	{
+		case CElementName::eName_Target:
+			ProcessItem(Node,m_d->m_Target);
+			break;
+
+		case CElementName::eName_Direction:
+			ProcessItem(Node,m_d->m_Direction);
+			break;
+
+		case CElementName::eName_AttributeList:
+			ProcessLazyItem(Node,m_d->m_AttributeList);
+			break;
+
+		case CElementName::eName_Begin:
+			ProcessItem(Node,m_d->m_Begin);
+			break;
+
+		case CElementName::eName_End:
+			ProcessItem(Node,m_d->m_End);
+			break;
+
+		case CElementName::eName_Ended:
+			ProcessItem(Node,m_d->m_Ended);
+			break;
+
+		case CElementName::eName_Artist:
+			ProcessLazyItem(Node,m_d->m_Artist);
+			break;
+
+		case CElementName::eName_Release:
+			ProcessLazyItem(Node,m_d->m_Release);
+			break;
+
+		case CElementName::eName_ReleaseGroup:
+			ProcessLazyItem(Node,m_d->m_ReleaseGroup);
+			break;
+
+		case CElementName::eName_Recording:
+			ProcessLazyItem(Node,m_d->m_Recording);
+			break;
+
+		case CElementName::eName_Label:
+			ProcessLazyItem(Node,m_d->m_Label);
+			break;
+
+		case CElementName::eName_Work:
+			ProcessLazyItem(Node,m_d->m_Work);
+			break;
+
+		default:
 #ifdef _MB5_DEBUG_
-		std::cerr << "Unrecognised relation element: '" << NodeName << "'" << std::endl;
+			std::cerr << "Unrecognised relation element: '" << Node.getName() << "'" << std::endl;
 #endif
+			break;
 	}
 }
 
@@ -256,6 +261,8 @@ std::string MusicBrainz5::CRelation::Direction() const
 
 MusicBrainz5::CAttributeList *MusicBrainz5::CRelation::AttributeList() const
 {
+	Materialise(CElementName::eName_AttributeList);
+
 	return m_d->m_AttributeList;
 }
 
@@ -276,31 +283,43 @@ std::string MusicBrainz5::CRelation::Ended() const
 
 MusicBrainz5::CArtist *MusicBrainz5::CRelation::Artist() const
 {
+	Materialise(CElementName::eName_Artist);
+
 	return m_d->m_Artist;
 }
 
 MusicBrainz5::CRelease *MusicBrainz5::CRelation::Release() const
 {
+	Materialise(CElementName::eName_Release);
+
 	return m_d->m_Release;
 }
 
 MusicBrainz5::CReleaseGroup *MusicBrainz5::CRelation::ReleaseGroup() const
 {
+	Materialise(CElementName::eName_ReleaseGroup);
+
 	return m_d->m_ReleaseGroup;
 }
 
 MusicBrainz5::CRecording *MusicBrainz5::CRelation::Recording() const
 {
+	Materialise(CElementName::eName_Recording);
+
 	return m_d->m_Recording;
 }
 
 MusicBrainz5::CLabel *MusicBrainz5::CRelation::Label() const
 {
+	Materialise(CElementName::eName_Label);
+
 	return m_d->m_Label;
 }
 
 MusicBrainz5::CWork *MusicBrainz5::CRelation::Work() const
 {
+	Materialise(CElementName::eName_Work);
+
 	return m_d->m_Work;
 }
 
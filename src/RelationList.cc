@@ -27,6 +27,7 @@
 #include "musicbrainz5/defines.h"
 
 #include "musicbrainz5/RelationList.h"
+#include "musicbrainz5/ElementName.h"
 
 #include "musicbrainz5/Relation.h"
 
@@ -79,10 +80,16 @@ MusicBrainz5::CRelationList *MusicBrainz5::CRelationList::Clone()
 
 void MusicBrainz5::CRelationList::ParseAttribute(const std::string& Name, const std::string& Value)
 {
-	if ("target-type"==Name)
-		ProcessItem(Value,m_d->m_TargetType);
-	else
-		CListImpl<CRelation>::ParseAttribute(Name,Value);
+	switch (CElementName::Lookup(Name))
+	{
+		case CElementName::eName_TargetType:
+			ProcessItem(Value,m_d->m_TargetType);
+			break;
+
+		default:
+			CListImpl<CRelation>::ParseAttribute(Name,Value);
+			break;
+	}
 }
 
 void MusicBrainz5::CRelationList::ParseElement(const XMLNode& Node)
@@ -27,6 +27,7 @@
 #include "musicbrainz5/defines.h"
 
 #include "musicbrainz5/Release.h"
+#include "musicbrainz5/ElementName.h"
 
 #include <string.h>
 
@@ -176,89 +177,93 @@ MusicBrainz5::CRelease *MusicBrainz5::CRelease::Clone()
 
 void MusicBrainz5::CRelease::ParseAttribute(const std::string& Name, const std::string& Value)
 {
-	if ("id"==Name)
-		m_d->m_ID=Value;
-	else
+	switch (CElementName::Lookup(Name))
 	{
+		case CElementName::eName_ID:
+			m_d->m_ID=Value;
+			break;
+
+		default:
 #ifdef _MB5_DEBUG_
-		std::cerr << "Unrecognised release attribute: '" << Name << "'" << std::endl;
+			std::cerr << "Unrecognised release attribute: '" << Name << "'" << std::endl;
 #endif
+			break;
 	}
 }
 
 void MusicBrainz5::CRelease::ParseElement(const XMLNode& Node)
 {
-	std::string NodeName=Node.getName();
-
-	if ("title"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Title);
-	}
-	else if ("status"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Status);
-	}
-	else if ("quality"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Quality);
-	}
-	else if ("disambiguation"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Disambiguation);
-	}
-	else if ("packaging"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Packaging);
-	}
-	else if ("text-representation"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_TextRepresentation);
-	}
-	else if ("artist-credit"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_ArtistCredit);
-	}
-	else if ("release-group"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_ReleaseGroup);
-	}
-	else if ("date"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Date);
-	}
-	else if ("country"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Country);
-	}
-	else if ("barcode"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Barcode);
-	}
-	else if ("asin"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_ASIN);
-	}
-	else if ("label-info-list"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_LabelInfoList);
-	}
-	else if ("medium-list"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_MediumList);
-	}
-	else if ("relation-list"==NodeName)
-	{
-		ProcessRelationList(Node,m_d->m_RelationListList);
-	}
-	else if ("collection-list"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_CollectionList);
-	}
-	else
+	switch (CElementName::Lookup(Node))
 	{
+		case CElementName::eName_Title:
+			ProcessItem(Node,m_d->m_Title);
+			break;
+
+		case CElementName::eName_Status:
+			ProcessItem(Node,m_d->m_Status);
+			break;
+
+		case CElementName::eName_Quality:
+			ProcessItem(Node,m_d->m_Quality);
+			break;
+
+		case CElementName::eName_Disambiguation:
+			ProcessItem(Node,m_d->m_Disambiguation);
+			break;
+
+		case CElementName::eName_Packaging:
+			ProcessItem(Node,m_d->m_Packaging);
+			break;
+
+		case CElementName::eName_TextRepresentation:
+			ProcessLazyItem(Node,m_d->m_TextRepresentation);
+			break;
+
+		case CElementName::eName_ArtistCredit:
+			ProcessLazyItem(Node,m_d->m_ArtistCredit);
+			break;
+
+		case CElementName::eName_ReleaseGroup:
+			ProcessLazyItem(Node,m_d->m_ReleaseGroup);
+			break;
+
+		case CElementName::eName_Date:
+			ProcessItem(Node,m_d->m_Date);
+			break;
+
+		case CElementName::eName_Country:
+			ProcessItem(Node,m_d->m_Country);
+			break;
+
+		case CElementName::eName_Barcode:
+			ProcessItem(Node,m_d->m_Barcode);
+			break;
+
+		case CElementName::eName_ASIN:
+			ProcessItem(Node,m_d->m_ASIN);
+			break;
+
+		case CElementName::eName_LabelInfoList:
+			ProcessLazyItem(Node,m_d->m_LabelInfoList);
+			break;
+
+		case CElementName::eName_MediumList:
+			ProcessLazyItem(Node,m_d->m_MediumList);
+			break;
+
+		case CElementName::eName_RelationList:
+			ProcessRelationList(Node,m_d->m_RelationListList);
+			break;
+
+		case CElementName::eName_CollectionList:
+			ProcessLazyItem(Node,m_d->m_CollectionList);
+			break;
+
+		default:
 #ifdef _MB5_DEBUG_
-		std::cerr << "Unrecognised release element: '" << NodeName << "'" << std::endl;
+			std::cerr << "Unrecognised release element: '" << Node.getName() << "'" << std::endl;
 #endif
+			break;
 	}
 }
 
@@ -299,16 +304,22 @@ std::string MusicBrainz5::CRelease::Packaging() const
 
 MusicBrainz5::CTextRepresentation *MusicBrainz5::CRelease::TextRepresentation() const
 {
+	Materialise(CElementName::eName_TextRepresentation);
+
 	return m_d->m_TextRepresentation;
 }
 
 MusicBrainz5::CArtistCredit *MusicBrainz5::CRelease::ArtistCredit() const
 {
+	Materialise(CElementName::eName_ArtistCredit);
+
 	return m_d->m_ArtistCredit;
 }
 
 MusicBrainz5::CReleaseGroup *MusicBrainz5::CRelease::ReleaseGroup() const
 {
+	Materialise(CElementName::eName_ReleaseGroup);
+
 	return m_d->m_ReleaseGroup;
 }
 
@@ -334,21 +345,29 @@ std::string MusicBrainz5::CRelease::ASIN() const
 
 MusicBrainz5::CLabelInfoList *MusicBrainz5::CRelease::LabelInfoList() const
 {
+	Materialise(CElementName::eName_LabelInfoList);
+
 	return m_d->m_LabelInfoList;
 }
 
 MusicBrainz5::CMediumList *MusicBrainz5::CRelease::MediumList() const
 {
+	Materialise(CElementName::eName_MediumList);
+
 	return m_d->m_MediumList;
 }
 
 MusicBrainz5::CRelationListList *MusicBrainz5::CRelease::RelationListList() const
 {
+	Materialise(CElementName::eName_RelationList);
+
 	return m_d->m_RelationListList;
 }
 
 MusicBrainz5::CCollectionList *MusicBrainz5::CRelease::CollectionList() const
 {
+	Materialise(CElementName::eName_CollectionList);
+
 	return m_d->m_CollectionList;
 }
 
@@ -356,11 +375,12 @@ MusicBrainz5::CMediumList MusicBrainz5::CRelease::MediaMatchingDiscID(const std:
 {
 	MusicBrainz5::CMediumList Ret;
 
-	if (m_d->m_MediumList)
+	MusicBrainz5::CMediumList *Media=MediumList();
+	if (Media)
 	{
-		for (int count=0;count<m_d->m_MediumList->NumItems();count++)
+		for (int count=0;count<Media->NumItems();count++)
 		{
-			MusicBrainz5::CMedium *Medium=m_d->m_MediumList->Item(count);
+			MusicBrainz5::CMedium *Medium=Media->Item(count);
 
 			if (Medium->ContainsDiscID(DiscID))
 				Ret.AddItem(new MusicBrainz5::CMedium(*Medium));
@@ -27,6 +27,7 @@
 #include "musicbrainz5/defines.h"
 
 #include "musicbrainz5/ReleaseGroup.h"
+#include "musicbrainz5/ElementName.h"
 
 #include "musicbrainz5/ArtistCredit.h"
 #include "musicbrainz5/Rating.h"
@@ -175,77 +176,81 @@ MusicBrainz5::CReleaseGroup *MusicBrainz5::CReleaseGroup::Clone()
 
 void MusicBrainz5::CReleaseGroup::ParseAttribute(const std::string& Name, const std::string& Value)
 {
-	if ("id"==Name)
-		m_d->m_ID=Value;
-	else if ("type"==Name)
-	{
-		//Ignore type
-	}
-	else
+	switch (CElementName::Lookup(Name))
 	{
+		case CElementName::eName_ID:
+			m_d->m_ID=Value;
+			break;
+
+		case CElementName::eName_Type:
+			//Ignore type
+			break;
+
+		default:
 #ifdef _MB5_DEBUG_
-		std::cerr << "Unrecognised releasegroup attribute: '" << Name << "'" << std::endl;
+			std::cerr << "Unrecognised releasegroup attribute: '" << Name << "'" << std::endl;
 #endif
+			break;
 	}
 }
 
 void MusicBrainz5::CReleaseGroup::ParseElement(const XMLNode& Node)
 {
-	std::string NodeName=Node.getName();
-
-	if ("primary-type"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_PrimaryType);
-	}
-	else if ("title"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Title);
-	}
-	else if ("disambiguation"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Disambiguation);
-	}
-	else if ("first-release-date"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_FirstReleaseDate);
-	}
-	else if ("artist-credit"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_ArtistCredit);
-	}
-	else if ("release-list"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_ReleaseList);
-	}
-	else if ("relation-list"==NodeName)
-	{
-		ProcessRelationList(Node,m_d->m_RelationListList);
-	}
-	else if ("tag-list"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_TagList);
-	}
-	else if ("user-tag-list"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_UserTagList);
-	}
-	else if ("rating"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Rating);
-	}
-	else if ("user-rating"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_UserRating);
-	}
-	else if ("secondary-type-list"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_SecondaryTypeList);
-	}
-	else
+	switch (CElementName::Lookup(Node))
 	{
+		case CElementName::eName_PrimaryType:
+			ProcessItem(Node,m_d->m_PrimaryType);
+			break;
+
+		case CElementName::eName_Title:
+			ProcessItem(Node,m_d->m_Title);
+			break;
+
+		case CElementName::eName_Disambiguation:
+			ProcessItem(Node,m_d->m_Disambiguation);
+			break;
+
+		case CElementName::eName_FirstReleaseDate:
+			ProcessItem(Node,m_d->m_FirstReleaseDate);
+			break;
+
+		case CElementName::eName_ArtistCredit:
+			ProcessLazyItem(Node,m_d->m_ArtistCredit);
+			break;
+
+		case CElementName::eName_ReleaseList:
+			ProcessLazyItem(Node,m_d->m_ReleaseList);
+			break;
+
+		case CElementName::eName_RelationList:
+			ProcessRelationList(Node,m_d->m_RelationListList);
+			break;
+
+		case CElementName::eName_TagList:
+			ProcessLazyItem(Node,m_d->m_TagList);
+			break;
+
+		case CElementName::eName_UserTagList:
+			ProcessLazyItem(Node,m_d->m_UserTagList);
+			break;
+
+		case CElementName::eName_Rating:
+			ProcessLazyItem(Node,m_d->m_Rating);
+			break;
+
+		case CElementName::eName_UserRating:
+			ProcessLazyItem(Node,m_d->m_UserRating);
+			break;
+
+		case CElementName::eName_SecondaryTypeList:
+			ProcessLazyItem(Node,m_d->m_SecondaryTypeList);
+			break;
+
+		default:
 #ifdef _MB5_DEBUG_
-		std::cerr << "Unrecognised release group element: '" << NodeName << "'" << std::endl;
+			std::cerr << "Unrecognised release group element: '" << Node.getName() << "'" << std::endl;
 #endif
+			break;
 	}
 }
 
@@ -281,41 +286,57 @@ std::string MusicBrainz5::CReleaseGroup::FirstReleaseDate() const
 
 MusicBrainz5::CArtistCredit *MusicBrainz5::CReleaseGroup::ArtistCredit() const
 {
+	Materialise(CElementName::eName_ArtistCredit);
+
 	return m_d->m_ArtistCredit;
 }
 
 MusicBrainz5::CReleaseList *MusicBrainz5::CReleaseGroup::ReleaseList() const
 {
+	Materialise(CElementName::eName_ReleaseList);
+
 	return m_d->m_ReleaseList;
 }
 
 MusicBrainz5::CRelationListList *MusicBrainz5::CReleaseGroup::RelationListList() const
 {
+	Materialise(CElementName::eName_RelationList);
+
 	return m_d->m_RelationListList;
 }
 
 MusicBrainz5::CTagList *MusicBrainz5::CReleaseGroup::TagList() const
 {
+	Materialise(CElementName::eName_TagList);
+
 	return m_d->m_TagList;
 }
 
 MusicBrainz5::CUserTagList *MusicBrainz5::CReleaseGroup::UserTagList() const
 {
+	Materialise(CElementName::eName_UserTagList);
+
 	return m_d->m_UserTagList;
 }
 
 MusicBrainz5::CRating *MusicBrainz5::CReleaseGroup::Rating() const
 {
+	Materialise(CElementName::eName_Rating);
+
 	return m_d->m_Rating;
 }
 
 MusicBrainz5::CUserRating *MusicBrainz5::CReleaseGroup::UserRating() const
 {
+	Materialise(CElementName::eName_UserRating);
+
 	return m_d->m_UserRating;
 }
 
 MusicBrainz5::CSecondaryTypeList *MusicBrainz5::CReleaseGroup::SecondaryTypeList() const
 {
+	Materialise(CElementName::eName_SecondaryTypeList);
+
 	return m_d->m_SecondaryTypeList;
 }
 
@@ -0,0 +1,351 @@
+/* --------------------------------------------------------------------------
+
+   libmusicbrainz5 - Client library to access MusicBrainz
+
+   Copyright (C) 2012 Andrew Hawkins
+
+   This file is part of libmusicbrainz5.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   libmusicbrainz5 is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+     $Id$
+
+----------------------------------------------------------------------------*/
+
+#include "config.h"
+#include "musicbrainz5/defines.h"
+
+#include "musicbrainz5/ReplayTransport.h"
+
+#include <map>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
+
+static const char ArchiveMagic[]="MB5REPLAY 1\n";
+
+class CReplayRecord
+{
+	public:
+		CReplayRecord()
+		:	m_Status(0),
+			m_Time(0)
+		{
+		}
+
+		int m_Status;
+		double m_Time;
+		std::map<std::string,std::string> m_Headers;
+		std::string m_Error;
+		std::string m_Body;
+};
+
+//All the responses recorded for one request, served in turn
+
+class CReplaySequence
+{
+	public:
+		CReplaySequence()
+		:	m_Next(0)
+		{
+		}
+
+		std::vector<CReplayRecord> m_Records;
+		std::vector<CReplayRecord>::size_type m_Next;
+};
+
+static void Sleep(double Seconds)
+{
+	if (Seconds>0)
+	{
+		struct timespec Remaining;
+		Remaining.tv_sec=(time_t)Seconds;
+		Remaining.tv_nsec=(long)((Seconds-Remaining.tv_sec)*1e9);
+
+		//Carry on with whatever is left after a signal, but give up on any other error
+
+		while (-1==nanosleep(&Remaining,&Remaining) && EINTR==errno)
+		{
+		}
+	}
+}
+
+static void ThrowError(const std::string& Error)
+{
+	std::string::size_type Space=Error.find(' ');
+	std::string Name=Error.substr(0,Space);
+	std::string Message=std::string::npos!=Space ? Error.substr(Space+1) : "";
+
+	if ("connection"==Name)
+		throw MusicBrainz5::CConnectionError(Message);
+
+	if ("timeout"==Name)
+		throw MusicBrainz5::CTimeoutError(Message);
+
+	if ("authentication"==Name)
+		throw MusicBrainz5::CAuthenticationError(Message);
+
+	if ("request"==Name)
+		throw MusicBrainz5::CRequestError(Message);
+
+	if ("notfound"==Name)
+		throw MusicBrainz5::CResourceNotFoundError(Message);
+
+	throw MusicBrainz5::CFetchError(Message);
+}
+
+class MusicBrainz5::CReplayTransportPrivate
+{
+	public:
+		CReplayTransportPrivate()
+		:	m_NumRecords(0),
+			m_NumServed(0),
+			m_NumMissed(0),
+			m_LatencyScale(0),
+			m_Latency(0)
+		{
+			pthread_mutex_init(&m_Lock,0);
+		}
+
+		~CReplayTransportPrivate()
+		{
+			pthread_mutex_destroy(&m_Lock);
+		}
+
+		bool Load(const std::string& Archive);
+
+		std::map<std::string,CReplaySequence> m_Sequences;
+		int m_NumRecords;
+		int m_NumServed;
+		int m_NumMissed;
+		double m_LatencyScale;
+		double m_Latency;
+		mutable pthread_mutex_t m_Lock;
+};
+
+bool MusicBrainz5::CReplayTransportPrivate::Load(const std::string& Archive)
+{
+	std::string::size_type Magic=sizeof(ArchiveMagic)-1;
+
+	if (Archive.compare(0,Magic,ArchiveMagic)!=0)
+		return false;
+
+	std::string::size_type Pos=Magic;
+
+	while (Pos<Archive.length())
+	{
+		std::string Request;
+		CReplayRecord Record;
+		std::string::size_type Length=0;
+
+		//Header lines, up to an empty line
+
+		for (;;)
+		{
+			std::string::size_type End=Archive.find('\n',Pos);
+			if (std::string::npos==End)
+				return false;
+
+			std::string Line=Archive.substr(Pos,End-Pos);
+			Pos=End+1;
+
+			if (Line.empty())
+				break;
+
+			std::string::size_type Colon=Line.find(": ");
+			if (std::string::npos==Colon)
+				return false;
+
+			std::string Name=Line.substr(0,Colon);
+			std::string Value=Line.substr(Colon+2);
+
+			if ("request"==Name)
+				Request=Value;
+			else if ("status"==Name)
+				Record.m_Status=atoi(Value.c_str());
+			else if ("time"==Name)
+				Record.m_Time=strtod(Value.c_str(),0);
+			else if ("error"==Name)
+				Record.m_Error=Value;
+			else if ("length"==Name)
+				Length=strtoul(Value.c_str(),0,10);
+			else if ("header"==Name)
+			{
+				Colon=Value.find(": ");
+				if (std::string::npos!=Colon)
+					Record.m_Headers[Value.substr(0,Colon)]=Value.substr(Colon+2);
+			}
+		}
+
+		//The body, followed by a newline
+
+		if (Request.empty() || Pos+Length+1>Archive.length())
+			return false;
+
+		Record.m_Body=Archive.substr(Pos,Length);
+		Pos+=Length+1;
+
+		m_Sequences[Request].m_Records.push_back(Record);
+		m_NumRecords++;
+	}
+
+	return true;
+}
+
+MusicBrainz5::CReplayTransport::CReplayTransport(const std::string& FileName)
+:	m_d(new CReplayTransportPrivate)
+{
+	std::string Archive;
+
+	FILE *fptr=fopen(FileName.c_str(),"rb");
+	if (fptr)
+	{
+		char Buffer[65536];
+		size_t Length;
+
+		while (0!=(Length=fread(Buffer,1,sizeof(Buffer),fptr)))
+			Archive.append(Buffer,Length);
+
+		bool Failed=ferror(fptr)!=0;
+
+		fclose(fptr);
+
+		if (!Failed && m_d->Load(Archive))
+			return;
+	}
+
+	delete m_d;
+	throw CFetchError("Unable to read "+FileName);
+}
+
+MusicBrainz5::CReplayTransport::~CReplayTransport()
+{
+	delete m_d;
+}
+
+void MusicBrainz5::CReplayTransport::Fetch(const CTransportRequest& Request, CTransportResponse& Response)
+{
+	const CReplayRecord *Record=0;
+	double Delay=0;
+
+	pthread_mutex_lock(&m_d->m_Lock);
+
+	std::map<std::string,CReplaySequence>::iterator ThisSequence=m_d->m_Sequences.find(Request.Method()+" "+Request.URL());
+	if (ThisSequence!=m_d->m_Sequences.end())
+	{
+		CReplaySequence& Sequence=(*ThisSequence).second;
+
+		Record=&Sequence.m_Records[Sequence.m_Next];
+		Sequence.m_Next=(Sequence.m_Next+1)%Sequence.m_Records.size();
+
+		m_d->m_NumServed++;
+	}
+	else
+		m_d->m_NumMissed++;
+
+	Delay=m_d->m_Latency;
+	if (Record)
+		Delay+=Record->m_Time*m_d->m_LatencyScale;
+
+	pthread_mutex_unlock(&m_d->m_Lock);
+
+	//Records are never modified once loaded, so can be used without the lock
+
+	Sleep(Delay);
+
+	if (!Record)
+	{
+		Response.SetStatus(404);
+		Response.SetErrorMessage("No recorded response for "+Request.URL());
+		return;
+	}
+
+	Response.SetStatus(Record->m_Status);
+
+	std::map<std::string,std::string>::const_iterator ThisHeader=Record->m_Headers.begin();
+	while (ThisHeader!=Record->m_Headers.end())
+	{
+		Response.SetHeader((*ThisHeader).first,(*ThisHeader).second);
+		++ThisHeader;
+	}
+
+	//Pass the body on in blocks, as a network transport would
+
+	bool Continue=true;
+	std::string::size_type Pos=0;
+
+	while (Continue && Pos<Record->m_Body.length())
+	{
+		std::string::size_type Length=Record->m_Body.length()-Pos;
+		if (Length>65536)
+			Length=65536;
+
+		Continue=Response.Read(Record->m_Body.data()+Pos,Length);
+		Pos+=Length;
+	}
+
+	if (!Continue)
+	{
+		Response.SetErrorMessage("Request aborted");
+		throw CFetchError(Response.ErrorMessage());
+	}
+
+	if (!Record->m_Error.empty())
+	{
+		std::string::size_type Space=Record->m_Error.find(' ');
+		Response.SetErrorMessage(std::string::npos!=Space ? Record->m_Error.substr(Space+1) : "");
+		ThrowError(Record->m_Error);
+	}
+}
+
+void MusicBrainz5::CReplayTransport::SetLatencyScale(double Scale)
+{
+	pthread_mutex_lock(&m_d->m_Lock);
+	m_d->m_LatencyScale=Scale>0 ? Scale : 0;
+	pthread_mutex_unlock(&m_d->m_Lock);
+}
+
+void MusicBrainz5::CReplayTransport::SetLatency(double Seconds)
+{
+	pthread_mutex_lock(&m_d->m_Lock);
+	m_d->m_Latency=Seconds>0 ? Seconds : 0;
+	pthread_mutex_unlock(&m_d->m_Lock);
+}
+
+int MusicBrainz5::CReplayTransport::NumRecords() const
+{
+	return m_d->m_NumRecords;
+}
+
+int MusicBrainz5::CReplayTransport::NumServed() const
+{
+	pthread_mutex_lock(&m_d->m_Lock);
+	int Ret=m_d->m_NumServed;
+	pthread_mutex_unlock(&m_d->m_Lock);
+
+	return Ret;
+}
+
+int MusicBrainz5::CReplayTransport::NumMissed() const
+{
+	pthread_mutex_lock(&m_d->m_Lock);
+	int Ret=m_d->m_NumMissed;
+	pthread_mutex_unlock(&m_d->m_Lock);
+
+	return Ret;
+}
@@ -102,10 +102,10 @@ void MusicBrainz5::CSecondaryType::ParseAttribute(const std::string& Name, const
 
 void MusicBrainz5::CSecondaryType::ParseElement(const XMLNode& Node)
 {
-	std::string NodeName=Node.getName();
-
 #ifdef _MB5_DEBUG_
-	std::cerr << "Unrecognised secondary type element: '" << NodeName << "'" << std::endl;
+	std::cerr << "Unrecognised secondary type element: '" << Node.getName() << "'" << std::endl;
+#else
+	(void)Node;
 #endif
 }
 
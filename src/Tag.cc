@@ -27,6 +27,7 @@
 #include "musicbrainz5/defines.h"
 
 #include "musicbrainz5/Tag.h"
+#include "musicbrainz5/ElementName.h"
 
 class MusicBrainz5::CTagPrivate
 {
@@ -84,31 +85,33 @@ MusicBrainz5::CTag *MusicBrainz5::CTag::Clone()
 
 void MusicBrainz5::CTag::ParseAttribute(const std::string& Name, const std::string& Value)
 {
-	if ("count"==Name)
-	{
-		ProcessItem(Value,m_d->m_Count);
-	}
-	else
+	switch (CElementName::Lookup(Name))
 	{
+		case CElementName::eName_Count:
+			ProcessItem(Value,m_d->m_Count);
+			break;
+
+		default:
 #ifdef _MB5_DEBUG_
-		std::cerr << "Unrecognised tag attribute: '" << Name << "'" << std::endl;
+			std::cerr << "Unrecognised tag attribute: '" << Name << "'" << std::endl;
 #endif
+			break;
 	}
 }
 
 void MusicBrainz5::CTag::ParseElement(const XMLNode& Node)
 {
-	std::string NodeName=Node.getName();
-
-	if ("name"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Name);
-	}
-	else
+	switch (CElementName::Lookup(Node))
 	{
+		case CElementName::eName_Name:
+			ProcessItem(Node,m_d->m_Name);
+			break;
+
+		default:
 #ifdef _MB5_DEBUG_
-		std::cerr << "Unrecognised tag element: '" << NodeName << "'" << std::endl;
+			std::cerr << "Unrecognised tag element: '" << Node.getName() << "'" << std::endl;
 #endif
+			break;
 	}
 }
 
@@ -27,6 +27,7 @@
 #include "musicbrainz5/defines.h"
 
 #include "musicbrainz5/TextRepresentation.h"
+#include "musicbrainz5/ElementName.h"
 
 class MusicBrainz5::CTextRepresentationPrivate
 {
@@ -88,21 +89,21 @@ void MusicBrainz5::CTextRepresentation::ParseAttribute(const std::string& Name,
 
 void MusicBrainz5::CTextRepresentation::ParseElement(const XMLNode& Node)
 {
-	std::string NodeName=Node.getName();
-
-	if ("language"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Language);
-	}
-	else if ("script"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Script);
-	}
-	else
+	switch (CElementName::Lookup(Node))
 	{
+		case CElementName::eName_Language:
+			ProcessItem(Node,m_d->m_Language);
+			break;
+
+		case CElementName::eName_Script:
+			ProcessItem(Node,m_d->m_Script);
+			break;
+
+		default:
 #ifdef _MB5_DEBUG_
-		std::cerr << "Unrecognised textrepresentation element: '" << NodeName << "'" << std::endl;
+			std::cerr << "Unrecognised textrepresentation element: '" << Node.getName() << "'" << std::endl;
 #endif
+			break;
 	}
 }
 
@@ -0,0 +1,186 @@
+/* --------------------------------------------------------------------------
+
+   libmusicbrainz5 - Client library to access MusicBrainz
+
+   Copyright (C) 2012 Andrew Hawkins
+
+   This file is part of libmusicbrainz5.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   libmusicbrainz5 is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+     $Id$
+
+----------------------------------------------------------------------------*/
+
+#include "config.h"
+#include "musicbrainz5/defines.h"
+
+#include "musicbrainz5/TimingHistogram.h"
+
+//Bucket limits double from 100us, so the last limited bucket ends at about 105s
+
+static const double FirstLimit=0.0001;
+static const int NumLimits=21;
+
+class MusicBrainz5::CTimingHistogramPrivate
+{
+	public:
+		CTimingHistogramPrivate()
+		{
+			Clear();
+		}
+
+		void Clear()
+		{
+			m_Count=0;
+			m_Sum=0;
+			m_Min=0;
+			m_Max=0;
+
+			for (int count=0;count<=NumLimits;count++)
+				m_Buckets[count]=0;
+		}
+
+		int m_Count;
+		double m_Sum;
+		double m_Min;
+		double m_Max;
+		int m_Buckets[NumLimits+1];
+};
+
+MusicBrainz5::CTimingHistogram::CTimingHistogram()
+:	m_d(new CTimingHistogramPrivate)
+{
+}
+
+MusicBrainz5::CTimingHistogram::CTimingHistogram(const CTimingHistogram& Other)
+:	m_d(new CTimingHistogramPrivate)
+{
+	*this=Other;
+}
+
+MusicBrainz5::CTimingHistogram& MusicBrainz5::CTimingHistogram::operator =(const CTimingHistogram& Other)
+{
+	if (this!=&Other)
+		*m_d=*Other.m_d;
+
+	return *this;
+}
+
+MusicBrainz5::CTimingHistogram::~CTimingHistogram()
+{
+	delete m_d;
+}
+
+void MusicBrainz5::CTimingHistogram::Add(double Seconds)
+{
+	if (Seconds<0)
+		Seconds=0;
+
+	if (0==m_d->m_Count || Seconds<m_d->m_Min)
+		m_d->m_Min=Seconds;
+
+	if (0==m_d->m_Count || Seconds>m_d->m_Max)
+		m_d->m_Max=Seconds;
+
+	m_d->m_Count++;
+	m_d->m_Sum+=Seconds;
+
+	int Bucket=0;
+	double Limit=FirstLimit;
+
+	while (Bucket<NumLimits && Seconds>Limit)
+	{
+		Bucket++;
+		Limit*=2;
+	}
+
+	m_d->m_Buckets[Bucket]++;
+}
+
+void MusicBrainz5::CTimingHistogram::Clear()
+{
+	m_d->Clear();
+}
+
+int MusicBrainz5::CTimingHistogram::Count() const
+{
+	return m_d->m_Count;
+}
+
+double MusicBrainz5::CTimingHistogram::Sum() const
+{
+	return m_d->m_Sum;
+}
+
+double MusicBrainz5::CTimingHistogram::Mean() const
+{
+	return m_d->m_Count ? m_d->m_Sum/m_d->m_Count : 0;
+}
+
+double MusicBrainz5::CTimingHistogram::Min() const
+{
+	return m_d->m_Min;
+}
+
+double MusicBrainz5::CTimingHistogram::Max() const
+{
+	return m_d->m_Max;
+}
+
+double MusicBrainz5::CTimingHistogram::Percentile(double Percent) const
+{
+	if (0==m_d->m_Count)
+		return 0;
+
+	double Target=m_d->m_Count*Percent/100;
+	int Seen=0;
+
+	for (int count=0;count<NumLimits;count++)
+	{
+		Seen+=m_d->m_Buckets[count];
+		if (Seen>0 && Seen>=Target)
+		{
+			double Limit=BucketLimit(count);
+			return Limit<m_d->m_Max ? Limit : m_d->m_Max;
+		}
+	}
+
+	return m_d->m_Max;
+}
+
+int MusicBrainz5::CTimingHistogram::NumBuckets() const
+{
+	return NumLimits+1;
+}
+
+double MusicBrainz5::CTimingHistogram::BucketLimit(int Bucket) const
+{
+	if (Bucket<0 || Bucket>=NumLimits)
+		return 0;
+
+	double Limit=FirstLimit;
+	for (int count=0;count<Bucket;count++)
+		Limit*=2;
+
+	return Limit;
+}
+
+int MusicBrainz5::CTimingHistogram::BucketCount(int Bucket) const
+{
+	if (Bucket<0 || Bucket>NumLimits)
+		return 0;
+
+	return m_d->m_Buckets[Bucket];
+}
@@ -0,0 +1,59 @@
+/* --------------------------------------------------------------------------
+
+   libmusicbrainz5 - Client library to access MusicBrainz
+
+   Copyright (C) 2012 Andrew Hawkins
+
+   This file is part of libmusicbrainz5.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   libmusicbrainz5 is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+     $Id$
+
+----------------------------------------------------------------------------*/
+
+#include "config.h"
+#include "musicbrainz5/defines.h"
+
+#include "musicbrainz5/TraceHook.h"
+
+MusicBrainz5::CTraceHook::~CTraceHook()
+{
+}
+
+std::string MusicBrainz5::CTraceHook::SpanName(tSpan Span)
+{
+	switch (Span)
+	{
+		case eSpan_Query:
+			return "query";
+
+		case eSpan_Wait:
+			return "wait";
+
+		case eSpan_Fetch:
+			return "fetch";
+
+		case eSpan_Parse:
+			return "parse";
+
+		case eSpan_Build:
+			return "build";
+
+		default:
+			break;
+	}
+
+	return "";
+}
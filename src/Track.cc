@@ -27,6 +27,7 @@
 #include "musicbrainz5/defines.h"
 
 #include "musicbrainz5/Track.h"
+#include "musicbrainz5/ElementName.h"
 
 #include "musicbrainz5/Recording.h"
 #include "musicbrainz5/ArtistCredit.h"
@@ -126,37 +127,37 @@ void MusicBrainz5::CTrack::ParseAttribute(const std::string& Name, const std::st
 
 void MusicBrainz5::CTrack::ParseElement(const XMLNode& Node)
 {
-	std::string NodeName=Node.getName();
-
-	if ("position"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Position);
-	}
-	else if ("title"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Title);
-	}
-	else if ("recording"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Recording);
-	}
-	else if ("length"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Length);
-	}
-	else if ("artist-credit"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_ArtistCredit);
-	}
-	else if ("number"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Number);
-	}
-	else
+	switch (CElementName::Lookup(Node))
 	{
+		case CElementName::eName_Position:
+			ProcessItem(Node,m_d->m_Position);
+			break;
+
+		case CElementName::eName_Title:
+			ProcessItem(Node,m_d->m_Title);
+			break;
+
+		case CElementName::eName_Recording:
+			ProcessLazyItem(Node,m_d->m_Recording);
+			break;
+
+		case CElementName::eName_Length:
+			ProcessItem(Node,m_d->m_Length);
+			break;
+
+		case CElementName::eName_ArtistCredit:
+			ProcessLazyItem(Node,m_d->m_ArtistCredit);
+			break;
+
+		case CElementName::eName_Number:
+			ProcessItem(Node,m_d->m_Number);
+			break;
+
+		default:
 #ifdef _MB5_DEBUG_
-		std::cerr << "Unrecognised track element: '" << NodeName << "'" << std::endl;
+			std::cerr << "Unrecognised track element: '" << Node.getName() << "'" << std::endl;
 #endif
+			break;
 	}
 }
 
@@ -177,6 +178,8 @@ std::string MusicBrainz5::CTrack::Title() const
 
 MusicBrainz5::CRecording *MusicBrainz5::CTrack::Recording() const
 {
+	Materialise(CElementName::eName_Recording);
+
 	return m_d->m_Recording;
 }
 
@@ -187,6 +190,8 @@ int MusicBrainz5::CTrack::Length() const
 
 MusicBrainz5::CArtistCredit *MusicBrainz5::CTrack::ArtistCredit() const
 {
+	Materialise(CElementName::eName_ArtistCredit);
+
 	return m_d->m_ArtistCredit;
 }
 
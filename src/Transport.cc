@@ -0,0 +1,264 @@
+/* --------------------------------------------------------------------------
+
+   libmusicbrainz5 - Client library to access MusicBrainz
+
+   Copyright (C) 2012 Andrew Hawkins
+
+   This file is part of libmusicbrainz5.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   libmusicbrainz5 is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+     $Id$
+
+----------------------------------------------------------------------------*/
+
+#include "config.h"
+#include "musicbrainz5/defines.h"
+
+#include "musicbrainz5/Transport.h"
+
+#include <map>
+
+#include <ctype.h>
+
+static std::string LowerCase(const std::string& Str)
+{
+	std::string Ret=Str;
+
+	for (std::string::size_type Pos=0;Pos<Ret.length();Pos++)
+		Ret[Pos]=tolower(Ret[Pos]);
+
+	return Ret;
+}
+
+class MusicBrainz5::CTransportRequestPrivate
+{
+	public:
+		CTransportRequestPrivate()
+		:	m_Timeout(0)
+		{
+		}
+
+		std::string m_URL;
+		std::string m_Method;
+		std::map<std::string,std::string> m_Headers;
+		double m_Timeout;
+};
+
+class MusicBrainz5::CTransportResponsePrivate
+{
+	public:
+		CTransportResponsePrivate()
+		:	m_Reader(0),
+			m_Status(0),
+			m_Length(0),
+			m_ConnectTime(0),
+			m_WireBytes(0)
+		{
+		}
+
+		CHTTPBodyReader *m_Reader;
+		int m_Status;
+		std::string m_ErrorMessage;
+		size_t m_Length;
+		double m_ConnectTime;
+		size_t m_WireBytes;
+		std::vector<unsigned char> m_Data;
+		std::map<std::string,std::string> m_Headers;
+};
+
+MusicBrainz5::CTransportRequest::CTransportRequest(const std::string& URL, const std::string& Method)
+:	m_d(new CTransportRequestPrivate)
+{
+	m_d->m_URL=URL;
+	m_d->m_Method=Method;
+}
+
+MusicBrainz5::CTransportRequest::CTransportRequest(const CTransportRequest& Other)
+:	m_d(new CTransportRequestPrivate)
+{
+	*this=Other;
+}
+
+MusicBrainz5::CTransportRequest& MusicBrainz5::CTransportRequest::operator =(const CTransportRequest& Other)
+{
+	if (this!=&Other)
+	{
+		m_d->m_URL=Other.m_d->m_URL;
+		m_d->m_Method=Other.m_d->m_Method;
+		m_d->m_Headers=Other.m_d->m_Headers;
+		m_d->m_Timeout=Other.m_d->m_Timeout;
+	}
+
+	return *this;
+}
+
+MusicBrainz5::CTransportRequest::~CTransportRequest()
+{
+	delete m_d;
+}
+
+std::string MusicBrainz5::CTransportRequest::URL() const
+{
+	return m_d->m_URL;
+}
+
+std::string MusicBrainz5::CTransportRequest::Method() const
+{
+	return m_d->m_Method;
+}
+
+void MusicBrainz5::CTransportRequest::SetHeader(const std::string& Name, const std::string& Value)
+{
+	m_d->m_Headers[Name]=Value;
+}
+
+const std::map<std::string,std::string>& MusicBrainz5::CTransportRequest::Headers() const
+{
+	return m_d->m_Headers;
+}
+
+void MusicBrainz5::CTransportRequest::SetTimeout(double Seconds)
+{
+	m_d->m_Timeout=Seconds>0 ? Seconds : 0;
+}
+
+double MusicBrainz5::CTransportRequest::Timeout() const
+{
+	return m_d->m_Timeout;
+}
+
+MusicBrainz5::CTransportResponse::CTransportResponse(CHTTPBodyReader *Reader)
+:	m_d(new CTransportResponsePrivate)
+{
+	m_d->m_Reader=Reader;
+}
+
+MusicBrainz5::CTransportResponse::~CTransportResponse()
+{
+	delete m_d;
+}
+
+bool MusicBrainz5::CTransportResponse::Read(const char *Data, size_t Length)
+{
+	m_d->m_Length+=Length;
+
+	if (m_d->m_Reader)
+		return m_d->m_Reader->Read(Data,Length);
+
+	m_d->m_Data.insert(m_d->m_Data.end(),Data,Data+Length);
+
+	return true;
+}
+
+void MusicBrainz5::CTransportResponse::SetStatus(int Status)
+{
+	m_d->m_Status=Status;
+}
+
+void MusicBrainz5::CTransportResponse::SetErrorMessage(const std::string& ErrorMessage)
+{
+	m_d->m_ErrorMessage=ErrorMessage;
+}
+
+void MusicBrainz5::CTransportResponse::SetHeader(const std::string& Name, const std::string& Value)
+{
+	m_d->m_Headers[LowerCase(Name)]=Value;
+}
+
+void MusicBrainz5::CTransportResponse::SetConnectTime(double Seconds)
+{
+	m_d->m_ConnectTime=Seconds;
+}
+
+void MusicBrainz5::CTransportResponse::SetWireBytes(size_t WireBytes)
+{
+	m_d->m_WireBytes=WireBytes;
+}
+
+int MusicBrainz5::CTransportResponse::Status() const
+{
+	return m_d->m_Status;
+}
+
+std::string MusicBrainz5::CTransportResponse::ErrorMessage() const
+{
+	return m_d->m_ErrorMessage;
+}
+
+std::string MusicBrainz5::CTransportResponse::Header(const std::string& Name) const
+{
+	std::map<std::string,std::string>::const_iterator ThisHeader=m_d->m_Headers.find(LowerCase(Name));
+	if (ThisHeader!=m_d->m_Headers.end())
+		return (*ThisHeader).second;
+
+	return "";
+}
+
+const std::map<std::string,std::string>& MusicBrainz5::CTransportResponse::Headers() const
+{
+	return m_d->m_Headers;
+}
+
+double MusicBrainz5::CTransportResponse::ConnectTime() const
+{
+	return m_d->m_ConnectTime;
+}
+
+size_t MusicBrainz5::CTransportResponse::WireBytes() const
+{
+	return m_d->m_WireBytes;
+}
+
+size_t MusicBrainz5::CTransportResponse::Length() const
+{
+	return m_d->m_Length;
+}
+
+const std::vector<unsigned char>& MusicBrainz5::CTransportResponse::Data() const
+{
+	return m_d->m_Data;
+}
+
+MusicBrainz5::CTransport::~CTransport()
+{
+}
+
+void MusicBrainz5::CTransport::CheckStatus(int Status, const std::string& ErrorMessage)
+{
+	if (2==Status/100)
+		return;
+
+	switch (Status)
+	{
+		case 304:
+			break;
+
+		case 400:
+			throw CRequestError(ErrorMessage);
+			break;
+
+		case 401:
+			throw CAuthenticationError(ErrorMessage);
+			break;
+
+		case 404:
+			throw CResourceNotFoundError(ErrorMessage);
+			break;
+
+		default:
+			throw CFetchError(ErrorMessage);
+			break;
+	}
+}
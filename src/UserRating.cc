@@ -96,10 +96,10 @@ void MusicBrainz5::CUserRating::ParseAttribute(const std::string& Name, const st
 
 void MusicBrainz5::CUserRating::ParseElement(const XMLNode& Node)
 {
-	std::string Name=Node.getName();
-
 #ifdef _MB5_DEBUG_
-	std::cerr << "Unrecognised userrating element: '" << Name << "'" << std::endl;
+	std::cerr << "Unrecognised userrating element: '" << Node.getName() << "'" << std::endl;
+#else
+	(void)Node;
 #endif
 }
 
@@ -27,6 +27,7 @@
 #include "musicbrainz5/defines.h"
 
 #include "musicbrainz5/UserTag.h"
+#include "musicbrainz5/ElementName.h"
 
 class MusicBrainz5::CUserTagPrivate
 {
@@ -86,17 +87,17 @@ void MusicBrainz5::CUserTag::ParseAttribute(const std::string& Name, const std::
 
 void MusicBrainz5::CUserTag::ParseElement(const XMLNode& Node)
 {
-	std::string NodeName=Node.getName();
-
-	if ("name"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Name);
-	}
-	else
+	switch (CElementName::Lookup(Node))
 	{
+		case CElementName::eName_Name:
+			ProcessItem(Node,m_d->m_Name);
+			break;
+
+		default:
 #ifdef _MB5_DEBUG_
-		std::cerr << "Unrecognised UserTag element: '" << NodeName << "'" << std::endl;
+			std::cerr << "Unrecognised UserTag element: '" << Node.getName() << "'" << std::endl;
 #endif
+			break;
 	}
 }
 
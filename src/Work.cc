@@ -27,6 +27,7 @@
 #include "musicbrainz5/defines.h"
 
 #include "musicbrainz5/Work.h"
+#include "musicbrainz5/ElementName.h"
 
 #include "musicbrainz5/ArtistCredit.h"
 #include "musicbrainz5/AliasList.h"
@@ -176,71 +177,77 @@ MusicBrainz5::CWork *MusicBrainz5::CWork::Clone()
 
 void MusicBrainz5::CWork::ParseAttribute(const std::string& Name, const std::string& Value)
 {
-	if ("id"==Name)
-		m_d->m_ID=Value;
-	else if ("type"==Name)
-		m_d->m_Type=Value;
-	else
+	switch (CElementName::Lookup(Name))
 	{
+		case CElementName::eName_ID:
+			m_d->m_ID=Value;
+			break;
+
+		case CElementName::eName_Type:
+			m_d->m_Type=Value;
+			break;
+
+		default:
 #ifdef _MB5_DEBUG_
-		std::cerr << "Unrecognised work attribute: '" << Name << "'" << std::endl;
+			std::cerr << "Unrecognised work attribute: '" << Name << "'" << std::endl;
 #endif
+			break;
 	}
 }
 
 void MusicBrainz5::CWork::ParseElement(const XMLNode& Node)
 {
-	std::string NodeName=Node.getName();
-
-	if ("title"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Title);
-	}
-	else if ("artist-credit"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_ArtistCredit);
-	}
-	else if ("iswc-list"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_ISWCList);
-	}
-	else if ("disambiguation"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Disambiguation);
-	}
-	else if ("alias-list"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_AliasList);
-	}
-	else if ("relation-list"==NodeName)
-	{
-		ProcessRelationList(Node,m_d->m_RelationListList);
-	}
-	else if ("tag-list"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_TagList);
-	}
-	else if ("user-tag-list"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_UserTagList);
-	}
-	else if ("rating"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Rating);
-	}
-	else if ("user-rating"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_UserRating);
-	}
-	else if ("language"==NodeName)
-	{
-		ProcessItem(Node,m_d->m_Language);
-	}
-	else
+	switch (CElementName::Lookup(Node))
 	{
+		case CElementName::eName_Title:
+			ProcessItem(Node,m_d->m_Title);
+			break;
+
+		case CElementName::eName_ArtistCredit:
+			ProcessLazyItem(Node,m_d->m_ArtistCredit);
+			break;
+
+		case CElementName::eName_ISWCList:
+			ProcessLazyItem(Node,m_d->m_ISWCList);
+			break;
+
+		case CElementName::eName_Disambiguation:
+			ProcessItem(Node,m_d->m_Disambiguation);
+			break;
+
+		case CElementName::eName_AliasList:
+			ProcessLazyItem(Node,m_d->m_AliasList);
+			break;
+
+		case CElementName::eName_RelationList:
+			ProcessRelationList(Node,m_d->m_RelationListList);
+			break;
+
+		case CElementName::eName_TagList:
+			ProcessLazyItem(Node,m_d->m_TagList);
+			break;
+
+		case CElementName::eName_UserTagList:
+			ProcessLazyItem(Node,m_d->m_UserTagList);
+			break;
+
+		case CElementName::eName_Rating:
+			ProcessLazyItem(Node,m_d->m_Rating);
+			break;
+
+		case CElementName::eName_UserRating:
+			ProcessLazyItem(Node,m_d->m_UserRating);
+			break;
+
+		case CElementName::eName_Language:
+			ProcessItem(Node,m_d->m_Language);
+			break;
+
+		default:
 #ifdef _MB5_DEBUG_
-		std::cerr << "Unrecognised work element: '" << NodeName << "'" << std::endl;
+			std::cerr << "Unrecognised work element: '" << Node.getName() << "'" << std::endl;
 #endif
+			break;
 	}
 }
 
@@ -266,11 +273,15 @@ std::string MusicBrainz5::CWork::Title() const
 
 MusicBrainz5::CArtistCredit *MusicBrainz5::CWork::ArtistCredit() const
 {
+	Materialise(CElementName::eName_ArtistCredit);
+
 	return m_d->m_ArtistCredit;
 }
 
 MusicBrainz5::CISWCList *MusicBrainz5::CWork::ISWCList() const
 {
+	Materialise(CElementName::eName_ISWCList);
+
 	return m_d->m_ISWCList;
 }
 
@@ -281,31 +292,43 @@ std::string MusicBrainz5::CWork::Disambiguation() const
 
 MusicBrainz5::CAliasList *MusicBrainz5::CWork::AliasList() const
 {
+	Materialise(CElementName::eName_AliasList);
+
 	return m_d->m_AliasList;
 }
 
 MusicBrainz5::CRelationListList *MusicBrainz5::CWork::RelationListList() const
 {
+	Materialise(CElementName::eName_RelationList);
+
 	return m_d->m_RelationListList;
 }
 
 MusicBrainz5::CTagList *MusicBrainz5::CWork::TagList() const
 {
+	Materialise(CElementName::eName_TagList);
+
 	return m_d->m_TagList;
 }
 
 MusicBrainz5::CUserTagList *MusicBrainz5::CWork::UserTagList() const
 {
+	Materialise(CElementName::eName_UserTagList);
+
 	return m_d->m_UserTagList;
 }
 
 MusicBrainz5::CRating *MusicBrainz5::CWork::Rating() const
 {
+	Materialise(CElementName::eName_Rating);
+
 	return m_d->m_Rating;
 }
 
 MusicBrainz5::CUserRating *MusicBrainz5::CWork::UserRating() const
 {
+	Materialise(CElementName::eName_UserRating);
+
 	return m_d->m_UserRating;
 }
 
@@ -29,7 +29,169 @@
 #include "musicbrainz5/xmlParser.h"
 
 #include <cstring>
+#include <pthread.h>
 #include <libxml/tree.h>
+#include <libxml/parser.h>
+#include <libxml/xmlreader.h>
+
+/* Each thread keeps the parser context and reader it last used, so that they
+ * can be reset and used again for the next document instead of being rebuilt.
+ * Element and attribute names are interned in the dictionary belonging to
+ * each, and as the same names turn up in every document they are only hashed
+ * and allocated once. Interned strings are only freed along with the
+ * dictionary, so a context is replaced after this many documents to keep it
+ * from growing without bound. */
+static const int maxParserUses = 1000;
+
+struct ParserCache
+{
+    xmlParserCtxtPtr ctxt;
+    int ctxtUses;
+    xmlTextReaderPtr reader;
+    int readerUses;
+};
+
+static pthread_key_t parserCacheKey;
+static pthread_once_t parserCacheOnce = PTHREAD_ONCE_INIT;
+
+static void freeParserCache(void *data)
+{
+    ParserCache *cache = (ParserCache *)data;
+
+    if (cache->ctxt != NULL)
+        xmlFreeParserCtxt(cache->ctxt);
+    if (cache->reader != NULL)
+        xmlFreeTextReader(cache->reader);
+
+    delete cache;
+}
+
+static void createParserCacheKey()
+{
+    pthread_key_create(&parserCacheKey, freeParserCache);
+}
+
+static ParserCache *parserCache()
+{
+    pthread_once(&parserCacheOnce, createParserCacheKey);
+
+    ParserCache *cache = (ParserCache *)pthread_getspecific(parserCacheKey);
+    if (cache == NULL) {
+        cache = new ParserCache;
+        cache->ctxt = NULL;
+        cache->ctxtUses = 0;
+        cache->reader = NULL;
+        cache->readerUses = 0;
+        pthread_setspecific(parserCacheKey, cache);
+    }
+
+    return cache;
+}
+
+/* Contexts are taken out of the cache while they are in use, and put back in
+ * the cache of whichever thread finishes with them. Returns NULL if a context
+ * couldn't be created. */
+static xmlParserCtxtPtr acquireContext()
+{
+    ParserCache *cache = parserCache();
+    xmlParserCtxtPtr ctxt = cache->ctxt;
+
+    if (ctxt == NULL) {
+        ctxt = xmlNewParserCtxt();
+        cache->ctxtUses = 0;
+    }
+
+    cache->ctxt = NULL;
+    cache->ctxtUses++;
+
+    return ctxt;
+}
+
+static void releaseContext(xmlParserCtxtPtr ctxt)
+{
+    ParserCache *cache = parserCache();
+
+    if (ctxt->myDoc != NULL) {
+        xmlFreeDoc(ctxt->myDoc);
+        ctxt->myDoc = NULL;
+    }
+
+    if ((cache->ctxt == NULL) && (cache->ctxtUses < maxParserUses)) {
+        /* Drop the input of the last document now, rather than holding on to
+         * it until the next one */
+        xmlCtxtReset(ctxt);
+        cache->ctxt = ctxt;
+    } else {
+        xmlFreeParserCtxt(ctxt);
+    }
+}
+
+static xmlTextReaderPtr acquireReader(const char *xml, size_t len)
+{
+    ParserCache *cache = parserCache();
+    xmlTextReaderPtr reader = cache->reader;
+
+    cache->reader = NULL;
+
+    if ((reader != NULL) && (xmlReaderNewMemory(reader, xml, len, NULL, NULL, 0) != 0)) {
+        xmlFreeTextReader(reader);
+        reader = NULL;
+    }
+
+    if (reader == NULL) {
+        reader = xmlReaderForMemory(xml, len, NULL, NULL, 0);
+        cache->readerUses = 0;
+    }
+
+    cache->readerUses++;
+
+    return reader;
+}
+
+/* Some versions of libxml2 won't start a reader again once it has stopped on
+ * an error, so only readers that finished cleanly are kept */
+static void releaseReader(xmlTextReaderPtr reader, bool failed)
+{
+    ParserCache *cache = parserCache();
+
+    xmlTextReaderSetStructuredErrorHandler(reader, NULL, NULL);
+
+    if (!failed && (cache->reader == NULL) && (cache->readerUses < maxParserUses) &&
+        (xmlTextReaderClose(reader) == 0)) {
+        cache->reader = reader;
+    } else {
+        xmlFreeTextReader(reader);
+    }
+}
+
+static void contextError(xmlParserCtxtPtr ctxt, XMLResults *results)
+{
+    xmlErrorPtr error = xmlCtxtGetLastError(ctxt);
+    if (error != NULL) {
+        results->message = error->message ? error->message : "";
+        results->line = error->line;
+        results->code = error->code;
+    } else {
+        results->code = XML_ERR_INTERNAL_ERROR;
+    }
+}
+
+/* Keeps the first error reported by a reader, which also stops it being
+ * printed */
+#if LIBXML_VERSION >= 21200
+static void readerError(void *arg, const xmlError *error)
+#else
+static void readerError(void *arg, xmlErrorPtr error)
+#endif
+{
+    XMLResults *results = (XMLResults *)arg;
+
+    if ((error->level >= XML_ERR_ERROR) && (results->code == eXMLErrorNone)) {
+        results->message = error->message ? error->message : "";
+        results->line = error->line;
+        results->code = error->code;
+    }
+}
 
 XMLResults::XMLResults()
     : line(0),
@@ -37,7 +199,16 @@ XMLResults::XMLResults()
 {}
 
 XMLNode::XMLNode(xmlNodePtr node)
-    : mNode(node)
+    : mNode(node),
+      mStream(NULL),
+      mDepth(0)
+{
+}
+
+XMLNode::XMLNode(xmlNodePtr node, XMLStreamParser *stream, int depth)
+    : mNode(node),
+      mStream(stream),
+      mDepth(depth)
 {
 }
 
@@ -67,14 +238,86 @@ XMLNode *XMLRootNode::parseFile(const std::string &filename, XMLResults* results
 
 XMLNode *XMLRootNode::parseString(const std::string &xml, XMLResults* results)
 {
-    xmlDocPtr doc;
+    return parseString(xml.c_str(), xml.length(), results);
+}
 
-    doc = xmlParseMemory(xml.c_str(), xml.length());
-    if ((doc == NULL) && (results != NULL)) {
-        xmlErrorPtr error = xmlGetLastError();
-        results->message = error->message;
-        results->line = error->line;
-        results->code = error->code;
+XMLNode *XMLRootNode::parseString(const char *xml, size_t len, XMLResults* results)
+{
+    xmlDocPtr doc = NULL;
+
+    xmlParserCtxtPtr ctxt = acquireContext();
+    if (ctxt != NULL) {
+        xmlCtxtResetLastError(ctxt);
+
+        /* The document is handed over to the caller, who may free it on any
+         * thread, so it mustn't share the context's dictionary */
+        doc = xmlCtxtReadMemory(ctxt, xml, len, NULL, NULL, XML_PARSE_NODICT);
+        if ((doc == NULL) && (results != NULL))
+            contextError(ctxt, results);
+
+        releaseContext(ctxt);
+    } else if (results != NULL) {
+        results->code = XML_ERR_NO_MEMORY;
+    }
+
+    return new XMLRootNode(doc);
+}
+
+XMLPushParser::XMLPushParser(bool retain)
+    : mCtxt(NULL),
+      mRetain(retain)
+{
+}
+
+XMLPushParser::~XMLPushParser()
+{
+    if (mCtxt != NULL)
+        releaseContext(mCtxt);
+}
+
+void XMLPushParser::parseChunk(const char *data, size_t len)
+{
+    /* The first chunk is given to the context when it is reset, so the
+     * encoding can be detected from it. Errors are reported by finish(), once
+     * all the data has been seen. */
+    if (mCtxt == NULL) {
+        mCtxt = acquireContext();
+        if (mCtxt != NULL) {
+            xmlCtxtResetPush(mCtxt, data, len, NULL, NULL);
+            xmlCtxtUseOptions(mCtxt, mRetain ? XML_PARSE_NODICT : 0);
+            xmlCtxtResetLastError(mCtxt);
+        }
+    } else {
+        xmlParseChunk(mCtxt, data, len, 0);
+    }
+}
+
+XMLNode *XMLPushParser::finish(XMLResults *results)
+{
+    xmlDocPtr doc = NULL;
+
+    if (mCtxt == NULL)
+        parseChunk(NULL, 0);
+
+    if (mCtxt != NULL) {
+        xmlParseChunk(mCtxt, NULL, 0, 1);
+
+        doc = mCtxt->myDoc;
+        mCtxt->myDoc = NULL;
+
+        if (!mCtxt->wellFormed) {
+            if (results != NULL)
+                contextError(mCtxt, results);
+
+            if (doc != NULL)
+                xmlFreeDoc(doc);
+            doc = NULL;
+        }
+
+        releaseContext(mCtxt);
+        mCtxt = NULL;
+    } else if (results != NULL) {
+        results->code = XML_ERR_NO_MEMORY;
     }
 
     return new XMLRootNode(doc);
@@ -87,6 +330,9 @@ const char *XMLNode::getName() const
 
 const char *XMLNode::getText() const
 {
+    if (mStream != NULL)
+        return mStream->text(mDepth);
+
     if (mNode->children == NULL)
         return NULL;
     if (!xmlNodeIsText(mNode->children))
@@ -158,11 +404,24 @@ static xmlNodePtr skipTextNodes(xmlNodePtr node)
 
 XMLNode XMLNode::next() const
 {
+    if (mStream != NULL)
+        return mStream->nextSibling(mDepth);
+
     return XMLNode(skipTextNodes(mNode->next));
 }
 
 XMLNode XMLNode::getChildNode(const char *name) const
 {
+    if (mStream != NULL) {
+        /* Children can only be read once, so any before the one wanted are
+         * skipped for good */
+        XMLNode child = mStream->firstChild(mDepth);
+        while ((name != NULL) && !child.isEmpty() && (strcmp(name, child.getName()) != 0))
+            child = child.next();
+
+        return child;
+    }
+
     xmlNodePtr it;
     if (name == NULL)
         return XMLNode(skipTextNodes(mNode->children));
@@ -182,6 +441,198 @@ bool XMLNode::isEmpty() const
     return mNode == NULL;
 }
 
+static bool isTextType(int type)
+{
+    return (type == XML_READER_TYPE_TEXT) ||
+           (type == XML_READER_TYPE_WHITESPACE) ||
+           (type == XML_READER_TYPE_SIGNIFICANT_WHITESPACE);
+}
+
+XMLStreamParser::XMLStreamParser(const char *xml, size_t len)
+    : mReader(acquireReader(xml, len)),
+      mFailed(mReader == NULL)
+{
+    if (mReader != NULL)
+        xmlTextReaderSetStructuredErrorHandler(mReader, readerError, &mError);
+
+    mFrames.reserve(16);
+}
+
+XMLStreamParser::~XMLStreamParser()
+{
+    if (mReader != NULL)
+        releaseReader(mReader, mFailed);
+}
+
+XMLNode XMLStreamParser::root()
+{
+    while (read()) {
+        if (xmlTextReaderNodeType(mReader) == XML_READER_TYPE_ELEMENT)
+            return push(0);
+    }
+
+    return XMLNode::emptyNode();
+}
+
+bool XMLStreamParser::finish(XMLResults *results)
+{
+    /* Read whatever the caller didn't, so that errors anywhere in the
+     * document are reported */
+    while (read())
+        ;
+
+    mFrames.clear();
+
+    if (mFailed && (results != NULL)) {
+        if (mError.code != eXMLErrorNone)
+            *results = mError;
+        else
+            results->code = (mReader == NULL) ? XML_ERR_NO_MEMORY : XML_ERR_INTERNAL_ERROR;
+    }
+
+    return !mFailed;
+}
+
+bool XMLStreamParser::read()
+{
+    if (!mFailed) {
+        int ret = xmlTextReaderRead(mReader);
+        if (ret == 1)
+            return true;
+
+        if (ret < 0)
+            mFailed = true;
+    }
+
+    /* Nothing more can be read, so every open element is finished */
+    for (std::vector<Frame>::size_type i = 0; i < mFrames.size(); i++)
+        mFrames[i].state = eEnd;
+
+    return false;
+}
+
+/* The reader is at the start of an element at the given depth */
+XMLNode XMLStreamParser::push(int depth)
+{
+    Frame frame;
+    frame.node = xmlTextReaderCurrentNode(mReader);
+    frame.state = xmlTextReaderIsEmptyElement(mReader) ? eEnd : eStart;
+    frame.textChecked = false;
+    frame.hasText = false;
+
+    mFrames.resize(depth);
+    mFrames.push_back(frame);
+
+    return XMLNode(frame.node, this, depth);
+}
+
+/* Read on to the next child of the element at the given depth, noting its
+ * text if it starts with some */
+XMLNode XMLStreamParser::scan(int depth)
+{
+    while (read()) {
+        int type = xmlTextReaderNodeType(mReader);
+        int nodeDepth = xmlTextReaderDepth(mReader);
+
+        if ((nodeDepth == depth) && (type == XML_READER_TYPE_END_ELEMENT)) {
+            mFrames[depth].state = eEnd;
+            break;
+        }
+
+        if (nodeDepth != depth + 1)
+            continue;
+
+        bool first = !mFrames[depth].textChecked;
+        mFrames[depth].textChecked = true;
+
+        if (type == XML_READER_TYPE_ELEMENT) {
+            mFrames[depth].state = eChildren;
+            return push(depth + 1);
+        }
+
+        if (first && isTextType(type)) {
+            const xmlChar *value = xmlTextReaderConstValue(mReader);
+            mFrames[depth].hasText = true;
+            mFrames[depth].text = value ? (const char *)value : "";
+        }
+    }
+
+    return XMLNode::emptyNode();
+}
+
+XMLNode XMLStreamParser::firstChild(int depth)
+{
+    if (depth >= (int)mFrames.size())
+        return XMLNode::emptyNode();
+
+    switch (mFrames[depth].state) {
+        case eStart:
+        case eText:
+            return scan(depth);
+
+        case ePending:
+            mFrames[depth].state = eChildren;
+            return push(depth + 1);
+
+        default:
+            return XMLNode::emptyNode();
+    }
+}
+
+XMLNode XMLStreamParser::nextSibling(int depth)
+{
+    if ((depth == 0) || (depth >= (int)mFrames.size()))
+        return XMLNode::emptyNode();
+
+    /* Skip whatever is left of this element, including any children that
+     * weren't read */
+    if (mFrames[depth].state != eEnd) {
+        while (read()) {
+            if ((xmlTextReaderNodeType(mReader) == XML_READER_TYPE_END_ELEMENT) &&
+                (xmlTextReaderDepth(mReader) == depth))
+                break;
+        }
+    }
+
+    mFrames.resize(depth);
+
+    return scan(depth - 1);
+}
+
+/* The text of an element is its first child, if that is text. If its children
+ * haven't been read yet, look at the first one, and leave it for firstChild()
+ * if it turns out to be an element. */
+const char *XMLStreamParser::text(int depth)
+{
+    if (depth >= (int)mFrames.size())
+        return NULL;
+
+    Frame &frame = mFrames[depth];
+
+    if (frame.state == eStart) {
+        frame.state = eText;
+
+        if (read()) {
+            int type = xmlTextReaderNodeType(mReader);
+            int nodeDepth = xmlTextReaderDepth(mReader);
+
+            frame.textChecked = true;
+
+            if ((nodeDepth == depth) && (type == XML_READER_TYPE_END_ELEMENT)) {
+                frame.state = eEnd;
+            } else if (type == XML_READER_TYPE_ELEMENT) {
+                frame.state = ePending;
+            } else if (isTextType(type)) {
+                const xmlChar *value = xmlTextReaderConstValue(mReader);
+                frame.hasText = true;
+                frame.text = value ? (const char *)value : "";
+            }
+        }
+    }
+
+    return frame.hasText ? frame.text.c_str() : NULL;
+}
+
 XMLAttribute::XMLAttribute(xmlAttrPtr attr)
     : mAttr(attr)
 {
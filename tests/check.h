@@ -0,0 +1,53 @@
+/* --------------------------------------------------------------------------
+
+   libmusicbrainz5 - Client library to access MusicBrainz
+
+   Copyright (C) 2012 Andrew Hawkins
+
+   This file is part of libmusicbrainz5.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   libmusicbrainz5 is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+     $Id$
+
+----------------------------------------------------------------------------*/
+
+#ifndef _MUSICBRAINZ5_TESTS_CHECK_H
+#define _MUSICBRAINZ5_TESTS_CHECK_H
+
+#include <iostream>
+#include <string>
+
+//Shared by the unit tests, each of which is a single source file. Every condition is
+//passed to Check, and main returns the result of Report.
+
+static int Failed=0;
+
+static void Check(bool Passed, const std::string& Description)
+{
+	if (!Passed)
+	{
+		std::cout << "FAILED: " << Description << std::endl;
+		Failed++;
+	}
+}
+
+static int Report()
+{
+	std::cout << Failed << " failures" << std::endl;
+
+	return Failed ? 1 : 0;
+}
+
+#endif
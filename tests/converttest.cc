@@ -0,0 +1,169 @@
+/* --------------------------------------------------------------------------
+
+   libmusicbrainz5 - Client library to access MusicBrainz
+
+   Copyright (C) 2012 Andrew Hawkins
+
+   This file is part of libmusicbrainz5.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   libmusicbrainz5 is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+     $Id$
+
+----------------------------------------------------------------------------*/
+
+/*
+ * Checks that integers and doubles in responses are converted exactly as they were
+ * when they were read through a std::stringstream: the same value for every input,
+ * and the value left alone where the stream would fail. A list of awkward inputs is
+ * followed by a large number of random ones, and the conversion is checked not to
+ * depend on the current locale.
+ */
+
+#include <iostream>
+#include <string>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <clocale>
+
+#include "musicbrainz5/Entity.h"
+
+#include "check.h"
+
+//Gives access to the conversions, and to the stream based template they replace
+
+class CConverter: public MusicBrainz5::CEntity
+{
+public:
+	CConverter *Clone()
+	{
+		return new CConverter(*this);
+	}
+
+	template<class T>
+	T Convert(const std::string& Text)
+	{
+		T RetVal=7;
+		ProcessItem(Text,RetVal);
+		return RetVal;
+	}
+
+	template<class T>
+	T Stream(const std::string& Text)
+	{
+		T RetVal=7;
+		ProcessItem<T>(Text,RetVal);
+		return RetVal;
+	}
+
+private:
+	void ParseAttribute(const std::string&, const std::string&)
+	{
+	}
+
+	void ParseElement(const XMLNode&)
+	{
+	}
+};
+
+template<class T>
+static void Compare(CConverter& Converter, const std::string& Text)
+{
+	T Converted=Converter.Convert<T>(Text);
+	T Streamed=Converter.Stream<T>(Text);
+
+	//Compare the representation, so that the sign of zero matters
+
+	if (0!=memcmp(&Converted,&Streamed,sizeof(T)))
+	{
+		std::cout << "Converted '" << Text << "' to " << Converted << ", stream gave " << Streamed << std::endl;
+		Check(false,"conversion matches the stream");
+	}
+}
+
+static const char *Edges[]=
+{
+	"", "0", "-0", "+5", " 42", "\t\n7x", "12abc", "abc", "-", "+",
+	"2147483647", "2147483648", "-2147483648", "-2147483649",
+	"99999999999999999999", "-99999999999999999999", "007",
+	"1.5", "4.5", "0.1", ".5", "5.", ".", " -3.25e2", "1e", "1e+", "1e-5",
+	"1E22", "1e23", "1e-22", "1e-23", "123456789012345", "1234567890123456",
+	"0.000000000000000000001234", "3.14159265358979", "2.718281828459045",
+	"1e400", "-1e400", "1e-400", "0.30000000000000004", "4,5", "  +.0e-0",
+	"9007199254740993", "0.0000001", "100000000000000000000000",
+};
+
+int main(int, const char *[])
+{
+	CConverter Converter;
+
+	for (unsigned int count=0;count<sizeof(Edges)/sizeof(Edges[0]);count++)
+	{
+		Compare<int>(Converter,Edges[count]);
+		Compare<double>(Converter,Edges[count]);
+	}
+
+	//Integers, fixed point, shortest and exponent forms, long fractions and values
+	//that overflow an int
+
+	srand(1);
+
+	for (int count=0;count<300000;count++)
+	{
+		char Text[512];
+
+		switch (rand()%6)
+		{
+			case 0:
+				sprintf(Text,"%d",rand()-RAND_MAX/2);
+				break;
+
+			case 1:
+				sprintf(Text,"%.*f",rand()%8,(rand()-RAND_MAX/2)/(double)(1+rand()%100000));
+				break;
+
+			case 2:
+				sprintf(Text,"%.*g",1+rand()%17,(rand()/(double)RAND_MAX)*pow(10.0,rand()%60-30));
+				break;
+
+			case 3:
+				sprintf(Text,"%.*e",rand()%16,(rand()/(double)RAND_MAX)*pow(10.0,rand()%50-25));
+				break;
+
+			case 4:
+				sprintf(Text,"%d.%0*d",rand()%1000,1+rand()%9,rand()%1000000000);
+				break;
+
+			default:
+				sprintf(Text,"%ld",(long)rand()*rand()*(rand()%2 ? 1 : -1));
+				break;
+		}
+
+		Compare<int>(Converter,Text);
+		Compare<double>(Converter,Text);
+	}
+
+	//A locale with a decimal comma must not change how responses are read
+
+	if (setlocale(LC_NUMERIC,"de_DE.UTF-8") || setlocale(LC_NUMERIC,"fr_FR.UTF-8"))
+	{
+		Check(4.5==Converter.Convert<double>("4.5"),"decimal point read regardless of the locale");
+		Check(1234==Converter.Convert<int>("1234"),"integer read regardless of the locale");
+		setlocale(LC_NUMERIC,"C");
+	}
+
+	return Report();
+}
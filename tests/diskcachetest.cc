@@ -0,0 +1,302 @@
+/* --------------------------------------------------------------------------
+
+   libmusicbrainz5 - Client library to access MusicBrainz
+
+   Copyright (C) 2012 Andrew Hawkins
+
+   This file is part of libmusicbrainz5.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   libmusicbrainz5 is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+     $Id$
+
+----------------------------------------------------------------------------*/
+
+/*
+ * Checks MusicBrainz5::CDiskCache in a temporary directory: that responses are
+ * returned as written with their validators, that files which are corrupt, truncated
+ * or hold another query are ignored, that expired entries are only kept if they can
+ * be revalidated, and that Collect removes old entries, abandoned temporary files and
+ * the oldest entries over the size limit.
+ */
+
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <utime.h>
+#include <sys/stat.h>
+
+#include "musicbrainz5/DiskCache.h"
+
+#include "check.h"
+
+class CStringReader: public MusicBrainz5::CHTTPBodyReader
+{
+public:
+	virtual bool Read(const char *Data, size_t Length)
+	{
+		m_Body.append(Data,Length);
+		return true;
+	}
+
+	std::string m_Body;
+};
+
+//The body cached for a query, or an empty string if there is none
+
+static std::string Cached(MusicBrainz5::CDiskCache& Cache, const std::string& Query)
+{
+	CStringReader Reader;
+	if (Cache.Get(Query,Reader))
+		return Reader.m_Body;
+
+	return "";
+}
+
+//Paths of the files in the cache's subdirectories, including temporary files
+
+static std::vector<std::string> Files(const std::string& Directory)
+{
+	std::vector<std::string> Ret;
+
+	DIR *Top=opendir(Directory.c_str());
+	if (Top)
+	{
+		struct dirent *SubDir;
+		while (0!=(SubDir=readdir(Top)))
+		{
+			std::string SubDirPath=Directory+"/"+SubDir->d_name;
+
+			DIR *Entries='.'==SubDir->d_name[0] ? 0 : opendir(SubDirPath.c_str());
+			if (Entries)
+			{
+				struct dirent *Entry;
+				while (0!=(Entry=readdir(Entries)))
+				{
+					std::string Name=Entry->d_name;
+					if ("."!=Name && ".."!=Name)
+						Ret.push_back(SubDirPath+"/"+Name);
+				}
+
+				closedir(Entries);
+			}
+		}
+
+		closedir(Top);
+	}
+
+	return Ret;
+}
+
+static std::string ReadFile(const std::string& Path)
+{
+	std::string Ret;
+
+	FILE *File=fopen(Path.c_str(),"rb");
+	if (File)
+	{
+		char Buffer[4096];
+		size_t Length;
+		while (0!=(Length=fread(Buffer,1,sizeof(Buffer),File)))
+			Ret.append(Buffer,Length);
+
+		fclose(File);
+	}
+
+	return Ret;
+}
+
+static void WriteFile(const std::string& Path, const std::string& Contents)
+{
+	FILE *File=fopen(Path.c_str(),"wb");
+	if (File)
+	{
+		fwrite(Contents.data(),1,Contents.length(),File);
+		fclose(File);
+	}
+}
+
+static void SetAge(const std::string& Path, int Seconds)
+{
+	struct utimbuf Times;
+	Times.actime=Times.modtime=time(0)-Seconds;
+	utime(Path.c_str(),&Times);
+}
+
+static void RemoveAll(const std::string& Directory)
+{
+	std::vector<std::string> Paths=Files(Directory);
+	for (std::vector<std::string>::const_iterator ThisPath=Paths.begin();ThisPath!=Paths.end();++ThisPath)
+		unlink((*ThisPath).c_str());
+
+	DIR *Top=opendir(Directory.c_str());
+	if (Top)
+	{
+		struct dirent *SubDir;
+		while (0!=(SubDir=readdir(Top)))
+		{
+			std::string Name=SubDir->d_name;
+			if ("."!=Name && ".."!=Name)
+				rmdir((Directory+"/"+Name).c_str());
+		}
+
+		closedir(Top);
+	}
+
+	unlink((Directory+"/.collect").c_str());
+	rmdir(Directory.c_str());
+}
+
+int main(int, const char *[])
+{
+	char Template[]="/tmp/mb5diskcachetest.XXXXXX";
+	if (!mkdtemp(Template))
+	{
+		Check(false,"temporary directory created");
+		return Report();
+	}
+
+	std::string Directory=Template;
+
+	const std::string Release="/ws/2/release/1?inc=artists";
+	const std::string Body="<metadata><release id=\"1\"/></metadata>\n\nwith a blank line";
+
+	MusicBrainz5::CDiskCache Cache(Directory);
+	Cache.SetCollectInterval(0);
+
+	Check(""==Cached(Cache,Release) && 1==Cache.Misses(),"missing query not found");
+
+	//Writing an entry leaves just the one file, named after the query's hash
+
+	Cache.Put(Release,Body.data(),Body.length());
+	std::vector<std::string> Written=Files(Directory);
+	Check(1==Written.size() && 1==Cache.Writes(),"entry written without leaving a temporary file");
+	Check(Body==Cached(Cache,Release) && 1==Cache.Hits(),"body returned as written");
+
+	std::string ETag;
+	std::string LastModified;
+	Check(!Cache.Validators(Release,ETag,LastModified),"no validators for a plain entry");
+
+	Cache.Put(Release,Body.data(),Body.length(),"\"v1\"","Sat, 01 Jan 2000 00:00:00 GMT");
+	CStringReader Reader;
+	Check(Cache.Get(Release,Reader,ETag,LastModified) && Body==Reader.m_Body,"entry replaced");
+	Check("\"v1\""==ETag && "Sat, 01 Jan 2000 00:00:00 GMT"==LastModified,"validators returned with the body");
+
+	//Files that don't hold this query are ignored
+
+	if (1==Written.size())
+	{
+		std::string Path=Written[0];
+		std::string Contents=ReadFile(Path);
+
+		std::string Other=Contents;
+		std::string::size_type URL=Other.find(Release);
+		if (std::string::npos!=URL)
+			Other.replace(URL,Release.length(),"/ws/2/release/2");
+		WriteFile(Path,Other);
+		Check(""==Cached(Cache,Release),"entry for another query with the same hash ignored");
+
+		WriteFile(Path,Contents.substr(0,Contents.find("etag")));
+		Check(""==Cached(Cache,Release),"truncated entry ignored");
+
+		WriteFile(Path,"garbage"+Contents);
+		Check(""==Cached(Cache,Release),"corrupt entry ignored");
+
+		WriteFile(Path,"");
+		Check(""==Cached(Cache,Release),"empty entry ignored");
+	}
+
+	Cache.SetTTL("label",0);
+	Cache.Put("/ws/2/label/1",Body.data(),Body.length());
+	Check(1==Files(Directory).size(),"entity with no time to live not written");
+
+	//Expired entries are only kept if they can be revalidated
+
+	Cache.Remove(Release);
+	Check(Files(Directory).empty(),"entry removed");
+
+	const std::string Plain="/ws/2/artist/plain";
+	const std::string Tagged="/ws/2/artist/tagged";
+
+	Cache.SetDefaultTTL(60);
+	Cache.Put(Plain,Body.data(),Body.length());
+	Cache.Put(Tagged,Body.data(),Body.length(),"\"v2\"");
+
+	std::vector<std::string> Paths=Files(Directory);
+	for (std::vector<std::string>::const_iterator ThisPath=Paths.begin();ThisPath!=Paths.end();++ThisPath)
+		SetAge(*ThisPath,120);
+
+	Check(""==Cached(Cache,Plain) && ""==Cached(Cache,Tagged),"expired entries not returned");
+	Check(1==Files(Directory).size(),"expired entry without validators removed");
+	Check(Cache.Validators(Tagged,ETag,LastModified) && "\"v2\""==ETag,"expired entry with validators kept");
+
+	Cache.Touch(Tagged);
+	Check(Body==Cached(Cache,Tagged),"touched entry returned again");
+
+	//Collect removes entries past their time to live and how long they are kept after,
+	//temporary files abandoned by another process, and the oldest entries over the limit
+
+	Cache.SetMaxStale(60);
+
+	const std::string Old="/ws/2/artist/old";
+	Cache.Put(Old,Body.data(),Body.length(),"\"v3\"");
+
+	Paths=Files(Directory);
+	std::string SubDir=Paths[0].substr(0,Paths[0].rfind('/'));
+	WriteFile(SubDir+"/.tmp.1.0","abandoned");
+	SetAge(SubDir+"/.tmp.1.0",7200);
+	WriteFile(SubDir+"/.tmp.1.1","in progress");
+
+	for (std::vector<std::string>::const_iterator ThisPath=Paths.begin();ThisPath!=Paths.end();++ThisPath)
+	{
+		if (std::string::npos!=ReadFile(*ThisPath).find(Old))
+			SetAge(*ThisPath,180);
+	}
+
+	Cache.Collect();
+	Check(2==Cache.Collected(),"expired entry and abandoned temporary file collected");
+	Check(""==Cached(Cache,Old) && !Cache.Validators(Old,ETag,LastModified),"entry past its time to keep removed");
+	Check(Body==Cached(Cache,Tagged),"current entry kept");
+	Check(2==Files(Directory).size(),"temporary file in progress kept");
+
+	unlink((SubDir+"/.tmp.1.1").c_str());
+
+	const std::string Newer="/ws/2/artist/newer";
+	Cache.Put(Newer,Body.data(),Body.length());
+
+	size_t Bytes=0;
+
+	Paths=Files(Directory);
+	for (std::vector<std::string>::const_iterator ThisPath=Paths.begin();ThisPath!=Paths.end();++ThisPath)
+	{
+		std::string Contents=ReadFile(*ThisPath);
+		if (std::string::npos!=Contents.find(Tagged))
+			SetAge(*ThisPath,10);
+
+		Bytes+=Contents.length();
+	}
+
+	Cache.SetMaxBytes(Bytes-1);
+	Cache.Collect();
+	Check(""==Cached(Cache,Tagged) && Body==Cached(Cache,Newer),"oldest entry collected over the size limit");
+
+	RemoveAll(Directory);
+
+	return Report();
+}
@@ -0,0 +1,192 @@
+/* --------------------------------------------------------------------------
+
+   libmusicbrainz5 - Client library to access MusicBrainz
+
+   Copyright (C) 2012 Andrew Hawkins
+
+   This file is part of libmusicbrainz5.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   libmusicbrainz5 is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+     $Id$
+
+----------------------------------------------------------------------------*/
+
+/*
+ * Checks MusicBrainz5::CElementName: that every name parsed from a response maps to
+ * its own value, whether given as a C string, a std::string or an element, and that
+ * names it does not know, including ones that differ only slightly from those it
+ * does, map to eName_Unknown.
+ */
+
+#include <string>
+
+#include "musicbrainz5/ElementName.h"
+
+#include "check.h"
+
+static const struct
+{
+	MusicBrainz5::CElementName::tName m_Value;
+	const char *m_Name;
+} Names[]=
+{
+	{MusicBrainz5::CElementName::eName_AliasList,"alias-list"},
+	{MusicBrainz5::CElementName::eName_AnnotationList,"annotation-list"},
+	{MusicBrainz5::CElementName::eName_Artist,"artist"},
+	{MusicBrainz5::CElementName::eName_ArtistCredit,"artist-credit"},
+	{MusicBrainz5::CElementName::eName_ArtistList,"artist-list"},
+	{MusicBrainz5::CElementName::eName_ASIN,"asin"},
+	{MusicBrainz5::CElementName::eName_AttributeList,"attribute-list"},
+	{MusicBrainz5::CElementName::eName_Barcode,"barcode"},
+	{MusicBrainz5::CElementName::eName_Begin,"begin"},
+	{MusicBrainz5::CElementName::eName_BeginDate,"begin-date"},
+	{MusicBrainz5::CElementName::eName_CatalogNumber,"catalog-number"},
+	{MusicBrainz5::CElementName::eName_Category,"category"},
+	{MusicBrainz5::CElementName::eName_CDStub,"cdstub"},
+	{MusicBrainz5::CElementName::eName_CDStubList,"cdstub-list"},
+	{MusicBrainz5::CElementName::eName_Collection,"collection"},
+	{MusicBrainz5::CElementName::eName_CollectionList,"collection-list"},
+	{MusicBrainz5::CElementName::eName_Comment,"comment"},
+	{MusicBrainz5::CElementName::eName_Count,"count"},
+	{MusicBrainz5::CElementName::eName_Country,"country"},
+	{MusicBrainz5::CElementName::eName_Created,"created"},
+	{MusicBrainz5::CElementName::eName_Date,"date"},
+	{MusicBrainz5::CElementName::eName_Direction,"direction"},
+	{MusicBrainz5::CElementName::eName_Disambiguation,"disambiguation"},
+	{MusicBrainz5::CElementName::eName_Disc,"disc"},
+	{MusicBrainz5::CElementName::eName_DiscList,"disc-list"},
+	{MusicBrainz5::CElementName::eName_Editor,"editor"},
+	{MusicBrainz5::CElementName::eName_End,"end"},
+	{MusicBrainz5::CElementName::eName_EndDate,"end-date"},
+	{MusicBrainz5::CElementName::eName_Ended,"ended"},
+	{MusicBrainz5::CElementName::eName_Entity,"entity"},
+	{MusicBrainz5::CElementName::eName_FirstReleaseDate,"first-release-date"},
+	{MusicBrainz5::CElementName::eName_Format,"format"},
+	{MusicBrainz5::CElementName::eName_FreeDBDiscList,"freedb-disc-list"},
+	{MusicBrainz5::CElementName::eName_Gender,"gender"},
+	{MusicBrainz5::CElementName::eName_Generator,"generator"},
+	{MusicBrainz5::CElementName::eName_ID,"id"},
+	{MusicBrainz5::CElementName::eName_IPI,"ipi"},
+	{MusicBrainz5::CElementName::eName_IPIList,"ipi-list"},
+	{MusicBrainz5::CElementName::eName_ISRC,"isrc"},
+	{MusicBrainz5::CElementName::eName_ISRCList,"isrc-list"},
+	{MusicBrainz5::CElementName::eName_ISWCList,"iswc-list"},
+	{MusicBrainz5::CElementName::eName_Joinphrase,"joinphrase"},
+	{MusicBrainz5::CElementName::eName_Label,"label"},
+	{MusicBrainz5::CElementName::eName_LabelCode,"label-code"},
+	{MusicBrainz5::CElementName::eName_LabelInfoList,"label-info-list"},
+	{MusicBrainz5::CElementName::eName_LabelList,"label-list"},
+	{MusicBrainz5::CElementName::eName_Language,"language"},
+	{MusicBrainz5::CElementName::eName_Length,"length"},
+	{MusicBrainz5::CElementName::eName_LifeSpan,"life-span"},
+	{MusicBrainz5::CElementName::eName_Locale,"locale"},
+	{MusicBrainz5::CElementName::eName_MediumList,"medium-list"},
+	{MusicBrainz5::CElementName::eName_Message,"message"},
+	{MusicBrainz5::CElementName::eName_Name,"name"},
+	{MusicBrainz5::CElementName::eName_NameCredit,"name-credit"},
+	{MusicBrainz5::CElementName::eName_NonmbTrackList,"nonmb-track-list"},
+	{MusicBrainz5::CElementName::eName_Number,"number"},
+	{MusicBrainz5::CElementName::eName_Offset,"offset"},
+	{MusicBrainz5::CElementName::eName_OffsetList,"offset-list"},
+	{MusicBrainz5::CElementName::eName_Packaging,"packaging"},
+	{MusicBrainz5::CElementName::eName_Position,"position"},
+	{MusicBrainz5::CElementName::eName_Primary,"primary"},
+	{MusicBrainz5::CElementName::eName_PrimaryType,"primary-type"},
+	{MusicBrainz5::CElementName::eName_PUID,"puid"},
+	{MusicBrainz5::CElementName::eName_PUIDList,"puid-list"},
+	{MusicBrainz5::CElementName::eName_Quality,"quality"},
+	{MusicBrainz5::CElementName::eName_Rating,"rating"},
+	{MusicBrainz5::CElementName::eName_Recording,"recording"},
+	{MusicBrainz5::CElementName::eName_RecordingList,"recording-list"},
+	{MusicBrainz5::CElementName::eName_RelationList,"relation-list"},
+	{MusicBrainz5::CElementName::eName_Release,"release"},
+	{MusicBrainz5::CElementName::eName_ReleaseGroup,"release-group"},
+	{MusicBrainz5::CElementName::eName_ReleaseGroupList,"release-group-list"},
+	{MusicBrainz5::CElementName::eName_ReleaseList,"release-list"},
+	{MusicBrainz5::CElementName::eName_Script,"script"},
+	{MusicBrainz5::CElementName::eName_SecondaryTypeList,"secondary-type-list"},
+	{MusicBrainz5::CElementName::eName_Sectors,"sectors"},
+	{MusicBrainz5::CElementName::eName_SortName,"sort-name"},
+	{MusicBrainz5::CElementName::eName_Status,"status"},
+	{MusicBrainz5::CElementName::eName_TagList,"tag-list"},
+	{MusicBrainz5::CElementName::eName_Target,"target"},
+	{MusicBrainz5::CElementName::eName_TargetType,"target-type"},
+	{MusicBrainz5::CElementName::eName_Text,"text"},
+	{MusicBrainz5::CElementName::eName_TextRepresentation,"text-representation"},
+	{MusicBrainz5::CElementName::eName_Title,"title"},
+	{MusicBrainz5::CElementName::eName_TrackCount,"track-count"},
+	{MusicBrainz5::CElementName::eName_TrackList,"track-list"},
+	{MusicBrainz5::CElementName::eName_Type,"type"},
+	{MusicBrainz5::CElementName::eName_UserRating,"user-rating"},
+	{MusicBrainz5::CElementName::eName_UserTagList,"user-tag-list"},
+	{MusicBrainz5::CElementName::eName_VotesCount,"votes-count"},
+	{MusicBrainz5::CElementName::eName_Work,"work"},
+	{MusicBrainz5::CElementName::eName_WorkList,"work-list"},
+	{MusicBrainz5::CElementName::eName_XMLNS,"xmlns"},
+	{MusicBrainz5::CElementName::eName_XMLNSExt,"xmlns:ext"},
+	{MusicBrainz5::CElementName::eName_Year,"year"},
+};
+
+static const char *Unknown[]=
+{
+	"",
+	"releases",
+	"releas",
+	"release-",
+	"Release",
+	"release-group-list-",
+	"xmlns:ex",
+	"metadata",
+	"this-name-is-longer-than-any-known-name",
+};
+
+int main(int, const char *[])
+{
+	const int NumNames=sizeof(Names)/sizeof(Names[0]);
+	Check(MusicBrainz5::CElementName::eName_NumNames-1==NumNames,"every name is checked");
+
+	for (int count=0;count<NumNames;count++)
+	{
+		std::string Name=Names[count].m_Name;
+
+		Check(Names[count].m_Value==MusicBrainz5::CElementName::Lookup(Name.c_str()),"'"+Name+"' found from a C string");
+		Check(Names[count].m_Value==MusicBrainz5::CElementName::Lookup(Name),"'"+Name+"' found from a std::string");
+		Check(Names[count].m_Value!=MusicBrainz5::CElementName::Lookup(Name+"x"),"'"+Name+"' not matched as a prefix");
+	}
+
+	for (unsigned int count=0;count<sizeof(Unknown)/sizeof(Unknown[0]);count++)
+	{
+		std::string Name=Unknown[count];
+		Check(MusicBrainz5::CElementName::eName_Unknown==MusicBrainz5::CElementName::Lookup(Name),"'"+Name+"' not found");
+	}
+
+	Check(MusicBrainz5::CElementName::eName_Unknown==MusicBrainz5::CElementName::Lookup((const char *)0),"NULL name not found");
+
+	XMLResults Results;
+	XMLNode *TopNode=XMLRootNode::parseString("<release-group><title/><unknown/></release-group>",&Results);
+	Check(Results.code==eXMLErrorNone,"test document parsed");
+	if (Results.code==eXMLErrorNone)
+	{
+		XMLNode Title=TopNode->getChildNode();
+
+		Check(MusicBrainz5::CElementName::eName_ReleaseGroup==MusicBrainz5::CElementName::Lookup(*TopNode),"document element found");
+		Check(MusicBrainz5::CElementName::eName_Title==MusicBrainz5::CElementName::Lookup(Title),"child element found");
+		Check(MusicBrainz5::CElementName::eName_Unknown==MusicBrainz5::CElementName::Lookup(Title.next()),"unknown element not found");
+	}
+
+	delete TopNode;
+
+	return Report();
+}
@@ -25,6 +25,7 @@
 
 #include <iostream>
 
+#include <stdlib.h>
 #include <strings.h>
 
 #include "musicbrainz5/Query.h"
@@ -52,6 +53,9 @@
 #include "musicbrainz5/IPI.h"
 #include "musicbrainz5/IPIList.h"
 #include "musicbrainz5/Lifespan.h"
+#include "musicbrainz5/NeonTransport.h"
+#include "musicbrainz5/RecordingTransport.h"
+#include "musicbrainz5/ReplayTransport.h"
 
 void PrintRelationList(MusicBrainz5::CRelationList *RelationList)
 {
@@ -66,7 +70,25 @@ void PrintRelationList(MusicBrainz5::CRelationList *RelationList)
 
 int main(int argc, const char *argv[])
 {
+	//Set MB5_RECORD to record the responses to an archive, and MB5_REPLAY to run again
+	//from that archive without a network. MB5_LATENCY scales the recorded latency.
+
+	MusicBrainz5::CNeonTransport Neon("MBTest/v1.0","musicbrainz.org");
+	MusicBrainz5::CTransport *Transport=0;
+
+	if (getenv("MB5_REPLAY"))
+	{
+		MusicBrainz5::CReplayTransport *Replay=new MusicBrainz5::CReplayTransport(getenv("MB5_REPLAY"));
+		if (getenv("MB5_LATENCY"))
+			Replay->SetLatencyScale(atof(getenv("MB5_LATENCY")));
+
+		Transport=Replay;
+	}
+	else if (getenv("MB5_RECORD"))
+		Transport=new MusicBrainz5::CRecordingTransport(Neon,getenv("MB5_RECORD"));
+
 	MusicBrainz5::CQuery MB2("MBTest/v1.0","musicbrainz.org");
+	MB2.SetTransport(Transport);
 
 	MusicBrainz5::CQuery::tParamMap Params5;
 	Params5["inc"]="aliases";
@@ -195,17 +217,20 @@ int main(int argc, const char *argv[])
 //	return 0;
 
 	MusicBrainz5::CQuery MB("MBTest/v1.0");
+	MB.SetTransport(Transport);
 
 	if (argc>1)
 	{
 		std::cout << "Setting username: '" << argv[1] << "'" << std::endl;
 		MB.SetUserName(argv[1]);
+		Neon.SetUserName(argv[1]);
 	}
 
 	if (argc>2)
 	{
 		std::cout << "Setting password: '" << argv[2] << "'" << std::endl;
 		MB.SetPassword(argv[2]);
+		Neon.SetPassword(argv[2]);
 	}
 
 	MusicBrainz5::CQuery::tParamMap Params2;
@@ -333,5 +358,7 @@ int main(int argc, const char *argv[])
 		std::cout << std::endl << std::endl;
 	}
 
+	delete Transport;
+
 	return 0;
 }
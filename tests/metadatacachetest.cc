@@ -0,0 +1,145 @@
+/* --------------------------------------------------------------------------
+
+   libmusicbrainz5 - Client library to access MusicBrainz
+
+   Copyright (C) 2012 Andrew Hawkins
+
+   This file is part of libmusicbrainz5.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   libmusicbrainz5 is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+     $Id$
+
+----------------------------------------------------------------------------*/
+
+/*
+ * Checks MusicBrainz5::CMetadataCache: that results are returned as they were added,
+ * that missing resources are remembered, that entries expire after their time to live
+ * and can then be revalidated, and that the least recently used entries are evicted
+ * to keep within the limits.
+ */
+
+#include <string>
+
+#include <time.h>
+
+#include "musicbrainz5/xmlParser.h"
+#include "musicbrainz5/Metadata.h"
+#include "musicbrainz5/MetadataCache.h"
+
+#include "check.h"
+
+//Metadata that can be told apart by its generator
+
+static MusicBrainz5::CMetadata Metadata(const std::string& Generator)
+{
+	MusicBrainz5::CMetadata Ret;
+
+	XMLResults Results;
+	XMLNode *TopNode=XMLRootNode::parseString("<metadata generator=\""+Generator+"\"/>",&Results);
+	if (Results.code==eXMLErrorNone)
+		Ret=MusicBrainz5::CMetadata(*TopNode);
+
+	delete TopNode;
+
+	return Ret;
+}
+
+//The generator of the cached result for a query, or an empty string if there is none
+
+static std::string Cached(MusicBrainz5::CMetadataCache& Cache, const std::string& Query)
+{
+	MusicBrainz5::CMetadata Result;
+	if (Cache.Get(Query,Result))
+		return Result.Generator();
+
+	return "";
+}
+
+int main(int, const char *[])
+{
+	Check("release"==MusicBrainz5::CMetadataCache::Entity("/ws/2/release/ID?inc=artists"),"entity of a lookup");
+	Check("artist"==MusicBrainz5::CMetadataCache::Entity("/ws/2/artist?query=name"),"entity of a search");
+	Check("discid"==MusicBrainz5::CMetadataCache::Entity("discid/ID"),"entity without the prefix");
+
+	MusicBrainz5::CMetadataCache Cache(3,1000);
+
+	Cache.Put("/ws/2/release/1",Metadata("one"),10);
+	Check("one"==Cached(Cache,"/ws/2/release/1"),"result returned as added");
+	Check(""==Cached(Cache,"/ws/2/release/2"),"missing query not found");
+	Check(1==Cache.Hits() && 1==Cache.Misses(),"hits and misses counted");
+
+	Cache.Put("/ws/2/release/1",Metadata("two"),20);
+	Check("two"==Cached(Cache,"/ws/2/release/1"),"result replaced");
+	Check(1==Cache.NumEntries() && 20==Cache.Bytes(),"replaced entry counted once");
+
+	MusicBrainz5::CMetadata Result;
+	bool NotFound=false;
+	Cache.PutNotFound("/ws/2/release/3");
+	Check(!Cache.Get("/ws/2/release/3",Result),"missing resource not returned as a result");
+	Check(Cache.Get("/ws/2/release/3",Result,NotFound) && NotFound,"missing resource remembered");
+
+	Cache.SetTTL("label",0);
+	Cache.Put("/ws/2/label/1",Metadata("label"),10);
+	Check(""==Cached(Cache,"/ws/2/label/1"),"entity with no time to live not cached");
+
+	Cache.Remove("/ws/2/release/3");
+	Check(!Cache.Get("/ws/2/release/3",Result,NotFound),"entry removed");
+
+	//Least recently used entries are evicted first
+
+	Cache.Clear();
+	Check(0==Cache.NumEntries() && 0==Cache.Bytes(),"cache cleared");
+	Check(0!=Cache.Hits(),"counters kept when cleared");
+
+	Cache.Put("/ws/2/artist/a",Metadata("a"),10);
+	Cache.Put("/ws/2/artist/b",Metadata("b"),10);
+	Cache.Put("/ws/2/artist/c",Metadata("c"),10);
+	Cached(Cache,"/ws/2/artist/a");
+	Cache.Put("/ws/2/artist/d",Metadata("d"),10);
+	Check(3==Cache.NumEntries() && 1==Cache.Evictions(),"entry evicted over the entry limit");
+	Check(""==Cached(Cache,"/ws/2/artist/b"),"least recently used entry evicted");
+	Check("a"==Cached(Cache,"/ws/2/artist/a"),"recently used entry kept");
+
+	Cache.SetLimits(10,100);
+	Cache.Clear();
+	Cache.Put("/ws/2/artist/a",Metadata("a"),60);
+	Cache.Put("/ws/2/artist/b",Metadata("b"),60);
+	Check(""==Cached(Cache,"/ws/2/artist/a") && "b"==Cached(Cache,"/ws/2/artist/b"),"entry evicted over the size limit");
+	Check(60==Cache.Bytes(),"size of the entries counted");
+
+	Cache.Put("/ws/2/artist/c",Metadata("c"),200);
+	Check(""==Cached(Cache,"/ws/2/artist/c") && "b"==Cached(Cache,"/ws/2/artist/b"),"entry larger than the cache not added");
+
+	//Expired entries are only kept if they can be revalidated
+
+	Cache.SetTTL("recording",1);
+	Cache.Put("/ws/2/recording/1",Metadata("plain"),10);
+	Cache.Put("/ws/2/recording/2",Metadata("tagged"),10,"\"etag\"");
+	Check("tagged"==Cached(Cache,"/ws/2/recording/2"),"entry returned before it expires");
+
+	struct timespec Expire={1,200000000};
+	nanosleep(&Expire,0);
+
+	std::string ETag;
+	std::string LastModified;
+	Check(""==Cached(Cache,"/ws/2/recording/2"),"expired entry not returned");
+	Check(!Cache.GetStale("/ws/2/recording/1",Result,ETag,LastModified),"expired entry without an ETag not kept");
+	Check(Cache.GetStale("/ws/2/recording/2",Result,ETag,LastModified) && "tagged"==Result.Generator() && "\"etag\""==ETag,"expired entry kept for revalidation");
+
+	Cache.Touch("/ws/2/recording/2");
+	Check("tagged"==Cached(Cache,"/ws/2/recording/2"),"touched entry returned again");
+
+	return Report();
+}
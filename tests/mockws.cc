@@ -0,0 +1,562 @@
+/* --------------------------------------------------------------------------
+
+   libmusicbrainz5 - Client library to access MusicBrainz
+
+   Copyright (C) 2012 Andrew Hawkins
+
+   This file is part of libmusicbrainz5.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   libmusicbrainz5 is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+     $Id$
+
+----------------------------------------------------------------------------*/
+
+/*
+ * A small stand in for the MusicBrainz web service, for load testing the library on a
+ * single machine. It serves XML responses from a fixture directory laid out in the
+ * same way as for MusicBrainz5::CFileTransport, so a request for
+ * /ws/2/release/ID?inc=labels is answered from DIR/ws/2/release/ID?inc=labels.xml, or
+ * DIR/ws/2/release/ID.xml if that does not exist.
+ *
+ * Point a MusicBrainz5::CQuery at it with CQuery("test","localhost",PORT). Sending
+ * SIGINT or SIGTERM prints the counters and exits.
+ */
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <map>
+
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/types.h>
+
+#include "MonotonicTime.h"
+
+class CSettings
+{
+public:
+	CSettings()
+	:	m_Port(8080),
+		m_Directory("."),
+		m_Latency(0),
+		m_Jitter(0),
+		m_Rate(0),
+		m_Burst(1),
+		m_MaxConnections(0),
+		m_IdleTimeout(15)
+	{
+	}
+
+	int m_Port;
+	std::string m_Directory;
+	int m_Latency;
+	int m_Jitter;
+	double m_Rate;
+	int m_Burst;
+	int m_MaxConnections;
+	int m_IdleTimeout;
+};
+
+class CStats
+{
+public:
+	CStats()
+	:	m_Accepted(0),
+		m_Refused(0),
+		m_Active(0),
+		m_MaxActive(0),
+		m_Requests(0),
+		m_OK(0),
+		m_NotFound(0),
+		m_Throttled(0),
+		m_Tokens(0),
+		m_LastRefill(0)
+	{
+		pthread_mutex_init(&m_Lock,0);
+	}
+
+	~CStats()
+	{
+		pthread_mutex_destroy(&m_Lock);
+	}
+
+	int m_Accepted;
+	int m_Refused;
+	int m_Active;
+	int m_MaxActive;
+	int m_Requests;
+	int m_OK;
+	int m_NotFound;
+	int m_Throttled;
+	double m_Tokens;
+	double m_LastRefill;
+	pthread_mutex_t m_Lock;
+};
+
+static CSettings Settings;
+static CStats Stats;
+static volatile sig_atomic_t Stop=0;
+
+static void HandleSignal(int)
+{
+	Stop=1;
+}
+
+//Token bucket shared by all connections, as the real server limits by client address
+
+static bool Allow()
+{
+	if (Settings.m_Rate<=0)
+		return true;
+
+	bool Ret=false;
+
+	pthread_mutex_lock(&Stats.m_Lock);
+
+	double Now=MusicBrainz5::MonotonicTime();
+	Stats.m_Tokens+=(Now-Stats.m_LastRefill)*Settings.m_Rate;
+	if (Stats.m_Tokens>Settings.m_Burst)
+		Stats.m_Tokens=Settings.m_Burst;
+	Stats.m_LastRefill=Now;
+
+	if (Stats.m_Tokens>=1)
+	{
+		Stats.m_Tokens-=1;
+		Ret=true;
+	}
+
+	pthread_mutex_unlock(&Stats.m_Lock);
+
+	return Ret;
+}
+
+static void Count(int& Counter)
+{
+	pthread_mutex_lock(&Stats.m_Lock);
+	Counter++;
+	pthread_mutex_unlock(&Stats.m_Lock);
+}
+
+static std::string Decode(const std::string& URL)
+{
+	std::string Ret;
+
+	for (std::string::size_type Pos=0;Pos<URL.length();Pos++)
+	{
+		if ('%'==URL[Pos] && Pos+2<URL.length())
+		{
+			Ret+=(char)strtol(URL.substr(Pos+1,2).c_str(),0,16);
+			Pos+=2;
+		}
+		else if ('+'==URL[Pos])
+			Ret+=' ';
+		else
+			Ret+=URL[Pos];
+	}
+
+	return Ret;
+}
+
+static bool ReadFile(const std::string& FileName, std::string& Body)
+{
+	FILE *fptr=fopen(FileName.c_str(),"rb");
+	if (!fptr)
+		return false;
+
+	char Buffer[65536];
+	size_t Length;
+
+	while (0!=(Length=fread(Buffer,1,sizeof(Buffer),fptr)))
+		Body.append(Buffer,Length);
+
+	fclose(fptr);
+
+	return true;
+}
+
+static bool WriteAll(int Socket, const std::string& Data)
+{
+	std::string::size_type Pos=0;
+
+	while (Pos<Data.length())
+	{
+		ssize_t Written=send(Socket,Data.data()+Pos,Data.length()-Pos,MSG_NOSIGNAL);
+		if (Written<=0)
+		{
+			if (Written<0 && EINTR==errno)
+				continue;
+
+			return false;
+		}
+
+		Pos+=Written;
+	}
+
+	return true;
+}
+
+static std::string Response(int Status, const std::string& Reason, const std::string& Body, bool Close,
+								const std::string& Extra="")
+{
+	std::stringstream os;
+
+	os << "HTTP/1.1 " << Status << " " << Reason << "\r\n";
+	os << "Content-Type: application/xml; charset=UTF-8\r\n";
+	os << "Content-Length: " << Body.length() << "\r\n";
+	os << Extra;
+	if (Close)
+		os << "Connection: close\r\n";
+	os << "\r\n";
+	os << Body;
+
+	return os.str();
+}
+
+static std::string Error(const std::string& Text)
+{
+	return "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<error><text>"+Text+"</text></error>\n";
+}
+
+static std::string Serve(const std::string& Method, const std::string& Target, bool Close, unsigned int& Seed)
+{
+	Count(Stats.m_Requests);
+
+	if (Settings.m_Latency>0 || Settings.m_Jitter>0)
+	{
+		int Delay=Settings.m_Latency;
+		if (Settings.m_Jitter>0)
+			Delay+=rand_r(&Seed)%(Settings.m_Jitter+1);
+
+		usleep(Delay*1000);
+	}
+
+	if (!Allow())
+	{
+		Count(Stats.m_Throttled);
+		return Response(503,"Service Unavailable",Error("Your requests are exceeding the allowable rate limit."),Close,"Retry-After: 1\r\n");
+	}
+
+	std::string URL=Decode(Target);
+	std::string Body;
+
+	if ("GET"!=Method)
+	{
+		//Collection edits just need to succeed
+
+		Body="<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<metadata><message><text>OK</text></message></metadata>\n";
+	}
+	else if (URL.find("..")==std::string::npos)
+	{
+		if (!ReadFile(Settings.m_Directory+URL+".xml",Body))
+		{
+			std::string::size_type QueryPos=URL.find('?');
+			if (std::string::npos!=QueryPos)
+				ReadFile(Settings.m_Directory+URL.substr(0,QueryPos)+".xml",Body);
+		}
+	}
+
+	if (Body.empty())
+	{
+		Count(Stats.m_NotFound);
+		return Response(404,"Not Found",Error("Not Found"),Close);
+	}
+
+	Count(Stats.m_OK);
+	return Response(200,"OK",Body,Close);
+}
+
+static void *Connection(void *Arg)
+{
+	int Socket=(int)(long)Arg;
+
+	struct timeval Timeout;
+	Timeout.tv_sec=Settings.m_IdleTimeout;
+	Timeout.tv_usec=0;
+	setsockopt(Socket,SOL_SOCKET,SO_RCVTIMEO,&Timeout,sizeof(Timeout));
+
+	int NoDelay=1;
+	setsockopt(Socket,IPPROTO_TCP,TCP_NODELAY,&NoDelay,sizeof(NoDelay));
+
+	//Each connection has its own thread, so each has its own seed for rand_r
+
+	unsigned int Seed=(unsigned int)time(0)^(unsigned int)Socket;
+
+	std::string Buffer;
+	bool Close=false;
+
+	while (!Close)
+	{
+		std::string::size_type HeaderEnd;
+
+		while (std::string::npos==(HeaderEnd=Buffer.find("\r\n\r\n")))
+		{
+			char Block[16384];
+			ssize_t Received=recv(Socket,Block,sizeof(Block),0);
+			if (Received<=0)
+			{
+				if (Received<0 && EINTR==errno && !Stop)
+					continue;
+
+				Close=true;
+				break;
+			}
+
+			Buffer.append(Block,Received);
+		}
+
+		if (Close)
+			break;
+
+		std::string Header=Buffer.substr(0,HeaderEnd);
+		Buffer.erase(0,HeaderEnd+4);
+
+		std::string Method;
+		std::string Target;
+		std::string Version;
+		size_t ContentLength=0;
+
+		std::stringstream Lines(Header);
+		std::string Line;
+
+		std::getline(Lines,Line);
+		std::stringstream RequestLine(Line);
+		RequestLine >> Method >> Target >> Version;
+
+		Close="HTTP/1.1"!=Version.substr(0,8);
+
+		while (std::getline(Lines,Line))
+		{
+			std::string::size_type Colon=Line.find(':');
+			if (std::string::npos==Colon)
+				continue;
+
+			std::string Name=Line.substr(0,Colon);
+			std::string Value=Line.substr(Colon+1);
+			while (!Value.empty() && (' '==Value[0]))
+				Value.erase(0,1);
+			while (!Value.empty() && ('\r'==Value[Value.length()-1] || ' '==Value[Value.length()-1]))
+				Value.erase(Value.length()-1);
+
+			if (0==strcasecmp(Name.c_str(),"Content-Length"))
+				ContentLength=strtoul(Value.c_str(),0,10);
+			else if (0==strcasecmp(Name.c_str(),"Connection"))
+				Close=0==strcasecmp(Value.c_str(),"close");
+		}
+
+		//Discard any request body
+
+		while (Buffer.length()<ContentLength)
+		{
+			char Block[16384];
+			ssize_t Received=recv(Socket,Block,sizeof(Block),0);
+			if (Received<=0)
+			{
+				Close=true;
+				break;
+			}
+
+			Buffer.append(Block,Received);
+		}
+
+		if (Buffer.length()<ContentLength)
+			break;
+
+		Buffer.erase(0,ContentLength);
+
+		if (!WriteAll(Socket,Serve(Method,Target,Close,Seed)))
+			break;
+	}
+
+	close(Socket);
+
+	pthread_mutex_lock(&Stats.m_Lock);
+	Stats.m_Active--;
+	pthread_mutex_unlock(&Stats.m_Lock);
+
+	return 0;
+}
+
+static void Usage(const char *Program)
+{
+	std::cerr << "Usage: " << Program << " [options]" << std::endl;
+	std::cerr << "  -p PORT     Port to listen on (default 8080)" << std::endl;
+	std::cerr << "  -d DIR      Directory containing the ws/2 fixtures (default .)" << std::endl;
+	std::cerr << "  -l MS       Latency added to each request, in milliseconds" << std::endl;
+	std::cerr << "  -j MS       Random extra latency of up to MS milliseconds" << std::endl;
+	std::cerr << "  -r RATE     Requests per second allowed before returning 503 (default unlimited)" << std::endl;
+	std::cerr << "  -b BURST    Requests allowed back to back within the rate (default 1)" << std::endl;
+	std::cerr << "  -c MAX      Maximum number of open connections (default unlimited)" << std::endl;
+	std::cerr << "  -i SECONDS  Close connections idle for this long (default 15)" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+	int Option;
+
+	while (-1!=(Option=getopt(argc,argv,"p:d:l:j:r:b:c:i:h")))
+	{
+		switch (Option)
+		{
+			case 'p':
+				Settings.m_Port=atoi(optarg);
+				break;
+
+			case 'd':
+				Settings.m_Directory=optarg;
+				break;
+
+			case 'l':
+				Settings.m_Latency=atoi(optarg);
+				break;
+
+			case 'j':
+				Settings.m_Jitter=atoi(optarg);
+				break;
+
+			case 'r':
+				Settings.m_Rate=atof(optarg);
+				break;
+
+			case 'b':
+				Settings.m_Burst=atoi(optarg)>0 ? atoi(optarg) : 1;
+				break;
+
+			case 'c':
+				Settings.m_MaxConnections=atoi(optarg);
+				break;
+
+			case 'i':
+				Settings.m_IdleTimeout=atoi(optarg);
+				break;
+
+			default:
+				Usage(argv[0]);
+				return 1;
+		}
+	}
+
+	Stats.m_Tokens=Settings.m_Burst;
+	Stats.m_LastRefill=MusicBrainz5::MonotonicTime();
+
+	int Listener=socket(AF_INET,SOCK_STREAM,0);
+	if (-1==Listener)
+	{
+		perror("socket");
+		return 1;
+	}
+
+	int Reuse=1;
+	setsockopt(Listener,SOL_SOCKET,SO_REUSEADDR,&Reuse,sizeof(Reuse));
+
+	struct sockaddr_in Address;
+	memset(&Address,0,sizeof(Address));
+	Address.sin_family=AF_INET;
+	Address.sin_addr.s_addr=htonl(INADDR_LOOPBACK);
+	Address.sin_port=htons(Settings.m_Port);
+
+	if (-1==bind(Listener,(struct sockaddr *)&Address,sizeof(Address)) || -1==listen(Listener,SOMAXCONN))
+	{
+		perror("bind");
+		return 1;
+	}
+
+	//No SA_RESTART, so that accept returns when a signal arrives
+
+	struct sigaction Action;
+	memset(&Action,0,sizeof(Action));
+	Action.sa_handler=HandleSignal;
+	sigaction(SIGINT,&Action,0);
+	sigaction(SIGTERM,&Action,0);
+
+	std::cout << "Serving " << Settings.m_Directory << " on port " << Settings.m_Port << std::endl;
+
+	while (!Stop)
+	{
+		int Socket=accept(Listener,0,0);
+		if (-1==Socket)
+			continue;
+
+		bool Refuse=false;
+
+		pthread_mutex_lock(&Stats.m_Lock);
+
+		if (Settings.m_MaxConnections>0 && Stats.m_Active>=Settings.m_MaxConnections)
+		{
+			Stats.m_Refused++;
+			Refuse=true;
+		}
+		else
+		{
+			Stats.m_Accepted++;
+			Stats.m_Active++;
+			if (Stats.m_Active>Stats.m_MaxActive)
+				Stats.m_MaxActive=Stats.m_Active;
+		}
+
+		pthread_mutex_unlock(&Stats.m_Lock);
+
+		if (Refuse)
+		{
+			WriteAll(Socket,Response(503,"Service Unavailable",Error("Too many connections"),true,"Retry-After: 1\r\n"));
+			close(Socket);
+			continue;
+		}
+
+		pthread_t Thread;
+		pthread_attr_t Attr;
+		pthread_attr_init(&Attr);
+		pthread_attr_setdetachstate(&Attr,PTHREAD_CREATE_DETACHED);
+
+		if (0!=pthread_create(&Thread,&Attr,Connection,(void *)(long)Socket))
+		{
+			close(Socket);
+
+			pthread_mutex_lock(&Stats.m_Lock);
+			Stats.m_Active--;
+			pthread_mutex_unlock(&Stats.m_Lock);
+		}
+
+		pthread_attr_destroy(&Attr);
+	}
+
+	close(Listener);
+
+	pthread_mutex_lock(&Stats.m_Lock);
+
+	std::cout << "Connections accepted: " << Stats.m_Accepted << std::endl;
+	std::cout << "Connections refused: " << Stats.m_Refused << std::endl;
+	std::cout << "Most connections open: " << Stats.m_MaxActive << std::endl;
+	std::cout << "Requests: " << Stats.m_Requests << std::endl;
+	std::cout << "Requests per connection: " << (Stats.m_Accepted ? (double)Stats.m_Requests/Stats.m_Accepted : 0) << std::endl;
+	std::cout << "200 OK: " << Stats.m_OK << std::endl;
+	std::cout << "404 Not Found: " << Stats.m_NotFound << std::endl;
+	std::cout << "503 Throttled: " << Stats.m_Throttled << std::endl;
+
+	pthread_mutex_unlock(&Stats.m_Lock);
+
+	return 0;
+}
@@ -0,0 +1,152 @@
+/* --------------------------------------------------------------------------
+
+   libmusicbrainz5 - Client library to access MusicBrainz
+
+   Copyright (C) 2012 Andrew Hawkins
+
+   This file is part of libmusicbrainz5.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   libmusicbrainz5 is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+     $Id$
+
+----------------------------------------------------------------------------*/
+
+/*
+ * Checks that every way of parsing a response builds the same entities. Each file
+ * named on the command line is parsed into a document, fed to the push parser in small
+ * chunks, read with the streaming parser and parsed lazily, and the serialised
+ * metadata from each compared with that from the document.
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "musicbrainz5/xmlParser.h"
+#include "musicbrainz5/Metadata.h"
+
+static std::string Serialise(const MusicBrainz5::CEntity& Entity)
+{
+	std::stringstream os;
+	os << Entity;
+	return os.str();
+}
+
+static std::string ParseDocument(const std::string& XML)
+{
+	std::string Ret;
+
+	XMLResults Results;
+	XMLNode *TopNode=XMLRootNode::parseString(XML,&Results);
+	if (Results.code==eXMLErrorNone)
+		Ret=Serialise(MusicBrainz5::CMetadata(*TopNode));
+
+	delete TopNode;
+
+	return Ret;
+}
+
+static std::string ParsePush(const std::string& XML, bool Lazy)
+{
+	std::string Ret;
+
+	//Small chunks, so that elements and text are split between them
+
+	XMLPushParser Parser(Lazy);
+	for (std::string::size_type Pos=0;Pos<XML.length();Pos+=7)
+		Parser.parseChunk(XML.c_str()+Pos,XML.length()-Pos<7 ? XML.length()-Pos : 7);
+
+	XMLResults Results;
+	XMLNode *TopNode=Parser.finish(&Results);
+	if (Results.code==eXMLErrorNone)
+	{
+		MusicBrainz5::CMetadata Metadata;
+
+		if (Lazy)
+		{
+			Metadata.ParseLazily(TopNode);
+			TopNode=0;
+		}
+		else
+			Metadata.Parse(*TopNode);
+
+		Ret=Serialise(Metadata);
+	}
+
+	delete TopNode;
+
+	return Ret;
+}
+
+static std::string ParseStream(const std::string& XML)
+{
+	XMLStreamParser Parser(XML.c_str(),XML.length());
+
+	MusicBrainz5::CMetadata Metadata;
+	Metadata.Parse(Parser.root());
+
+	XMLResults Results;
+	if (!Parser.finish(&Results))
+		return "";
+
+	return Serialise(Metadata);
+}
+
+static bool Check(const std::string& FileName, const std::string& Method, const std::string& Expected, const std::string& Actual)
+{
+	if (Expected!=Actual)
+	{
+		std::cout << FileName << ": " << Method << " parse differs" << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+int main(int argc, const char *argv[])
+{
+	int Failed=0;
+
+	for (int count=1;count<argc;count++)
+	{
+		std::ifstream File(argv[count]);
+		std::stringstream Contents;
+		Contents << File.rdbuf();
+
+		std::string XML=Contents.str();
+		std::string Expected=ParseDocument(XML);
+
+		if (Expected.empty())
+		{
+			std::cout << argv[count] << ": not a valid document" << std::endl;
+			Failed++;
+			continue;
+		}
+
+		if (!Check(argv[count],"push",Expected,ParsePush(XML,false)))
+			Failed++;
+
+		if (!Check(argv[count],"streaming",Expected,ParseStream(XML)))
+			Failed++;
+
+		if (!Check(argv[count],"lazy",Expected,ParsePush(XML,true)))
+			Failed++;
+	}
+
+	std::cout << argc-1 << " files, " << Failed << " failures" << std::endl;
+
+	return Failed ? 1 : 0;
+}
@@ -0,0 +1,90 @@
+/* --------------------------------------------------------------------------
+
+   libmusicbrainz5 - Client library to access MusicBrainz
+
+   Copyright (C) 2012 Andrew Hawkins
+
+   This file is part of libmusicbrainz5.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   libmusicbrainz5 is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this library.  If not, see <http://www.gnu.org/licenses/>.
+
+     $Id$
+
+----------------------------------------------------------------------------*/
+
+/*
+ * Checks the token bucket in MusicBrainz5::CRateLimiter: that a burst is allowed
+ * straight away, that later requests are paced at the rate, that a penalty holds off
+ * every request, and that the defaults for servers are as documented.
+ */
+
+#include <string>
+
+#include "musicbrainz5/RateLimiter.h"
+
+#include "MonotonicTime.h"
+#include "check.h"
+
+//Time taken by a number of calls to Wait, in seconds
+
+static double TimeWaits(MusicBrainz5::CRateLimiter& Limiter, int Waits)
+{
+	double Start=MusicBrainz5::MonotonicTime();
+
+	for (int count=0;count<Waits;count++)
+		Limiter.Wait();
+
+	return MusicBrainz5::MonotonicTime()-Start;
+}
+
+int main(int, const char *[])
+{
+	MusicBrainz5::CRateLimiter Unlimited;
+	Check(0==Unlimited.Rate(),"unlimited by default");
+	Check(TimeWaits(Unlimited,1000)<0.1,"unlimited waits return straight away");
+	Check(Unlimited.TryWait(0),"unlimited TryWait succeeds");
+
+	MusicBrainz5::CRateLimiter Limiter(-5,0);
+	Check(0==Limiter.Rate(),"negative rate means unlimited");
+	Check(1==Limiter.Burst(),"burst is at least one");
+
+	Limiter.SetRate(20,3);
+	Check(20==Limiter.Rate() && 3==Limiter.Burst(),"rate and burst are set");
+
+	Check(Limiter.TryWait(0) && Limiter.TryWait(0) && Limiter.TryWait(0),"whole burst allowed at once");
+	Check(!Limiter.TryWait(0),"no token left after the burst");
+	Check(!Limiter.TryWait(0.01),"TryWait gives up if the next token is too far off");
+
+	double Start=MusicBrainz5::MonotonicTime();
+	Check(Limiter.TryWait(0.5),"TryWait waits for the next token");
+	Check(MusicBrainz5::MonotonicTime()-Start>=0.03,"TryWait slept until the token was due");
+
+	double Paced=TimeWaits(Limiter,5);
+	Check(Paced>=0.2 && Paced<1,"waits are paced at the rate");
+
+	Limiter.SetRate(1000,10);
+	Limiter.Penalise(0.2);
+	Check(!Limiter.TryWait(0.05),"penalty holds off TryWait");
+
+	double Penalised=TimeWaits(Limiter,1);
+	Check(Penalised>=0.1 && Penalised<1,"penalty holds off Wait");
+	Check(TimeWaits(Limiter,5)<0.1,"requests resume once the penalty is over");
+
+	MusicBrainz5::CRateLimiter *MusicBrainz=MusicBrainz5::CRateLimiter::ServerLimiter("musicbrainz.org",80);
+	Check(MusicBrainz==MusicBrainz5::CRateLimiter::ServerLimiter("musicbrainz.org",80),"one limiter per server");
+	Check(0.5==MusicBrainz->Rate(),"musicbrainz.org is limited by default");
+	Check(0==MusicBrainz5::CRateLimiter::ServerLimiter("localhost",8080)->Rate(),"other servers are unlimited by default");
+
+	return Report();
+}